@@ -0,0 +1,357 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Navigation/CrowdAgent.h>
+#include <Urho3D/Navigation/CrowdManager.h>
+#include <Urho3D/Navigation/Navigable.h>
+#include <Urho3D/Navigation/NavigationMesh.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include "CrowdBenchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+/// Default number of agents.
+static const unsigned DEFAULT_NUM_AGENTS = 1000;
+/// Maximum number of agents.
+static const unsigned MAX_NUM_AGENTS = 8000;
+/// Number of agents added or removed with one key press.
+static const unsigned NUM_AGENTS_STEP = 250;
+/// Half size of the square area the agents walk in.
+static const float AREA_HALF_SIZE = 60.0f;
+/// Time in milliseconds between crowd target switches.
+static const unsigned TARGET_INTERVAL = 15000;
+/// Time in milliseconds between statistics updates.
+static const unsigned STATS_INTERVAL = 1000;
+
+URHO3D_DEFINE_APPLICATION_MAIN(CrowdBenchmark)
+
+CrowdBenchmark::CrowdBenchmark(Context* context) :
+    Sample(context)
+{
+}
+
+void CrowdBenchmark::Start()
+{
+    // Execute base class startup
+    Sample::Start();
+
+    // Create the scene content
+    CreateScene();
+
+    // Create the UI content
+    CreateUI();
+
+    // Setup the viewport for displaying the scene
+    SetupViewport();
+
+    // Hook up to the frame update and scene update events
+    SubscribeToEvents();
+
+    // Set the mouse mode to use in the sample
+    Sample::InitMouseMode(MM_RELATIVE);
+}
+
+void CrowdBenchmark::CreateScene()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+
+    // Create a static plane to walk on
+    Node* planeNode = scene_->CreateChild("Plane");
+    planeNode->SetScale(Vector3(AREA_HALF_SIZE * 2.0f, 1.0f, AREA_HALF_SIZE * 2.0f));
+    auto* planeObject = planeNode->CreateComponent<StaticModel>();
+    planeObject->SetModel(cache->GetResource<Model>("Models/Plane.mdl"));
+    planeObject->SetMaterial(cache->GetResource<Material>("Materials/StoneTiled.xml"));
+
+    // Create a Zone component for ambient lighting & fog control
+    Node* zoneNode = scene_->CreateChild("Zone");
+    auto* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.0f, 1000.0f));
+    zone->SetAmbientColor(Color(0.3f, 0.3f, 0.3f));
+    zone->SetFogColor(Color(0.5f, 0.5f, 0.7f));
+    zone->SetFogStart(200.0f);
+    zone->SetFogEnd(300.0f);
+
+    // Create a directional light without shadows, the benchmark is about the crowd update
+    Node* lightNode = scene_->CreateChild("DirectionalLight");
+    lightNode->SetDirection(Vector3(0.6f, -1.0f, 0.8f));
+    auto* light = lightNode->CreateComponent<Light>();
+    light->SetLightType(LIGHT_DIRECTIONAL);
+
+    // Create boxes in the middle of the area so that the crossing crowds have to steer around them and each other
+    Node* boxGroup = scene_->CreateChild("Boxes");
+    for (unsigned i = 0; i < 30; ++i)
+    {
+        Node* boxNode = boxGroup->CreateChild("Box");
+        float size = 2.0f + Random(4.0f);
+        boxNode->SetPosition(Vector3(Random(AREA_HALF_SIZE) - AREA_HALF_SIZE * 0.5f, size * 0.5f,
+            Random(AREA_HALF_SIZE * 1.6f) - AREA_HALF_SIZE * 0.8f));
+        boxNode->SetScale(size);
+        auto* boxObject = boxNode->CreateComponent<StaticModel>();
+        boxObject->SetModel(cache->GetResource<Model>("Models/Box.mdl"));
+        boxObject->SetMaterial(cache->GetResource<Material>("Materials/Stone.xml"));
+    }
+
+    // Build a static navigation mesh from all the geometry in the scene
+    auto* navMesh = scene_->CreateComponent<NavigationMesh>();
+    navMesh->SetTileSize(64);
+    scene_->CreateComponent<Navigable>();
+    navMesh->Build();
+
+    // Create the CrowdManager. The agents are added in SetNumAgents()
+    scene_->CreateComponent<CrowdManager>();
+    agentGroup_ = scene_->CreateChild("Agents");
+
+    // Read the initial agent count from the command line
+    unsigned numAgents = DEFAULT_NUM_AGENTS;
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i + 1 < arguments.Size(); ++i)
+    {
+        if (arguments[i].ToLower() == "-agents")
+            numAgents = ToUInt(arguments[i + 1]);
+    }
+    SetNumAgents(numAgents);
+    SetCrowdTarget();
+
+    // Create the camera high above the area, looking down
+    cameraNode_ = new Node(context_);
+    auto* camera = cameraNode_->CreateComponent<Camera>();
+    camera->SetFarClip(300.0f);
+    cameraNode_->SetPosition(Vector3(0.0f, 90.0f, -60.0f));
+    pitch_ = 55.0f;
+    cameraNode_->SetRotation(Quaternion(pitch_, yaw_, 0.0f));
+}
+
+void CrowdBenchmark::CreateUI()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* ui = GetSubsystem<UI>();
+
+    // Construct new Text object for the instructions and the statistics
+    statsText_ = ui->GetRoot()->CreateChild<Text>();
+    statsText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    statsText_->SetHorizontalAlignment(HA_CENTER);
+    statsText_->SetVerticalAlignment(VA_TOP);
+    statsText_->SetTextAlignment(HA_CENTER);
+    statsText_->SetPosition(0, 10);
+    UpdateStats();
+}
+
+void CrowdBenchmark::SetupViewport()
+{
+    auto* renderer = GetSubsystem<Renderer>();
+
+    // Set up a viewport to the Renderer subsystem so that the 3D scene can be seen
+    SharedPtr<Viewport> viewport(new Viewport(context_, scene_, cameraNode_->GetComponent<Camera>()));
+    renderer->SetViewport(0, viewport);
+}
+
+void CrowdBenchmark::SubscribeToEvents()
+{
+    // Subscribe HandleUpdate() function for processing update events
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(CrowdBenchmark, HandleUpdate));
+
+    // The crowd update happens in the scene subsystem update, which is sent between the scene update and post-update.
+    // Measure the time between them
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(CrowdBenchmark, HandleCrowdUpdateBegin));
+    SubscribeToEvent(scene_, E_SCENEPOSTUPDATE, URHO3D_HANDLER(CrowdBenchmark, HandleCrowdUpdateEnd));
+}
+
+void CrowdBenchmark::MoveCamera(float timeStep)
+{
+    // Do not move if the UI has a focused element (the console)
+    if (GetSubsystem<UI>()->GetFocusElement())
+        return;
+
+    auto* input = GetSubsystem<Input>();
+
+    // Movement speed as world units per second
+    const float MOVE_SPEED = 30.0f;
+    // Mouse sensitivity as degrees per pixel
+    const float MOUSE_SENSITIVITY = 0.1f;
+
+    // Use this frame's mouse motion to adjust camera node yaw and pitch. Clamp the pitch between -90 and 90 degrees
+    IntVector2 mouseMove = input->GetMouseMove();
+    yaw_ += MOUSE_SENSITIVITY * mouseMove.x_;
+    pitch_ += MOUSE_SENSITIVITY * mouseMove.y_;
+    pitch_ = Clamp(pitch_, -90.0f, 90.0f);
+
+    // Construct new orientation for the camera scene node from yaw and pitch. Roll is fixed to zero
+    cameraNode_->SetRotation(Quaternion(pitch_, yaw_, 0.0f));
+
+    // Read WASD keys and move the camera scene node to the corresponding direction if they are pressed
+    if (input->GetKeyDown(KEY_W))
+        cameraNode_->Translate(Vector3::FORWARD * MOVE_SPEED * timeStep);
+    if (input->GetKeyDown(KEY_S))
+        cameraNode_->Translate(Vector3::BACK * MOVE_SPEED * timeStep);
+    if (input->GetKeyDown(KEY_A))
+        cameraNode_->Translate(Vector3::LEFT * MOVE_SPEED * timeStep);
+    if (input->GetKeyDown(KEY_D))
+        cameraNode_->Translate(Vector3::RIGHT * MOVE_SPEED * timeStep);
+
+    // Add or remove agents with the up and down arrows
+    if (input->GetKeyPress(KEY_UP))
+        SetNumAgents(agentGroup_->GetNumChildren() + NUM_AGENTS_STEP);
+    else if (input->GetKeyPress(KEY_DOWN) && agentGroup_->GetNumChildren() > NUM_AGENTS_STEP)
+        SetNumAgents(agentGroup_->GetNumChildren() - NUM_AGENTS_STEP);
+    // Toggle the threaded crowd update with T
+    else if (input->GetKeyPress(KEY_T))
+    {
+        auto* crowdManager = scene_->GetComponent<CrowdManager>();
+        crowdManager->SetThreadedUpdate(!crowdManager->GetThreadedUpdate());
+    }
+}
+
+void CrowdBenchmark::SetNumAgents(unsigned numAgents)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* crowdManager = scene_->GetComponent<CrowdManager>();
+    auto* navMesh = scene_->GetComponent<NavigationMesh>();
+
+    numAgents = Clamp(numAgents, 1U, MAX_NUM_AGENTS);
+
+    // Grow the crowd before adding agents, it will re-add the existing ones
+    if (crowdManager->GetMaxAgents() < numAgents)
+        crowdManager->SetMaxAgents(numAgents);
+
+    while (agentGroup_->GetNumChildren() > numAgents)
+        agentGroup_->GetChildren().Back()->Remove();
+
+    while (agentGroup_->GetNumChildren() < numAgents)
+    {
+        // Start the agents on both sides of the area
+        float side = (agentGroup_->GetNumChildren() & 1u) ? 1.0f : -1.0f;
+        Vector3 position(side * (AREA_HALF_SIZE * 0.6f + Random(AREA_HALF_SIZE * 0.35f)), 0.0f,
+            Random(AREA_HALF_SIZE * 1.9f) - AREA_HALF_SIZE * 0.95f);
+
+        Node* agentNode = agentGroup_->CreateChild("Agent");
+        agentNode->SetPosition(navMesh->FindNearestPoint(position));
+        agentNode->SetScale(Vector3(0.6f, 1.8f, 0.6f));
+        auto* agentObject = agentNode->CreateComponent<StaticModel>();
+        agentObject->SetModel(cache->GetResource<Model>("Models/Cylinder.mdl"));
+        agentObject->SetMaterial(cache->GetResource<Material>("Materials/Stone.xml"));
+
+        auto* agent = agentNode->CreateComponent<CrowdAgent>();
+        agent->SetRadius(0.4f);
+        agent->SetHeight(1.8f);
+        agent->SetMaxSpeed(3.0f + Random(1.0f));
+        agent->SetMaxAccel(8.0f);
+    }
+
+    statsTimer_.Reset();
+    updateTime_ = 0;
+    numUpdates_ = 0;
+}
+
+void CrowdBenchmark::SetCrowdTarget()
+{
+    // Send every other agent to the opposite side so that the two halves of the crowd cross each other
+    targetSide_ = !targetSide_;
+    auto* navMesh = scene_->GetComponent<NavigationMesh>();
+    const Vector<SharedPtr<Node> >& agents = agentGroup_->GetChildren();
+    for (unsigned i = 0; i < agents.Size(); ++i)
+    {
+        float side = ((i & 1u) != 0) == targetSide_ ? -1.0f : 1.0f;
+        Vector3 target(side * (AREA_HALF_SIZE * 0.6f + Random(AREA_HALF_SIZE * 0.35f)), 0.0f,
+            Random(AREA_HALF_SIZE * 1.9f) - AREA_HALF_SIZE * 0.95f);
+        agents[i]->GetComponent<CrowdAgent>()->SetTargetPosition(navMesh->FindNearestPoint(target));
+    }
+
+    targetTimer_.Reset();
+}
+
+void CrowdBenchmark::UpdateStats()
+{
+    auto* crowdManager = scene_->GetComponent<CrowdManager>();
+    auto* queue = GetSubsystem<WorkQueue>();
+
+    statsText_->SetText(
+        "Use WASD keys and mouse to move\n"
+        "Up/Down to add or remove " + String(NUM_AGENTS_STEP) + " agents, T to toggle threaded update\n\n"
+        "Agents: " + String(agentGroup_->GetNumChildren()) +
+        "  Threaded: " + String(crowdManager->GetThreadedUpdate() ? "yes" : "no") +
+        "  Worker threads: " + String(queue->GetNumThreads()) +
+        "\nCrowd update: " + String(averageUpdateTime_) + " ms"
+    );
+}
+
+void CrowdBenchmark::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace Update;
+
+    // Take the frame time step, which is stored as a float
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+
+    // Move the camera, scale movement with time step
+    MoveCamera(timeStep);
+
+    // Swap the crowd targets periodically so that the agents keep crossing
+    if (targetTimer_.GetMSec(false) >= TARGET_INTERVAL)
+        SetCrowdTarget();
+
+    // Refresh the average crowd update time
+    if (statsTimer_.GetMSec(false) >= STATS_INTERVAL)
+    {
+        averageUpdateTime_ = numUpdates_ ? (float)updateTime_ / numUpdates_ / 1000.0f : 0.0f;
+        URHO3D_LOGINFO(ToString("Crowd update of %u agents: %f ms", agentGroup_->GetNumChildren(), averageUpdateTime_));
+        updateTime_ = 0;
+        numUpdates_ = 0;
+        statsTimer_.Reset();
+    }
+
+    UpdateStats();
+}
+
+void CrowdBenchmark::HandleCrowdUpdateBegin(StringHash eventType, VariantMap& eventData)
+{
+    updateTimer_.Reset();
+}
+
+void CrowdBenchmark::HandleCrowdUpdateEnd(StringHash eventType, VariantMap& eventData)
+{
+    updateTime_ += updateTimer_.GetUSec(false);
+    ++numUpdates_;
+}
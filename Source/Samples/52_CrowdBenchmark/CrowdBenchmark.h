@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Core/Timer.h>
+
+#include "Sample.h"
+
+namespace Urho3D
+{
+
+class Node;
+class Scene;
+class Text;
+
+}
+
+/// Crowd benchmark example.
+/// This sample demonstrates:
+///     - Simulating a large crowd with the CrowdManager
+///     - Running the crowd update on the work queue threads
+///     - Measuring the crowd update time with a configurable agent count
+/// The initial agent count can be given on the command line with -agents <count>.
+class CrowdBenchmark : public Sample
+{
+    URHO3D_OBJECT(CrowdBenchmark, Sample);
+
+public:
+    /// Construct.
+    explicit CrowdBenchmark(Context* context);
+
+    /// Setup after engine initialization and before running the main loop.
+    void Start() override;
+
+private:
+    /// Construct the scene content.
+    void CreateScene();
+    /// Construct user interface elements.
+    void CreateUI();
+    /// Set up a viewport for displaying the scene.
+    void SetupViewport();
+    /// Subscribe to application-wide logic update and scene update events.
+    void SubscribeToEvents();
+    /// Read input and moves the camera.
+    void MoveCamera(float timeStep);
+    /// Add or remove agents to reach the requested count.
+    void SetNumAgents(unsigned numAgents);
+    /// Send the agents to the opposite side of the scene.
+    void SetCrowdTarget();
+    /// Update the statistics text.
+    void UpdateStats();
+    /// Handle the logic update event.
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the scene update event, before the crowd update.
+    void HandleCrowdUpdateBegin(StringHash eventType, VariantMap& eventData);
+    /// Handle the scene post-update event, after the crowd update.
+    void HandleCrowdUpdateEnd(StringHash eventType, VariantMap& eventData);
+
+    /// Parent node of the agents.
+    Node* agentGroup_{};
+    /// Timer for the crowd update.
+    HiresTimer updateTimer_;
+    /// Accumulated crowd update time in microseconds.
+    long long updateTime_{};
+    /// Number of accumulated crowd updates.
+    unsigned numUpdates_{};
+    /// Average crowd update time in milliseconds of the last measurement period.
+    float averageUpdateTime_{};
+    /// Measurement period timer.
+    Timer statsTimer_;
+    /// Crowd target timer.
+    Timer targetTimer_;
+    /// Crowd target side.
+    bool targetSide_{};
+    /// Statistics text UI-element.
+    Text* statsText_{};
+};
@@ -0,0 +1,344 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include "PhysicsQueryBenchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+/// Default number of queries.
+static const unsigned DEFAULT_NUM_QUERIES = 2000;
+/// Maximum number of queries.
+static const unsigned MAX_NUM_QUERIES = 50000;
+/// Number of queries added or removed with one key press.
+static const unsigned NUM_QUERIES_STEP = 500;
+/// Half size of the square area the queries are cast in.
+static const float AREA_HALF_SIZE = 60.0f;
+/// Radius of the sphere casts.
+static const float SPHERE_CAST_RADIUS = 0.3f;
+/// Time in milliseconds between statistics updates.
+static const unsigned STATS_INTERVAL = 1000;
+
+URHO3D_DEFINE_APPLICATION_MAIN(PhysicsQueryBenchmark)
+
+PhysicsQueryBenchmark::PhysicsQueryBenchmark(Context* context) :
+    Sample(context)
+{
+}
+
+void PhysicsQueryBenchmark::Start()
+{
+    // Execute base class startup
+    Sample::Start();
+
+    // Create the scene content
+    CreateScene();
+
+    // Create the UI content
+    CreateUI();
+
+    // Setup the viewport for displaying the scene
+    SetupViewport();
+
+    // Hook up to the frame update events
+    SubscribeToEvents();
+
+    // Set the mouse mode to use in the sample
+    Sample::InitMouseMode(MM_RELATIVE);
+}
+
+void PhysicsQueryBenchmark::CreateScene()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+    scene_->CreateComponent<PhysicsWorld>();
+
+    // Create a physical floor
+    Node* floorNode = scene_->CreateChild("Floor");
+    floorNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+    floorNode->SetScale(Vector3(AREA_HALF_SIZE * 2.0f, 1.0f, AREA_HALF_SIZE * 2.0f));
+    auto* floorObject = floorNode->CreateComponent<StaticModel>();
+    floorObject->SetModel(cache->GetResource<Model>("Models/Box.mdl"));
+    floorObject->SetMaterial(cache->GetResource<Material>("Materials/StoneTiled.xml"));
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    // Create a Zone component for ambient lighting & fog control
+    Node* zoneNode = scene_->CreateChild("Zone");
+    auto* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.0f, 1000.0f));
+    zone->SetAmbientColor(Color(0.3f, 0.3f, 0.3f));
+    zone->SetFogColor(Color(0.5f, 0.5f, 0.7f));
+    zone->SetFogStart(200.0f);
+    zone->SetFogEnd(300.0f);
+
+    // Create a directional light without shadows, the benchmark is about the queries
+    Node* lightNode = scene_->CreateChild("DirectionalLight");
+    lightNode->SetDirection(Vector3(0.6f, -1.0f, 0.8f));
+    auto* light = lightNode->CreateComponent<Light>();
+    light->SetLightType(LIGHT_DIRECTIONAL);
+
+    // Create static boxes and triangle mesh mushrooms for the queries to hit
+    for (unsigned i = 0; i < 400; ++i)
+    {
+        Node* objectNode = scene_->CreateChild("Obstacle");
+        auto* object = objectNode->CreateComponent<StaticModel>();
+        auto* shape = objectNode->CreateComponent<CollisionShape>();
+        objectNode->CreateComponent<RigidBody>();
+        objectNode->SetPosition(Vector3(Random(AREA_HALF_SIZE * 2.0f) - AREA_HALF_SIZE, 0.0f,
+            Random(AREA_HALF_SIZE * 2.0f) - AREA_HALF_SIZE));
+        objectNode->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+
+        if (i & 1u)
+        {
+            float size = 1.0f + Random(3.0f);
+            objectNode->Translate(Vector3(0.0f, size * 0.5f, 0.0f), TS_PARENT);
+            objectNode->SetScale(size);
+            object->SetModel(cache->GetResource<Model>("Models/Box.mdl"));
+            object->SetMaterial(cache->GetResource<Material>("Materials/Stone.xml"));
+            shape->SetBox(Vector3::ONE);
+        }
+        else
+        {
+            objectNode->SetScale(1.0f + Random(2.0f));
+            object->SetModel(cache->GetResource<Model>("Models/Mushroom.mdl"));
+            object->SetMaterial(cache->GetResource<Material>("Materials/Mushroom.xml"));
+            shape->SetTriangleMesh(object->GetModel());
+        }
+    }
+
+    // Read the initial query count from the command line
+    unsigned numQueries = DEFAULT_NUM_QUERIES;
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i + 1 < arguments.Size(); ++i)
+    {
+        if (arguments[i].ToLower() == "-queries")
+            numQueries = ToUInt(arguments[i + 1]);
+    }
+    SetNumQueries(numQueries);
+
+    // Create the camera high above the area, looking down
+    cameraNode_ = new Node(context_);
+    auto* camera = cameraNode_->CreateComponent<Camera>();
+    camera->SetFarClip(300.0f);
+    cameraNode_->SetPosition(Vector3(0.0f, 90.0f, -60.0f));
+    pitch_ = 55.0f;
+    cameraNode_->SetRotation(Quaternion(pitch_, yaw_, 0.0f));
+}
+
+void PhysicsQueryBenchmark::CreateUI()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* ui = GetSubsystem<UI>();
+
+    // Construct new Text object for the instructions and the statistics
+    statsText_ = ui->GetRoot()->CreateChild<Text>();
+    statsText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    statsText_->SetHorizontalAlignment(HA_CENTER);
+    statsText_->SetVerticalAlignment(VA_TOP);
+    statsText_->SetTextAlignment(HA_CENTER);
+    statsText_->SetPosition(0, 10);
+    UpdateStats();
+}
+
+void PhysicsQueryBenchmark::SetupViewport()
+{
+    auto* renderer = GetSubsystem<Renderer>();
+
+    // Set up a viewport to the Renderer subsystem so that the 3D scene can be seen
+    SharedPtr<Viewport> viewport(new Viewport(context_, scene_, cameraNode_->GetComponent<Camera>()));
+    renderer->SetViewport(0, viewport);
+}
+
+void PhysicsQueryBenchmark::SubscribeToEvents()
+{
+    // Subscribe HandleUpdate() function for processing update events
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(PhysicsQueryBenchmark, HandleUpdate));
+}
+
+void PhysicsQueryBenchmark::MoveCamera(float timeStep)
+{
+    // Do not move if the UI has a focused element (the console)
+    if (GetSubsystem<UI>()->GetFocusElement())
+        return;
+
+    auto* input = GetSubsystem<Input>();
+
+    // Movement speed as world units per second
+    const float MOVE_SPEED = 30.0f;
+    // Mouse sensitivity as degrees per pixel
+    const float MOUSE_SENSITIVITY = 0.1f;
+
+    // Use this frame's mouse motion to adjust camera node yaw and pitch. Clamp the pitch between -90 and 90 degrees
+    IntVector2 mouseMove = input->GetMouseMove();
+    yaw_ += MOUSE_SENSITIVITY * mouseMove.x_;
+    pitch_ += MOUSE_SENSITIVITY * mouseMove.y_;
+    pitch_ = Clamp(pitch_, -90.0f, 90.0f);
+
+    // Construct new orientation for the camera scene node from yaw and pitch. Roll is fixed to zero
+    cameraNode_->SetRotation(Quaternion(pitch_, yaw_, 0.0f));
+
+    // Read WASD keys and move the camera scene node to the corresponding direction if they are pressed
+    if (input->GetKeyDown(KEY_W))
+        cameraNode_->Translate(Vector3::FORWARD * MOVE_SPEED * timeStep);
+    if (input->GetKeyDown(KEY_S))
+        cameraNode_->Translate(Vector3::BACK * MOVE_SPEED * timeStep);
+    if (input->GetKeyDown(KEY_A))
+        cameraNode_->Translate(Vector3::LEFT * MOVE_SPEED * timeStep);
+    if (input->GetKeyDown(KEY_D))
+        cameraNode_->Translate(Vector3::RIGHT * MOVE_SPEED * timeStep);
+
+    // Add or remove queries with the up and down arrows
+    if (input->GetKeyPress(KEY_UP))
+        SetNumQueries(queries_.Size() + NUM_QUERIES_STEP);
+    else if (input->GetKeyPress(KEY_DOWN) && queries_.Size() > NUM_QUERIES_STEP)
+        SetNumQueries(queries_.Size() - NUM_QUERIES_STEP);
+    // Toggle between raycasts and sphere casts with C
+    else if (input->GetKeyPress(KEY_C))
+    {
+        sphereCast_ = !sphereCast_;
+        SetNumQueries(queries_.Size());
+    }
+}
+
+void PhysicsQueryBenchmark::SetNumQueries(unsigned numQueries)
+{
+    numQueries = Clamp(numQueries, 1U, MAX_NUM_QUERIES);
+
+    // Cast from eye height between random points of the area, as line of sight checks between characters would
+    queries_.Resize(numQueries);
+    for (unsigned i = 0; i < numQueries; ++i)
+    {
+        Vector3 start(Random(AREA_HALF_SIZE * 2.0f) - AREA_HALF_SIZE, 1.7f, Random(AREA_HALF_SIZE * 2.0f) - AREA_HALF_SIZE);
+        Vector3 end(Random(AREA_HALF_SIZE * 2.0f) - AREA_HALF_SIZE, 1.7f, Random(AREA_HALF_SIZE * 2.0f) - AREA_HALF_SIZE);
+        queries_[i] = PhysicsRaycastQuery(Ray(start, end - start), (end - start).Length(), sphereCast_ ? SPHERE_CAST_RADIUS : 0.0f);
+    }
+
+    statsTimer_.Reset();
+    singleTime_ = 0;
+    batchTime_ = 0;
+    numRuns_ = 0;
+}
+
+void PhysicsQueryBenchmark::RunQueries()
+{
+    auto* physicsWorld = scene_->GetComponent<PhysicsWorld>();
+
+    // Issue the queries one at a time
+    singleResults_.Resize(queries_.Size());
+    queryTimer_.Reset();
+    for (unsigned i = 0; i < queries_.Size(); ++i)
+    {
+        const PhysicsRaycastQuery& query = queries_[i];
+        if (sphereCast_)
+            physicsWorld->SphereCast(singleResults_[i], query.ray_, query.radius_, query.maxDistance_, query.collisionMask_);
+        else
+            physicsWorld->RaycastSingle(singleResults_[i], query.ray_, query.maxDistance_, query.collisionMask_);
+    }
+    singleTime_ += queryTimer_.GetUSec(false);
+
+    // Issue the same queries as a batch
+    queryTimer_.Reset();
+    physicsWorld->RaycastSingleBatch(batchResults_, queries_);
+    batchTime_ += queryTimer_.GetUSec(false);
+    ++numRuns_;
+
+    // The batch must find the same bodies
+    numHits_ = 0;
+    numMismatches_ = 0;
+    for (unsigned i = 0; i < queries_.Size(); ++i)
+    {
+        if (singleResults_[i].body_)
+            ++numHits_;
+        if (batchResults_[i].body_ != singleResults_[i].body_ || batchResults_[i].distance_ != singleResults_[i].distance_)
+            ++numMismatches_;
+    }
+}
+
+void PhysicsQueryBenchmark::UpdateStats()
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+
+    statsText_->SetText(
+        "Use WASD keys and mouse to move\n"
+        "Up/Down to add or remove " + String(NUM_QUERIES_STEP) + " queries, C to toggle sphere casts\n\n"
+        "Queries: " + String(queries_.Size()) +
+        "  Type: " + String(sphereCast_ ? "sphere cast" : "raycast") +
+        "  Hits: " + String(numHits_) +
+        "  Worker threads: " + String(queue->GetNumThreads()) +
+        "\nOne at a time: " + String(averageSingleTime_) + " ms  Batched: " + String(averageBatchTime_) + " ms" +
+        (numMismatches_ ? "  Mismatches: " + String(numMismatches_) : String::EMPTY)
+    );
+}
+
+void PhysicsQueryBenchmark::HandleUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace Update;
+
+    // Take the frame time step, which is stored as a float
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+
+    // Move the camera, scale movement with time step
+    MoveCamera(timeStep);
+
+    RunQueries();
+
+    // Refresh the average query times
+    if (statsTimer_.GetMSec(false) >= STATS_INTERVAL)
+    {
+        averageSingleTime_ = numRuns_ ? (float)singleTime_ / numRuns_ / 1000.0f : 0.0f;
+        averageBatchTime_ = numRuns_ ? (float)batchTime_ / numRuns_ / 1000.0f : 0.0f;
+        URHO3D_LOGINFO(ToString("%u queries one at a time: %f ms, batched: %f ms", queries_.Size(), averageSingleTime_,
+            averageBatchTime_));
+        singleTime_ = 0;
+        batchTime_ = 0;
+        numRuns_ = 0;
+        statsTimer_.Reset();
+    }
+
+    UpdateStats();
+}
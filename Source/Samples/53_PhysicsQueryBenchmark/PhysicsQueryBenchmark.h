@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+
+#include "Sample.h"
+
+namespace Urho3D
+{
+
+class Node;
+class Scene;
+class Text;
+
+}
+
+/// Physics query benchmark example.
+/// This sample demonstrates:
+///     - Issuing a large number of raycasts or sphere casts every frame, as for AI line of sight checks
+///     - Running them as one batch on the work queue threads with PhysicsWorld::RaycastSingleBatch()
+///     - Comparing the batched query time against issuing the same queries one at a time
+/// The initial query count can be given on the command line with -queries <count>.
+class PhysicsQueryBenchmark : public Sample
+{
+    URHO3D_OBJECT(PhysicsQueryBenchmark, Sample);
+
+public:
+    /// Construct.
+    explicit PhysicsQueryBenchmark(Context* context);
+
+    /// Setup after engine initialization and before running the main loop.
+    void Start() override;
+
+private:
+    /// Construct the scene content.
+    void CreateScene();
+    /// Construct user interface elements.
+    void CreateUI();
+    /// Set up a viewport for displaying the scene.
+    void SetupViewport();
+    /// Subscribe to application-wide logic update events.
+    void SubscribeToEvents();
+    /// Read input and moves the camera.
+    void MoveCamera(float timeStep);
+    /// Generate the requested number of queries between random points of the area.
+    void SetNumQueries(unsigned numQueries);
+    /// Run the queries one at a time and as a batch, and accumulate the times.
+    void RunQueries();
+    /// Update the statistics text.
+    void UpdateStats();
+    /// Handle the logic update event.
+    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Queries run every frame.
+    PODVector<PhysicsRaycastQuery> queries_;
+    /// Results of the queries issued one at a time.
+    PODVector<PhysicsRaycastResult> singleResults_;
+    /// Results of the batched queries.
+    PODVector<PhysicsRaycastResult> batchResults_;
+    /// Timer for the queries.
+    HiresTimer queryTimer_;
+    /// Accumulated time of the queries issued one at a time in microseconds.
+    long long singleTime_{};
+    /// Accumulated time of the batched queries in microseconds.
+    long long batchTime_{};
+    /// Number of accumulated query runs.
+    unsigned numRuns_{};
+    /// Average time of the queries issued one at a time in milliseconds of the last measurement period.
+    float averageSingleTime_{};
+    /// Average time of the batched queries in milliseconds of the last measurement period.
+    float averageBatchTime_{};
+    /// Number of queries that hit a body on the last run.
+    unsigned numHits_{};
+    /// Number of batched results that differed from the queries issued one at a time on the last run.
+    unsigned numMismatches_{};
+    /// Sphere cast flag.
+    bool sphereCast_{};
+    /// Measurement period timer.
+    Timer statsTimer_;
+    /// Statistics text UI-element.
+    Text* statsText_{};
+};
@@ -0,0 +1,219 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/EventProfiler.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include "EventBenchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+/// Default number of events of each kind sent every frame.
+static const unsigned DEFAULT_NUM_EVENTS = 10000;
+/// Maximum number of events of each kind sent every frame.
+static const unsigned MAX_NUM_EVENTS = 1000000;
+/// Number of events added or removed with one key press.
+static const unsigned NUM_EVENTS_STEP = 5000;
+/// Default number of receivers.
+static const unsigned DEFAULT_NUM_RECEIVERS = 4;
+/// Maximum number of receivers.
+static const unsigned MAX_NUM_RECEIVERS = 1000;
+/// Time in milliseconds between statistics updates.
+static const unsigned STATS_INTERVAL = 1000;
+
+URHO3D_DEFINE_APPLICATION_MAIN(EventBenchmark)
+
+EventBenchmarkReceiver::EventBenchmarkReceiver(Context* context) :
+    Object(context)
+{
+    SubscribeToEvent(E_BENCHMARKNAMED, URHO3D_HANDLER(EventBenchmarkReceiver, HandleNamed));
+    SubscribeToEvent(&EventBenchmarkReceiver::HandleTyped);
+}
+
+void EventBenchmarkReceiver::HandleNamed(StringHash eventType, VariantMap& eventData)
+{
+    using namespace BenchmarkNamed;
+
+    sum_ += eventData[P_VALUE].GetFloat();
+}
+
+void EventBenchmarkReceiver::HandleTyped(const BenchmarkTypedEventData& event)
+{
+    sum_ += event.value_;
+}
+
+EventBenchmark::EventBenchmark(Context* context) :
+    Sample(context),
+    numEvents_(DEFAULT_NUM_EVENTS)
+{
+}
+
+void EventBenchmark::Start()
+{
+    // Execute base class startup
+    Sample::Start();
+
+    // Read the initial event and receiver counts from the command line
+    unsigned numReceivers = DEFAULT_NUM_RECEIVERS;
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i + 1 < arguments.Size(); ++i)
+    {
+        if (arguments[i].ToLower() == "-events")
+            numEvents_ = Clamp(ToUInt(arguments[i + 1]), 1U, MAX_NUM_EVENTS);
+        else if (arguments[i].ToLower() == "-receivers")
+            numReceivers = ToUInt(arguments[i + 1]);
+    }
+    SetNumReceivers(numReceivers);
+
+    // Create the UI content
+    CreateUI();
+
+    // Hook up to the frame update events
+    SubscribeToEvents();
+
+    // Set the mouse mode to use in the sample
+    Sample::InitMouseMode(MM_FREE);
+}
+
+void EventBenchmark::CreateUI()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* ui = GetSubsystem<UI>();
+
+    // Construct new Text object for the instructions and the statistics
+    statsText_ = ui->GetRoot()->CreateChild<Text>();
+    statsText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    statsText_->SetHorizontalAlignment(HA_CENTER);
+    statsText_->SetVerticalAlignment(VA_CENTER);
+    statsText_->SetTextAlignment(HA_CENTER);
+    UpdateStats();
+}
+
+void EventBenchmark::SubscribeToEvents()
+{
+    // Subscribe HandleUpdate() function for processing update events. The handler takes the typed update event
+    SubscribeToEvent(&EventBenchmark::HandleUpdate);
+}
+
+void EventBenchmark::SetNumReceivers(unsigned numReceivers)
+{
+    numReceivers = Clamp(numReceivers, 1U, MAX_NUM_RECEIVERS);
+
+    while (receivers_.Size() < numReceivers)
+        receivers_.Push(SharedPtr<EventBenchmarkReceiver>(new EventBenchmarkReceiver(context_)));
+    receivers_.Resize(numReceivers);
+
+    statsTimer_.Reset();
+    namedTime_ = 0;
+    typedTime_ = 0;
+    numRuns_ = 0;
+}
+
+void EventBenchmark::SendEvents()
+{
+    // Send the events by name, filling the parameters each time as the receivers may modify them
+    eventTimer_.Reset();
+    for (unsigned i = 0; i < numEvents_; ++i)
+    {
+        using namespace BenchmarkNamed;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_INDEX] = i;
+        eventData[P_VALUE] = 1.0f;
+        SendEvent(E_BENCHMARKNAMED, eventData);
+    }
+    namedTime_ += eventTimer_.GetUSec(false);
+
+    // Send the same number of typed events
+    eventTimer_.Reset();
+    for (unsigned i = 0; i < numEvents_; ++i)
+        SendEvent(BenchmarkTypedEventData{i, 1.0f});
+    typedTime_ += eventTimer_.GetUSec(false);
+    ++numRuns_;
+}
+
+void EventBenchmark::UpdateStats()
+{
+    statsText_->SetText(
+        "Up/Down to add or remove " + String(NUM_EVENTS_STEP) + " events per frame, Left/Right to change the number of receivers\n"
+        "P to toggle the event profiler\n\n"
+        "Events per frame: " + String(numEvents_) +
+        "  Receivers: " + String(receivers_.Size()) +
+        "  Event profiler: " + String(EventProfiler::IsActive() ? "on" : "off") +
+        "\nBy name: " + String(averageNamedTime_) + " ns  Typed: " + String(averageTypedTime_) + " ns per event"
+    );
+}
+
+void EventBenchmark::HandleUpdate(const UpdateEventData& event)
+{
+    // Do not react to keys if the UI has a focused element (the console)
+    auto* input = GetSubsystem<Input>();
+    if (!GetSubsystem<UI>()->GetFocusElement())
+    {
+        if (input->GetKeyPress(KEY_UP))
+        {
+            numEvents_ = Min(numEvents_ + NUM_EVENTS_STEP, MAX_NUM_EVENTS);
+            SetNumReceivers(receivers_.Size());
+        }
+        else if (input->GetKeyPress(KEY_DOWN) && numEvents_ > NUM_EVENTS_STEP)
+        {
+            numEvents_ -= NUM_EVENTS_STEP;
+            SetNumReceivers(receivers_.Size());
+        }
+        else if (input->GetKeyPress(KEY_RIGHT))
+            SetNumReceivers(receivers_.Size() * 2);
+        else if (input->GetKeyPress(KEY_LEFT))
+            SetNumReceivers(receivers_.Size() / 2);
+        // The event profiler measures every event sent, which adds to the dispatch cost of both kinds
+        else if (input->GetKeyPress(KEY_P))
+        {
+            EventProfiler::SetActive(!EventProfiler::IsActive());
+            SetNumReceivers(receivers_.Size());
+        }
+    }
+
+    SendEvents();
+
+    // Refresh the average dispatch times
+    if (statsTimer_.GetMSec(false) >= STATS_INTERVAL)
+    {
+        float numSent = (float)numRuns_ * numEvents_;
+        averageNamedTime_ = numRuns_ ? namedTime_ * 1000.0f / numSent : 0.0f;
+        averageTypedTime_ = numRuns_ ? typedTime_ * 1000.0f / numSent : 0.0f;
+        URHO3D_LOGINFO(ToString("%u events to %u receivers by name: %f ns, typed: %f ns per event", numEvents_,
+            receivers_.Size(), averageNamedTime_, averageTypedTime_));
+        namedTime_ = 0;
+        typedTime_ = 0;
+        numRuns_ = 0;
+        statsTimer_.Reset();
+    }
+
+    UpdateStats();
+}
@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Timer.h>
+
+#include "Sample.h"
+
+namespace Urho3D
+{
+
+class Text;
+struct UpdateEventData;
+
+}
+
+/// Benchmark event sent by name.
+URHO3D_EVENT(E_BENCHMARKNAMED, BenchmarkNamed)
+{
+    URHO3D_PARAM(P_INDEX, Index);                  // unsigned
+    URHO3D_PARAM(P_VALUE, Value);                  // float
+}
+
+/// Benchmark event sent typed.
+URHO3D_EVENT(E_BENCHMARKTYPED, BenchmarkTyped)
+{
+    URHO3D_PARAM(P_INDEX, Index);                  // unsigned
+    URHO3D_PARAM(P_VALUE, Value);                  // float
+}
+
+/// Typed benchmark event.
+struct BenchmarkTypedEventData
+{
+    URHO3D_TYPED_EVENT(E_BENCHMARKTYPED);
+
+    /// Convert to event parameters.
+    void ToVariantMap(VariantMap& eventData) const
+    {
+        eventData[BenchmarkTyped::P_INDEX] = index_;
+        eventData[BenchmarkTyped::P_VALUE] = value_;
+    }
+
+    /// Convert from event parameters.
+    void FromVariantMap(VariantMap& eventData)
+    {
+        index_ = eventData[BenchmarkTyped::P_INDEX].GetUInt();
+        value_ = eventData[BenchmarkTyped::P_VALUE].GetFloat();
+    }
+
+    /// Index of the event in the frame.
+    unsigned index_;
+    /// Value to accumulate.
+    float value_;
+};
+
+/// Benchmark event receiver. Accumulates the values of the events it receives.
+class EventBenchmarkReceiver : public Object
+{
+    URHO3D_OBJECT(EventBenchmarkReceiver, Object);
+
+public:
+    /// Construct and subscribe to the benchmark events.
+    explicit EventBenchmarkReceiver(Context* context);
+
+    /// Return accumulated value.
+    float GetSum() const { return sum_; }
+
+private:
+    /// Handle the benchmark event sent by name.
+    void HandleNamed(StringHash eventType, VariantMap& eventData);
+    /// Handle the typed benchmark event.
+    void HandleTyped(const BenchmarkTypedEventData& event);
+
+    /// Accumulated value.
+    float sum_{};
+};
+
+/// Event dispatch benchmark example.
+/// This sample demonstrates:
+///     - Sending events by name with the parameters in a VariantMap
+///     - Sending typed events, which are dispatched to the typed handlers without building a VariantMap
+///     - Comparing the dispatch cost of the two
+/// The initial event and receiver counts can be given on the command line with -events <count> and -receivers <count>.
+class EventBenchmark : public Sample
+{
+    URHO3D_OBJECT(EventBenchmark, Sample);
+
+public:
+    /// Construct.
+    explicit EventBenchmark(Context* context);
+
+    /// Setup after engine initialization and before running the main loop.
+    void Start() override;
+
+private:
+    /// Construct user interface elements.
+    void CreateUI();
+    /// Subscribe to application-wide logic update events.
+    void SubscribeToEvents();
+    /// Create the requested number of receivers.
+    void SetNumReceivers(unsigned numReceivers);
+    /// Send the events by name and typed, and accumulate the times.
+    void SendEvents();
+    /// Update the statistics text.
+    void UpdateStats();
+    /// Handle the logic update event.
+    void HandleUpdate(const UpdateEventData& event);
+
+    /// Event receivers.
+    Vector<SharedPtr<EventBenchmarkReceiver> > receivers_;
+    /// Number of events of each kind sent every frame.
+    unsigned numEvents_{};
+    /// Timer for the events.
+    HiresTimer eventTimer_;
+    /// Accumulated time of the events sent by name in microseconds.
+    long long namedTime_{};
+    /// Accumulated time of the typed events in microseconds.
+    long long typedTime_{};
+    /// Number of accumulated frames.
+    unsigned numRuns_{};
+    /// Average dispatch time of one event sent by name in nanoseconds of the last measurement period.
+    float averageNamedTime_{};
+    /// Average dispatch time of one typed event in nanoseconds of the last measurement period.
+    float averageTypedTime_{};
+    /// Measurement period timer.
+    Timer statsTimer_;
+    /// Statistics text UI-element.
+    Text* statsText_{};
+};
@@ -0,0 +1,237 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/FlatHashMap.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include "ContainerBenchmark.h"
+
+#include <unordered_map>
+
+#include <Urho3D/DebugNew.h>
+
+/// Default number of elements.
+static const unsigned DEFAULT_NUM_ELEMENTS = 100000;
+/// Minimum number of elements.
+static const unsigned MIN_NUM_ELEMENTS = 1000;
+/// Maximum number of elements.
+static const unsigned MAX_NUM_ELEMENTS = 4000000;
+
+URHO3D_DEFINE_APPLICATION_MAIN(ContainerBenchmark)
+
+/// Scramble a number into a pseudo-random key. Each step is invertible, so different numbers give different keys.
+static unsigned ScrambleKey(unsigned value)
+{
+    value ^= value >> 16;
+    value *= 0x7feb352d;
+    value ^= value >> 15;
+    value *= 0x846ca68b;
+    value ^= value >> 16;
+    return value;
+}
+
+/// Return the value of a key that is known to exist.
+template <class T, class U> static U FindValue(const HashMap<T, U>& map, const T& key) { return map.Find(key)->second_; }
+template <class T, class U> static U FindValue(const FlatHashMap<T, U>& map, const T& key) { return map.Find(key)->second_; }
+template <class T, class U> static U FindValue(const std::unordered_map<T, U>& map, const T& key) { return map.find(key)->second; }
+
+/// Return whether a key exists.
+template <class T, class U> static bool HasKey(const HashMap<T, U>& map, const T& key) { return map.Contains(key); }
+template <class T, class U> static bool HasKey(const FlatHashMap<T, U>& map, const T& key) { return map.Contains(key); }
+template <class T, class U> static bool HasKey(const std::unordered_map<T, U>& map, const T& key) { return map.find(key) != map.end(); }
+
+/// Erase a key.
+template <class T, class U> static void EraseKey(HashMap<T, U>& map, const T& key) { map.Erase(key); }
+template <class T, class U> static void EraseKey(FlatHashMap<T, U>& map, const T& key) { map.Erase(key); }
+template <class T, class U> static void EraseKey(std::unordered_map<T, U>& map, const T& key) { map.erase(key); }
+
+/// Return the value of an iterated pair.
+template <class P> static unsigned GetPairValue(const P& pair) { return pair.second_; }
+template <class T, class U> static unsigned GetPairValue(const std::pair<T, U>& pair) { return pair.second; }
+
+/// Measure one container type. The values found are added to the sink.
+template <class MapType> static ContainerBenchmarkResult RunMapBenchmark(const String& name, const PODVector<unsigned>& keys,
+    const PODVector<unsigned>& lookups, const PODVector<unsigned>& misses, unsigned& sink)
+{
+    ContainerBenchmarkResult result;
+    result.name_ = name;
+    HiresTimer timer;
+    MapType map;
+
+    for (unsigned i = 0; i < keys.Size(); ++i)
+        map[keys[i]] = i;
+    result.insertTime_ = timer.GetUSec(true) / 1000.0f;
+
+    for (unsigned i = 0; i < lookups.Size(); ++i)
+        sink += FindValue(map, lookups[i]);
+    result.findTime_ = timer.GetUSec(true) / 1000.0f;
+
+    for (unsigned i = 0; i < misses.Size(); ++i)
+        sink += HasKey(map, misses[i]) ? 1 : 0;
+    result.missTime_ = timer.GetUSec(true) / 1000.0f;
+
+    for (const auto& pair : map)
+        sink += GetPairValue(pair);
+    result.iterateTime_ = timer.GetUSec(true) / 1000.0f;
+
+    for (unsigned i = 0; i < lookups.Size(); ++i)
+        EraseKey(map, lookups[i]);
+    result.eraseTime_ = timer.GetUSec(true) / 1000.0f;
+
+    return result;
+}
+
+ContainerBenchmark::ContainerBenchmark(Context* context) :
+    Sample(context)
+{
+}
+
+void ContainerBenchmark::Start()
+{
+    // Execute base class startup
+    Sample::Start();
+
+    // Create the UI content
+    CreateUI();
+
+    // Read the initial element count from the command line and run the benchmark once
+    unsigned numElements = DEFAULT_NUM_ELEMENTS;
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i + 1 < arguments.Size(); ++i)
+    {
+        if (arguments[i].ToLower() == "-elements")
+            numElements = ToUInt(arguments[i + 1]);
+    }
+    SetNumElements(numElements);
+
+    // Hook up to the frame update events
+    SubscribeToEvents();
+
+    // Set the mouse mode to use in the sample
+    Sample::InitMouseMode(MM_FREE);
+}
+
+void ContainerBenchmark::CreateUI()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* ui = GetSubsystem<UI>();
+
+    // Construct new Text object for the instructions and the results
+    statsText_ = ui->GetRoot()->CreateChild<Text>();
+    statsText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    statsText_->SetHorizontalAlignment(HA_CENTER);
+    statsText_->SetVerticalAlignment(VA_CENTER);
+    statsText_->SetTextAlignment(HA_LEFT);
+}
+
+void ContainerBenchmark::SubscribeToEvents()
+{
+    // Subscribe HandleUpdate() function for processing update events. The handler takes the typed update event
+    SubscribeToEvent(&ContainerBenchmark::HandleUpdate);
+}
+
+void ContainerBenchmark::SetNumElements(unsigned numElements)
+{
+    numElements_ = Clamp(numElements, MIN_NUM_ELEMENTS, MAX_NUM_ELEMENTS);
+
+    // Use pseudo-random unique keys, like string hashes. The keys after the inserted ones are used for the misses
+    keys_.Resize(numElements_);
+    misses_.Resize(numElements_);
+    for (unsigned i = 0; i < numElements_; ++i)
+    {
+        keys_[i] = ScrambleKey(i);
+        misses_[i] = ScrambleKey(i + numElements_);
+    }
+
+    // Find the keys in a shuffled order so that the lookups do not follow the insertion order
+    lookups_ = keys_;
+    SetRandomSeed(1);
+    for (unsigned i = numElements_ - 1; i > 0; --i)
+        Swap(lookups_[i], lookups_[Rand() % (i + 1)]);
+
+    RunBenchmark();
+}
+
+void ContainerBenchmark::RunBenchmark()
+{
+    results_.Clear();
+    results_.Push(RunMapBenchmark<HashMap<unsigned, unsigned> >("HashMap", keys_, lookups_, misses_, sink_));
+    results_.Push(RunMapBenchmark<FlatHashMap<unsigned, unsigned> >("FlatHashMap", keys_, lookups_, misses_, sink_));
+    results_.Push(RunMapBenchmark<std::unordered_map<unsigned, unsigned> >("std::unordered_map", keys_, lookups_, misses_, sink_));
+
+    for (unsigned i = 0; i < results_.Size(); ++i)
+    {
+        const ContainerBenchmarkResult& result = results_[i];
+        URHO3D_LOGINFO(ToString("%s with %u elements: insert %f ms, find %f ms, miss %f ms, iterate %f ms, erase %f ms",
+            result.name_.CString(), numElements_, result.insertTime_, result.findTime_, result.missTime_, result.iterateTime_,
+            result.eraseTime_));
+    }
+
+    UpdateStats();
+}
+
+void ContainerBenchmark::UpdateStats()
+{
+    String text = "Up/Down to double or halve the number of elements, R to run again\n\n"
+        "Elements: " + String(numElements_) + "  Times in milliseconds\n\n"
+        "Container           Insert    Find      Miss      Iterate   Erase\n";
+    for (unsigned i = 0; i < results_.Size(); ++i)
+    {
+        const ContainerBenchmarkResult& result = results_[i];
+        const float times[] = {result.insertTime_, result.findTime_, result.missTime_, result.iterateTime_, result.eraseTime_};
+        String line = result.name_;
+        for (unsigned j = 0; j < 5; ++j)
+        {
+            // Pad to the column
+            int padding = (int)(20 + j * 10) - (int)line.Length();
+            line += String(' ', (unsigned)Max(padding, 1));
+            line += String(Round(times[j] * 100.0f) / 100.0f);
+        }
+        text += line + "\n";
+    }
+
+    statsText_->SetText(text);
+}
+
+void ContainerBenchmark::HandleUpdate(const UpdateEventData& event)
+{
+    // Do not react to keys if the UI has a focused element (the console)
+    auto* input = GetSubsystem<Input>();
+    if (GetSubsystem<UI>()->GetFocusElement())
+        return;
+
+    if (input->GetKeyPress(KEY_UP))
+        SetNumElements(numElements_ * 2);
+    else if (input->GetKeyPress(KEY_DOWN))
+        SetNumElements(numElements_ / 2);
+    else if (input->GetKeyPress(KEY_R))
+        RunBenchmark();
+}
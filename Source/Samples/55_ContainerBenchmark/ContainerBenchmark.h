@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "Sample.h"
+
+namespace Urho3D
+{
+
+class Text;
+struct UpdateEventData;
+
+}
+
+/// Timings of one container in milliseconds.
+struct ContainerBenchmarkResult
+{
+    /// Container name.
+    String name_;
+    /// Time to insert all keys.
+    float insertTime_;
+    /// Time to find all keys.
+    float findTime_;
+    /// Time to look up keys that are not in the container.
+    float missTime_;
+    /// Time to iterate over all pairs.
+    float iterateTime_;
+    /// Time to erase all keys.
+    float eraseTime_;
+};
+
+/// Hash container benchmark example.
+/// This sample demonstrates:
+///     - Using FlatHashMap, the open-addressing hash map, in place of HashMap
+///     - Comparing insert, find, iterate and erase times of HashMap, FlatHashMap and std::unordered_map
+/// The initial element count can be given on the command line with -elements <count>.
+class ContainerBenchmark : public Sample
+{
+    URHO3D_OBJECT(ContainerBenchmark, Sample);
+
+public:
+    /// Construct.
+    explicit ContainerBenchmark(Context* context);
+
+    /// Setup after engine initialization and before running the main loop.
+    void Start() override;
+
+private:
+    /// Construct user interface elements.
+    void CreateUI();
+    /// Subscribe to application-wide logic update events.
+    void SubscribeToEvents();
+    /// Set the element count and run the benchmark.
+    void SetNumElements(unsigned numElements);
+    /// Run the benchmark for all containers.
+    void RunBenchmark();
+    /// Update the statistics text.
+    void UpdateStats();
+    /// Handle the logic update event.
+    void HandleUpdate(const UpdateEventData& event);
+
+    /// Keys inserted, in insertion order.
+    PODVector<unsigned> keys_;
+    /// Keys to find, in a different order.
+    PODVector<unsigned> lookups_;
+    /// Keys not inserted.
+    PODVector<unsigned> misses_;
+    /// Results of the last run.
+    Vector<ContainerBenchmarkResult> results_;
+    /// Number of elements.
+    unsigned numElements_{};
+    /// Sum of the values found, to keep the measured work from being optimized away.
+    unsigned sink_{};
+    /// Statistics text UI-element.
+    Text* statsText_{};
+};
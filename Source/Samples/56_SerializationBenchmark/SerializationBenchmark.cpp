@@ -0,0 +1,233 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/UI/Font.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include "SerializationBenchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+/// Default number of nodes.
+static const unsigned DEFAULT_NUM_NODES = 10000;
+/// Minimum number of nodes.
+static const unsigned MIN_NUM_NODES = 100;
+/// Maximum number of nodes.
+static const unsigned MAX_NUM_NODES = 320000;
+/// Number of times each operation is repeated for the average time.
+static const unsigned NUM_ITERATIONS = 10;
+
+URHO3D_DEFINE_APPLICATION_MAIN(SerializationBenchmark)
+
+SerializationBenchmark::SerializationBenchmark(Context* context) :
+    Sample(context)
+{
+}
+
+void SerializationBenchmark::Start()
+{
+    // Execute base class startup
+    Sample::Start();
+
+    // Create the UI content
+    CreateUI();
+
+    // Read the initial node count from the command line and run the benchmark once
+    unsigned numNodes = DEFAULT_NUM_NODES;
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i + 1 < arguments.Size(); ++i)
+    {
+        if (arguments[i].ToLower() == "-nodes")
+            numNodes = ToUInt(arguments[i + 1]);
+    }
+    SetNumNodes(numNodes);
+
+    // Hook up to the frame update events
+    SubscribeToEvents();
+
+    // Set the mouse mode to use in the sample
+    Sample::InitMouseMode(MM_FREE);
+}
+
+void SerializationBenchmark::CreateUI()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* ui = GetSubsystem<UI>();
+
+    // Construct new Text object for the instructions and the results
+    statsText_ = ui->GetRoot()->CreateChild<Text>();
+    statsText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    statsText_->SetHorizontalAlignment(HA_CENTER);
+    statsText_->SetVerticalAlignment(VA_CENTER);
+    statsText_->SetTextAlignment(HA_LEFT);
+}
+
+void SerializationBenchmark::SubscribeToEvents()
+{
+    // Subscribe HandleUpdate() function for processing update events. The handler takes the typed update event
+    SubscribeToEvent(&SerializationBenchmark::HandleUpdate);
+}
+
+void SerializationBenchmark::SetNumNodes(unsigned numNodes)
+{
+    numNodes_ = Clamp(numNodes, MIN_NUM_NODES, MAX_NUM_NODES);
+
+    // Create a scene of nodes with a model each and a light on every fourth node. The scene is not rendered
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* model = cache->GetResource<Model>("Models/Box.mdl");
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+    nodes_.Resize(numNodes_);
+    for (unsigned i = 0; i < numNodes_; ++i)
+    {
+        Node* node = scene_->CreateChild("Object");
+        node->SetPosition(Vector3((float)(i % 100), 0.0f, (float)(i / 100)));
+        node->SetVar("Health", 100);
+        node->CreateComponent<StaticModel>()->SetModel(model);
+        if (i % 4 == 0)
+            node->CreateComponent<Light>()->SetRange(5.0f);
+        nodes_[i] = node;
+    }
+
+    // Allocate the network states before measuring
+    PrepareNetworkUpdate();
+
+    RunBenchmark();
+}
+
+void SerializationBenchmark::RunBenchmark()
+{
+    HiresTimer timer;
+    VectorBuffer buffer;
+
+    for (unsigned i = 0; i < NUM_ITERATIONS; ++i)
+    {
+        buffer.Clear();
+        scene_->Save(buffer);
+    }
+    saveTime_ = timer.GetUSec(true) / 1000.0f / NUM_ITERATIONS;
+    saveSize_ = buffer.GetSize();
+
+    SharedPtr<Scene> loadScene(new Scene(context_));
+    timer.Reset();
+    for (unsigned i = 0; i < NUM_ITERATIONS; ++i)
+    {
+        MemoryBuffer source(buffer.GetBuffer());
+        loadScene->Load(source);
+    }
+    loadTime_ = timer.GetUSec(true) / 1000.0f / NUM_ITERATIONS;
+    loadScene.Reset();
+
+    timer.Reset();
+    for (unsigned i = 0; i < NUM_ITERATIONS; ++i)
+        PrepareNetworkUpdate();
+    diffTime_ = timer.GetUSec(true) / 1000.0f / NUM_ITERATIONS;
+
+    timer.Reset();
+    for (unsigned i = 0; i < NUM_ITERATIONS; ++i)
+    {
+        for (unsigned j = 0; j < nodes_.Size(); j += 10)
+            nodes_[j]->Translate(Vector3(0.0f, 0.01f, 0.0f));
+        PrepareNetworkUpdate();
+    }
+    diffMovedTime_ = timer.GetUSec(true) / 1000.0f / NUM_ITERATIONS;
+
+    // Read the attributes of all nodes, first one at a time and then in bulk into a reused vector
+    Vector<Variant> values;
+    unsigned sink = 0;
+    timer.Reset();
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        Node* node = nodes_[i];
+        unsigned numAttributes = node->GetNumAttributes();
+        for (unsigned j = 0; j < numAttributes; ++j)
+            sink += node->GetAttribute(j).GetType();
+    }
+    getAttributeTime_ = timer.GetUSec(true) / 1000.0f;
+
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        nodes_[i]->GetAttributeValues(values);
+        for (unsigned j = 0; j < values.Size(); ++j)
+            sink += values[j].GetType();
+    }
+    getAttributeValuesTime_ = timer.GetUSec(true) / 1000.0f;
+
+    URHO3D_LOGINFO(ToString("%u nodes, %u bytes: save %f ms, load %f ms, network diff %f ms, network diff moved %f ms, "
+        "GetAttribute %f ms, GetAttributeValues %f ms (%u)", numNodes_, saveSize_, saveTime_, loadTime_, diffTime_, diffMovedTime_,
+        getAttributeTime_, getAttributeValuesTime_, sink));
+
+    UpdateStats();
+}
+
+void SerializationBenchmark::PrepareNetworkUpdate()
+{
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        Node* node = nodes_[i];
+        node->PrepareNetworkUpdate();
+        const Vector<SharedPtr<Component> >& components = node->GetComponents();
+        for (unsigned j = 0; j < components.Size(); ++j)
+            components[j]->PrepareNetworkUpdate();
+    }
+}
+
+void SerializationBenchmark::UpdateStats()
+{
+    statsText_->SetText("Up/Down to double or halve the number of nodes, R to run again\n\n"
+        "Nodes: " + String(numNodes_) + "  Saved size: " + String(saveSize_) + " bytes  Times in milliseconds\n\n"
+        "Save                    " + String(Round(saveTime_ * 100.0f) / 100.0f) + "\n"
+        "Load                    " + String(Round(loadTime_ * 100.0f) / 100.0f) + "\n"
+        "Network diff            " + String(Round(diffTime_ * 100.0f) / 100.0f) + "\n"
+        "Network diff, 10% moved " + String(Round(diffMovedTime_ * 100.0f) / 100.0f) + "\n"
+        "GetAttribute            " + String(Round(getAttributeTime_ * 100.0f) / 100.0f) + "\n"
+        "GetAttributeValues      " + String(Round(getAttributeValuesTime_ * 100.0f) / 100.0f) + "\n");
+}
+
+void SerializationBenchmark::HandleUpdate(const UpdateEventData& event)
+{
+    // Do not react to keys if the UI has a focused element (the console)
+    auto* input = GetSubsystem<Input>();
+    if (GetSubsystem<UI>()->GetFocusElement())
+        return;
+
+    if (input->GetKeyPress(KEY_UP))
+        SetNumNodes(numNodes_ * 2);
+    else if (input->GetKeyPress(KEY_DOWN))
+        SetNumNodes(numNodes_ / 2);
+    else if (input->GetKeyPress(KEY_R))
+        RunBenchmark();
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "Sample.h"
+
+namespace Urho3D
+{
+
+class Node;
+class Text;
+struct UpdateEventData;
+
+}
+
+/// Serialization benchmark example.
+/// This sample demonstrates:
+///     - Saving and loading a scene in the binary format, where the attributes go through the typed accessors
+///     - Detecting the changed attributes for network replication, as is done each network update for every replicated node and component
+///     - Reading all attributes at once with GetAttributeValues() instead of one GetAttribute() call for each
+/// The initial node count can be given on the command line with -nodes <count>.
+class SerializationBenchmark : public Sample
+{
+    URHO3D_OBJECT(SerializationBenchmark, Sample);
+
+public:
+    /// Construct.
+    explicit SerializationBenchmark(Context* context);
+
+    /// Setup after engine initialization and before running the main loop.
+    void Start() override;
+
+private:
+    /// Construct user interface elements.
+    void CreateUI();
+    /// Subscribe to application-wide logic update events.
+    void SubscribeToEvents();
+    /// Set the node count, recreate the scene and run the benchmark.
+    void SetNumNodes(unsigned numNodes);
+    /// Run the benchmark.
+    void RunBenchmark();
+    /// Check all nodes and components for changed network attributes.
+    void PrepareNetworkUpdate();
+    /// Update the statistics text.
+    void UpdateStats();
+    /// Handle the logic update event.
+    void HandleUpdate(const UpdateEventData& event);
+
+    /// Nodes of the scene.
+    PODVector<Node*> nodes_;
+    /// Number of nodes.
+    unsigned numNodes_{};
+    /// Size of the saved scene in bytes.
+    unsigned saveSize_{};
+    /// Time to save the scene in milliseconds.
+    float saveTime_{};
+    /// Time to load the scene in milliseconds.
+    float loadTime_{};
+    /// Time to check unchanged attributes for network replication in milliseconds.
+    float diffTime_{};
+    /// Time to check attributes for network replication after moving a tenth of the nodes in milliseconds.
+    float diffMovedTime_{};
+    /// Time to read the attributes one at a time in milliseconds.
+    float getAttributeTime_{};
+    /// Time to read the attributes with GetAttributeValues() in milliseconds.
+    float getAttributeValuesTime_{};
+    /// Statistics text UI-element.
+    Text* statsText_{};
+};
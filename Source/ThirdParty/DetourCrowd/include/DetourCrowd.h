@@ -204,6 +204,15 @@ struct dtCrowdAgentDebugInfo
 /// Type for the update callback.
 typedef void (*dtUpdateCallback)(dtCrowdAgent* ag, float dt);
 
+// Urho3D: Add parallel update support
+/// Type for a task that processes the agents in the range [first, last) using the per worker data of @p worker.
+typedef void (*dtParallelTask)(const int first, const int last, const int worker, void* taskData);
+
+/// Type for the parallel for callback. It must split [0, count) into ranges, call @p task for every range and return
+/// only when all of them have completed. A worker index may be used by only one thread at a time and must be less than
+/// the maximum number of workers given to dtCrowd::setParallelFor().
+typedef void (*dtParallelForCallback)(dtParallelTask task, void* taskData, const int count, void* userData);
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
@@ -234,6 +243,14 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
+	// Urho3D: Add parallel update support
+	dtParallelForCallback m_parallelFor;
+	void* m_parallelForUserData;
+	int m_maxWorkers;
+	dtNavMeshQuery** m_workerNavQueries;
+	dtObstacleAvoidanceQuery** m_workerObstacleQueries;
+	int* m_workerSampleCounts;
+
 	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
 	void updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
@@ -242,6 +259,11 @@ class dtCrowd
 
 	bool requestMoveTargetReplan(const int idx, dtPolyRef ref, const float* pos);
 
+	// Urho3D: Add parallel update support
+	void runParallel(const int phase, dtCrowdAgent** agents, const int nagents, const float dt, dtCrowdAgentDebugInfo* debug);
+	static void updatePhase(const int first, const int last, const int worker, void* taskData);
+	void freeWorkers();
+
 	void purge();
 
 public:
@@ -256,6 +278,19 @@ public:
 	///  @param[in]		cb				The update callback.
 	/// @return True if the initialization succeeded.
 	bool init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav, dtUpdateCallback cb = 0);
+
+	// Urho3D: Add parallel update support
+	/// Sets the callback used to run the per agent phases of #update() in parallel. Must be called after #init(), which
+	/// resets it.
+	///  @param[in]		cb				The parallel for callback, or null to update serially.
+	///  @param[in]		userData		The user data passed to the callback.
+	///  @param[in]		maxWorkers		The maximum number of workers the callback uses. [Limit: >= 1]
+	/// @return True if the per worker queries could be allocated.
+	bool setParallelFor(dtParallelForCallback cb, void* userData, const int maxWorkers);
+
+	/// Gets the maximum number of workers of the parallel update.
+	/// @return The maximum number of workers, or 1 if the update is serial.
+	int getMaxWorkers() const { return m_maxWorkers; }
 	
 	/// Sets the shared avoidance configuration for the specified index.
 	///  @param[in]		idx		The index. [Limits: 0 <= value < #DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS]
@@ -122,6 +122,8 @@ void Urho3DPlayer::Setup()
             "-noshadows   Disable shadow rendering\n"
             "-nolimit     Disable frame limiter\n"
             "-nothreads   Disable worker threads\n"
+            "-tickrate <rate> Use fixed tick rate for dedicated server operation\n"
+            "-affinity <mask> Restrict to the logical CPUs in a bit mask\n"
             "-nosound     Disable sound output\n"
             "-noip        Disable sound mixing interpolation\n"
             "-touch       Touch emulation on desktop platform\n"
@@ -427,6 +427,18 @@ static const AttributeInfo& SerializableGetAttributeInfo(unsigned index, Seriali
         return attributes->At(index);
 }
 
+static CScriptArray* SerializableGetAttributeValues(Serializable* ptr)
+{
+    Vector<Variant> values;
+    ptr->GetAttributeValues(values);
+    return VectorToArray<Variant>(values, "Array<Variant>");
+}
+
+static bool SerializableSetAttributeValues(CScriptArray* values, Serializable* ptr)
+{
+    return values && ptr->SetAttributeValues(ArrayToVector<Variant>(values));
+}
+
 static bool SerializableLoad(File* file, Serializable* ptr)
 {
     return file && ptr->Load(*file);
@@ -466,6 +478,8 @@ template <class T> void RegisterSerializable(asIScriptEngine* engine, const char
     engine->RegisterObjectMethod(className, "void RemoveInstanceDefault()", asMETHOD(T, RemoveInstanceDefault), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "Variant GetAttribute(const String&in) const", asMETHODPR(T, GetAttribute, (const String&) const, Variant), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "Variant GetAttributeDefault(const String&in) const", asMETHODPR(T, GetAttributeDefault, (const String&) const, Variant), asCALL_THISCALL);
+    engine->RegisterObjectMethod(className, "Array<Variant>@ GetAttributeValues() const", asFUNCTION(SerializableGetAttributeValues), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(className, "bool SetAttributeValues(Array<Variant>@+)", asFUNCTION(SerializableSetAttributeValues), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(className, "void SetInterceptNetworkUpdate(const String&in, bool)", asMETHODPR(T, SetInterceptNetworkUpdate, (const String&, bool), void), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "bool GetInterceptNetworkUpdate(const String&in) const", asMETHODPR(T, GetInterceptNetworkUpdate, (const String&) const, bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "uint get_numAttributes() const", asMETHODPR(T, GetNumAttributes, () const, unsigned), asCALL_THISCALL);
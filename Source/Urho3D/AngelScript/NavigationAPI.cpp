@@ -27,6 +27,7 @@
 #include "../AngelScript/APITemplates.h"
 #include "../Navigation/Navigable.h"
 #include "../Navigation/CrowdAgent.h"
+#include "../Navigation/CrowdFlowField.h"
 #include "../Navigation/DynamicNavigationMesh.h"
 #include "../Navigation/NavArea.h"
 #include "../Navigation/Obstacle.h"
@@ -56,6 +57,13 @@ static CScriptArray* DynamicNavigationMeshFindPath(const Vector3& start, const V
     return VectorToArray<Vector3>(dest, "Array<Vector3>");
 }
 
+static CScriptArray* NavigationMeshFindPathHierarchical(const Vector3& start, const Vector3& end, const Vector3& extents, unsigned maxRefinedPortals, NavigationMesh* ptr)
+{
+    PODVector<Vector3> dest;
+    ptr->FindPathHierarchical(dest, start, end, extents, maxRefinedPortals);
+    return VectorToArray<Vector3>(dest, "Array<Vector3>");
+}
+
 static CScriptArray* CrowdManagerGetAgents(Node* node, bool inCrowdFilter, CrowdManager* crowd)
 {
     PODVector<CrowdAgent*> agents = crowd->GetAgents(node, inCrowdFilter);
@@ -120,6 +128,13 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "bool Build()", asMETHODPR(T, Build, (), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const BoundingBox&in)", asMETHODPR(T, Build, (const BoundingBox&), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const IntVector2&, const IntVector2&)", asMETHODPR(T, Build, (const IntVector2&, const IntVector2&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool BuildAsync(const BoundingBox&in)", asMETHODPR(T, BuildAsync, (const BoundingBox&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool BuildAsync(const IntVector2&, const IntVector2&)", asMETHODPR(T, BuildAsync, (const IntVector2&, const IntVector2&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void CancelAsyncBuilds()", asMETHOD(T, CancelAsyncBuilds), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void ClearGeometryCache()", asMETHOD(T, ClearGeometryCache), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void CancelPathQueries()", asMETHOD(T, CancelPathQueries), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "Array<Vector3>@ FindPathHierarchical(const Vector3&in, const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0), uint maxRefinedPortals = 0xffffffff)", asFUNCTION(NavigationMeshFindPathHierarchical), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "void UpdatePortalGraph()", asMETHOD(T, UpdatePortalGraph), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "VectorBuffer GetTileData(const IntVector2&) const", asFUNCTION(NavigationMeshGetTileData), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "bool AddTile(const VectorBuffer&in) const", asFUNCTION(NavigationMeshAddTile), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "void RemoveTile(const IntVector2&)", asMETHOD(T, RemoveTile), asCALL_THISCALL);
@@ -168,6 +183,14 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "const BoundingBox& get_boundingBox() const", asMETHOD(T, GetBoundingBox), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "BoundingBox get_worldBoundingBox() const", asMETHOD(T, GetWorldBoundingBox), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "IntVector2 get_numTiles() const", asMETHOD(T, GetNumTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numAsyncBuilds() const", asMETHOD(T, GetNumAsyncBuilds), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numCachedGeometries() const", asMETHOD(T, GetNumCachedGeometries), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_pathQueryTimeBudget(float)", asMETHOD(T, SetPathQueryTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "float get_pathQueryTimeBudget() const", asMETHOD(T, GetPathQueryTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_pathCacheSize(uint)", asMETHOD(T, SetPathCacheSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_pathCacheSize() const", asMETHOD(T, GetPathCacheSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPendingPathQueries() const", asMETHOD(T, GetNumPendingPathQueries), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPortals() const", asMETHOD(T, GetNumPortals), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_partitionType()", asMETHOD(T, SetPartitionType), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "NavmeshPartitionType get_partitionType()", asMETHOD(T, GetPartitionType), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_drawOffMeshConnections(bool)", asMETHOD(T, SetDrawOffMeshConnections), asCALL_THISCALL);
@@ -275,6 +298,8 @@ void RegisterCrowdManager(asIScriptEngine* engine)
     engine->RegisterObjectMethod("CrowdManager", "void set_maxAgents(int)", asMETHOD(CrowdManager, SetMaxAgents), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "float get_maxAgentRadius() const", asMETHOD(CrowdManager, GetMaxAgentRadius), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "void set_maxAgentRadius(float)", asMETHOD(CrowdManager, SetMaxAgentRadius), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "bool get_threadedUpdate() const", asMETHOD(CrowdManager, GetThreadedUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "void set_threadedUpdate(bool)", asMETHOD(CrowdManager, SetThreadedUpdate), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "void set_navMesh(NavigationMesh@+)", asMETHOD(CrowdManager, SetNavigationMesh), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "NavigationMesh@+ get_navMesh() const", asMETHOD(CrowdManager, GetNavigationMesh), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "uint get_numQueryFilterTypes() const", asMETHOD(CrowdManager, GetNumQueryFilterTypes), asCALL_THISCALL);
@@ -350,11 +375,29 @@ void RegisterCrowdAgent(asIScriptEngine* engine)
     engine->RegisterObjectMethod("CrowdAgent", "bool get_inCrowd() const", asMETHOD(CrowdAgent, IsInCrowd), asCALL_THISCALL);
 }
 
+void RegisterCrowdFlowField(asIScriptEngine* engine)
+{
+    RegisterComponent<CrowdFlowField>(engine, "CrowdFlowField");
+    engine->RegisterObjectMethod("CrowdFlowField", "void DrawDebugGeometry(bool)", asMETHODPR(CrowdFlowField, DrawDebugGeometry, (bool), void), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "void SetFlowTarget(const Vector3&in, Node@+ node = null)", asMETHOD(CrowdFlowField, SetFlowTarget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "void SetAgentFlowTarget(CrowdAgent@+, const Vector3&in)", asMETHOD(CrowdFlowField, SetAgentFlowTarget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "void ResetFlowTarget(Node@+ node = null)", asMETHOD(CrowdFlowField, ResetFlowTarget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "void ClearFields()", asMETHOD(CrowdFlowField, ClearFields), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "Vector3 GetFlowDirection(const Vector3&in, const Vector3&in, uint queryFilterType = 0)", asMETHOD(CrowdFlowField, GetFlowDirection), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "float GetFlowDistance(const Vector3&in, const Vector3&in, uint queryFilterType = 0)", asMETHOD(CrowdFlowField, GetFlowDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "bool IsFlowAgent(CrowdAgent@+) const", asMETHOD(CrowdFlowField, IsFlowAgent), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "void set_maxFields(uint)", asMETHOD(CrowdFlowField, SetMaxFields), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "uint get_maxFields() const", asMETHOD(CrowdFlowField, GetMaxFields), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "uint get_numFields() const", asMETHOD(CrowdFlowField, GetNumFields), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdFlowField", "uint get_numAgents() const", asMETHOD(CrowdFlowField, GetNumAgents), asCALL_THISCALL);
+}
+
 void RegisterNavigationAPI(asIScriptEngine* engine)
 {
     RegisterNavigationMesh(engine);
     RegisterCrowdAgent(engine);
     RegisterCrowdManager(engine);
+    RegisterCrowdFlowField(engine);
     RegisterDynamicNavigationMesh(engine);
     RegisterNavArea(engine);
     RegisterNavigable(engine);
@@ -25,7 +25,9 @@
 #include "../Precompiled.h"
 
 #include "../AngelScript/APITemplates.h"
+#include "../Network/ClientPrediction.h"
 #include "../Network/HttpRequest.h"
+#include "../Network/LagCompensation.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkPriority.h"
 
@@ -45,6 +47,87 @@ static void RegisterNetworkPriority(asIScriptEngine* engine)
     engine->RegisterObjectMethod("NetworkPriority", "bool get_alwaysUpdateOwner() const", asMETHOD(NetworkPriority, GetAlwaysUpdateOwner), asCALL_THISCALL);
 }
 
+static void RegisterClientPrediction(asIScriptEngine* engine)
+{
+    RegisterComponent<ClientPrediction>(engine, "ClientPrediction");
+    engine->RegisterObjectMethod("ClientPrediction", "void Reconcile(Connection@+)", asMETHOD(ClientPrediction, Reconcile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "void set_smoothingConstant(float)", asMETHOD(ClientPrediction, SetSmoothingConstant), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "float get_smoothingConstant() const", asMETHOD(ClientPrediction, GetSmoothingConstant), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "void set_snapThreshold(float)", asMETHOD(ClientPrediction, SetSnapThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "float get_snapThreshold() const", asMETHOD(ClientPrediction, GetSnapThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "bool get_replaying() const", asMETHOD(ClientPrediction, IsReplaying), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "const Controls& get_replayControls() const", asMETHOD(ClientPrediction, GetReplayControls), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "const Vector3& get_serverPosition() const", asMETHOD(ClientPrediction, GetServerPosition), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "const Quaternion& get_serverRotation() const", asMETHOD(ClientPrediction, GetServerRotation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ClientPrediction", "const Vector3& get_positionError() const", asMETHOD(ClientPrediction, GetPositionError), asCALL_THISCALL);
+}
+
+static void ConstructLagCompensationRaycastResult(LagCompensationRaycastResult* ptr)
+{
+    new(ptr) LagCompensationRaycastResult();
+}
+
+static void DestructLagCompensationRaycastResult(LagCompensationRaycastResult* ptr)
+{
+    ptr->~LagCompensationRaycastResult();
+}
+
+static Node* LagCompensationRaycastResultGetNode(LagCompensationRaycastResult* ptr)
+{
+    return ptr->node_;
+}
+
+static CScriptArray* LagCompensationRaycast(const Ray& ray, float maxDistance, float time, unsigned occluderMask, LagCompensation* ptr)
+{
+    PODVector<LagCompensationRaycastResult> result;
+    ptr->Raycast(result, ray, maxDistance, time, occluderMask);
+    return VectorToArray<LagCompensationRaycastResult>(result, "Array<LagCompensationRaycastResult>");
+}
+
+static LagCompensationRaycastResult LagCompensationRaycastSingle(const Ray& ray, float maxDistance, float time, unsigned occluderMask, LagCompensation* ptr)
+{
+    LagCompensationRaycastResult result;
+    ptr->RaycastSingle(result, ray, maxDistance, time, occluderMask);
+    return result;
+}
+
+static CScriptArray* LagCompensationGetNodes(const Sphere& sphere, float time, LagCompensation* ptr)
+{
+    PODVector<Node*> result;
+    ptr->GetNodes(result, sphere, time);
+    return VectorToHandleArray<Node>(result, "Array<Node@>");
+}
+
+static void RegisterLagCompensation(asIScriptEngine* engine)
+{
+    engine->RegisterObjectType("LagCompensationRaycastResult", sizeof(LagCompensationRaycastResult), asOBJ_VALUE | asOBJ_APP_CLASS_C);
+    engine->RegisterObjectBehaviour("LagCompensationRaycastResult", asBEHAVE_CONSTRUCT, "void f()", asFUNCTION(ConstructLagCompensationRaycastResult), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("LagCompensationRaycastResult", asBEHAVE_DESTRUCT, "void f()", asFUNCTION(DestructLagCompensationRaycastResult), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("LagCompensationRaycastResult", "LagCompensationRaycastResult& opAssign(const LagCompensationRaycastResult&in)", asMETHODPR(LagCompensationRaycastResult, operator =, (const LagCompensationRaycastResult&), LagCompensationRaycastResult&), asCALL_THISCALL);
+    engine->RegisterObjectProperty("LagCompensationRaycastResult", "Vector3 position", offsetof(LagCompensationRaycastResult, position_));
+    engine->RegisterObjectProperty("LagCompensationRaycastResult", "Vector3 normal", offsetof(LagCompensationRaycastResult, normal_));
+    engine->RegisterObjectProperty("LagCompensationRaycastResult", "float distance", offsetof(LagCompensationRaycastResult, distance_));
+    engine->RegisterObjectProperty("LagCompensationRaycastResult", "uint hitbox", offsetof(LagCompensationRaycastResult, hitbox_));
+    engine->RegisterObjectMethod("LagCompensationRaycastResult", "Node@+ get_node() const", asFUNCTION(LagCompensationRaycastResultGetNode), asCALL_CDECL_OBJLAST);
+
+    RegisterComponent<LagCompensation>(engine, "LagCompensation");
+    engine->RegisterObjectMethod("LagCompensation", "void AddNode(Node@+, const BoundingBox&in hitbox = BoundingBox())", asMETHOD(LagCompensation, AddNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "void RemoveNode(Node@+)", asMETHOD(LagCompensation, RemoveNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "void Clear()", asMETHOD(LagCompensation, Clear), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "void Record()", asMETHOD(LagCompensation, Record), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "Array<LagCompensationRaycastResult>@ Raycast(const Ray&in, float, float, uint occluderMask = 0)", asFUNCTION(LagCompensationRaycast), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("LagCompensation", "LagCompensationRaycastResult RaycastSingle(const Ray&in, float, float, uint occluderMask = 0)", asFUNCTION(LagCompensationRaycastSingle), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("LagCompensation", "Array<Node@>@ GetNodes(const Sphere&in, float)", asFUNCTION(LagCompensationGetNodes), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("LagCompensation", "float GetRewindTime(Connection@+) const", asMETHOD(LagCompensation, GetRewindTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "void set_historySize(uint)", asMETHOD(LagCompensation, SetHistorySize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "uint get_historySize() const", asMETHOD(LagCompensation, GetHistorySize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "void set_interpolationDelay(float)", asMETHOD(LagCompensation, SetInterpolationDelay), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "float get_interpolationDelay() const", asMETHOD(LagCompensation, GetInterpolationDelay), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "uint get_numNodes() const", asMETHOD(LagCompensation, GetNumNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "float get_oldestTime() const", asMETHOD(LagCompensation, GetOldestTime), asCALL_THISCALL);
+    engine->RegisterObjectMethod("LagCompensation", "float get_newestTime() const", asMETHOD(LagCompensation, GetNewestTime), asCALL_THISCALL);
+}
+
 void SendRemoteEvent(const String& eventType, bool inOrder, const VariantMap& eventData, Connection* ptr)
 {
     ptr->SendRemoteEvent(eventType, inOrder, eventData);
@@ -71,6 +154,8 @@ static void RegisterConnection(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Connection", "bool get_connected() const", asMETHOD(Connection, IsConnected), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "bool get_connectPending() const", asMETHOD(Connection, IsConnectPending), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "bool get_sceneLoaded() const", asMETHOD(Connection, IsSceneLoaded), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "uint get_numPendingNodes() const", asMETHOD(Connection, GetNumPendingNodes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "uint get_numPendingSceneUpdates() const", asMETHOD(Connection, GetNumPendingSceneUpdates), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "String get_address() const", asMETHOD(Connection, GetAddress), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "uint16 get_port() const", asMETHOD(Connection, GetPort), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "float get_roundTripTime() const", asMETHOD(Connection, GetRoundTripTime), asCALL_THISCALL);
@@ -89,6 +174,10 @@ static void RegisterConnection(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Connection", "void SendPackageToClient(PackageFile@+)", asMETHOD(Connection, SendPackageToClient), asCALL_THISCALL);
     engine->RegisterObjectProperty("Connection", "Controls controls", offsetof(Connection, controls_));
     engine->RegisterObjectProperty("Connection", "uint8 timeStamp", offsetof(Connection, timeStamp_));
+    engine->RegisterObjectMethod("Connection", "uint get_controlsSequence() const", asMETHOD(Connection, GetControlsSequence), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "uint get_ackedControlsSequence() const", asMETHOD(Connection, GetAckedControlsSequence), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "void set_maxControlsHistory(uint)", asMETHOD(Connection, SetMaxControlsHistory), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "uint get_maxControlsHistory() const", asMETHOD(Connection, GetMaxControlsHistory), asCALL_THISCALL);
     engine->RegisterObjectProperty("Connection", "VariantMap identity", offsetof(Connection, identity_));
 
     // Register SetOwner/GetOwner now
@@ -188,8 +277,17 @@ void RegisterNetwork(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Network", "int get_simulatedLatency() const", asMETHOD(Network, GetSimulatedLatency), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "void set_simulatedPacketLoss(float)", asMETHOD(Network, SetSimulatedPacketLoss), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "float get_simulatedPacketLoss() const", asMETHOD(Network, GetSimulatedPacketLoss), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_createNodeBudget(uint)", asMETHOD(Network, SetCreateNodeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "uint get_createNodeBudget() const", asMETHOD(Network, GetCreateNodeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_createNodeTimeBudget(float)", asMETHOD(Network, SetCreateNodeTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "float get_createNodeTimeBudget() const", asMETHOD(Network, GetCreateNodeTimeBudget), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "void set_packageCacheDir(const String&in)", asMETHOD(Network, SetPackageCacheDir), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "const String& get_packageCacheDir() const", asMETHOD(Network, GetPackageCacheDir), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void set_statisticsEnabled(bool)", asMETHOD(Network, SetStatisticsEnabled), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool get_statisticsEnabled() const", asMETHOD(Network, GetStatisticsEnabled), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "void ResetStatistics()", asMETHOD(Network, ResetStatistics), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "String PrintStatistics() const", asMETHOD(Network, PrintStatistics), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Network", "bool SaveStatistics(const String&in) const", asMETHOD(Network, SaveStatistics), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "bool get_serverRunning() const", asMETHOD(Network, IsServerRunning), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "Connection@+ get_serverConnection() const", asMETHOD(Network, GetServerConnection), asCALL_THISCALL);
     engine->RegisterObjectMethod("Network", "Array<Connection@>@ get_clientConnections() const", asFUNCTION(NetworkGetClientConnections), asCALL_CDECL_OBJLAST);
@@ -202,6 +300,8 @@ void RegisterNetworkAPI(asIScriptEngine* engine)
     RegisterConnection(engine);
     RegisterHttpRequest(engine);
     RegisterNetwork(engine);
+    RegisterClientPrediction(engine);
+    RegisterLagCompensation(engine);
 }
 
 }
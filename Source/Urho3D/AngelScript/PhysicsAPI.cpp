@@ -64,6 +64,21 @@ static RigidBody* PhysicsRaycastResultGetRigidBody(PhysicsRaycastResult* ptr)
     return ptr->body_;
 }
 
+static void ConstructPhysicsRaycastQuery(PhysicsRaycastQuery* ptr)
+{
+    new(ptr) PhysicsRaycastQuery();
+}
+
+static void ConstructPhysicsRaycastQueryInit(const Ray& ray, float maxDistance, float radius, unsigned collisionMask, PhysicsRaycastQuery* ptr)
+{
+    new(ptr) PhysicsRaycastQuery(ray, maxDistance, radius, collisionMask);
+}
+
+static void DestructPhysicsRaycastQuery(PhysicsRaycastQuery* ptr)
+{
+    ptr->~PhysicsRaycastQuery();
+}
+
 static void RegisterCollisionShape(asIScriptEngine* engine)
 {
     engine->RegisterEnum("ShapeType");
@@ -257,6 +272,13 @@ static PhysicsRaycastResult PhysicsWorldSphereCast(const Ray& ray, float radius,
     return result;
 }
 
+static CScriptArray* PhysicsWorldRaycastSingleBatch(CScriptArray* queries, PhysicsWorld* ptr)
+{
+    PODVector<PhysicsRaycastResult> result;
+    ptr->RaycastSingleBatch(result, ArrayToPODVector<PhysicsRaycastQuery>(queries));
+    return VectorToArray<PhysicsRaycastResult>(result, "Array<PhysicsRaycastResult>");
+}
+
 static PhysicsRaycastResult PhysicsWorldConvexCast(CollisionShape* shape, const Vector3& startPos, const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask, PhysicsWorld* ptr)
 {
     PhysicsRaycastResult result;
@@ -307,6 +329,16 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectProperty("PhysicsRaycastResult", "float hitFraction", offsetof(PhysicsRaycastResult, hitFraction_));
     engine->RegisterObjectMethod("PhysicsRaycastResult", "RigidBody@+ get_body() const", asFUNCTION(PhysicsRaycastResultGetRigidBody), asCALL_CDECL_OBJLAST);
 
+    engine->RegisterObjectType("PhysicsRaycastQuery", sizeof(PhysicsRaycastQuery), asOBJ_VALUE | asOBJ_APP_CLASS_C);
+    engine->RegisterObjectBehaviour("PhysicsRaycastQuery", asBEHAVE_CONSTRUCT, "void f()", asFUNCTION(ConstructPhysicsRaycastQuery), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("PhysicsRaycastQuery", asBEHAVE_CONSTRUCT, "void f(const Ray&in, float, float radius = 0.0f, uint collisionMask = 0xffff)", asFUNCTION(ConstructPhysicsRaycastQueryInit), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("PhysicsRaycastQuery", asBEHAVE_DESTRUCT, "void f()", asFUNCTION(DestructPhysicsRaycastQuery), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsRaycastQuery", "PhysicsRaycastQuery& opAssign(const PhysicsRaycastQuery&in)", asMETHODPR(PhysicsRaycastQuery, operator =, (const PhysicsRaycastQuery&), PhysicsRaycastQuery&), asCALL_THISCALL);
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "Ray ray", offsetof(PhysicsRaycastQuery, ray_));
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "float maxDistance", offsetof(PhysicsRaycastQuery, maxDistance_));
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "float radius", offsetof(PhysicsRaycastQuery, radius_));
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "uint collisionMask", offsetof(PhysicsRaycastQuery, collisionMask_));
+
     RegisterComponent<PhysicsWorld>(engine, "PhysicsWorld");
     engine->RegisterObjectMethod("PhysicsWorld", "void Update(float)", asMETHOD(PhysicsWorld, Update), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void UpdateCollisions()", asMETHOD(PhysicsWorld, UpdateCollisions), asCALL_THISCALL);
@@ -314,6 +346,7 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult RaycastSingle(const Ray&in, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycastSingle), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult RaycastSingleSegmented(const Ray&in, float, float, uint collisionMask = 0xffff, float overlapDistance = 0.1f)", asFUNCTION(PhysicsWorldRaycastSingleSegmented), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult SphereCast(const Ray&in, float, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldSphereCast), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ RaycastSingleBatch(Array<PhysicsRaycastQuery>@+)", asFUNCTION(PhysicsWorldRaycastSingleBatch), asCALL_CDECL_OBJLAST);
     // There seems to be a bug in AngelScript resulting in a crash if we use an auto handle with this function.
     // Work around by manually releasing the CollisionShape handle
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult ConvexCast(CollisionShape@, const Vector3&in, const Quaternion&in, const Vector3&in, const Quaternion&in, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldConvexCast), asCALL_CDECL_OBJLAST);
@@ -339,6 +372,14 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_internalEdge() const", asMETHOD(PhysicsWorld, GetInternalEdge), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void set_splitImpulse(bool)", asMETHOD(PhysicsWorld, SetSplitImpulse), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_splitImpulse() const", asMETHOD(PhysicsWorld, GetSplitImpulse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_maxThreads(uint)", asMETHOD(PhysicsWorld, SetMaxThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "uint get_maxThreads() const", asMETHOD(PhysicsWorld, GetMaxThreads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_deterministic(bool)", asMETHOD(PhysicsWorld, SetDeterministic), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_deterministic() const", asMETHOD(PhysicsWorld, IsDeterministic), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_useCookedGeometry(bool)", asMETHOD(PhysicsWorld, SetUseCookedGeometry), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_useCookedGeometry() const", asMETHOD(PhysicsWorld, GetUseCookedGeometry), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_saveCookedGeometry(bool)", asMETHOD(PhysicsWorld, SetSaveCookedGeometry), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_saveCookedGeometry() const", asMETHOD(PhysicsWorld, GetSaveCookedGeometry), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "PhysicsWorld@+ get_physicsWorld() const", asFUNCTION(SceneGetPhysicsWorld), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("PhysicsWorld@+ get_physicsWorld()", asFUNCTION(GetPhysicsWorld), asCALL_CDECL);
 }
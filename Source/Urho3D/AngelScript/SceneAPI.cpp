@@ -27,6 +27,7 @@
 #include "../IO/PackageFile.h"
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/Scene.h"
+#include "../Scene/SceneStreamer.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
 #include "../Scene/ValueAnimation.h"
@@ -180,6 +181,11 @@ static CScriptArray* SceneGetNodesWithTag(const String& tag, Scene* ptr)
     return VectorToHandleArray<Node>(nodes, "Array<Node@>");
 }
 
+static CScriptArray* SceneGetComponentsOfType(const String& typeName, Scene* ptr)
+{
+    return VectorToHandleArray<Component>(ptr->GetComponentsOfType(typeName), "Array<Component@>");
+}
+
 static bool SceneLoadJSONVectorBuffer(VectorBuffer& buffer, Scene* ptr)
 {
     return ptr->LoadJSON(buffer);
@@ -190,6 +196,26 @@ static bool SceneLoadJSON(File* file, Scene* ptr)
     return file && ptr->LoadJSON(*file);
 }
 
+static bool SceneLoadChunked(File* file, Scene* ptr)
+{
+    return file && ptr->LoadChunked(*file);
+}
+
+static bool SceneLoadChunkedVectorBuffer(VectorBuffer& buffer, Scene* ptr)
+{
+    return ptr->LoadChunked(buffer);
+}
+
+static bool SceneSaveChunked(File* file, Scene* ptr)
+{
+    return file && ptr->SaveChunked(*file);
+}
+
+static bool SceneSaveChunkedVectorBuffer(VectorBuffer& buffer, Scene* ptr)
+{
+    return ptr->SaveChunked(buffer);
+}
+
 static bool SceneSaveXML(File* file, const String& indentation, Scene* ptr)
 {
     return file && ptr->SaveXML(*file, indentation);
@@ -329,6 +355,41 @@ static void RegisterSplinePath(asIScriptEngine* engine)
     engine->RegisterObjectMethod("SplinePath", "bool get_isFinished() const", asMETHOD(SplinePath, IsFinished), asCALL_THISCALL);
 }
 
+static void RegisterSceneStreamer(asIScriptEngine* engine)
+{
+    engine->RegisterEnum("StreamingCellState");
+    engine->RegisterEnumValue("StreamingCellState", "CELL_UNLOADED", CELL_UNLOADED);
+    engine->RegisterEnumValue("StreamingCellState", "CELL_LOADING", CELL_LOADING);
+    engine->RegisterEnumValue("StreamingCellState", "CELL_LOADED", CELL_LOADED);
+
+    RegisterComponent<SceneStreamer>(engine, "SceneStreamer");
+    engine->RegisterGlobalFunction("uint PartitionStreamingCells(Scene@+, float)", asFUNCTION(SceneStreamer::Partition), asCALL_CDECL);
+    engine->RegisterObjectMethod("SceneStreamer", "void AddFocus(Node@+)", asMETHOD(SceneStreamer, AddFocus), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void RemoveFocus(Node@+)", asMETHOD(SceneStreamer, RemoveFocus), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void RemoveAllFocus()", asMETHOD(SceneStreamer, RemoveAllFocus), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "bool LoadCell(uint)", asMETHOD(SceneStreamer, LoadCell), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void UnloadCell(uint)", asMETHOD(SceneStreamer, UnloadCell), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void UnloadAllCells()", asMETHOD(SceneStreamer, UnloadAllCells), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "StreamingCellState GetCellState(uint) const", asMETHOD(SceneStreamer, GetCellState), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "Vector3 GetCellPosition(uint) const", asMETHOD(SceneStreamer, GetCellPosition), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "Node@+ GetCellNode(uint) const", asMETHOD(SceneStreamer, GetCellNode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "uint64 GetCellMemoryUse(uint) const", asMETHOD(SceneStreamer, GetCellMemoryUse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "bool set_worldFile(const String&in)", asMETHOD(SceneStreamer, SetWorldFile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "const String& get_worldFile() const", asMETHOD(SceneStreamer, GetWorldFile), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void set_loadDistance(float)", asMETHOD(SceneStreamer, SetLoadDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "float get_loadDistance() const", asMETHOD(SceneStreamer, GetLoadDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void set_unloadDistance(float)", asMETHOD(SceneStreamer, SetUnloadDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "float get_unloadDistance() const", asMETHOD(SceneStreamer, GetUnloadDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void set_maxLoads(uint)", asMETHOD(SceneStreamer, SetMaxLoads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "uint get_maxLoads() const", asMETHOD(SceneStreamer, GetMaxLoads), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "void set_timeBudget(int)", asMETHOD(SceneStreamer, SetTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "int get_timeBudget() const", asMETHOD(SceneStreamer, GetTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "uint get_numFocus() const", asMETHOD(SceneStreamer, GetNumFocus), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "uint get_numCells() const", asMETHOD(SceneStreamer, GetNumCells), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "uint get_numLoadedCells() const", asMETHOD(SceneStreamer, GetNumLoadedCells), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SceneStreamer", "uint64 get_memoryUse() const", asMETHOD(SceneStreamer, GetMemoryUse), asCALL_THISCALL);
+}
+
 static void RegisterScene(asIScriptEngine* engine)
 {
     engine->RegisterEnum("LoadMode");
@@ -352,6 +413,10 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "bool LoadJSON(VectorBuffer&)", asFUNCTION(SceneLoadJSONVectorBuffer), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "bool SaveJSON(File@+, const String&in indentation = \"\t\")", asFUNCTION(SceneSaveJSON), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "bool SaveJSON(VectorBuffer&, const String&in indentation = \"\t\")", asFUNCTION(SceneSaveJSONVectorBuffer), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "bool LoadChunked(File@+)", asFUNCTION(SceneLoadChunked), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "bool LoadChunked(VectorBuffer&)", asFUNCTION(SceneLoadChunkedVectorBuffer), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "bool SaveChunked(File@+) const", asFUNCTION(SceneSaveChunked), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "bool SaveChunked(VectorBuffer&) const", asFUNCTION(SceneSaveChunkedVectorBuffer), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Scene", "bool LoadAsync(File@+, LoadMode mode = LOAD_SCENE_AND_RESOURCES)", asMETHOD(Scene, LoadAsync), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "bool LoadAsyncXML(File@+, LoadMode mode = LOAD_SCENE_AND_RESOURCES)", asMETHOD(Scene, LoadAsyncXML), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void StopAsyncLoading()", asMETHOD(Scene, StopAsyncLoading), asCALL_THISCALL);
@@ -377,6 +442,7 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "void UnregisterAllVars(const String&in)", asMETHOD(Scene, UnregisterAllVars), asCALL_THISCALL);
 
     engine->RegisterObjectMethod("Scene", "Array<Node@>@ GetNodesWithTag(const String&in) const", asFUNCTION(SceneGetNodesWithTag), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Scene", "Array<Component@>@ GetComponentsOfType(const String&in)", asFUNCTION(SceneGetComponentsOfType), asCALL_CDECL_OBJLAST);
 
     engine->RegisterObjectMethod("Scene", "Component@+ GetComponent(uint) const", asMETHODPR(Scene, GetComponent, (unsigned) const, Component*), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "Node@+ GetNode(uint) const", asMETHOD(Scene, GetNode), asCALL_THISCALL);
@@ -392,6 +458,9 @@ static void RegisterScene(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Scene", "float get_smoothingConstant() const", asMETHOD(Scene, GetSmoothingConstant), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "void set_snapThreshold(float)", asMETHOD(Scene, SetSnapThreshold), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "float get_snapThreshold() const", asMETHOD(Scene, GetSnapThreshold), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "void set_batchedTransformUpdate(bool)", asMETHOD(Scene, SetBatchedTransformUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "bool get_batchedTransformUpdate() const", asMETHOD(Scene, GetBatchedTransformUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Scene", "void UpdateTransforms()", asMETHOD(Scene, UpdateTransforms), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "bool get_asyncLoading() const", asMETHOD(Scene, IsAsyncLoading), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "float get_asyncProgress() const", asMETHOD(Scene, GetAsyncProgress), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "LoadMode get_asyncLoadMode() const", asMETHOD(Scene, GetAsyncLoadMode), asCALL_THISCALL);
@@ -420,6 +489,7 @@ void RegisterSceneAPI(asIScriptEngine* engine)
     RegisterSmoothedTransform(engine);
     RegisterSplinePath(engine);
     RegisterScene(engine);
+    RegisterSceneStreamer(engine);
 }
 
 }
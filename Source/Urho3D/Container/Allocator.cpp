@@ -119,4 +119,74 @@ void AllocatorFree(AllocatorBlock* allocator, void* ptr)
     allocator->free_ = node;
 }
 
+ArenaAllocator::ArenaAllocator(unsigned blockSize) :
+    blocks_(nullptr),
+    current_(nullptr),
+    end_(nullptr),
+    blockSize_(blockSize ? blockSize : 1),
+    usedSize_(0),
+    capacity_(0),
+    generation_(0)
+{
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    while (blocks_)
+    {
+        ArenaBlock* next = blocks_->next_;
+        delete[] reinterpret_cast<unsigned char*>(blocks_);
+        blocks_ = next;
+    }
+}
+
+void ArenaAllocator::Reset()
+{
+    ++generation_;
+    usedSize_ = 0;
+
+    if (!blocks_)
+        return;
+
+    if (blocks_->next_)
+    {
+        // Coalesce into one block so that the next round fits without overflowing
+        unsigned totalSize = capacity_;
+        while (blocks_)
+        {
+            ArenaBlock* next = blocks_->next_;
+            delete[] reinterpret_cast<unsigned char*>(blocks_);
+            blocks_ = next;
+        }
+        capacity_ = 0;
+        ReserveBlock(totalSize);
+    }
+    else
+    {
+        current_ = reinterpret_cast<unsigned char*>(blocks_) + sizeof(ArenaBlock);
+        end_ = current_ + blocks_->size_;
+    }
+}
+
+void* ArenaAllocator::AllocateFromNewBlock(unsigned size, unsigned alignment)
+{
+    // Reserve room for aligning the start of the data, which is only guaranteed to be aligned as the block header
+    unsigned blockSize = size + alignment;
+    ReserveBlock(blockSize > blockSize_ ? blockSize : blockSize_);
+    return Allocate(size, alignment);
+}
+
+void ArenaAllocator::ReserveBlock(unsigned size)
+{
+    auto* blockPtr = new unsigned char[sizeof(ArenaBlock) + size];
+    auto* newBlock = reinterpret_cast<ArenaBlock*>(blockPtr);
+    newBlock->size_ = size;
+    newBlock->next_ = blocks_;
+    blocks_ = newBlock;
+    capacity_ += size;
+
+    current_ = blockPtr + sizeof(ArenaBlock);
+    end_ = current_ + size;
+}
+
 }
@@ -67,6 +67,81 @@ URHO3D_API void* AllocatorReserve(AllocatorBlock* allocator);
 /// Free a node. Does not free any blocks.
 URHO3D_API void AllocatorFree(AllocatorBlock* allocator, void* ptr);
 
+/// %Arena allocator memory block.
+struct ArenaBlock
+{
+    /// Size of the data.
+    unsigned size_;
+    /// Next (older) arena block.
+    ArenaBlock* next_;
+    /// Data follows.
+};
+
+/// Linear %arena allocator. Allocations are only bumps of a pointer and are never freed individually; all memory is reclaimed at once on Reset(). Not thread-safe, use one arena per thread.
+class URHO3D_API ArenaAllocator
+{
+public:
+    /// Construct with the default block size.
+    explicit ArenaAllocator(unsigned blockSize = 65536);
+    /// Destruct. Frees all blocks.
+    ~ArenaAllocator();
+
+    /// Prevent copy construction.
+    ArenaAllocator(const ArenaAllocator& rhs) = delete;
+    /// Prevent assignment.
+    ArenaAllocator& operator =(const ArenaAllocator& rhs) = delete;
+
+    /// Allocate memory with alignment, which must be a power of two. Creates a new block if necessary.
+    void* Allocate(unsigned size, unsigned alignment = 16)
+    {
+        auto* ptr = reinterpret_cast<unsigned char*>((reinterpret_cast<size_t>(current_) + alignment - 1) & ~(size_t)(alignment - 1));
+        if (!current_ || ptr + size > end_)
+            return AllocateFromNewBlock(size, alignment);
+        usedSize_ += (unsigned)(ptr + size - current_);
+        current_ = ptr + size;
+        return ptr;
+    }
+
+    /// Allocate uninitialized memory for an array of objects.
+    template <class T> T* Allocate(unsigned count) { return static_cast<T*>(Allocate(count * (unsigned)sizeof(T), (unsigned)alignof(T))); }
+
+    /// Reclaim all allocated memory. If the allocations overflowed into several blocks, they are replaced by one block large enough for all of them, so that steady use needs no further allocation.
+    void Reset();
+
+    /// Return the number of resets so far. Memory allocated before a reset must no longer be used.
+    unsigned GetGeneration() const { return generation_; }
+
+    /// Return bytes allocated since the last reset, including alignment padding.
+    unsigned GetUsedSize() const { return usedSize_; }
+
+    /// Return the total size of the blocks.
+    unsigned GetCapacity() const { return capacity_; }
+
+    /// Return the minimum block size.
+    unsigned GetBlockSize() const { return blockSize_; }
+
+private:
+    /// Allocate from a new block when the current block is exhausted.
+    void* AllocateFromNewBlock(unsigned size, unsigned alignment);
+    /// Create a block and make it current.
+    void ReserveBlock(unsigned size);
+
+    /// Blocks, the current block first.
+    ArenaBlock* blocks_;
+    /// Current allocation position.
+    unsigned char* current_;
+    /// End of the current block.
+    unsigned char* end_;
+    /// Minimum block size.
+    unsigned blockSize_;
+    /// Bytes allocated since the last reset.
+    unsigned usedSize_;
+    /// Total size of the blocks.
+    unsigned capacity_;
+    /// Number of resets.
+    unsigned generation_;
+};
+
 /// %Allocator template class. Allocates objects of a specific class.
 template <class T> class Allocator
 {
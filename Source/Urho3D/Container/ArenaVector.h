@@ -0,0 +1,375 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Container/VectorBase.h"
+
+#include <cassert>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// %Vector template class which allocates its buffer from an ArenaAllocator. Growing leaves the old buffer to the arena, so it suits transient data that is filled and discarded within the arena's lifetime, such as one frame. After the arena is reset the contents are invalid, and the vector must be cleared before reuse. Element destructors are run on Clear() and destruction, but not for memory already reclaimed by the arena.
+template <class T> class ArenaVector
+{
+public:
+    using ValueType = T;
+    using Iterator = RandomAccessIterator<T>;
+    using ConstIterator = RandomAccessConstIterator<T>;
+
+    /// Construct empty without an arena.
+    ArenaVector() noexcept :
+        allocator_(nullptr),
+        buffer_(nullptr),
+        size_(0),
+        capacity_(0),
+        generation_(0)
+    {
+    }
+
+    /// Construct empty with an arena.
+    explicit ArenaVector(ArenaAllocator* allocator) noexcept :
+        allocator_(allocator),
+        buffer_(nullptr),
+        size_(0),
+        capacity_(0),
+        generation_(0)
+    {
+    }
+
+    /// Copy-construct from another vector. Allocates from the same arena.
+    ArenaVector(const ArenaVector<T>& vector) :
+        allocator_(vector.allocator_),
+        buffer_(nullptr),
+        size_(0),
+        capacity_(0),
+        generation_(0)
+    {
+        *this = vector;
+    }
+
+    /// Move-construct from another vector. Takes over the buffer without touching the elements, so that also a vector whose arena has been reset can be relocated.
+    ArenaVector(ArenaVector<T>&& vector) noexcept :
+        allocator_(vector.allocator_),
+        buffer_(vector.buffer_),
+        size_(vector.size_),
+        capacity_(vector.capacity_),
+        generation_(vector.generation_)
+    {
+        vector.ForgetBuffer();
+    }
+
+    /// Destruct.
+    ~ArenaVector()
+    {
+        DestructElements();
+    }
+
+    /// Assign from another vector.
+    ArenaVector<T>& operator =(const ArenaVector<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            assert(rhs.IsCurrent());
+            Clear();
+            if (!allocator_)
+                allocator_ = rhs.allocator_;
+            Reserve(rhs.size_);
+            for (unsigned i = 0; i < rhs.size_; ++i)
+                new(buffer_ + i) T(rhs.buffer_[i]);
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    /// Move-assign from another vector. Takes over the buffer and the arena.
+    ArenaVector<T>& operator =(ArenaVector<T>&& rhs) noexcept
+    {
+        if (&rhs != this)
+        {
+            DestructElements();
+            allocator_ = rhs.allocator_;
+            buffer_ = rhs.buffer_;
+            size_ = rhs.size_;
+            capacity_ = rhs.capacity_;
+            generation_ = rhs.generation_;
+            rhs.ForgetBuffer();
+        }
+        return *this;
+    }
+
+    /// Return element at index.
+    T& operator [](unsigned index)
+    {
+        assert(index < size_ && IsCurrent());
+        return buffer_[index];
+    }
+
+    /// Return const element at index.
+    const T& operator [](unsigned index) const
+    {
+        assert(index < size_ && IsCurrent());
+        return buffer_[index];
+    }
+
+    /// Set the arena. Clears the vector.
+    void SetAllocator(ArenaAllocator* allocator)
+    {
+        Clear();
+        if (allocator != allocator_)
+        {
+            ForgetBuffer();
+            allocator_ = allocator;
+        }
+    }
+
+    /// Add an element at the end.
+    void Push(const T& value)
+    {
+        assert(!buffer_ || generation_ == allocator_->GetGeneration());
+        if (size_ == capacity_)
+        {
+            // Copy first in case the value is an element of this vector
+            T valueCopy(value);
+            Grow(size_ + 1);
+            new(buffer_ + size_) T(std::move(valueCopy));
+        }
+        else
+            new(buffer_ + size_) T(value);
+        ++size_;
+    }
+
+    /// Remove the last element.
+    void Pop()
+    {
+        if (size_)
+        {
+            --size_;
+            (buffer_ + size_)->~T();
+        }
+    }
+
+    /// Resize the vector. New elements are default-constructed.
+    void Resize(unsigned newSize)
+    {
+        if (newSize > size_)
+        {
+            Reserve(newSize);
+            for (unsigned i = size_; i < newSize; ++i)
+                new(buffer_ + i) T();
+        }
+        else
+        {
+            for (unsigned i = newSize; i < size_; ++i)
+                (buffer_ + i)->~T();
+        }
+        size_ = newSize;
+    }
+
+    /// Set new capacity. Never shrinks.
+    void Reserve(unsigned newCapacity)
+    {
+        if (buffer_ && generation_ != allocator_->GetGeneration())
+            ForgetBuffer();
+        if (newCapacity > capacity_)
+            Reallocate(newCapacity);
+    }
+
+    /// Remove all elements. The buffer is kept for reuse if it still belongs to the arena.
+    void Clear()
+    {
+        if (buffer_ && generation_ != allocator_->GetGeneration())
+            ForgetBuffer();
+        else
+        {
+            DestructElements();
+            size_ = 0;
+        }
+    }
+
+    /// Return whether contains a specific value.
+    bool Contains(const T& value) const
+    {
+        assert(IsCurrent());
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            if (buffer_[i] == value)
+                return true;
+        }
+        return false;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin()
+    {
+        assert(IsCurrent());
+        return Iterator(buffer_);
+    }
+
+    /// Return const iterator to the beginning.
+    ConstIterator Begin() const
+    {
+        assert(IsCurrent());
+        return ConstIterator(buffer_);
+    }
+
+    /// Return iterator to the end.
+    Iterator End()
+    {
+        assert(IsCurrent());
+        return Iterator(buffer_ + size_);
+    }
+
+    /// Return const iterator to the end.
+    ConstIterator End() const
+    {
+        assert(IsCurrent());
+        return ConstIterator(buffer_ + size_);
+    }
+
+    /// Return element at index.
+    T& At(unsigned index)
+    {
+        assert(index < size_ && IsCurrent());
+        return buffer_[index];
+    }
+
+    /// Return const element at index.
+    const T& At(unsigned index) const
+    {
+        assert(index < size_ && IsCurrent());
+        return buffer_[index];
+    }
+
+    /// Return first element.
+    T& Front()
+    {
+        assert(size_ && IsCurrent());
+        return buffer_[0];
+    }
+
+    /// Return const first element.
+    const T& Front() const
+    {
+        assert(size_ && IsCurrent());
+        return buffer_[0];
+    }
+
+    /// Return last element.
+    T& Back()
+    {
+        assert(size_ && IsCurrent());
+        return buffer_[size_ - 1];
+    }
+
+    /// Return const last element.
+    const T& Back() const
+    {
+        assert(size_ && IsCurrent());
+        return buffer_[size_ - 1];
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return capacity of vector.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return whether vector is empty.
+    bool Empty() const { return size_ == 0; }
+
+    /// Return the buffer.
+    T* Buffer() const { return buffer_; }
+
+    /// Return the arena.
+    ArenaAllocator* GetAllocator() const { return allocator_; }
+
+private:
+    /// Return whether the elements are usable, meaning the vector is empty or the arena has not been reset since the buffer was allocated. Used for catching stale use in debug builds.
+    bool IsCurrent() const { return !size_ || generation_ == allocator_->GetGeneration(); }
+
+    /// Grow the capacity to at least the specified size.
+    void Grow(unsigned minCapacity)
+    {
+        unsigned newCapacity = capacity_ ? capacity_ + (capacity_ + 1) / 2 : 8;
+        Reallocate(newCapacity > minCapacity ? newCapacity : minCapacity);
+    }
+
+    /// Allocate a new buffer from the arena and move the elements there. The old buffer is left to the arena.
+    void Reallocate(unsigned newCapacity)
+    {
+        assert(allocator_);
+        T* newBuffer = allocator_->Allocate<T>(newCapacity);
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(newBuffer + i) T(std::move(buffer_[i]));
+            (buffer_ + i)->~T();
+        }
+        buffer_ = newBuffer;
+        capacity_ = newCapacity;
+        generation_ = allocator_->GetGeneration();
+    }
+
+    /// Drop a buffer that the arena has already reclaimed.
+    void ForgetBuffer()
+    {
+        buffer_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    /// Call the element destructors, unless the arena has already reclaimed the buffer.
+    void DestructElements()
+    {
+        if (std::is_trivially_destructible<T>::value || !buffer_ || generation_ != allocator_->GetGeneration())
+            return;
+        for (unsigned i = 0; i < size_; ++i)
+            (buffer_ + i)->~T();
+    }
+
+    /// Arena.
+    ArenaAllocator* allocator_;
+    /// Buffer.
+    T* buffer_;
+    /// Number of elements.
+    unsigned size_;
+    /// Buffer capacity.
+    unsigned capacity_;
+    /// Arena generation the buffer was allocated in.
+    unsigned generation_;
+};
+
+template <class T> typename Urho3D::ArenaVector<T>::ConstIterator begin(const Urho3D::ArenaVector<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::ArenaVector<T>::ConstIterator end(const Urho3D::ArenaVector<T>& v) { return v.End(); }
+
+template <class T> typename Urho3D::ArenaVector<T>::Iterator begin(Urho3D::ArenaVector<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::ArenaVector<T>::Iterator end(Urho3D::ArenaVector<T>& v) { return v.End(); }
+
+}
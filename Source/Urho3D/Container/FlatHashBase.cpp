@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Return the maximum number of elements for a slot count. The slots are small compared to the elements, so a load factor of 3/4 keeps the probe sequences short at little memory cost.
+static unsigned GetMaxLoad(unsigned numSlots)
+{
+    return numSlots - numSlots / 4;
+}
+
+unsigned FlatHashBase::GetNumSlots(unsigned capacity)
+{
+    unsigned numSlots = MIN_SLOTS;
+    while (GetMaxLoad(numSlots) < capacity)
+        numSlots <<= 1;
+    return numSlots;
+}
+
+void FlatHashBase::AllocateSlots(unsigned numSlots)
+{
+    FlatHashSlot* oldSlots = slots_;
+    unsigned oldNumSlots = numSlots_;
+
+    slots_ = new FlatHashSlot[numSlots];
+    numSlots_ = numSlots;
+    capacity_ = GetMaxLoad(numSlots);
+    ResetSlots();
+
+    // Insert in the order of the old slots using the stored hashes, so that the new slots are written mostly in sequence
+    for (unsigned i = 0; i < oldNumSlots; ++i)
+    {
+        if (oldSlots[i].index_ != M_FLAT_HASH_EMPTY)
+            InsertSlot(oldSlots[i].hash_, oldSlots[i].index_);
+    }
+
+    delete[] oldSlots;
+}
+
+void FlatHashBase::ResetSlots()
+{
+    for (unsigned i = 0; i < numSlots_; ++i)
+        slots_[i].index_ = M_FLAT_HASH_EMPTY;
+}
+
+void FlatHashBase::InsertSlot(unsigned hash, unsigned index)
+{
+    unsigned mask = numSlots_ - 1;
+    FlatHashSlot entry{hash, index};
+
+    for (unsigned slot = HomeSlot(hash), distance = 0;; slot = (slot + 1) & mask, ++distance)
+    {
+        FlatHashSlot& current = slots_[slot];
+        if (current.index_ == M_FLAT_HASH_EMPTY)
+        {
+            current = entry;
+            return;
+        }
+
+        // Take the slot from an entry closer to its home slot, and continue placing that entry
+        unsigned currentDistance = ProbeDistance(slot, current.hash_);
+        if (currentDistance < distance)
+        {
+            Urho3D::Swap(current, entry);
+            distance = currentDistance;
+        }
+    }
+}
+
+void FlatHashBase::RemoveSlot(unsigned slot)
+{
+    unsigned mask = numSlots_ - 1;
+
+    // Shift the following entries back until an empty slot or an entry in its home slot
+    for (unsigned next = (slot + 1) & mask; slots_[next].index_ != M_FLAT_HASH_EMPTY && ProbeDistance(next, slots_[next].hash_);
+         next = (next + 1) & mask)
+    {
+        slots_[slot] = slots_[next];
+        slot = next;
+    }
+
+    slots_[slot].index_ = M_FLAT_HASH_EMPTY;
+}
+
+}
@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+
+namespace Urho3D
+{
+
+/// Element index of an empty open-addressed hash slot.
+static const unsigned M_FLAT_HASH_EMPTY = 0xffffffff;
+
+/// Open-addressed hash slot.
+struct FlatHashSlot
+{
+    /// Mixed hash of the key. Its low bits select the home slot.
+    unsigned hash_;
+    /// Index of the element, or M_FLAT_HASH_EMPTY if the slot is empty.
+    unsigned index_;
+};
+
+/// Open-addressed hash set/map base class. Manages the Robin Hood hashed slots, which refer to the elements stored densely by the subclass.
+/** Note that to prevent extra memory use due to vtable pointer, %FlatHashBase intentionally does not declare a virtual destructor
+    and therefore %FlatHashBase pointers should never be used.
+  */
+class URHO3D_API FlatHashBase
+{
+public:
+    /// Minimum amount of slots.
+    static const unsigned MIN_SLOTS = 8;
+
+    /// Construct.
+    FlatHashBase() :
+        slots_(nullptr),
+        size_(0),
+        capacity_(0),
+        numSlots_(0)
+    {
+    }
+
+    /// Destruct.
+    ~FlatHashBase()
+    {
+        delete[] slots_;
+    }
+
+    /// Prevent copy construction, the subclasses copy the elements.
+    FlatHashBase(const FlatHashBase& rhs) = delete;
+    /// Prevent assignment, the subclasses copy the elements.
+    FlatHashBase& operator =(const FlatHashBase& rhs) = delete;
+
+    /// Swap with another hash set or map.
+    void Swap(FlatHashBase& rhs)
+    {
+        Urho3D::Swap(slots_, rhs.slots_);
+        Urho3D::Swap(size_, rhs.size_);
+        Urho3D::Swap(capacity_, rhs.capacity_);
+        Urho3D::Swap(numSlots_, rhs.numSlots_);
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return number of elements that fit in the memory reserved.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return number of slots.
+    unsigned NumSlots() const { return numSlots_; }
+
+    /// Return whether has no elements.
+    bool Empty() const { return size_ == 0; }
+
+protected:
+    /// Return the number of slots needed for an element count.
+    static unsigned GetNumSlots(unsigned capacity);
+
+    /// Return the key hash mixed so that all its bits depend on all bits of the key hash. Uses the MurmurHash3 finalizer, as sequential or strided key hashes would cluster in the slots otherwise.
+    template <class T> static unsigned MixHash(const T& key)
+    {
+        unsigned hash = MakeHash(key);
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    /// Return the home slot of a mixed hash.
+    unsigned HomeSlot(unsigned hash) const { return hash & (numSlots_ - 1); }
+
+    /// Return the distance of a slot from the home slot of its hash.
+    unsigned ProbeDistance(unsigned slot, unsigned hash) const { return (slot - HomeSlot(hash)) & (numSlots_ - 1); }
+
+    /// Return the slot that refers to an element index.
+    unsigned FindSlotOfIndex(unsigned index, unsigned hash) const
+    {
+        unsigned mask = numSlots_ - 1;
+        unsigned slot = HomeSlot(hash);
+        while (slots_[slot].index_ != index)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    /// Reallocate the slots and insert the existing entries again. Sets the capacity according to the maximum load factor.
+    void AllocateSlots(unsigned numSlots);
+    /// Empty all slots.
+    void ResetSlots();
+    /// Add an element index to the slots.
+    void InsertSlot(unsigned hash, unsigned index);
+    /// Empty a slot and shift the following slots back.
+    void RemoveSlot(unsigned slot);
+
+    /// Slots.
+    FlatHashSlot* slots_;
+    /// Number of elements.
+    unsigned size_;
+    /// Number of elements that fit in the memory reserved.
+    unsigned capacity_;
+    /// Number of slots. Always a power of two.
+    unsigned numSlots_;
+};
+
+}
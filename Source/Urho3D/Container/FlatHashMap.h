@@ -0,0 +1,444 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Vector.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// Hash map template class with open addressing. The pairs are stored densely in one array, which is iterated like a Vector, and found through a Robin Hood hashed index of slots, so that inserting needs no allocation per pair and finding touches few cache lines. Unlike HashMap, erasing moves the last pair into the erased position, so the order of the pairs is not kept, and inserting or erasing may invalidate references and iterators like with Vector.
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    using KeyType = T;
+    using ValueType = U;
+
+    /// Hash map key-value pair with const key.
+    class KeyValue
+    {
+    public:
+        /// Construct with key and value.
+        KeyValue(const T& first, const U& second) :
+            first_(first),
+            second_(second)
+        {
+        }
+
+        /// Copy-construct.
+        KeyValue(const KeyValue& value) :
+            first_(value.first_),
+            second_(value.second_)
+        {
+        }
+
+        /// Move-construct.
+        KeyValue(KeyValue&& value) noexcept :
+            first_(value.first_),
+            second_(std::move(value.second_))
+        {
+        }
+
+        /// Prevent assignment.
+        KeyValue& operator =(const KeyValue& rhs) = delete;
+
+        /// Test for equality with another pair.
+        bool operator ==(const KeyValue& rhs) const { return first_ == rhs.first_ && second_ == rhs.second_; }
+        /// Test for inequality with another pair.
+        bool operator !=(const KeyValue& rhs) const { return first_ != rhs.first_ || second_ != rhs.second_; }
+
+        /// Key.
+        const T first_;
+        /// Value.
+        U second_;
+    };
+
+    /// Iterator.
+    using Iterator = KeyValue*;
+    /// Const iterator.
+    using ConstIterator = const KeyValue*;
+
+    /// Construct empty.
+    FlatHashMap() noexcept :
+        pairs_(nullptr)
+    {
+    }
+
+    /// Construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map) :
+        FlatHashMap()
+    {
+        *this = map;
+    }
+
+    /// Move-construct from another hash map.
+    FlatHashMap(FlatHashMap<T, U>&& map) noexcept :
+        FlatHashMap()
+    {
+        Swap(map);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashMap(const std::initializer_list<Pair<T, U> >& list) :
+        FlatHashMap()
+    {
+        Reserve((unsigned)list.size());
+        for (auto it = list.begin(); it != list.end(); ++it)
+            Insert(*it);
+    }
+
+    /// Destruct.
+    ~FlatHashMap()
+    {
+        Clear();
+        delete[] reinterpret_cast<unsigned char*>(pairs_);
+    }
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            Clear();
+            Reserve(rhs.size_);
+            for (unsigned i = 0; i < rhs.size_; ++i)
+                InsertPair(rhs.pairs_[i].first_, rhs.pairs_[i].second_);
+        }
+        return *this;
+    }
+
+    /// Move-assign a hash map.
+    FlatHashMap& operator =(FlatHashMap<T, U>&& rhs) noexcept
+    {
+        assert(&rhs != this);
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Add-assign a pair.
+    FlatHashMap& operator +=(const Pair<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash map.
+    FlatHashMap& operator +=(const FlatHashMap<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.size_ != size_)
+            return false;
+
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            ConstIterator j = rhs.Find(pairs_[i].first_);
+            if (j == rhs.End() || j->second_ != pairs_[i].second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        return slot != M_FLAT_HASH_EMPTY ? pairs_[slots_[slot].index_].second_ : InsertPair(key, U())->second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        return slot != M_FLAT_HASH_EMPTY ? &pairs_[slots_[slot].index_].second_ : nullptr;
+    }
+
+    /// Populate the map using variadic template. This handles the base case.
+    FlatHashMap& Populate(const T& key, const U& value)
+    {
+        this->operator [](key) = value;
+        return *this;
+    }
+
+    /// Populate the map using variadic template.
+    template <typename... Args> FlatHashMap& Populate(const T& key, const U& value, const Args&... args)
+    {
+        this->operator [](key) = value;
+        return Populate(args...);
+    }
+
+    /// Insert a pair, replacing the value if the key exists. Return an iterator to it.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair, replacing the value if the key exists. Return an iterator to it and whether the key existed.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        unsigned slot = FindSlot(pair.first_, MixHash(pair.first_));
+        exists = slot != M_FLAT_HASH_EMPTY;
+        if (!exists)
+            return InsertPair(pair.first_, pair.second_);
+
+        Iterator it = pairs_ + slots_[slot].index_;
+        it->second_ = pair.second_;
+        return it;
+    }
+
+    /// Insert the pairs of another hash map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        if (&map == this)
+            return;
+
+        Reserve(size_ + map.size_);
+        for (unsigned i = 0; i < map.size_; ++i)
+            Insert(MakePair(map.pairs_[i].first_, map.pairs_[i].second_));
+    }
+
+    /// Insert a pair by iterator. Return iterator to the value.
+    Iterator Insert(const ConstIterator& it) { return Insert(MakePair(it->first_, it->second_)); }
+
+    /// Insert a range by iterators.
+    void Insert(const ConstIterator& start, const ConstIterator& end)
+    {
+        for (ConstIterator it = start; it != end; ++it)
+            Insert(it);
+    }
+
+    /// Erase a pair. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        if (slot == M_FLAT_HASH_EMPTY)
+            return false;
+
+        EraseSlot(slot);
+        return true;
+    }
+
+    /// Erase a pair by iterator. The last pair is moved in its place, so the returned iterator to the same position points to the next pair to visit.
+    Iterator Erase(const Iterator& it)
+    {
+        auto index = (unsigned)(it - pairs_);
+        if (index >= size_)
+            return End();
+
+        EraseSlot(FindSlotOfIndex(index, MixHash(it->first_)));
+        return pairs_ + index;
+    }
+
+    /// Clear the map. Keeps the memory reserved.
+    void Clear()
+    {
+        for (unsigned i = 0; i < size_; ++i)
+            pairs_[i].~KeyValue();
+        size_ = 0;
+
+        ResetSlots();
+    }
+
+    /// Reserve memory for at least the specified number of pairs.
+    void Reserve(unsigned capacity)
+    {
+        if (capacity <= capacity_)
+            return;
+
+        Reallocate(GetNumSlots(capacity));
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& map)
+    {
+        FlatHashBase::Swap(map);
+        Urho3D::Swap(pairs_, map.pairs_);
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        return slot != M_FLAT_HASH_EMPTY ? pairs_ + slots_[slot].index_ : End();
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        return slot != M_FLAT_HASH_EMPTY ? pairs_ + slots_[slot].index_ : End();
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindSlot(key, MixHash(key)) != M_FLAT_HASH_EMPTY; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        if (slot == M_FLAT_HASH_EMPTY)
+            return false;
+
+        out = pairs_[slots_[slot].index_].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        for (unsigned i = 0; i < size_; ++i)
+            result.Push(pairs_[i].first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(size_);
+        for (unsigned i = 0; i < size_; ++i)
+            result.Push(pairs_[i].second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return pairs_; }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return pairs_; }
+
+    /// Return iterator to the end.
+    Iterator End() { return pairs_ + size_; }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return pairs_ + size_; }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return pairs_[0]; }
+
+    /// Return last pair.
+    const KeyValue& Back() const { return pairs_[size_ - 1]; }
+
+private:
+    /// Return the slot of a key, or M_FLAT_HASH_EMPTY if not found.
+    unsigned FindSlot(const T& key, unsigned hash) const
+    {
+        if (!size_)
+            return M_FLAT_HASH_EMPTY;
+
+        unsigned mask = numSlots_ - 1;
+        for (unsigned slot = HomeSlot(hash), distance = 0;; slot = (slot + 1) & mask, ++distance)
+        {
+            const FlatHashSlot& s = slots_[slot];
+            // Robin Hood ordering: the key would have displaced any pair closer to its home slot
+            if (s.index_ == M_FLAT_HASH_EMPTY || ProbeDistance(slot, s.hash_) < distance)
+                return M_FLAT_HASH_EMPTY;
+            if (s.hash_ == hash && pairs_[s.index_].first_ == key)
+                return slot;
+        }
+    }
+
+    /// Append a pair. The key must not exist.
+    Iterator InsertPair(const T& key, const U& value)
+    {
+        if (size_ == capacity_)
+        {
+            // The pair may be stored in this map, so copy it before moving the pairs
+            KeyValue pair(key, value);
+            Reserve(size_ + 1);
+            new(pairs_ + size_) KeyValue(std::move(pair));
+        }
+        else
+            new(pairs_ + size_) KeyValue(key, value);
+
+        InsertSlot(MixHash(pairs_[size_].first_), size_);
+        return pairs_ + size_++;
+    }
+
+    /// Erase the pair of a slot.
+    void EraseSlot(unsigned slot)
+    {
+        unsigned index = slots_[slot].index_;
+        RemoveSlot(slot);
+
+        // Move the last pair into the erased position to keep the pairs dense
+        unsigned last = size_ - 1;
+        pairs_[index].~KeyValue();
+        if (index != last)
+        {
+            slots_[FindSlotOfIndex(last, MixHash(pairs_[last].first_))].index_ = index;
+            new(pairs_ + index) KeyValue(std::move(pairs_[last]));
+            pairs_[last].~KeyValue();
+        }
+        --size_;
+    }
+
+    /// Move the pairs to new memory and rebuild the slots.
+    void Reallocate(unsigned numSlots)
+    {
+        AllocateSlots(numSlots);
+
+        auto* newPairs = reinterpret_cast<KeyValue*>(new unsigned char[capacity_ * sizeof(KeyValue)]);
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(newPairs + i) KeyValue(std::move(pairs_[i]));
+            pairs_[i].~KeyValue();
+        }
+        delete[] reinterpret_cast<unsigned char*>(pairs_);
+        pairs_ = newPairs;
+    }
+
+    /// Pairs.
+    KeyValue* pairs_;
+};
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator begin(const Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator end(const Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator begin(Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator end(Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// Hash set template class with open addressing. The keys are stored densely in one array, which is iterated like a Vector, and found through a Robin Hood hashed index of slots. Unlike HashSet, erasing moves the last key into the erased position, so the order of the keys is not kept, and inserting or erasing may invalidate iterators like with Vector.
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    /// Iterator. The keys must not be modified through it.
+    using Iterator = const T*;
+    /// Const iterator.
+    using ConstIterator = const T*;
+
+    /// Construct empty.
+    FlatHashSet() noexcept :
+        keys_(nullptr)
+    {
+    }
+
+    /// Construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set) :
+        FlatHashSet()
+    {
+        *this = set;
+    }
+
+    /// Move-construct from another hash set.
+    FlatHashSet(FlatHashSet<T>&& set) noexcept :
+        FlatHashSet()
+    {
+        Swap(set);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashSet(const std::initializer_list<T>& list) :
+        FlatHashSet()
+    {
+        Reserve((unsigned)list.size());
+        for (auto it = list.begin(); it != list.end(); ++it)
+            Insert(*it);
+    }
+
+    /// Destruct.
+    ~FlatHashSet()
+    {
+        Clear();
+        delete[] reinterpret_cast<unsigned char*>(keys_);
+    }
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            Clear();
+            Reserve(rhs.size_);
+            for (unsigned i = 0; i < rhs.size_; ++i)
+                InsertKey(rhs.keys_[i]);
+        }
+        return *this;
+    }
+
+    /// Move-assign a hash set.
+    FlatHashSet& operator =(FlatHashSet<T>&& rhs) noexcept
+    {
+        assert(&rhs != this);
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Add-assign a key.
+    FlatHashSet& operator +=(const T& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash set.
+    FlatHashSet& operator +=(const FlatHashSet<T>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.size_ != size_)
+            return false;
+
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            if (!rhs.Contains(keys_[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return an iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        exists = slot != M_FLAT_HASH_EMPTY;
+        return exists ? keys_ + slots_[slot].index_ : InsertKey(key);
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        if (&set == this)
+            return;
+
+        Reserve(size_ + set.size_);
+        for (unsigned i = 0; i < set.size_; ++i)
+            Insert(set.keys_[i]);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        if (slot == M_FLAT_HASH_EMPTY)
+            return false;
+
+        EraseSlot(slot);
+        return true;
+    }
+
+    /// Erase a key by iterator. The last key is moved in its place, so the returned iterator to the same position points to the next key to visit.
+    Iterator Erase(Iterator it)
+    {
+        auto index = (unsigned)(it - keys_);
+        if (index >= size_)
+            return End();
+
+        EraseSlot(FindSlotOfIndex(index, MixHash(*it)));
+        return keys_ + index;
+    }
+
+    /// Clear the set. Keeps the memory reserved.
+    void Clear()
+    {
+        for (unsigned i = 0; i < size_; ++i)
+            (keys_ + i)->~T();
+        size_ = 0;
+
+        ResetSlots();
+    }
+
+    /// Reserve memory for at least the specified number of keys.
+    void Reserve(unsigned capacity)
+    {
+        if (capacity <= capacity_)
+            return;
+
+        Reallocate(GetNumSlots(capacity));
+    }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& set)
+    {
+        FlatHashBase::Swap(set);
+        Urho3D::Swap(keys_, set.keys_);
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned slot = FindSlot(key, MixHash(key));
+        return slot != M_FLAT_HASH_EMPTY ? keys_ + slots_[slot].index_ : End();
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindSlot(key, MixHash(key)) != M_FLAT_HASH_EMPTY; }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return keys_; }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return keys_ + size_; }
+
+    /// Return first key.
+    const T& Front() const { return keys_[0]; }
+
+    /// Return last key.
+    const T& Back() const { return keys_[size_ - 1]; }
+
+private:
+    /// Return the slot of a key, or M_FLAT_HASH_EMPTY if not found.
+    unsigned FindSlot(const T& key, unsigned hash) const
+    {
+        if (!size_)
+            return M_FLAT_HASH_EMPTY;
+
+        unsigned mask = numSlots_ - 1;
+        for (unsigned slot = HomeSlot(hash), distance = 0;; slot = (slot + 1) & mask, ++distance)
+        {
+            const FlatHashSlot& s = slots_[slot];
+            // Robin Hood ordering: the key would have displaced any key closer to its home slot
+            if (s.index_ == M_FLAT_HASH_EMPTY || ProbeDistance(slot, s.hash_) < distance)
+                return M_FLAT_HASH_EMPTY;
+            if (s.hash_ == hash && keys_[s.index_] == key)
+                return slot;
+        }
+    }
+
+    /// Append a key. The key must not exist.
+    Iterator InsertKey(const T& key)
+    {
+        if (size_ == capacity_)
+        {
+            // The key may be stored in this set, so copy it before moving the keys
+            T copy(key);
+            Reserve(size_ + 1);
+            new(keys_ + size_) T(std::move(copy));
+        }
+        else
+            new(keys_ + size_) T(key);
+
+        InsertSlot(MixHash(keys_[size_]), size_);
+        return keys_ + size_++;
+    }
+
+    /// Erase the key of a slot.
+    void EraseSlot(unsigned slot)
+    {
+        unsigned index = slots_[slot].index_;
+        RemoveSlot(slot);
+
+        // Move the last key into the erased position to keep the keys dense
+        unsigned last = size_ - 1;
+        (keys_ + index)->~T();
+        if (index != last)
+        {
+            slots_[FindSlotOfIndex(last, MixHash(keys_[last]))].index_ = index;
+            new(keys_ + index) T(std::move(keys_[last]));
+            (keys_ + last)->~T();
+        }
+        --size_;
+    }
+
+    /// Move the keys to new memory and rebuild the slots.
+    void Reallocate(unsigned numSlots)
+    {
+        AllocateSlots(numSlots);
+
+        auto* newKeys = reinterpret_cast<T*>(new unsigned char[capacity_ * sizeof(T)]);
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(newKeys + i) T(std::move(keys_[i]));
+            (keys_ + i)->~T();
+        }
+        delete[] reinterpret_cast<unsigned char*>(keys_);
+        keys_ = newKeys;
+    }
+
+    /// Keys.
+    T* keys_;
+};
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator begin(const Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator end(const Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+}
@@ -26,6 +26,8 @@
 #include "../Container/Ptr.h"
 #include "../Core/Variant.h"
 
+#include <type_traits>
+
 namespace Urho3D
 {
 
@@ -54,7 +56,9 @@ enum AttributeMode
 };
 URHO3D_FLAGSET(AttributeMode, AttributeModeFlags);
 
+class Deserializer;
 class Serializable;
+class Serializer;
 
 /// Abstract base class for invoking attribute accessors.
 class URHO3D_API AttributeAccessor : public RefCounted
@@ -64,6 +68,12 @@ public:
     virtual void Get(const Serializable* ptr, Variant& dest) const = 0;
     /// Set the attribute.
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
+    /// Write the attribute as binary data, as Serializer::WriteVariantData() would. Default implementation goes through Get(). Return true if successful.
+    virtual bool Write(const Serializable* ptr, Serializer& dest) const;
+    /// Read the attribute from binary data of the attribute type and set it. Default implementation goes through Set().
+    virtual void Read(Serializable* ptr, Deserializer& source, VariantType type);
+    /// Compare the attribute to a value and assign the value if different. Default implementation goes through Get(). Return true if changed.
+    virtual bool Update(const Serializable* ptr, Variant& value) const;
 };
 
 /// Description of an automatically serializable variable.
@@ -112,6 +122,8 @@ struct AttributeInfo
     VariantMap metadata_;
     /// Attribute data pointer if elsewhere than in the Serializable.
     void* ptr_ = nullptr;
+    /// Whether binary load/save and network change detection may call the accessor directly instead of going through OnSetAttribute() / OnGetAttribute(). Set on registration for classes which do not override them.
+    bool typedAccess_ = false;
 };
 
 /// Attribute handle returned by Context::RegisterAttribute and used to chain attribute setup calls.
@@ -139,4 +151,11 @@ public:
     }
 };
 
+/// Return whether a Serializable subclass uses the default OnSetAttribute() and OnGetAttribute().
+template <class T> constexpr bool HasDefaultAttributeAccess()
+{
+    return std::is_same<decltype(&T::OnSetAttribute), void (Serializable::*)(const AttributeInfo&, const Variant&)>::value &&
+        std::is_same<decltype(&T::OnGetAttribute), void (Serializable::*)(const AttributeInfo&, Variant&) const>::value;
+}
+
 }
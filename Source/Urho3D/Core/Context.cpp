@@ -231,6 +231,23 @@ void Context::RemoveAllAttributes(StringHash objectType)
     networkAttributes_.Erase(objectType);
 }
 
+void Context::DisableTypedAttributeAccess(StringHash objectType)
+{
+    HashMap<StringHash, Vector<AttributeInfo> >::Iterator i = attributes_.Find(objectType);
+    if (i != attributes_.End())
+    {
+        for (unsigned j = 0; j < i->second_.Size(); ++j)
+            i->second_[j].typedAccess_ = false;
+    }
+
+    i = networkAttributes_.Find(objectType);
+    if (i != networkAttributes_.End())
+    {
+        for (unsigned j = 0; j < i->second_.Size(); ++j)
+            i->second_[j].typedAccess_ = false;
+    }
+}
+
 void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* name, const Variant& defaultValue)
 {
     AttributeInfo* info = GetAttribute(objectType, name);
@@ -219,6 +219,9 @@ private:
     /// End event send. Clean up event receivers removed in the meanwhile.
     void EndSendEvent();
 
+    /// Stop using the typed attribute accessors of an object type, which overrides OnSetAttribute() / OnGetAttribute().
+    void DisableTypedAttributeAccess(StringHash objectType);
+
     /// Set current event handler. Called by Object.
     void SetEventHandler(EventHandler* handler) { eventHandler_ = handler; }
 
@@ -262,13 +265,26 @@ template <class T> T* Context::RegisterSubsystem()
 
 template <class T> void Context::RemoveSubsystem() { RemoveSubsystem(T::GetTypeStatic()); }
 
-template <class T> AttributeHandle Context::RegisterAttribute(const AttributeInfo& attr) { return RegisterAttribute(T::GetTypeStatic(), attr); }
+template <class T> AttributeHandle Context::RegisterAttribute(const AttributeInfo& attr)
+{
+    AttributeHandle handle = RegisterAttribute(T::GetTypeStatic(), attr);
+    if (handle.attributeInfo_)
+        handle.attributeInfo_->typedAccess_ = HasDefaultAttributeAccess<T>();
+    if (handle.networkAttributeInfo_)
+        handle.networkAttributeInfo_->typedAccess_ = HasDefaultAttributeAccess<T>();
+    return handle;
+}
 
 template <class T> void Context::RemoveAttribute(const char* name) { RemoveAttribute(T::GetTypeStatic(), name); }
 
 template <class T> void Context::RemoveAllAttributes() { RemoveAllAttributes(T::GetTypeStatic()); }
 
-template <class T, class U> void Context::CopyBaseAttributes() { CopyBaseAttributes(T::GetTypeStatic(), U::GetTypeStatic()); }
+template <class T, class U> void Context::CopyBaseAttributes()
+{
+    CopyBaseAttributes(T::GetTypeStatic(), U::GetTypeStatic());
+    if (!HasDefaultAttributeAccess<U>())
+        DisableTypedAttributeAccess(U::GetTypeStatic());
+}
 
 template <class T> T* Context::GetSubsystem() const { return static_cast<T*>(GetSubsystem(T::GetTypeStatic())); }
 
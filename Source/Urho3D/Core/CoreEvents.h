@@ -40,6 +40,20 @@ URHO3D_EVENT(E_UPDATE, Update)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed application-wide logic update event.
+struct UpdateEventData
+{
+    URHO3D_TYPED_EVENT(E_UPDATE);
+
+    /// Convert to event parameters.
+    void ToVariantMap(VariantMap& eventData) const { eventData[Update::P_TIMESTEP] = timeStep_; }
+    /// Convert from event parameters.
+    void FromVariantMap(VariantMap& eventData) { timeStep_ = eventData[Update::P_TIMESTEP].GetFloat(); }
+
+    /// Time step.
+    float timeStep_;
+};
+
 /// Application-wide logic post-update event.
 URHO3D_EVENT(E_POSTUPDATE, PostUpdate)
 {
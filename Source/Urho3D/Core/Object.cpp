@@ -85,45 +85,7 @@ Object::~Object()
 
 void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData)
 {
-    if (blockEvents_)
-        return;
-
-    // Make a copy of the context pointer in case the object is destroyed during event handler invocation
-    Context* context = context_;
-    EventHandler* specific = nullptr;
-    EventHandler* nonSpecific = nullptr;
-
-    EventHandler* handler = eventHandlers_.First();
-    while (handler)
-    {
-        if (handler->GetEventType() == eventType)
-        {
-            if (!handler->GetSender())
-                nonSpecific = handler;
-            else if (handler->GetSender() == sender)
-            {
-                specific = handler;
-                break;
-            }
-        }
-        handler = eventHandlers_.Next(handler);
-    }
-
-    // Specific event handlers have priority, so if found, invoke first
-    if (specific)
-    {
-        context->SetEventHandler(specific);
-        specific->Invoke(eventData);
-        context->SetEventHandler(nullptr);
-        return;
-    }
-
-    if (nonSpecific)
-    {
-        context->SetEventHandler(nonSpecific);
-        nonSpecific->Invoke(eventData);
-        context->SetEventHandler(nullptr);
-    }
+    InvokeEventHandler(sender, eventType, eventData, nullptr);
 }
 
 bool Object::IsInstanceOf(StringHash type) const
@@ -295,6 +257,11 @@ void Object::SendEvent(StringHash eventType)
 }
 
 void Object::SendEvent(StringHash eventType, VariantMap& eventData)
+{
+    DispatchEvent(eventType, eventData, nullptr);
+}
+
+void Object::DispatchEvent(StringHash eventType, VariantMap& eventData, TypedEventSend* typedEvent)
 {
     if (!Thread::IsMainThread())
     {
@@ -308,13 +275,18 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     // Make a weak pointer to self to check for destruction during event handling
     WeakPtr<Object> self(this);
     Context* context = context_;
-    HashSet<Object*> processed;
+    // Constructed only when needed, as constructing a hash set allocates memory
+    UniquePtr<HashSet<Object*> > processed;
 
     context->BeginSendEvent(this, eventType);
 
     // Check first the specific event receivers
     // Note: group is held alive with a shared ptr, as it may get destroyed along with the sender
-    SharedPtr<EventReceiverGroup> group(context->GetEventReceivers(this, eventType));
+    SharedPtr<EventReceiverGroup> specificGroup(context->GetEventReceivers(this, eventType));
+    SharedPtr<EventReceiverGroup> group(specificGroup);
+    // Remember the receivers only if there are non-specific receivers which could get the event twice
+    if (group && context->GetEventReceivers(eventType))
+        processed = new HashSet<Object*>();
     if (group)
     {
         group->BeginSendEvent();
@@ -327,7 +299,10 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             if (!receiver)
                 continue;
 
-            receiver->OnEvent(this, eventType, eventData);
+            if (typedEvent)
+                receiver->InvokeEventHandler(this, eventType, eventData, typedEvent);
+            else
+                receiver->OnEvent(this, eventType, eventData);
 
             // If self has been destroyed as a result of event handling, exit
             if (self.Expired())
@@ -337,7 +312,8 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
                 return;
             }
 
-            processed.Insert(receiver);
+            if (processed)
+                processed->Insert(receiver);
         }
 
         group->EndSendEvent();
@@ -347,9 +323,20 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     group = context->GetEventReceivers(eventType);
     if (group)
     {
+        // The non-specific receivers were subscribed during the send, so the specific receivers were not remembered
+        if (specificGroup && !processed)
+        {
+            processed = new HashSet<Object*>();
+            for (unsigned i = 0; i < specificGroup->receivers_.Size(); ++i)
+            {
+                if (specificGroup->receivers_[i])
+                    processed->Insert(specificGroup->receivers_[i]);
+            }
+        }
+
         group->BeginSendEvent();
 
-        if (processed.Empty())
+        if (!processed || processed->Empty())
         {
             const unsigned numReceivers = group->receivers_.Size();
             for (unsigned i = 0; i < numReceivers; ++i)
@@ -358,7 +345,10 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
                 if (!receiver)
                     continue;
 
-                receiver->OnEvent(this, eventType, eventData);
+                if (typedEvent)
+                    receiver->InvokeEventHandler(this, eventType, eventData, typedEvent);
+                else
+                    receiver->OnEvent(this, eventType, eventData);
 
                 if (self.Expired())
                 {
@@ -375,10 +365,13 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             for (unsigned i = 0; i < numReceivers; ++i)
             {
                 Object* receiver = group->receivers_[i];
-                if (!receiver || processed.Contains(receiver))
+                if (!receiver || processed->Contains(receiver))
                     continue;
 
-                receiver->OnEvent(this, eventType, eventData);
+                if (typedEvent)
+                    receiver->InvokeEventHandler(this, eventType, eventData, typedEvent);
+                else
+                    receiver->OnEvent(this, eventType, eventData);
 
                 if (self.Expired())
                 {
@@ -530,6 +523,53 @@ void Object::RemoveEventSender(Object* sender)
     }
 }
 
+void Object::InvokeEventHandler(Object* sender, StringHash eventType, VariantMap& eventData, TypedEventSend* typedEvent)
+{
+    if (blockEvents_)
+        return;
+
+    // Make a copy of the context pointer in case the object is destroyed during event handler invocation
+    Context* context = context_;
+    EventHandler* specific = nullptr;
+    EventHandler* nonSpecific = nullptr;
+
+    EventHandler* handler = eventHandlers_.First();
+    while (handler)
+    {
+        if (handler->GetEventType() == eventType)
+        {
+            if (!handler->GetSender())
+                nonSpecific = handler;
+            else if (handler->GetSender() == sender)
+            {
+                specific = handler;
+                break;
+            }
+        }
+        handler = eventHandlers_.Next(handler);
+    }
+
+    // Specific event handlers have priority
+    handler = specific ? specific : nonSpecific;
+    if (!handler)
+        return;
+
+    context->SetEventHandler(handler);
+    // A typed event struct is passed as is to typed event handlers, and converted to the event parameters once for the others
+    if (!typedEvent)
+        handler->Invoke(eventData);
+    else if (!handler->InvokeTyped(typedEvent->event_))
+    {
+        if (!typedEvent->converted_)
+        {
+            typedEvent->toVariantMap_(typedEvent->event_, eventData);
+            typedEvent->converted_ = true;
+        }
+        handler->Invoke(eventData);
+    }
+    context->SetEventHandler(nullptr);
+}
+
 StringHashRegister& GetEventNameRegister()
 {
     static StringHashRegister eventNameRegister(false /*non thread safe*/);
@@ -33,6 +33,18 @@ namespace Urho3D
 
 class Context;
 class EventHandler;
+template <class T, class E> class TypedEventHandlerImpl;
+
+/// Typed event struct being sent. Converted to event parameters on demand for the event handlers subscribed by name.
+struct TypedEventSend
+{
+    /// Event struct.
+    const void* event_;
+    /// Function that converts the event struct to event parameters.
+    void (*toVariantMap_)(const void* event, VariantMap& eventData);
+    /// Whether the event parameters have been converted.
+    bool converted_;
+};
 
 /// Type info.
 class URHO3D_API TypeInfo
@@ -139,6 +151,22 @@ public:
     {
         SendEvent(eventType, GetEventDataMap().Populate(args...));
     }
+    /// Subscribe to a typed event that can be sent by any sender. The handler receives the event struct without a VariantMap.
+    template <class T, class E> void SubscribeToEvent(void (T::*function)(const E&))
+    {
+        SubscribeToEvent(E::GetEventType(), new TypedEventHandlerImpl<T, E>(static_cast<T*>(this), function));
+    }
+    /// Subscribe to a specific sender's typed event. The handler receives the event struct without a VariantMap.
+    template <class T, class E> void SubscribeToEvent(Object* sender, void (T::*function)(const E&))
+    {
+        SubscribeToEvent(sender, E::GetEventType(), new TypedEventHandlerImpl<T, E>(static_cast<T*>(this), function));
+    }
+    /// Send a typed event to all subscribers. The event is converted to a VariantMap only for the handlers subscribed by name, such as scripts.
+    template <class E> auto SendEvent(const E& event) -> decltype(E::GetEventType(), void())
+    {
+        TypedEventSend typedEvent{&event, &ConvertTypedEvent<E>, false};
+        DispatchEvent(E::GetEventType(), GetEventDataMap(), &typedEvent);
+    }
 
     /// Return execution context.
     Context* GetContext() const { return context_; }
@@ -185,6 +213,15 @@ private:
     EventHandler* FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous = nullptr) const;
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Send event with parameters, or a typed event struct when not null, to all subscribers.
+    void DispatchEvent(StringHash eventType, VariantMap& eventData, TypedEventSend* typedEvent);
+    /// Invoke the event handler for an event with parameters, or a typed event struct when not null.
+    void InvokeEventHandler(Object* sender, StringHash eventType, VariantMap& eventData, TypedEventSend* typedEvent);
+    /// Convert a typed event struct to event parameters.
+    template <class E> static void ConvertTypedEvent(const void* event, VariantMap& eventData)
+    {
+        static_cast<const E*>(event)->ToVariantMap(eventData);
+    }
 
     /// Event handlers. Sender is null for non-specific handlers.
     LinkedList<EventHandler> eventHandlers_;
@@ -267,6 +304,8 @@ public:
 
     /// Invoke event handler function.
     virtual void Invoke(VariantMap& eventData) = 0;
+    /// Invoke event handler function with a typed event struct. Return false without invoking if the handler takes event parameters.
+    virtual bool InvokeTyped(const void* event) { return false; }
     /// Return a unique copy of the event handler.
     virtual EventHandler* Clone() const = 0;
 
@@ -355,6 +394,49 @@ private:
     std::function<void(StringHash, VariantMap&)> function_;
 };
 
+/// Template implementation of the typed event handler invoke helper (stores a function pointer of specific class.)
+template <class T, class E> class TypedEventHandlerImpl : public EventHandler
+{
+public:
+    using HandlerFunctionPtr = void (T::*)(const E&);
+
+    /// Construct with receiver and function pointer.
+    TypedEventHandlerImpl(T* receiver, HandlerFunctionPtr function) :
+        EventHandler(receiver),
+        function_(function)
+    {
+        assert(receiver_);
+        assert(function_);
+    }
+
+    /// Invoke event handler function with the event struct converted from event parameters.
+    void Invoke(VariantMap& eventData) override
+    {
+        E event{};
+        event.FromVariantMap(eventData);
+        auto* receiver = static_cast<T*>(receiver_);
+        (receiver->*function_)(event);
+    }
+
+    /// Invoke event handler function with the event struct.
+    bool InvokeTyped(const void* event) override
+    {
+        auto* receiver = static_cast<T*>(receiver_);
+        (receiver->*function_)(*static_cast<const E*>(event));
+        return true;
+    }
+
+    /// Return a unique copy of the event handler.
+    EventHandler* Clone() const override
+    {
+        return new TypedEventHandlerImpl(static_cast<T*>(receiver_), function_);
+    }
+
+private:
+    /// Class-specific pointer to handler function.
+    HandlerFunctionPtr function_;
+};
+
 /// Get register of event names.
 URHO3D_API StringHashRegister& GetEventNameRegister();
 
@@ -362,6 +444,8 @@ URHO3D_API StringHashRegister& GetEventNameRegister();
 #define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(Urho3D::GetEventNameRegister().RegisterString(#eventName)); namespace eventName
 /// Describe an event's parameter hash ID. Should be used inside an event namespace.
 #define URHO3D_PARAM(paramID, paramName) static const Urho3D::StringHash paramID(#paramName)
+/// Describe the event hash ID of a typed event struct. Should be used inside the struct, which holds the event parameters as members and defines ToVariantMap(VariantMap& eventData) const for the subscribers by name, and FromVariantMap(VariantMap& eventData) for the events sent by name. There should be only one typed event struct per event.
+#define URHO3D_TYPED_EVENT(eventID) static Urho3D::StringHash GetEventType() { return eventID; }
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function.
 #define URHO3D_HANDLER(className, function) (new Urho3D::EventHandlerImpl<className>(this, &className::function))
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function, and also defines a userdata pointer.
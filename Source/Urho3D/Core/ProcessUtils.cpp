@@ -62,6 +62,9 @@ extern "C" unsigned SDL_TVOS_GetActiveProcessorCount();
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 #if defined(__EMSCRIPTEN__) && defined(__EMSCRIPTEN_PTHREADS__)
 #include <emscripten/threading.h>
@@ -495,6 +498,27 @@ unsigned GetNumLogicalCPUs()
 #endif
 }
 
+bool SetCPUAffinity(unsigned long long mask)
+{
+    if (!mask)
+        return false;
+
+#if defined(_WIN32)
+    return SetProcessAffinityMask(GetCurrentProcess(), (DWORD_PTR)mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (unsigned i = 0; i < 64 && i < CPU_SETSIZE; ++i)
+    {
+        if (mask & (1ULL << i))
+            CPU_SET(i, &cpuSet);
+    }
+    return sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+#else
+    return false;
+#endif
+}
+
 void SetMiniDumpDir(const String& pathName)
 {
     miniDumpDir = AddTrailingSlash(pathName);
@@ -67,6 +67,8 @@ URHO3D_API String GetPlatform();
 URHO3D_API unsigned GetNumPhysicalCPUs();
 /// Return the number of logical CPUs (different from physical if hyperthreading is used.)
 URHO3D_API unsigned GetNumLogicalCPUs();
+/// Restrict the process to the logical CPUs in a bit mask. On Linux and Android this applies to the calling thread and the threads it creates afterward. Return true if successful. Supported on Windows, Linux and Android.
+URHO3D_API bool SetCPUAffinity(unsigned long long mask);
 /// Set minidump write location as an absolute path. If empty, uses default (UserProfile/AppData/Roaming/urho3D/crashdumps) Minidumps are only supported on MSVC compiler.
 URHO3D_API void SetMiniDumpDir(const String& pathName);
 /// Return minidump write location.
@@ -140,6 +140,87 @@ Variant& Variant::operator =(const Variant& rhs)
     return *this;
 }
 
+Variant& Variant::operator =(Variant&& rhs) noexcept
+{
+    if (&rhs == this)
+        return *this;
+
+    switch (rhs.type_)
+    {
+    case VAR_STRING:
+        SetType(VAR_STRING);
+        value_.string_.Swap(rhs.value_.string_);
+        break;
+
+    case VAR_BUFFER:
+        SetType(VAR_BUFFER);
+        value_.buffer_.Swap(rhs.value_.buffer_);
+        break;
+
+    case VAR_RESOURCEREF:
+        SetType(VAR_RESOURCEREF);
+        value_.resourceRef_.type_ = rhs.value_.resourceRef_.type_;
+        value_.resourceRef_.name_.Swap(rhs.value_.resourceRef_.name_);
+        break;
+
+    case VAR_RESOURCEREFLIST:
+        SetType(VAR_RESOURCEREFLIST);
+        value_.resourceRefList_.type_ = rhs.value_.resourceRefList_.type_;
+        value_.resourceRefList_.names_.Swap(rhs.value_.resourceRefList_.names_);
+        break;
+
+    case VAR_VARIANTVECTOR:
+        SetType(VAR_VARIANTVECTOR);
+        value_.variantVector_.Swap(rhs.value_.variantVector_);
+        break;
+
+    case VAR_STRINGVECTOR:
+        SetType(VAR_STRINGVECTOR);
+        value_.stringVector_.Swap(rhs.value_.stringVector_);
+        break;
+
+    case VAR_VARIANTMAP:
+        SetType(VAR_VARIANTMAP);
+        value_.variantMap_.Swap(rhs.value_.variantMap_);
+        break;
+
+    // Take over the heap-allocated values and leave the source empty
+    case VAR_MATRIX3:
+        SetType(VAR_NONE);
+        value_.matrix3_ = rhs.value_.matrix3_;
+        type_ = rhs.type_;
+        rhs.type_ = VAR_NONE;
+        break;
+
+    case VAR_MATRIX3X4:
+        SetType(VAR_NONE);
+        value_.matrix3x4_ = rhs.value_.matrix3x4_;
+        type_ = rhs.type_;
+        rhs.type_ = VAR_NONE;
+        break;
+
+    case VAR_MATRIX4:
+        SetType(VAR_NONE);
+        value_.matrix4_ = rhs.value_.matrix4_;
+        type_ = rhs.type_;
+        rhs.type_ = VAR_NONE;
+        break;
+
+    case VAR_CUSTOM_HEAP:
+        SetType(VAR_NONE);
+        value_.customValueHeap_ = rhs.value_.customValueHeap_;
+        type_ = rhs.type_;
+        rhs.type_ = VAR_NONE;
+        break;
+
+    default:
+        *this = static_cast<const Variant&>(rhs);
+        break;
+    }
+
+    return *this;
+}
+
 Variant& Variant::operator =(const VectorBuffer& rhs)
 {
     SetType(VAR_BUFFER);
@@ -976,4 +1057,317 @@ VariantType Variant::GetTypeFromName(const char* typeName)
     return (VariantType)GetStringListIndex(typeName, typeNames, VAR_NONE);
 }
 
+/// Memory block of a variant map.
+struct VariantMap::Block
+{
+    /// Next older block.
+    Block* next_;
+    /// Number of pairs allocated in the block.
+    unsigned numPairs_;
+};
+
+static_assert(sizeof(VariantMap) <= VARIANT_VALUE_SIZE, "VariantMap must fit in the Variant value");
+
+VariantMap::VariantMap(const VariantMap& map) :
+    VariantMap()
+{
+    *this = map;
+}
+
+VariantMap::VariantMap(VariantMap&& map) noexcept :
+    VariantMap()
+{
+    Swap(map);
+}
+
+VariantMap::VariantMap(const std::initializer_list<Pair<StringHash, Variant> >& list) :
+    VariantMap()
+{
+    Reserve((unsigned)list.size());
+    for (auto it = list.begin(); it != list.end(); ++it)
+        Insert(*it);
+}
+
+VariantMap::~VariantMap()
+{
+    Clear();
+
+    while (blocks_)
+    {
+        Block* next = blocks_->next_;
+        delete[] reinterpret_cast<unsigned char*>(blocks_);
+        blocks_ = next;
+    }
+}
+
+VariantMap& VariantMap::operator =(const VariantMap& rhs)
+{
+    if (&rhs != this)
+    {
+        Clear();
+        Reserve(rhs.size_);
+        for (unsigned i = 0; i < rhs.size_; ++i)
+            InsertPair(rhs.pairs_[i]->first_, rhs.pairs_[i]->second_);
+    }
+    return *this;
+}
+
+VariantMap& VariantMap::operator =(VariantMap&& rhs) noexcept
+{
+    Swap(rhs);
+    return *this;
+}
+
+VariantMap& VariantMap::operator +=(const Pair<StringHash, Variant>& rhs)
+{
+    Insert(rhs);
+    return *this;
+}
+
+VariantMap& VariantMap::operator +=(const VariantMap& rhs)
+{
+    Insert(rhs);
+    return *this;
+}
+
+bool VariantMap::operator ==(const VariantMap& rhs) const
+{
+    if (rhs.size_ != size_)
+        return false;
+
+    for (unsigned i = 0; i < size_; ++i)
+    {
+        unsigned j = rhs.FindIndex(pairs_[i]->first_);
+        if (j == M_MAX_UNSIGNED || rhs.pairs_[j]->second_ != pairs_[i]->second_)
+            return false;
+    }
+
+    return true;
+}
+
+VariantMap& VariantMap::Populate(StringHash key, const Variant& value)
+{
+    operator [](key) = value;
+    return *this;
+}
+
+VariantMap::Iterator VariantMap::Insert(const Pair<StringHash, Variant>& pair)
+{
+    bool exists;
+    return Insert(pair, exists);
+}
+
+VariantMap::Iterator VariantMap::Insert(const Pair<StringHash, Variant>& pair, bool& exists)
+{
+    unsigned i = FindIndex(pair.first_);
+    exists = i != M_MAX_UNSIGNED;
+    if (!exists)
+        return InsertPair(pair.first_, pair.second_);
+
+    pairs_[i]->second_ = pair.second_;
+    return Iterator(pairs_ + i);
+}
+
+void VariantMap::Insert(const VariantMap& map)
+{
+    if (&map == this)
+        return;
+
+    Reserve(size_ + map.size_);
+    Insert(map.Begin(), map.End());
+}
+
+VariantMap::Iterator VariantMap::Insert(ConstIterator it)
+{
+    unsigned i = FindIndex(it->first_);
+    if (i == M_MAX_UNSIGNED)
+        return InsertPair(it->first_, it->second_);
+
+    pairs_[i]->second_ = it->second_;
+    return Iterator(pairs_ + i);
+}
+
+void VariantMap::Insert(ConstIterator start, ConstIterator end)
+{
+    for (ConstIterator it = start; it != end; ++it)
+        Insert(it);
+}
+
+bool VariantMap::Erase(StringHash key)
+{
+    unsigned i = FindIndex(key);
+    if (i == M_MAX_UNSIGNED)
+        return false;
+
+    Erase(Iterator(pairs_ + i));
+    return true;
+}
+
+VariantMap::Iterator VariantMap::Erase(Iterator it)
+{
+    auto i = (unsigned)(it.ptr_ - pairs_);
+    if (i >= size_)
+        return End();
+
+    unsigned last = size_ - 1;
+    if (capacity_ > MAX_LINEAR_CAPACITY)
+    {
+        UnindexPair(i);
+        if (i != last)
+            GetIndex()[FindSlot(last)] = i;
+    }
+
+    // Move the pointer to the last pair into the erased position. The erased pair's storage goes after the pairs in use,
+    // to be reused by the next inserted pair
+    pairs_[i]->~KeyValue();
+    Urho3D::Swap(pairs_[i], pairs_[last]);
+    --size_;
+
+    return Iterator(pairs_ + i);
+}
+
+void VariantMap::Clear()
+{
+    for (unsigned i = 0; i < size_; ++i)
+        pairs_[i]->~KeyValue();
+    size_ = 0;
+
+    RebuildIndex();
+}
+
+void VariantMap::Reserve(unsigned capacity)
+{
+    if (capacity <= capacity_)
+        return;
+
+    Reallocate(capacity > MIN_CAPACITY ? NextPowerOfTwo(capacity) : (unsigned)MIN_CAPACITY);
+}
+
+void VariantMap::Swap(VariantMap& map)
+{
+    Urho3D::Swap(blocks_, map.blocks_);
+    Urho3D::Swap(pairs_, map.pairs_);
+    Urho3D::Swap(size_, map.size_);
+    Urho3D::Swap(capacity_, map.capacity_);
+}
+
+bool VariantMap::TryGetValue(StringHash key, Variant& out) const
+{
+    unsigned i = FindIndex(key);
+    if (i == M_MAX_UNSIGNED)
+        return false;
+
+    out = pairs_[i]->second_;
+    return true;
+}
+
+Vector<StringHash> VariantMap::Keys() const
+{
+    Vector<StringHash> result;
+    result.Reserve(size_);
+    for (unsigned i = 0; i < size_; ++i)
+        result.Push(pairs_[i]->first_);
+    return result;
+}
+
+Vector<Variant> VariantMap::Values() const
+{
+    Vector<Variant> result;
+    result.Reserve(size_);
+    for (unsigned i = 0; i < size_; ++i)
+        result.Push(pairs_[i]->second_);
+    return result;
+}
+
+unsigned VariantMap::FindSlot(unsigned i) const
+{
+    const unsigned* index = GetIndex();
+    unsigned mask = capacity_ * 2 - 1;
+    unsigned slot = MakeHash(pairs_[i]->first_) & mask;
+    while (index[slot] != i)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+VariantMap::Iterator VariantMap::InsertPair(StringHash key, const Variant& value)
+{
+    // The value may be stored in this map, but the pairs are not moved when reserving more
+    if (size_ == capacity_)
+        Reserve(size_ + 1);
+
+    new(pairs_[size_]) KeyValue(key, value);
+    IndexPair(size_);
+    return Iterator(pairs_ + size_++);
+}
+
+void VariantMap::Reallocate(unsigned capacity)
+{
+    static_assert(sizeof(Block) % alignof(KeyValue) == 0, "Variant map block header must keep the pairs aligned");
+
+    unsigned numPairs = capacity - capacity_;
+    unsigned indexSize = capacity > MAX_LINEAR_CAPACITY ? capacity * 2 * sizeof(unsigned) : 0;
+    auto* block = reinterpret_cast<Block*>(new unsigned char[sizeof(Block) + numPairs * sizeof(KeyValue) +
+        capacity * sizeof(KeyValue*) + indexSize]);
+    auto* newPairs = reinterpret_cast<KeyValue*>(block + 1);
+    auto* newPairPtrs = reinterpret_cast<KeyValue**>(newPairs + numPairs);
+
+    // Keep the existing pairs where they are, along with the storage of erased pairs
+    for (unsigned i = 0; i < capacity_; ++i)
+        newPairPtrs[i] = pairs_[i];
+    for (unsigned i = 0; i < numPairs; ++i)
+        newPairPtrs[capacity_ + i] = newPairs + i;
+
+    block->next_ = blocks_;
+    block->numPairs_ = numPairs;
+    blocks_ = block;
+    pairs_ = newPairPtrs;
+    capacity_ = capacity;
+
+    RebuildIndex();
+}
+
+void VariantMap::RebuildIndex()
+{
+    if (capacity_ <= MAX_LINEAR_CAPACITY)
+        return;
+
+    unsigned* index = GetIndex();
+    for (unsigned slot = 0; slot < capacity_ * 2; ++slot)
+        index[slot] = M_MAX_UNSIGNED;
+    for (unsigned i = 0; i < size_; ++i)
+        IndexPair(i);
+}
+
+void VariantMap::IndexPair(unsigned i)
+{
+    if (capacity_ <= MAX_LINEAR_CAPACITY)
+        return;
+
+    unsigned* index = GetIndex();
+    unsigned mask = capacity_ * 2 - 1;
+    unsigned slot = MakeHash(pairs_[i]->first_) & mask;
+    while (index[slot] != M_MAX_UNSIGNED)
+        slot = (slot + 1) & mask;
+    index[slot] = i;
+}
+
+void VariantMap::UnindexPair(unsigned i)
+{
+    unsigned* index = GetIndex();
+    unsigned mask = capacity_ * 2 - 1;
+    unsigned hole = FindSlot(i);
+
+    // Shift back the following pairs of the probe sequence which can not be found past the hole otherwise
+    for (unsigned slot = (hole + 1) & mask; index[slot] != M_MAX_UNSIGNED; slot = (slot + 1) & mask)
+    {
+        unsigned home = MakeHash(pairs_[index[slot]]->first_) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            index[hole] = index[slot];
+            hole = slot;
+        }
+    }
+    index[hole] = M_MAX_UNSIGNED;
+}
+
 }
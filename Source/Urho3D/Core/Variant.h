@@ -80,8 +80,7 @@ using VariantVector = Vector<Variant>;
 /// Vector of strings.
 using StringVector = Vector<String>;
 
-/// Map of variants.
-using VariantMap = HashMap<StringHash, Variant>;
+class VariantMap;
 
 /// Typed resource reference.
 struct URHO3D_API ResourceRef
@@ -272,6 +271,281 @@ private:
 /// Make custom variant value.
 template <typename T> CustomVariantValueImpl<T> MakeCustomValue(const T& value) { return CustomVariantValueImpl<T>(value); }
 
+/// Map of variants keyed by string hash. Keeps pointers to the pairs in insertion order in one flat array, which is searched linearly while small and through an open-addressed index when larger, avoiding the per-pair allocations of HashMap. The pairs are allocated in blocks which are never moved, so references to the values stay valid until the pair is erased, like with HashMap. Erasing moves the last pair into the erased position of the iteration order, and inserting or erasing may invalidate iterators.
+class URHO3D_API VariantMap
+{
+public:
+    using KeyType = StringHash;
+    using ValueType = Variant;
+
+    /// Key-value pair with const key.
+    struct KeyValue;
+
+    /// Map iterator.
+    struct Iterator
+    {
+        /// Construct.
+        Iterator() = default;
+
+        /// Construct with a pair pointer array position.
+        explicit Iterator(KeyValue** ptr) :
+            ptr_(ptr)
+        {
+        }
+
+        /// Preincrement the pointer.
+        Iterator& operator ++()
+        {
+            ++ptr_;
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        Iterator operator ++(int)
+        {
+            Iterator it = *this;
+            ++ptr_;
+            return it;
+        }
+
+        /// Predecrement the pointer.
+        Iterator& operator --()
+        {
+            --ptr_;
+            return *this;
+        }
+
+        /// Postdecrement the pointer.
+        Iterator operator --(int)
+        {
+            Iterator it = *this;
+            --ptr_;
+            return it;
+        }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const Iterator& rhs) const { return ptr_ == rhs.ptr_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const Iterator& rhs) const { return ptr_ != rhs.ptr_; }
+
+        /// Point to the pair.
+        KeyValue* operator ->() const { return *ptr_; }
+
+        /// Dereference the pair.
+        KeyValue& operator *() const { return **ptr_; }
+
+        /// Pair pointer array position.
+        KeyValue** ptr_{};
+    };
+
+    /// Map const iterator.
+    struct ConstIterator
+    {
+        /// Construct.
+        ConstIterator() = default;
+
+        /// Construct with a pair pointer array position.
+        explicit ConstIterator(KeyValue* const* ptr) :
+            ptr_(ptr)
+        {
+        }
+
+        /// Construct from a non-const iterator.
+        ConstIterator(const Iterator& rhs) :        // NOLINT(google-explicit-constructor)
+            ptr_(rhs.ptr_)
+        {
+        }
+
+        /// Assign from a non-const iterator.
+        ConstIterator& operator =(const Iterator& rhs)
+        {
+            ptr_ = rhs.ptr_;
+            return *this;
+        }
+
+        /// Preincrement the pointer.
+        ConstIterator& operator ++()
+        {
+            ++ptr_;
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        ConstIterator operator ++(int)
+        {
+            ConstIterator it = *this;
+            ++ptr_;
+            return it;
+        }
+
+        /// Predecrement the pointer.
+        ConstIterator& operator --()
+        {
+            --ptr_;
+            return *this;
+        }
+
+        /// Postdecrement the pointer.
+        ConstIterator operator --(int)
+        {
+            ConstIterator it = *this;
+            --ptr_;
+            return it;
+        }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const ConstIterator& rhs) const { return ptr_ == rhs.ptr_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const ConstIterator& rhs) const { return ptr_ != rhs.ptr_; }
+
+        /// Point to the pair.
+        const KeyValue* operator ->() const { return *ptr_; }
+
+        /// Dereference the pair.
+        const KeyValue& operator *() const { return **ptr_; }
+
+        /// Pair pointer array position.
+        KeyValue* const* ptr_{};
+    };
+
+    /// Construct empty.
+    VariantMap() noexcept :
+        blocks_(nullptr),
+        pairs_(nullptr),
+        size_(0),
+        capacity_(0)
+    {
+    }
+
+    /// Copy-construct from another map.
+    VariantMap(const VariantMap& map);
+    /// Move-construct from another map.
+    VariantMap(VariantMap&& map) noexcept;
+    /// Construct from a list of pairs.
+    VariantMap(const std::initializer_list<Pair<StringHash, Variant> >& list);
+    /// Destruct.
+    ~VariantMap();
+
+    /// Assign a map.
+    VariantMap& operator =(const VariantMap& rhs);
+    /// Move-assign a map.
+    VariantMap& operator =(VariantMap&& rhs) noexcept;
+    /// Add-assign a pair.
+    VariantMap& operator +=(const Pair<StringHash, Variant>& rhs);
+    /// Add-assign a map.
+    VariantMap& operator +=(const VariantMap& rhs);
+    /// Test for equality with another map. The order of the pairs does not matter.
+    bool operator ==(const VariantMap& rhs) const;
+    /// Test for inequality with another map.
+    bool operator !=(const VariantMap& rhs) const { return !(*this == rhs); }
+    /// Index the map. Create a new pair if key not found.
+    Variant& operator [](StringHash key);
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    Variant* operator [](StringHash key) const;
+
+    /// Populate the map using variadic template. This handles the base case.
+    VariantMap& Populate(StringHash key, const Variant& value);
+    /// Populate the map using variadic template.
+    template <typename... Args> VariantMap& Populate(StringHash key, const Variant& value, const Args&... args)
+    {
+        Populate(key, value);
+        return Populate(args...);
+    }
+
+    /// Insert a pair, replacing the value if the key exists. Return an iterator to it.
+    Iterator Insert(const Pair<StringHash, Variant>& pair);
+    /// Insert a pair, replacing the value if the key exists. Return an iterator to it and whether the key existed.
+    Iterator Insert(const Pair<StringHash, Variant>& pair, bool& exists);
+    /// Insert the pairs of another map.
+    void Insert(const VariantMap& map);
+    /// Insert a pair by iterator. Return an iterator to it.
+    Iterator Insert(ConstIterator it);
+    /// Insert a range by iterators.
+    void Insert(ConstIterator start, ConstIterator end);
+    /// Erase a pair. Return true if was found.
+    bool Erase(StringHash key);
+    /// Erase a pair by iterator. The last pair is moved in its place, so the returned iterator to the same position points to the next pair to visit.
+    Iterator Erase(Iterator it);
+    /// Clear the map. Keeps the memory reserved.
+    void Clear();
+    /// Reserve memory for at least the specified number of pairs.
+    void Reserve(unsigned capacity);
+    /// Swap with another map.
+    void Swap(VariantMap& map);
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(StringHash key);
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(StringHash key) const;
+    /// Return whether contains a pair with key.
+    bool Contains(StringHash key) const { return FindIndex(key) != M_MAX_UNSIGNED; }
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(StringHash key, Variant& out) const;
+    /// Return all the keys.
+    Vector<StringHash> Keys() const;
+    /// Return all the values.
+    Vector<Variant> Values() const;
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(pairs_); }
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(pairs_); }
+    /// Return iterator to the end.
+    Iterator End();
+    /// Return iterator to the end.
+    ConstIterator End() const;
+    /// Return first pair.
+    const KeyValue& Front() const { return **pairs_; }
+    /// Return last pair.
+    const KeyValue& Back() const;
+
+    /// Return number of pairs.
+    unsigned Size() const { return size_; }
+
+    /// Return number of pairs that fit in the memory reserved.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return whether map is empty.
+    bool Empty() const { return size_ == 0; }
+
+    /// Minimum number of pairs to reserve memory for.
+    static const unsigned MIN_CAPACITY = 8;
+    /// Largest capacity searched linearly. Larger maps have an open-addressed index with twice as many slots, after the pair pointers.
+    static const unsigned MAX_LINEAR_CAPACITY = 8;
+
+private:
+    /// Memory block header, followed by the pairs allocated in the block, the pair pointers and the index.
+    struct Block;
+
+    /// Return position of the pair with key, or M_MAX_UNSIGNED if not found.
+    unsigned FindIndex(StringHash key) const;
+    /// Return the index slot which refers to a pair position.
+    unsigned FindSlot(unsigned i) const;
+    /// Append a pair. The key must not exist.
+    Iterator InsertPair(StringHash key, const Variant& value);
+    /// Allocate a block for more pairs. The existing pairs are not moved.
+    void Reallocate(unsigned capacity);
+    /// Rebuild the index.
+    void RebuildIndex();
+    /// Return the index slots.
+    unsigned* GetIndex() const;
+    /// Add a pair to the index.
+    void IndexPair(unsigned i);
+    /// Remove a pair from the index, shifting the following slots back. The map must be large enough to have an index.
+    void UnindexPair(unsigned i);
+
+    /// Newest memory block, which holds the pair pointers and the index. The blocks are linked to the older ones.
+    Block* blocks_;
+    /// Pointers to the pairs in iteration order, followed by pointers to the constructed pairs' unused storage.
+    KeyValue** pairs_;
+    /// Number of pairs.
+    unsigned size_;
+    /// Number of pairs that fit in the memory reserved.
+    unsigned capacity_;
+};
+
 /// Size of variant value. 16 bytes on 32-bit platform, 32 bytes on 64-bit platform.
 static const unsigned VARIANT_VALUE_SIZE = sizeof(void*) * 4;
 
@@ -548,6 +822,12 @@ public:
         *this = value;
     }
 
+    /// Move-construct from another variant. Values allocated on the heap are moved instead of copied.
+    Variant(Variant&& value) noexcept
+    {
+        *this = std::move(value);
+    }
+
     /// Destruct.
     ~Variant()
     {
@@ -563,6 +843,9 @@ public:
     /// Assign from another variant.
     Variant& operator =(const Variant& rhs);
 
+    /// Move-assign from another variant. Values allocated on the heap are moved instead of copied.
+    Variant& operator =(Variant&& rhs) noexcept;
+
     /// Assign from an integer.
     Variant& operator =(int rhs)
     {
@@ -1400,6 +1683,92 @@ private:
     VariantValue value_;
 };
 
+/// Variant map key-value pair with const key.
+struct VariantMap::KeyValue
+{
+    /// Construct with key and value.
+    KeyValue(StringHash first, const Variant& second) :
+        first_(first),
+        second_(second)
+    {
+    }
+
+    /// Construct with key and moved value.
+    KeyValue(StringHash first, Variant&& second) :
+        first_(first),
+        second_(std::move(second))
+    {
+    }
+
+    /// Prevent assignment.
+    KeyValue& operator =(const KeyValue& rhs) = delete;
+
+    /// Test for equality with another pair.
+    bool operator ==(const KeyValue& rhs) const { return first_ == rhs.first_ && second_ == rhs.second_; }
+
+    /// Test for inequality with another pair.
+    bool operator !=(const KeyValue& rhs) const { return first_ != rhs.first_ || second_ != rhs.second_; }
+
+    /// Key.
+    const StringHash first_;
+    /// Value.
+    Variant second_;
+};
+
+inline unsigned VariantMap::FindIndex(StringHash key) const
+{
+    if (capacity_ <= MAX_LINEAR_CAPACITY)
+    {
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            if (pairs_[i]->first_ == key)
+                return i;
+        }
+        return M_MAX_UNSIGNED;
+    }
+
+    const unsigned* index = GetIndex();
+    unsigned mask = capacity_ * 2 - 1;
+    for (unsigned slot = MakeHash(key) & mask;; slot = (slot + 1) & mask)
+    {
+        unsigned i = index[slot];
+        if (i == M_MAX_UNSIGNED || pairs_[i]->first_ == key)
+            return i;
+    }
+}
+
+inline unsigned* VariantMap::GetIndex() const { return reinterpret_cast<unsigned*>(pairs_ + capacity_); }
+
+inline Variant& VariantMap::operator [](StringHash key)
+{
+    unsigned i = FindIndex(key);
+    return i != M_MAX_UNSIGNED ? pairs_[i]->second_ : InsertPair(key, Variant::EMPTY)->second_;
+}
+
+inline Variant* VariantMap::operator [](StringHash key) const
+{
+    unsigned i = FindIndex(key);
+    return i != M_MAX_UNSIGNED ? &pairs_[i]->second_ : nullptr;
+}
+
+inline VariantMap::Iterator VariantMap::Find(StringHash key)
+{
+    unsigned i = FindIndex(key);
+    return i != M_MAX_UNSIGNED ? Iterator(pairs_ + i) : End();
+}
+
+inline VariantMap::ConstIterator VariantMap::Find(StringHash key) const
+{
+    unsigned i = FindIndex(key);
+    return i != M_MAX_UNSIGNED ? ConstIterator(pairs_ + i) : End();
+}
+
+inline VariantMap::Iterator VariantMap::End() { return Iterator(pairs_ + size_); }
+
+inline VariantMap::ConstIterator VariantMap::End() const { return ConstIterator(pairs_ + size_); }
+
+inline const VariantMap::KeyValue& VariantMap::Back() const { return *pairs_[size_ - 1]; }
+
 /// Return variant type from type.
 template <typename T> VariantType GetVariantType();
 
@@ -1566,4 +1935,12 @@ template <class T> const T* CustomVariantValue::GetValuePtr() const
     return nullptr;
 }
 
+inline VariantMap::ConstIterator begin(const VariantMap& v) { return v.Begin(); }
+
+inline VariantMap::ConstIterator end(const VariantMap& v) { return v.End(); }
+
+inline VariantMap::Iterator begin(VariantMap& v) { return v.Begin(); }
+
+inline VariantMap::Iterator end(VariantMap& v) { return v.End(); }
+
 }
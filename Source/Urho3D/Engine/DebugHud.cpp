@@ -32,6 +32,9 @@
 #include "../Graphics/Renderer.h"
 #include "../Resource/ResourceCache.h"
 #include "../IO/Log.h"
+#ifdef URHO3D_NETWORK
+#include "../Network/Network.h"
+#endif
 #include "../UI/Font.h"
 #include "../UI/Text.h"
 #include "../UI/UI.h"
@@ -99,6 +102,12 @@ DebugHud::DebugHud(Context* context) :
     eventProfilerText_->SetVisible(false);
     uiRoot->AddChild(eventProfilerText_);
 
+    networkText_ = new Text(context_);
+    networkText_->SetAlignment(HA_RIGHT, VA_BOTTOM);
+    networkText_->SetPriority(100);
+    networkText_->SetVisible(false);
+    uiRoot->AddChild(networkText_);
+
     SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(DebugHud, HandlePostUpdate));
 }
 
@@ -109,6 +118,7 @@ DebugHud::~DebugHud()
     profilerText_->Remove();
     memoryText_->Remove();
     eventProfilerText_->Remove();
+    networkText_->Remove();
 }
 
 void DebugHud::Update()
@@ -126,6 +136,7 @@ void DebugHud::Update()
         uiRoot->AddChild(statsText_);
         uiRoot->AddChild(modeText_);
         uiRoot->AddChild(profilerText_);
+        uiRoot->AddChild(networkText_);
     }
 
     if (statsText_->IsVisible())
@@ -203,6 +214,15 @@ void DebugHud::Update()
 
     if (memoryText_->IsVisible())
         memoryText_->SetText(GetSubsystem<ResourceCache>()->PrintMemoryUsage());
+
+#ifdef URHO3D_NETWORK
+    auto* network = GetSubsystem<Network>();
+    if (network && networkText_->IsVisible() && networkTimer_.GetMSec(false) >= profilerInterval_)
+    {
+        networkTimer_.Reset();
+        networkText_->SetText(network->PrintStatistics());
+    }
+#endif
 }
 
 void DebugHud::SetDefaultStyle(XMLFile* style)
@@ -220,6 +240,8 @@ void DebugHud::SetDefaultStyle(XMLFile* style)
     memoryText_->SetStyle("DebugHudText");
     eventProfilerText_->SetDefaultStyle(style);
     eventProfilerText_->SetStyle("DebugHudText");
+    networkText_->SetDefaultStyle(style);
+    networkText_->SetStyle("DebugHudText");
 }
 
 void DebugHud::SetMode(unsigned mode)
@@ -229,6 +251,7 @@ void DebugHud::SetMode(unsigned mode)
     profilerText_->SetVisible((mode & DEBUGHUD_SHOW_PROFILER) != 0);
     memoryText_->SetVisible((mode & DEBUGHUD_SHOW_MEMORY) != 0);
     eventProfilerText_->SetVisible((mode & DEBUGHUD_SHOW_EVENTPROFILER) != 0);
+    networkText_->SetVisible((mode & DEBUGHUD_SHOW_NETWORK) != 0);
 
     memoryText_->SetPosition(0, modeText_->IsVisible() ? modeText_->GetHeight() * -2 : 0);
 
@@ -239,6 +262,13 @@ void DebugHud::SetMode(unsigned mode)
         EventProfiler::SetActive((mode & DEBUGHUD_SHOW_EVENTPROFILER) != 0);
 #endif
 
+#ifdef URHO3D_NETWORK
+    // Collect network statistics while they are shown
+    auto* network = GetSubsystem<Network>();
+    if (network && (mode & DEBUGHUD_SHOW_NETWORK) != (mode_ & DEBUGHUD_SHOW_NETWORK))
+        network->SetStatisticsEnabled((mode & DEBUGHUD_SHOW_NETWORK) != 0);
+#endif
+
     mode_ = mode;
 }
 
@@ -39,6 +39,7 @@ static const unsigned DEBUGHUD_SHOW_MODE = 0x2;
 static const unsigned DEBUGHUD_SHOW_PROFILER = 0x4;
 static const unsigned DEBUGHUD_SHOW_MEMORY = 0x8;
 static const unsigned DEBUGHUD_SHOW_EVENTPROFILER = 0x10;
+static const unsigned DEBUGHUD_SHOW_NETWORK = 0x20;
 static const unsigned DEBUGHUD_SHOW_ALL = DEBUGHUD_SHOW_STATS | DEBUGHUD_SHOW_MODE | DEBUGHUD_SHOW_PROFILER | DEBUGHUD_SHOW_MEMORY;
 
 /// Displays rendering stats and profiling information.
@@ -84,6 +85,9 @@ public:
     /// Return memory text.
     Text* GetMemoryText() const { return memoryText_; }
 
+    /// Return network statistics text.
+    Text* GetNetworkText() const { return networkText_; }
+
     /// Return currently shown elements.
     unsigned GetMode() const { return mode_; }
 
@@ -119,10 +123,14 @@ private:
     SharedPtr<Text> eventProfilerText_;
     /// Memory stats text.
     SharedPtr<Text> memoryText_;
+    /// Network statistics text.
+    SharedPtr<Text> networkText_;
     /// Hashmap containing application specific stats.
     HashMap<String, String> appStats_;
     /// Profiler timer.
     Timer profilerTimer_;
+    /// Network statistics update timer.
+    Timer networkTimer_;
     /// Profiler max block depth.
     unsigned profilerMaxDepth_;
     /// Profiler accumulation interval.
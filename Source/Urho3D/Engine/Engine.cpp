@@ -92,6 +92,9 @@ namespace Urho3D
 
 extern const char* logLevelPrefixes[];
 
+/// Number of ticks the fixed tick loop may fall behind before the missed ticks are dropped.
+static const long long MAX_TICK_CATCHUP = 5;
+
 Engine::Engine(Context* context) :
     Object(context),
     timeStep_(0.0f),
@@ -106,6 +109,11 @@ Engine::Engine(Context* context) :
     maxInactiveFps_(60),
     pauseMinimized_(false),
 #endif
+    nextTickTime_(0),
+    lastTickTime_(0),
+    tickRate_(0),
+    numTickOverruns_(0),
+    numSkippedTicks_(0),
 #ifdef URHO3D_TESTING
     timeOut_(0),
 #endif
@@ -204,10 +212,29 @@ bool Engine::Initialize(const VariantMap& parameters)
     if (GetParameter(parameters, EP_FRAME_LIMITER, true) == false)
         SetMaxFps(0);
 
-    // Set amount of worker threads according to the available physical CPU cores. Using also hyperthreaded cores results in
-    // unpredictable extra synchronization overhead. Also reserve one core for the main thread
+    // Configure fixed tick rate
+    if (HasParameter(parameters, EP_TICK_RATE))
+        SetTickRate(GetParameter(parameters, EP_TICK_RATE).GetInt());
+
+    // Restrict the main thread and the worker threads created below to the given CPUs
+    unsigned numCPUs = GetNumPhysicalCPUs();
+    if (HasParameter(parameters, EP_CPU_AFFINITY))
+    {
+        unsigned long long mask = GetParameter(parameters, EP_CPU_AFFINITY).GetUInt64();
+        if (SetCPUAffinity(mask))
+        {
+            URHO3D_LOGINFO("Set CPU affinity mask " + String(mask));
+            numCPUs = Min(CountSetBits((unsigned)mask) + CountSetBits((unsigned)(mask >> 32)), numCPUs);
+        }
+        else
+            URHO3D_LOGERROR("Failed to set CPU affinity mask " + String(mask));
+    }
+
+    // Set amount of worker threads according to the available physical CPU cores, or the CPUs of the affinity mask if fewer.
+    // Using also hyperthreaded cores results in unpredictable extra synchronization overhead. Also reserve one core for the
+    // main thread
 #ifdef URHO3D_THREADING
-    unsigned numThreads = GetParameter(parameters, EP_WORKER_THREADS, true).GetBool() ? GetNumPhysicalCPUs() - 1 : 0;
+    unsigned numThreads = GetParameter(parameters, EP_WORKER_THREADS, true).GetBool() && numCPUs ? numCPUs - 1 : 0;
     if (numThreads)
     {
         GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
@@ -575,6 +602,16 @@ void Engine::SetMaxInactiveFps(int fps)
     maxInactiveFps_ = (unsigned)Max(fps, 0);
 }
 
+void Engine::SetTickRate(int rate)
+{
+    tickRate_ = (unsigned)Max(rate, 0);
+
+    // Restart the tick schedule
+    tickTimer_.Reset();
+    nextTickTime_ = 0;
+    lastTimeSteps_.Clear();
+}
+
 void Engine::SetPauseMinimized(bool enable)
 {
     pauseMinimized_ = enable;
@@ -685,12 +722,13 @@ void Engine::Update()
 {
     URHO3D_PROFILE(Update);
 
-    // Logic update event
+    // Logic update event. Sent typed before filling the event data, as it may use the same event data map
+    SendEvent(UpdateEventData{timeStep_});
+
     using namespace Update;
 
     VariantMap& eventData = GetEventDataMap();
     eventData[P_TIMESTEP] = timeStep_;
-    SendEvent(E_UPDATE, eventData);
 
     // Logic post-update event
     SendEvent(E_POSTUPDATE, eventData);
@@ -724,6 +762,12 @@ void Engine::ApplyFrameLimit()
     if (!initialized_)
         return;
 
+    if (tickRate_)
+    {
+        ApplyTickLimit();
+        return;
+    }
+
     unsigned maxFps = maxFps_;
     auto* input = GetSubsystem<Input>();
     if (input && !input->HasFocus())
@@ -794,6 +838,57 @@ void Engine::ApplyFrameLimit()
         timeStep_ = lastTimeSteps_.Back();
 }
 
+void Engine::ApplyTickLimit()
+{
+    URHO3D_PROFILE(ApplyTickLimit);
+
+    long long interval = 1000000LL / tickRate_;
+    // The tick timer runs from the start of the current tick
+    long long now = tickTimer_.GetUSec(false);
+
+    lastTickTime_ = now;
+    if (lastTickTime_ > interval)
+        ++numTickOverruns_;
+
+    // Schedule ticks at absolute times so that the sleep inaccuracy does not accumulate. If too far behind, drop the missed
+    // ticks instead of running them back-to-back
+    nextTickTime_ += interval;
+    if (now - nextTickTime_ >= MAX_TICK_CATCHUP * interval)
+    {
+        long long missed = (now - nextTickTime_) / interval;
+        numSkippedTicks_ += (unsigned)missed;
+        nextTickTime_ += missed * interval;
+    }
+
+    for (;;)
+    {
+        now = tickTimer_.GetUSec(false);
+        long long remaining = nextTickTime_ - now;
+        if (remaining <= 0)
+            break;
+
+        // Sleep while at least 1 ms remains after the sleep to absorb the scheduler granularity, then yield until due
+        if (remaining >= 2000LL)
+            Time::Sleep((unsigned)((remaining - 1000LL) / 1000LL));
+        else
+            Time::Sleep(0);
+    }
+
+    // Rebase the schedule on the new tick start
+    nextTickTime_ -= tickTimer_.GetUSec(true);
+    timeStep_ = 1.0f / tickRate_;
+    frameTimer_.Reset();
+
+#ifdef URHO3D_TESTING
+    if (timeOut_ > 0)
+    {
+        timeOut_ -= interval;
+        if (timeOut_ <= 0)
+            Exit();
+    }
+#endif
+}
+
 VariantMap Engine::ParseParameters(const Vector<String>& arguments)
 {
     VariantMap ret;
@@ -946,6 +1041,16 @@ VariantMap Engine::ParseParameters(const Vector<String>& arguments)
             }
             else if (argument == "touch")
                 ret[EP_TOUCH_EMULATION] = true;
+            else if (argument == "tickrate" && !value.Empty())
+            {
+                ret[EP_TICK_RATE] = ToInt(value);
+                ++i;
+            }
+            else if (argument == "affinity" && !value.Empty())
+            {
+                ret[EP_CPU_AFFINITY] = ToUInt64(value, value.StartsWith("0x", false) ? 16 : 10);
+                ++i;
+            }
 #ifdef URHO3D_TESTING
             else if (argument == "timeout" && !value.Empty())
             {
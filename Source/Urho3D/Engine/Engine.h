@@ -58,6 +58,8 @@ public:
     void SetMaxFps(int fps);
     /// Set maximum frames per second when the application does not have input focus.
     void SetMaxInactiveFps(int fps);
+    /// Set fixed tick rate for dedicated server operation. When nonzero, each frame advances time by exactly one tick and the engine sleeps until the next tick is due, ignoring the maximum and minimum FPS. 0 (default) uses the variable timestep.
+    void SetTickRate(int rate);
     /// Set how many frames to average for timestep smoothing. Default is 2. 1 disables smoothing.
     void SetTimeStepSmoothing(int frames);
     /// Set whether to pause update events and audio when minimized.
@@ -87,6 +89,18 @@ public:
     /// Return the maximum frames per second when the application does not have input focus.
     int GetMaxInactiveFps() const { return maxInactiveFps_; }
 
+    /// Return fixed tick rate. 0 if using the variable timestep.
+    int GetTickRate() const { return tickRate_; }
+
+    /// Return number of ticks whose processing took longer than the tick interval.
+    unsigned GetNumTickOverruns() const { return numTickOverruns_; }
+
+    /// Return number of ticks dropped because the engine fell too far behind the tick schedule.
+    unsigned GetNumSkippedTicks() const { return numSkippedTicks_; }
+
+    /// Return processing time of the last tick in microseconds, excluding the sleep.
+    long long GetLastTickTime() const { return lastTickTime_; }
+
     /// Return how many frames to average for timestep smoothing.
     int GetTimeStepSmoothing() const { return timeStepSmoothing_; }
 
@@ -125,6 +139,8 @@ private:
     void HandleExitRequested(StringHash eventType, VariantMap& eventData);
     /// Actually perform the exit actions.
     void DoExit();
+    /// Get the fixed timestep and sleep until the next tick is due.
+    void ApplyTickLimit();
 
     /// Frame update timer.
     HiresTimer frameTimer_;
@@ -142,6 +158,18 @@ private:
     unsigned maxInactiveFps_;
     /// Pause when minimized flag.
     bool pauseMinimized_;
+    /// Tick schedule timer.
+    HiresTimer tickTimer_;
+    /// Scheduled time of the next tick in microseconds, relative to the start of the current tick.
+    long long nextTickTime_;
+    /// Processing time of the last tick in microseconds.
+    long long lastTickTime_;
+    /// Fixed tick rate.
+    unsigned tickRate_;
+    /// Number of tick overruns.
+    unsigned numTickOverruns_;
+    /// Number of skipped ticks.
+    unsigned numSkippedTicks_;
 #ifdef URHO3D_TESTING
     /// Time out counter for testing.
     long long timeOut_;
@@ -28,6 +28,7 @@ namespace Urho3D
 // Engine parameters
 static const String EP_AUTOLOAD_PATHS = "AutoloadPaths";
 static const String EP_BORDERLESS = "Borderless";
+static const String EP_CPU_AFFINITY = "CpuAffinity";
 static const String EP_DUMP_SHADERS = "DumpShaders";
 static const String EP_EVENT_PROFILER = "EventProfiler";
 static const String EP_EXTERNAL_WINDOW = "ExternalWindow";
@@ -61,6 +62,7 @@ static const String EP_SOUND_STEREO = "SoundStereo";
 static const String EP_TEXTURE_ANISOTROPY = "TextureAnisotropy";
 static const String EP_TEXTURE_FILTER_MODE = "TextureFilterMode";
 static const String EP_TEXTURE_QUALITY = "TextureQuality";
+static const String EP_TICK_RATE = "TickRate";
 static const String EP_TIME_OUT = "TimeOut";
 static const String EP_TOUCH_EMULATION = "TouchEmulation";
 static const String EP_TRIPLE_BUFFER = "TripleBuffer";
@@ -134,6 +134,15 @@ bool AnimatedModel::Load(Deserializer& source)
     return success;
 }
 
+bool AnimatedModel::LoadValues(const Vector<Variant>& values)
+{
+    loading_ = true;
+    bool success = Component::LoadValues(values);
+    loading_ = false;
+
+    return success;
+}
+
 bool AnimatedModel::LoadXML(const XMLElement& source)
 {
     loading_ = true;
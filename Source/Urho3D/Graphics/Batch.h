@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/ArenaVector.h"
 #include "../Container/Ptr.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Material.h"
@@ -168,8 +169,8 @@ struct BatchGroup : public Batch
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
 
-    /// Instance data.
-    PODVector<InstanceData> instances_;
+    /// Instance data. Allocated from the renderer's frame arena.
+    ArenaVector<InstanceData> instances_;
     /// Instance stream start index, or M_MAX_UNSIGNED if transforms not pre-set.
     unsigned startIndex_;
 };
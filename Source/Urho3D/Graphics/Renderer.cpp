@@ -24,6 +24,7 @@
 
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Geometry.h"
@@ -664,6 +665,17 @@ void Renderer::Update(float timeStep)
     numOcclusionBuffers_ = 0;
     updatedOctrees_.Clear();
 
+    // The views are rebuilt, so the transient data of the previous views is no longer needed. When updates are paused,
+    // for example while minimized, the previous views keep being rendered and their data must remain valid until here
+    for (unsigned i = 0; i < frameAllocators_.Size(); ++i)
+        frameAllocators_[i]->Reset();
+
+    // Make sure there is a frame arena for each thread that may process views
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numThreads = queue ? queue->GetNumThreads() + 1 : 1;
+    while (frameAllocators_.Size() < numThreads)
+        frameAllocators_.Push(UniquePtr<ArenaAllocator>(new ArenaAllocator()));
+
     // Reload shaders now if needed
     if (shadersDirty_)
         LoadShaders();
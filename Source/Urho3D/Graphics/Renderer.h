@@ -379,6 +379,12 @@ public:
     /// Return the frame update parameters.
     const FrameInfo& GetFrameInfo() const { return frame_; }
 
+    /// Return the per-frame arena of a work queue thread, 0 being the main thread. Its memory is reclaimed when the views are next updated. Return null if the thread index is out of range.
+    ArenaAllocator* GetFrameAllocator(unsigned threadIndex = 0) const
+    {
+        return threadIndex < frameAllocators_.Size() ? frameAllocators_[threadIndex].Get() : nullptr;
+    }
+
     /// Update for rendering. Called by HandleRenderUpdate().
     void Update(float timeStep);
     /// Render. Called by Engine.
@@ -532,6 +538,8 @@ private:
     Vector<String> deferredLightPSVariations_;
     /// Frame info for rendering.
     FrameInfo frame_;
+    /// Per-frame arenas for the main thread and each work queue thread.
+    Vector<UniquePtr<ArenaAllocator> > frameAllocators_;
     /// Texture anisotropy level.
     int textureAnisotropy_{4};
     /// Texture filtering mode.
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Graphics/Drawable.h"
+#include "../Scene/ComponentPool.h"
 
 namespace Urho3D
 {
@@ -42,6 +43,7 @@ struct StaticModelGeometryData
 class URHO3D_API StaticModel : public Drawable
 {
     URHO3D_OBJECT(StaticModel, Drawable);
+    URHO3D_POOLED_COMPONENT(StaticModel)
 
 public:
     /// Construct.
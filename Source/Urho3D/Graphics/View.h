@@ -56,10 +56,10 @@ struct LightQueryResult
 {
     /// Light.
     Light* light_;
-    /// Lit geometries.
-    PODVector<Drawable*> litGeometries_;
-    /// Shadow casters.
-    PODVector<Drawable*> shadowCasters_;
+    /// Lit geometries. Allocated from the frame arena of the thread processing the light.
+    ArenaVector<Drawable*> litGeometries_;
+    /// Shadow casters. Allocated from the frame arena of the thread processing the light.
+    ArenaVector<Drawable*> shadowCasters_;
     /// Shadow cameras.
     Camera* shadowCameras_[MAX_LIGHT_SPLITS];
     /// Shadow caster start indices.
@@ -73,6 +73,7 @@ class URHO3D_API CrowdAgent : public Component
 {
     URHO3D_OBJECT(CrowdAgent, Component);
 
+    friend class CrowdFlowField;
     friend class CrowdManager;
     friend void CrowdAgentUpdateCallback(dtCrowdAgent* ag, float dt);
 
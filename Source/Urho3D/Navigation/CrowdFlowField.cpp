@@ -0,0 +1,796 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/DebugRenderer.h"
+#include "../IO/Log.h"
+#include "../Navigation/CrowdAgent.h"
+#include "../Navigation/CrowdFlowField.h"
+#include "../Navigation/CrowdManager.h"
+#include "../Navigation/NavigationEvents.h"
+#include "../Navigation/NavigationMesh.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include <Detour/DetourNavMesh.h>
+#include <Detour/DetourNavMeshQuery.h>
+#include <DetourCrowd/DetourCrowd.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* NAVIGATION_CATEGORY;
+
+static const unsigned DEFAULT_MAX_FIELDS = 16;
+/// Number of portals looked ahead when steering.
+static const unsigned MAX_LOOKAHEAD_PORTALS = 8;
+
+/// Flow field cells of one navigation mesh tile.
+struct CrowdFlowFieldTile
+{
+    /// Tile salt when the cells were computed, to detect the tile being replaced.
+    unsigned salt_{M_MAX_UNSIGNED};
+    /// Path distance to the goal from each polygon.
+    PODVector<float> distances_;
+    /// Next polygon towards the goal from each polygon.
+    PODVector<dtPolyRef> next_;
+};
+
+/// Flow field over the navigation mesh polygons to one goal polygon.
+struct CrowdFlowFieldGoal : public RefCounted
+{
+    /// Return the tile and polygon index of a polygon reference, or false if the reference is outdated.
+    bool Decode(dtPolyRef ref, unsigned& tileIndex, unsigned& polyIndex) const
+    {
+        unsigned salt, it, ip;
+        navMesh_->decodePolyId(ref, salt, it, ip);
+        if (it >= tiles_.Size() || tiles_[it].salt_ != salt || ip >= tiles_[it].distances_.Size())
+            return false;
+        tileIndex = it;
+        polyIndex = ip;
+        return true;
+    }
+
+    /// Return path distance to the goal from a polygon, or infinity if not reachable.
+    float GetDistance(dtPolyRef ref) const
+    {
+        unsigned it, ip;
+        return Decode(ref, it, ip) ? tiles_[it].distances_[ip] : M_INFINITY;
+    }
+
+    /// Return next polygon towards the goal, or zero if not reachable.
+    dtPolyRef GetNext(dtPolyRef ref) const
+    {
+        unsigned it, ip;
+        return Decode(ref, it, ip) ? tiles_[it].next_[ip] : 0;
+    }
+
+    /// Navigation mesh the field was computed for.
+    const dtNavMesh* navMesh_{};
+    /// Goal polygon.
+    dtPolyRef goalRef_{};
+    /// Goal position on the navigation mesh.
+    Vector3 goal_;
+    /// Query filter type.
+    unsigned queryFilterType_{};
+    /// Cells by tile.
+    Vector<CrowdFlowFieldTile> tiles_;
+    /// Number of agents following the field.
+    unsigned numAgents_{};
+    /// Update count when the field was last used.
+    unsigned lastUsed_{};
+};
+
+static Vector3 GetPolyCenter(const dtMeshTile* tile, const dtPoly* poly)
+{
+    Vector3 center;
+    for (unsigned i = 0; i < poly->vertCount; ++i)
+        center += Vector3(&tile->verts[poly->verts[i] * 3]);
+    return center / (float)poly->vertCount;
+}
+
+static bool IsPassable(const dtQueryFilter* filter, const dtPoly* poly)
+{
+    // Velocity steered agents can not traverse off-mesh connections. Check the flags directly, as dtQueryFilter::passFilter() is not exported
+    return poly->getType() == DT_POLYTYPE_GROUND && (poly->flags & filter->getIncludeFlags()) && !(poly->flags & filter->getExcludeFlags());
+}
+
+static bool GetPortal(const dtNavMesh* navMesh, dtPolyRef from, dtPolyRef to, Vector3& left, Vector3& right)
+{
+    const dtMeshTile* tile;
+    const dtPoly* poly;
+    if (dtStatusFailed(navMesh->getTileAndPolyByRef(from, &tile, &poly)))
+        return false;
+
+    for (unsigned i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+    {
+        const dtLink& link = tile->links[i];
+        if (link.ref != to)
+            continue;
+
+        const float* v0 = &tile->verts[poly->verts[link.edge] * 3];
+        const float* v1 = &tile->verts[poly->verts[(link.edge + 1) % poly->vertCount] * 3];
+        left = Vector3(v0);
+        right = Vector3(v1);
+
+        // Clamp to the linked part of a tile border edge, as in dtNavMeshQuery::getPortalPoints()
+        if (link.side != 0xff && (link.bmin != 0 || link.bmax != 255))
+        {
+            left = Vector3(v0).Lerp(Vector3(v1), link.bmin / 255.0f);
+            right = Vector3(v0).Lerp(Vector3(v1), link.bmax / 255.0f);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/// Shrink a portal by the given radius from both ends.
+static void ShrinkPortal(Vector3& left, Vector3& right, float radius)
+{
+    Vector3 edge = right - left;
+    float length = Vector2(edge.x_, edge.z_).Length();
+    if (length <= radius * 2.0f)
+        left = right = (left + right) * 0.5f;
+    else if (radius > 0.0f)
+    {
+        left += edge * (radius / length);
+        right -= edge * (radius / length);
+    }
+}
+
+/// Return twice the signed area of a triangle on the XZ plane, as dtTriArea2D().
+static float TriArea2D(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+    return (c.x_ - a.x_) * (b.z_ - a.z_) - (b.x_ - a.x_) * (c.z_ - a.z_);
+}
+
+static bool EqualXZ(const Vector3& a, const Vector3& b)
+{
+    return Vector2(a.x_ - b.x_, a.z_ - b.z_).LengthSquared() < M_EPSILON * M_EPSILON;
+}
+
+/// Return the direction to steer from a position in a polygon. Return false if the polygon is not part of the field or not connected to the goal.
+static bool GetFieldDirection(const CrowdFlowFieldGoal* field, dtPolyRef ref, const Vector3& position, const Vector3& goal, float radius,
+    Vector3& direction)
+{
+    if (field->GetDistance(ref) == M_INFINITY)
+        return false;
+
+    // Pull the route taut through the next portals towards the goal, as in dtNavMeshQuery::findStraightPath(), and steer to its
+    // first corner. Looking ahead keeps the agents from hugging the near end of each portal
+    Vector3 funnelLeft = position;
+    Vector3 funnelRight = position;
+    Vector3 target;
+    bool found = false;
+    dtPolyRef current = ref;
+    for (unsigned i = 0; i < MAX_LOOKAHEAD_PORTALS && !found; ++i)
+    {
+        Vector3 left, right;
+        bool last = current == field->goalRef_;
+        if (last)
+            left = right = goal;
+        else
+        {
+            dtPolyRef next = field->GetNext(current);
+            if (!next || !GetPortal(field->navMesh_, current, next, left, right))
+                return false;
+            ShrinkPortal(left, right, radius);
+            current = next;
+        }
+
+        // Narrow the funnel, or stop at the corner it collapses on
+        if (TriArea2D(position, funnelRight, right) <= 0.0f)
+        {
+            if (EqualXZ(position, funnelRight) || TriArea2D(position, funnelLeft, right) > 0.0f)
+                funnelRight = right;
+            else
+            {
+                target = funnelLeft;
+                found = true;
+            }
+        }
+        if (!found && TriArea2D(position, funnelLeft, left) >= 0.0f)
+        {
+            if (EqualXZ(position, funnelLeft) || TriArea2D(position, funnelRight, left) < 0.0f)
+                funnelLeft = left;
+            else
+            {
+                target = funnelRight;
+                found = true;
+            }
+        }
+
+        if (!found && last)
+        {
+            target = goal;
+            found = true;
+        }
+    }
+
+    // Head between the funnel sides if it did not close within the lookahead
+    if (!found || EqualXZ(position, target))
+        target = (funnelLeft + funnelRight) * 0.5f;
+
+    direction = Vector3(target.x_ - position.x_, 0.0f, target.z_ - position.z_);
+    if (direction.LengthSquared() < M_EPSILON * M_EPSILON)
+        return false;
+    direction.Normalize();
+    return true;
+}
+
+CrowdFlowField::CrowdFlowField(Context* context) :
+    Component(context),
+    maxFields_(DEFAULT_MAX_FIELDS),
+    updateCount_(0)
+{
+}
+
+CrowdFlowField::~CrowdFlowField() = default;
+
+void CrowdFlowField::RegisterObject(Context* context)
+{
+    context->RegisterFactory<CrowdFlowField>(NAVIGATION_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Max Fields", GetMaxFields, SetMaxFields, unsigned, DEFAULT_MAX_FIELDS, AM_DEFAULT);
+}
+
+void CrowdFlowField::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
+{
+    if (!debug)
+        return;
+
+    for (unsigned i = 0; i < fields_.Size(); ++i)
+    {
+        const CrowdFlowFieldGoal* field = fields_[i];
+        if (!field->numAgents_ || !field->navMesh_)
+            continue;
+
+        // Draw a line from each polygon center to its portal towards the goal
+        Color color(Color::CYAN.Lerp(Color::MAGENTA, (float)i / Max(fields_.Size() - 1, 1U)));
+        for (unsigned j = 0; j < field->tiles_.Size(); ++j)
+        {
+            const dtMeshTile* tile = field->navMesh_->getTile(j);
+            const CrowdFlowFieldTile& cells = field->tiles_[j];
+            if (!tile->header || tile->salt != cells.salt_)
+                continue;
+
+            dtPolyRef base = field->navMesh_->getPolyRefBase(tile);
+            for (unsigned k = 0; k < cells.next_.Size(); ++k)
+            {
+                Vector3 left, right;
+                if (cells.next_[k] && GetPortal(field->navMesh_, base | (dtPolyRef)k, cells.next_[k], left, right))
+                    debug->AddLine(GetPolyCenter(tile, &tile->polys[k]), (left + right) * 0.5f, color, depthTest);
+            }
+        }
+
+        debug->AddSphere(Sphere(field->goal_, 0.5f), color, depthTest);
+    }
+}
+
+void CrowdFlowField::DrawDebugGeometry(bool depthTest)
+{
+    Scene* scene = GetScene();
+    if (scene)
+    {
+        auto* debug = scene->GetComponent<DebugRenderer>();
+        if (debug)
+            DrawDebugGeometry(debug, depthTest);
+    }
+}
+
+void CrowdFlowField::SetFlowTarget(const Vector3& position, Node* node)
+{
+    if (!crowdManager_)
+    {
+        URHO3D_LOGERROR("CrowdFlowField requires a CrowdManager in the scene");
+        return;
+    }
+
+    PODVector<CrowdAgent*> agents = crowdManager_->GetAgents(node, false);
+    for (unsigned i = 0; i < agents.Size(); ++i)
+        SetAgentFlowTarget(agents[i], position);
+}
+
+void CrowdFlowField::SetAgentFlowTarget(CrowdAgent* agent, const Vector3& position)
+{
+    if (!agent || !crowdManager_)
+        return;
+
+    CrowdFlowFieldGoal* field = GetField(position, agent->GetQueryFilterType());
+    if (!field)
+    {
+        // Not on the navigation mesh, let the crowd report the failure
+        agent->SetTargetPosition(position);
+        return;
+    }
+
+    CrowdFlowFieldAgent& entry = agents_[agent];
+    if (entry.field_)
+        --entry.field_->numAgents_;
+    entry.agent_ = agent;
+    entry.field_ = field;
+    entry.goal_ = position;
+    entry.steering_ = false;
+    ++field->numAgents_;
+}
+
+void CrowdFlowField::ResetFlowTarget(Node* node)
+{
+    if (!crowdManager_)
+        return;
+
+    PODVector<CrowdAgent*> agents = crowdManager_->GetAgents(node, false);
+    for (unsigned i = 0; i < agents.Size(); ++i)
+    {
+        HashMap<CrowdAgent*, CrowdFlowFieldAgent>::Iterator j = agents_.Find(agents[i]);
+        if (j != agents_.End())
+        {
+            --j->second_.field_->numAgents_;
+            agents_.Erase(j);
+            agents[i]->ResetTarget();
+        }
+    }
+}
+
+void CrowdFlowField::SetMaxFields(unsigned maxFields)
+{
+    maxFields_ = maxFields;
+    PruneFields();
+    MarkNetworkUpdate();
+}
+
+void CrowdFlowField::ClearFields()
+{
+    for (unsigned i = fields_.Size() - 1; i < fields_.Size(); --i)
+    {
+        if (!fields_[i]->numAgents_)
+            fields_.Erase(i);
+    }
+}
+
+Vector3 CrowdFlowField::GetFlowDirection(const Vector3& goal, const Vector3& position, unsigned queryFilterType)
+{
+    CrowdFlowFieldGoal* field = GetField(goal, queryFilterType);
+    if (!field || !UpdateField(field))
+        return Vector3::ZERO;
+
+    dtPolyRef ref;
+    Vector3 nearest = crowdManager_->FindNearestPoint(position, queryFilterType, &ref);
+    Vector3 direction;
+    return GetFieldDirection(field, ref, nearest, field->goal_, 0.0f, direction) ? direction : Vector3::ZERO;
+}
+
+float CrowdFlowField::GetFlowDistance(const Vector3& goal, const Vector3& position, unsigned queryFilterType)
+{
+    CrowdFlowFieldGoal* field = GetField(goal, queryFilterType);
+    if (!field || !UpdateField(field))
+        return M_INFINITY;
+
+    dtPolyRef ref;
+    Vector3 nearest = crowdManager_->FindNearestPoint(position, queryFilterType, &ref);
+    if (ref == field->goalRef_)
+        return (field->goal_ - nearest).Length();
+    return field->GetDistance(ref);
+}
+
+void CrowdFlowField::OnSceneSet(Scene* scene)
+{
+    if (scene)
+    {
+        if (scene != node_)
+        {
+            URHO3D_LOGERROR("CrowdFlowField is a scene component and should only be attached to the scene node");
+            return;
+        }
+
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(CrowdFlowField, HandleSceneUpdate));
+        SubscribeToEvent(E_NAVIGATION_MESH_REBUILT, URHO3D_HANDLER(CrowdFlowField, HandleNavigationMeshRebuilt));
+        crowdManager_ = scene->GetComponent<CrowdManager>();
+    }
+    else
+    {
+        UnsubscribeFromEvent(E_SCENEUPDATE);
+        UnsubscribeFromEvent(E_NAVIGATION_MESH_REBUILT);
+        crowdManager_.Reset();
+    }
+}
+
+CrowdFlowFieldGoal* CrowdFlowField::GetField(const Vector3& goal, unsigned queryFilterType)
+{
+    if (!crowdManager_ && GetScene())
+        crowdManager_ = GetScene()->GetComponent<CrowdManager>();
+    if (!crowdManager_ || !crowdManager_->GetCrowd())
+        return nullptr;
+
+    dtPolyRef goalRef;
+    Vector3 nearest = crowdManager_->FindNearestPoint(goal, queryFilterType, &goalRef);
+    if (!goalRef)
+        return nullptr;
+
+    // The distances do not depend on the position within the goal polygon, so share the field
+    for (unsigned i = 0; i < fields_.Size(); ++i)
+    {
+        CrowdFlowFieldGoal* field = fields_[i];
+        if (field->goalRef_ == goalRef && field->queryFilterType_ == queryFilterType)
+        {
+            field->lastUsed_ = updateCount_;
+            return field;
+        }
+    }
+
+    SharedPtr<CrowdFlowFieldGoal> field(new CrowdFlowFieldGoal());
+    field->goalRef_ = goalRef;
+    field->goal_ = nearest;
+    field->queryFilterType_ = queryFilterType;
+    field->lastUsed_ = updateCount_;
+    fields_.Push(field);
+    PruneFields();
+    return field;
+}
+
+bool CrowdFlowField::UpdateField(CrowdFlowFieldGoal* field)
+{
+    dtCrowd* crowd = crowdManager_ ? crowdManager_->GetCrowd() : nullptr;
+    const dtNavMesh* navMesh = crowd ? crowd->getNavMeshQuery()->getAttachedNavMesh() : nullptr;
+    const dtQueryFilter* filter = crowdManager_ ? crowdManager_->GetDetourQueryFilter(field->queryFilterType_) : nullptr;
+    if (!navMesh || !filter)
+        return false;
+
+    field->lastUsed_ = updateCount_;
+
+    bool full = false;
+    if (navMesh != field->navMesh_)
+    {
+        field->navMesh_ = navMesh;
+        field->tiles_.Clear();
+        full = true;
+    }
+    field->tiles_.Resize((unsigned)navMesh->getMaxTiles());
+
+    // Find the tiles replaced since the previous update. Their polygon references are no longer valid
+    bool changed = false;
+    for (unsigned i = 0; i < field->tiles_.Size(); ++i)
+    {
+        const dtMeshTile* tile = navMesh->getTile(i);
+        unsigned salt = tile->header ? tile->salt : M_MAX_UNSIGNED;
+        CrowdFlowFieldTile& cells = field->tiles_[i];
+        if (cells.salt_ == salt)
+            continue;
+
+        unsigned numPolys = tile->header ? (unsigned)tile->header->polyCount : 0;
+        cells.salt_ = salt;
+        cells.distances_.Resize(numPolys);
+        cells.next_.Resize(numPolys);
+        for (unsigned j = 0; j < numPolys; ++j)
+        {
+            cells.distances_[j] = M_INFINITY;
+            cells.next_[j] = 0;
+        }
+        changed = true;
+    }
+    if (!changed)
+        return field->goalRef_ != 0;
+
+    URHO3D_PROFILE(UpdateFlowField);
+
+    // Find the goal again if its tile was replaced, and recompute everything
+    if (!navMesh->isValidPolyRef(field->goalRef_))
+    {
+        crowdManager_->FindNearestPoint(field->goal_, field->queryFilterType_, &field->goalRef_);
+        full = true;
+    }
+
+    // Open list as a binary min-heap of path distance and polygon
+    PODVector<Pair<float, dtPolyRef> > open;
+
+    auto pushOpen = [&open](float distance, dtPolyRef ref)
+    {
+        open.Push(MakePair(distance, ref));
+        unsigned i = open.Size() - 1;
+        while (i > 0 && open[(i - 1) / 2].first_ > open[i].first_)
+        {
+            Swap(open[(i - 1) / 2], open[i]);
+            i = (i - 1) / 2;
+        }
+    };
+
+    auto popOpen = [&open]()
+    {
+        Pair<float, dtPolyRef> top = open.Front();
+        open.Front() = open.Back();
+        open.Pop();
+        unsigned i = 0;
+        for (;;)
+        {
+            unsigned smallest = i;
+            unsigned left = i * 2 + 1;
+            unsigned right = left + 1;
+            if (left < open.Size() && open[left].first_ < open[smallest].first_)
+                smallest = left;
+            if (right < open.Size() && open[right].first_ < open[smallest].first_)
+                smallest = right;
+            if (smallest == i)
+                break;
+            Swap(open[i], open[smallest]);
+            i = smallest;
+        }
+        return top;
+    };
+
+    unsigned goalTile, goalPoly;
+    if (full)
+    {
+        for (unsigned i = 0; i < field->tiles_.Size(); ++i)
+        {
+            CrowdFlowFieldTile& cells = field->tiles_[i];
+            for (unsigned j = 0; j < cells.distances_.Size(); ++j)
+            {
+                cells.distances_[j] = M_INFINITY;
+                cells.next_[j] = 0;
+            }
+        }
+
+        if (!field->goalRef_ || !field->Decode(field->goalRef_, goalTile, goalPoly))
+            return false;
+        field->tiles_[goalTile].distances_[goalPoly] = 0.0f;
+        pushOpen(0.0f, field->goalRef_);
+    }
+    else
+    {
+        field->Decode(field->goalRef_, goalTile, goalPoly);
+
+        // Invalidate the polygons whose route to the goal passes through a replaced tile
+        Vector<PODVector<unsigned char> > states(field->tiles_.Size());
+        for (unsigned i = 0; i < field->tiles_.Size(); ++i)
+        {
+            states[i].Resize(field->tiles_[i].distances_.Size());
+            for (unsigned j = 0; j < states[i].Size(); ++j)
+                states[i][j] = 0;
+        }
+        states[goalTile][goalPoly] = 1;
+
+        PODVector<Pair<unsigned, unsigned> > chain;
+        for (unsigned i = 0; i < field->tiles_.Size(); ++i)
+        {
+            CrowdFlowFieldTile& cells = field->tiles_[i];
+            for (unsigned j = 0; j < cells.distances_.Size(); ++j)
+            {
+                if (states[i][j] || cells.distances_[j] == M_INFINITY)
+                    continue;
+
+                // Follow the route until a polygon with known state, marking the polygons on the way as visited
+                unsigned char state = 2;
+                unsigned it = i;
+                unsigned ip = j;
+                chain.Clear();
+                for (;;)
+                {
+                    if (states[it][ip])
+                    {
+                        state = states[it][ip] == 3 ? (unsigned char)2 : states[it][ip];
+                        break;
+                    }
+                    chain.Push(MakePair(it, ip));
+                    states[it][ip] = 3;
+                    dtPolyRef next = field->tiles_[it].next_[ip];
+                    if (!next || !field->Decode(next, it, ip) || field->tiles_[it].distances_[ip] == M_INFINITY)
+                        break;
+                }
+
+                for (unsigned k = 0; k < chain.Size(); ++k)
+                {
+                    states[chain[k].first_][chain[k].second_] = state;
+                    if (state == 2)
+                    {
+                        field->tiles_[chain[k].first_].distances_[chain[k].second_] = M_INFINITY;
+                        field->tiles_[chain[k].first_].next_[chain[k].second_] = 0;
+                    }
+                }
+            }
+        }
+
+        // Seed the unreached polygons from their reached neighbours
+        for (unsigned i = 0; i < field->tiles_.Size(); ++i)
+        {
+            const dtMeshTile* tile = navMesh->getTile(i);
+            CrowdFlowFieldTile& cells = field->tiles_[i];
+            if (cells.distances_.Empty())
+                continue;
+
+            dtPolyRef base = navMesh->getPolyRefBase(tile);
+            for (unsigned j = 0; j < cells.distances_.Size(); ++j)
+            {
+                const dtPoly* poly = &tile->polys[j];
+                if (cells.distances_[j] != M_INFINITY || !IsPassable(filter, poly))
+                    continue;
+
+                Vector3 center = GetPolyCenter(tile, poly);
+                float cost = filter->getAreaCost(poly->getArea());
+                for (unsigned k = poly->firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+                {
+                    dtPolyRef neighbourRef = tile->links[k].ref;
+                    unsigned nt, np;
+                    if (!neighbourRef || !field->Decode(neighbourRef, nt, np) || field->tiles_[nt].distances_[np] == M_INFINITY)
+                        continue;
+
+                    const dtMeshTile* neighbourTile;
+                    const dtPoly* neighbourPoly;
+                    navMesh->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);
+                    float distance = field->tiles_[nt].distances_[np] + (GetPolyCenter(neighbourTile, neighbourPoly) - center).Length() * cost;
+                    if (distance < cells.distances_[j])
+                    {
+                        cells.distances_[j] = distance;
+                        cells.next_[j] = neighbourRef;
+                    }
+                }
+
+                if (cells.distances_[j] != M_INFINITY)
+                    pushOpen(cells.distances_[j], base | (dtPolyRef)j);
+            }
+        }
+    }
+
+    // Expand outward from the goal. Reached polygons may still get shorter routes through the replaced tiles
+    while (!open.Empty())
+    {
+        Pair<float, dtPolyRef> current = popOpen();
+        unsigned it, ip;
+        field->Decode(current.second_, it, ip);
+        // Skip outdated heap entries
+        if (current.first_ > field->tiles_[it].distances_[ip])
+            continue;
+
+        const dtMeshTile* tile;
+        const dtPoly* poly;
+        navMesh->getTileAndPolyByRefUnsafe(current.second_, &tile, &poly);
+        Vector3 center = GetPolyCenter(tile, poly);
+
+        for (unsigned i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+        {
+            dtPolyRef neighbourRef = tile->links[i].ref;
+            unsigned nt, np;
+            if (!neighbourRef || !field->Decode(neighbourRef, nt, np))
+                continue;
+
+            const dtMeshTile* neighbourTile;
+            const dtPoly* neighbourPoly;
+            navMesh->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);
+            if (!IsPassable(filter, neighbourPoly))
+                continue;
+
+            float distance = current.first_ + (GetPolyCenter(neighbourTile, neighbourPoly) - center).Length() *
+                filter->getAreaCost(neighbourPoly->getArea());
+            if (distance < field->tiles_[nt].distances_[np])
+            {
+                field->tiles_[nt].distances_[np] = distance;
+                field->tiles_[nt].next_[np] = current.second_;
+                pushOpen(distance, neighbourRef);
+            }
+        }
+    }
+
+    return true;
+}
+
+void CrowdFlowField::UpdateAgents()
+{
+    for (HashMap<CrowdAgent*, CrowdFlowFieldAgent>::Iterator i = agents_.Begin(); i != agents_.End();)
+    {
+        CrowdFlowFieldAgent& entry = i->second_;
+        CrowdAgent* agent = entry.agent_;
+
+        // Discard agents that were destroyed or given another target since the previous update
+        if (!agent || (entry.steering_ && (agent->GetRequestedTargetType() != CA_REQUESTEDTARGET_VELOCITY ||
+            agent->GetTargetVelocity() != entry.velocity_)))
+        {
+            --entry.field_->numAgents_;
+            i = agents_.Erase(i);
+            continue;
+        }
+
+        // Wait while not in the crowd or crossing an off-mesh connection
+        const dtCrowdAgent* ag = agent->GetDetourCrowdAgent();
+        if (!ag || ag->state != DT_CROWDAGENT_STATE_WALKING)
+        {
+            ++i;
+            continue;
+        }
+
+        // Hand over to the crowd's own path following next to the goal polygon, or when the goal is not reachable
+        Vector3 direction;
+        dtPolyRef ref = ag->corridor.getFirstPoly();
+        Vector3 position(ag->npos);
+        CrowdFlowFieldGoal* field = entry.field_;
+        if (!field->navMesh_ || ref == field->goalRef_ || field->GetNext(ref) == field->goalRef_ ||
+            !GetFieldDirection(field, ref, position, field->goal_, agent->GetRadius(), direction))
+        {
+            --field->numAgents_;
+            agent->SetTargetPosition(entry.goal_);
+            i = agents_.Erase(i);
+            continue;
+        }
+
+        entry.velocity_ = direction * agent->GetMaxSpeed();
+        entry.steering_ = true;
+        agent->SetTargetVelocity(entry.velocity_);
+        ++i;
+    }
+}
+
+void CrowdFlowField::PruneFields()
+{
+    while (fields_.Size() > maxFields_)
+    {
+        unsigned oldest = M_MAX_UNSIGNED;
+        for (unsigned i = 0; i < fields_.Size(); ++i)
+        {
+            if (!fields_[i]->numAgents_ && (oldest == M_MAX_UNSIGNED || fields_[i]->lastUsed_ < fields_[oldest]->lastUsed_))
+                oldest = i;
+        }
+        if (oldest == M_MAX_UNSIGNED)
+            break;
+        fields_.Erase(oldest);
+    }
+}
+
+void CrowdFlowField::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    ++updateCount_;
+
+    if (agents_.Empty() || !IsEnabledEffective())
+        return;
+
+    URHO3D_PROFILE(UpdateCrowdFlowField);
+
+    // Bring the fields with agents up to date with the navigation mesh, then steer the agents
+    for (unsigned i = 0; i < fields_.Size(); ++i)
+    {
+        if (fields_[i]->numAgents_ && !UpdateField(fields_[i]))
+            fields_[i]->navMesh_ = nullptr;
+    }
+
+    UpdateAgents();
+}
+
+void CrowdFlowField::HandleNavigationMeshRebuilt(StringHash eventType, VariantMap& eventData)
+{
+    using namespace NavigationMeshRebuilt;
+
+    // The rebuilt navigation mesh may reuse the memory and tile salts of the previous one, so recompute the fields
+    if (crowdManager_ && eventData[P_MESH].GetPtr() == crowdManager_->GetNavigationMesh())
+    {
+        for (unsigned i = 0; i < fields_.Size(); ++i)
+        {
+            fields_[i]->navMesh_ = nullptr;
+            fields_[i]->tiles_.Clear();
+        }
+    }
+}
+
+}
@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Scene/Component.h"
+
+namespace Urho3D
+{
+
+class CrowdAgent;
+class CrowdManager;
+struct CrowdFlowFieldGoal;
+
+/// Crowd agent steered by a flow field.
+struct CrowdFlowFieldAgent
+{
+    /// Agent.
+    WeakPtr<CrowdAgent> agent_;
+    /// Flow field followed.
+    SharedPtr<CrowdFlowFieldGoal> field_;
+    /// Goal position.
+    Vector3 goal_;
+    /// Velocity requested on the previous update, to detect the agent being given another target.
+    Vector3 velocity_;
+    /// Velocity requested flag.
+    bool steering_;
+};
+
+/// Flow field navigation scene component. Computes one integration field over the navigation mesh polygons for each goal and steers the crowd agents heading there by lookup, instead of planning a corridor for each agent. Should be added only to the root scene node, next to the CrowdManager.
+class URHO3D_API CrowdFlowField : public Component
+{
+    URHO3D_OBJECT(CrowdFlowField, Component);
+
+public:
+    /// Construct.
+    explicit CrowdFlowField(Context* context);
+    /// Destruct.
+    ~CrowdFlowField() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Draw the flow fields in use.
+    void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) override;
+    /// Add debug geometry to the debug renderer.
+    void DrawDebugGeometry(bool depthTest);
+
+    /// Steer all crowd agents found in the specified node to the goal with a shared flow field. Defaulted to scene node.
+    void SetFlowTarget(const Vector3& position, Node* node = nullptr);
+    /// Steer a crowd agent to the goal with a shared flow field.
+    void SetAgentFlowTarget(CrowdAgent* agent, const Vector3& position);
+    /// Stop steering all crowd agents found in the specified node and reset their target. Defaulted to scene node.
+    void ResetFlowTarget(Node* node = nullptr);
+    /// Set the maximum number of flow fields kept. Fields without agents are discarded beyond this, least recently used first.
+    void SetMaxFields(unsigned maxFields);
+    /// Discard all flow fields without agents.
+    void ClearFields();
+
+    /// Return the direction to move from a position to reach the goal, or zero if not reachable. Uses the query filter type's flow field, which is computed if it does not exist.
+    Vector3 GetFlowDirection(const Vector3& goal, const Vector3& position, unsigned queryFilterType = 0);
+    /// Return the path distance from a position to the goal along the flow field, or infinity if not reachable.
+    float GetFlowDistance(const Vector3& goal, const Vector3& position, unsigned queryFilterType = 0);
+
+    /// Return the maximum number of flow fields kept.
+    unsigned GetMaxFields() const { return maxFields_; }
+
+    /// Return the number of flow fields.
+    unsigned GetNumFields() const { return fields_.Size(); }
+
+    /// Return the number of agents steered by the flow fields.
+    unsigned GetNumAgents() const { return agents_.Size(); }
+
+    /// Return whether the agent is steered by a flow field.
+    bool IsFlowAgent(CrowdAgent* agent) const { return agents_.Contains(agent); }
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Return the flow field to a goal, creating it if necessary. Return null if the goal is not on the navigation mesh.
+    CrowdFlowFieldGoal* GetField(const Vector3& goal, unsigned queryFilterType);
+    /// Bring a flow field up to date with the navigation mesh tiles. Return false if the goal is not on the navigation mesh.
+    bool UpdateField(CrowdFlowFieldGoal* field);
+    /// Steer the agents and discard the agents that have reached their goal polygon or were given another target.
+    void UpdateAgents();
+    /// Discard the least recently used fields without agents beyond the maximum.
+    void PruneFields();
+    /// Handle the scene update event, which is sent before the crowd is updated.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the navigation mesh being rebuilt.
+    void HandleNavigationMeshRebuilt(StringHash eventType, VariantMap& eventData);
+
+    /// Crowd manager of the scene.
+    WeakPtr<CrowdManager> crowdManager_;
+    /// Flow fields.
+    Vector<SharedPtr<CrowdFlowFieldGoal> > fields_;
+    /// Steered agents.
+    HashMap<CrowdAgent*, CrowdFlowFieldAgent> agents_;
+    /// Maximum number of flow fields kept.
+    unsigned maxFields_;
+    /// Update counter for discarding the least recently used fields.
+    unsigned updateCount_;
+};
+
+}
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../Navigation/CrowdAgent.h"
@@ -45,6 +46,8 @@ extern const char* NAVIGATION_CATEGORY;
 
 static const unsigned DEFAULT_MAX_AGENTS = 512;
 static const float DEFAULT_MAX_AGENT_RADIUS = 0.f;
+/// Minimum number of agents worth updating in a separate work item.
+static const int MIN_AGENTS_PER_WORK_ITEM = 32;
 
 static const StringVector filterTypesStructureElementNames =
 {
@@ -74,6 +77,53 @@ void CrowdAgentUpdateCallback(dtCrowdAgent* ag, float dt)
     static_cast<CrowdAgent*>(ag->params.userData)->OnCrowdUpdate(ag, dt);
 }
 
+/// Range of crowd agents updated in one work item.
+struct CrowdUpdateRange
+{
+    /// Detour update task.
+    dtParallelTask task_;
+    /// Detour update task data.
+    void* taskData_;
+    /// First agent.
+    int first_;
+    /// Last agent, exclusive.
+    int last_;
+};
+
+void CrowdUpdateWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* range = reinterpret_cast<CrowdUpdateRange*>(item->start_);
+    range->task_(range->first_, range->last_, threadIndex, range->taskData_);
+}
+
+void CrowdParallelFor(dtParallelTask task, void* taskData, const int count, void* userData)
+{
+    auto* queue = static_cast<WorkQueue*>(userData);
+    int numItems = Min((int)queue->GetNumThreads() + 1, count / MIN_AGENTS_PER_WORK_ITEM);
+    if (numItems <= 1)
+    {
+        task(0, count, 0, taskData);
+        return;
+    }
+
+    PODVector<CrowdUpdateRange> ranges(numItems);
+    for (int i = 0; i < numItems; ++i)
+    {
+        CrowdUpdateRange& range = ranges[i];
+        range.task_ = task;
+        range.taskData_ = taskData;
+        range.first_ = count * i / numItems;
+        range.last_ = count * (i + 1) / numItems;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CrowdUpdateWork;
+        item->start_ = &range;
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 CrowdManager::CrowdManager(Context* context) :
     Component(context),
     maxAgents_(DEFAULT_MAX_AGENTS),
@@ -98,6 +148,7 @@ void CrowdManager::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Max Agents", unsigned, maxAgents_, DEFAULT_MAX_AGENTS, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Max Agent Radius", float, maxAgentRadius_, DEFAULT_MAX_AGENT_RADIUS, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Navigation Mesh", unsigned, navigationMeshId_, 0, AM_DEFAULT | AM_COMPONENTID);
+    URHO3D_ATTRIBUTE("Threaded Update", bool, threadedUpdate_, true, AM_DEFAULT);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Filter Types", GetQueryFilterTypesAttr, SetQueryFilterTypesAttr,
         VariantVector, Variant::emptyVariantVector, AM_DEFAULT)
         .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, filterTypesStructureElementNames);
@@ -253,6 +304,15 @@ void CrowdManager::SetMaxAgentRadius(float maxAgentRadius)
     }
 }
 
+void CrowdManager::SetThreadedUpdate(bool enable)
+{
+    if (enable != threadedUpdate_)
+    {
+        threadedUpdate_ = enable;
+        MarkNetworkUpdate();
+    }
+}
+
 void CrowdManager::SetNavigationMesh(NavigationMesh* navMesh)
 {
     UnsubscribeFromEvent(E_COMPONENTADDED);
@@ -679,6 +739,19 @@ void CrowdManager::Update(float delta)
 {
     assert(crowd_ && navigationMesh_);
     URHO3D_PROFILE(UpdateCrowd);
+
+    // Use one Detour worker per thread, the main thread included. The thread count may change after the crowd was created
+    auto* queue = GetSubsystem<WorkQueue>();
+    int maxWorkers = threadedUpdate_ && queue ? queue->GetNumThreads() + 1 : 1;
+    if (crowd_->getMaxWorkers() != maxWorkers)
+    {
+        if (!crowd_->setParallelFor(maxWorkers > 1 ? CrowdParallelFor : nullptr, queue, maxWorkers))
+        {
+            URHO3D_LOGERROR("Could not allocate threaded crowd update queries, falling back to serial update");
+            threadedUpdate_ = false;
+        }
+    }
+
     crowd_->update(delta, nullptr);
 }
 
@@ -61,6 +61,7 @@ class URHO3D_API CrowdManager : public Component
     URHO3D_OBJECT(CrowdManager, Component);
 
     friend class CrowdAgent;
+    friend class CrowdFlowField;
 
 public:
     /// Construct.
@@ -87,6 +88,8 @@ public:
     void SetMaxAgents(unsigned maxAgents);
     /// Set the maximum radius of any agent.
     void SetMaxAgentRadius(float maxAgentRadius);
+    /// Set whether to run the per agent phases of the crowd update on the work queue threads. Default true.
+    void SetThreadedUpdate(bool enable);
     /// Assigns the navigation mesh for the crowd.
     void SetNavigationMesh(NavigationMesh* navMesh);
     /// Set all the query filter types configured in the crowd based on the corresponding attribute.
@@ -125,6 +128,9 @@ public:
     /// Get the maximum radius of any agent.
     float GetMaxAgentRadius() const { return maxAgentRadius_; }
 
+    /// Return whether the per agent phases of the crowd update run on the work queue threads.
+    bool GetThreadedUpdate() const { return threadedUpdate_; }
+
     /// Get the Navigation mesh assigned to the crowd.
     NavigationMesh* GetNavigationMesh() const { return navigationMesh_; }
 
@@ -195,6 +201,8 @@ private:
     PODVector<unsigned> numAreas_;
     /// Number of obstacle avoidance types configured in the crowd. Limit to DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS.
     unsigned numObstacleAvoidanceTypes_{};
+    /// Threaded update flag.
+    bool threadedUpdate_{true};
 };
 
 }
@@ -538,6 +538,23 @@ bool DynamicNavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     return true;
 }
 
+bool DynamicNavigationMesh::BuildAsync(const IntVector2& from, const IntVector2& to)
+{
+    // The compressed tile cache layers are built synchronously, obstacles already update the tiles incrementally
+    if (!Build(from, to))
+        return false;
+
+    using namespace NavigationAsyncBuildFinished;
+    VariantMap& eventData = GetContext()->GetEventDataMap();
+    eventData[P_NODE] = GetNode();
+    eventData[P_MESH] = this;
+    eventData[P_BOUNDSMIN] = GetTileBoudningBox(from).min_;
+    eventData[P_BOUNDSMAX] = GetTileBoudningBox(to).max_;
+    eventData[P_SUCCESS] = true;
+    SendEvent(E_NAVIGATION_ASYNC_BUILD_FINISHED, eventData);
+    return true;
+}
+
 PODVector<unsigned char> DynamicNavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -62,6 +62,9 @@ public:
     bool Build(const BoundingBox& boundingBox) override;
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     bool Build(const IntVector2& from, const IntVector2& to) override;
+    /// Rebuild part of the navigation mesh in the rectangular area. The tile cache is rebuilt immediately and E_NAVIGATION_ASYNC_BUILD_FINISHED is sent before returning. Return true if successful.
+    bool BuildAsync(const IntVector2& from, const IntVector2& to) override;
+    using NavigationMesh::BuildAsync;
     /// Return tile data.
     PODVector<unsigned char> GetTileData(const IntVector2& tile) const override;
     /// Return whether the Obstacle is touching the given tile.
@@ -43,6 +43,25 @@ URHO3D_EVENT(E_NAVIGATION_AREA_REBUILT, NavigationAreaRebuilt)
     URHO3D_PARAM(P_BOUNDSMAX, BoundsMax); // Vector3
 }
 
+/// Background navigation mesh build has finished and its tiles have been swapped in.
+URHO3D_EVENT(E_NAVIGATION_ASYNC_BUILD_FINISHED, NavigationAsyncBuildFinished)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_BOUNDSMIN, BoundsMin); // Vector3
+    URHO3D_PARAM(P_BOUNDSMAX, BoundsMax); // Vector3
+    URHO3D_PARAM(P_SUCCESS, Success); // bool
+}
+
+/// Background path query has finished.
+URHO3D_EVENT(E_NAVIGATION_PATH_QUERY_FINISHED, NavigationPathQueryFinished)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_REQUEST, Request); // NavigationPathRequest pointer
+    URHO3D_PARAM(P_SUCCESS, Success); // bool
+}
+
 /// Mesh tile is added to navigation mesh.
 URHO3D_EVENT(E_NAVIGATION_TILE_ADDED, NavigationTileAdded)
 {
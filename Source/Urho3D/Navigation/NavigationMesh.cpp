@@ -23,7 +23,11 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -34,12 +38,14 @@
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../Navigation/CrowdAgent.h"
+#include "../Navigation/CrowdFlowField.h"
 #include "../Navigation/DynamicNavigationMesh.h"
 #include "../Navigation/NavArea.h"
 #include "../Navigation/NavBuildData.h"
 #include "../Navigation/Navigable.h"
 #include "../Navigation/NavigationEvents.h"
 #include "../Navigation/NavigationMesh.h"
+#include "../Navigation/NavigationPortalGraph.h"
 #include "../Navigation/Obstacle.h"
 #include "../Navigation/OffMeshConnection.h"
 #ifdef URHO3D_PHYSICS
@@ -82,6 +88,8 @@ static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
 
 static const int MAX_POLYS = 2048;
+static const unsigned DEFAULT_PATH_CACHE_SIZE = 256;
+static const long long DEFAULT_PATH_QUERY_TIME_BUDGET = 2000;
 
 
 /// Temporary data for finding a path.
@@ -97,12 +105,391 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// Background path query state of one thread.
+struct NavigationPathSlot
+{
+    /// Detour query, also holding the state of the sliced search.
+    dtNavMeshQuery* query_{};
+    /// Request being searched, carried over to the next frame if the search does not finish.
+    SharedPtr<NavigationPathRequest> current_;
+    /// Local-space start point of the current request.
+    Vector3 localStart_;
+    /// Local-space end point of the current request.
+    Vector3 localEnd_;
+    /// Start polygon of the current request.
+    dtPolyRef startRef_{};
+    /// End polygon of the current request.
+    dtPolyRef endRef_{};
+    /// Requests finished during this frame.
+    Vector<SharedPtr<NavigationPathRequest> > finished_;
+    /// Corridors found during this frame, to be added to the cache.
+    Vector<Pair<Pair<dtPolyRef, dtPolyRef>, PODVector<dtPolyRef> > > corridors_;
+    /// Temporary data for finding the path.
+    FindPathData pathData_;
+};
+
+/// Background path queries of a navigation mesh.
+struct NavigationPathQueue
+{
+    /// Requests not yet started.
+    Vector<SharedPtr<NavigationPathRequest> > pending_;
+    /// Index of the next request to start during the current frame.
+    unsigned nextPending_{};
+    /// Mutex for taking the pending requests.
+    Mutex mutex_;
+    /// Per-thread state.
+    Vector<NavigationPathSlot> slots_;
+    /// Cached polygon corridors by start and end polygon.
+    HashMap<Pair<dtPolyRef, dtPolyRef>, PODVector<dtPolyRef> > corridors_;
+    /// Maximum number of cached corridors.
+    unsigned cacheSize_{DEFAULT_PATH_CACHE_SIZE};
+    /// Time budget per frame in microseconds.
+    long long timeBudget_{DEFAULT_PATH_QUERY_TIME_BUDGET};
+    /// Time since the start of the current frame's processing.
+    HiresTimer timer_;
+    /// Navigation mesh world transform.
+    Matrix3x4 transform_;
+    /// Inverse of the navigation mesh world transform.
+    Matrix3x4 inverse_;
+    /// Query filter.
+    const dtQueryFilter* filter_{};
+    /// Subscribed to post-update flag.
+    bool subscribed_{};
+};
+
+/// Convert the found polygon corridor of a background path query to path points and finish the query.
+static void FinishNavigationPathQuery(NavigationPathQueue& queue, NavigationPathSlot& slot, int numPolys)
+{
+    NavigationPathRequest* request = slot.current_;
+    FindPathData& data = slot.pathData_;
+
+    if (numPolys)
+    {
+        Vector3 actualLocalEnd = slot.localEnd_;
+
+        // If full path was not found, clamp end point to the end polygon
+        if (data.polys_[numPolys - 1] != slot.endRef_)
+            slot.query_->closestPointOnPoly(data.polys_[numPolys - 1], &slot.localEnd_.x_, &actualLocalEnd.x_, nullptr);
+
+        int numPathPoints = 0;
+        slot.query_->findStraightPath(&slot.localStart_.x_, &actualLocalEnd.x_, data.polys_, numPolys, &data.pathPoints_[0].x_,
+            data.pathFlags_, data.pathPolys_, &numPathPoints, MAX_POLYS);
+
+        // The points are transformed to world space on the main thread
+        request->path_.Resize((unsigned)numPathPoints);
+        for (int i = 0; i < numPathPoints; ++i)
+        {
+            request->path_[i].position_ = data.pathPoints_[i];
+            request->path_[i].flag_ = (NavigationPathPointFlag)data.pathFlags_[i];
+            request->path_[i].areaID_ = 0;
+        }
+    }
+
+    request->state_ = request->path_.Size() ? PATH_REQUEST_SUCCEEDED : PATH_REQUEST_FAILED;
+    slot.finished_.Push(slot.current_);
+    slot.current_.Reset();
+}
+
+/// Start a background path query. Reuse a cached corridor if possible, otherwise begin a sliced search.
+static void StartNavigationPathQuery(NavigationPathQueue& queue, NavigationPathSlot& slot)
+{
+    NavigationPathRequest* request = slot.current_;
+    dtNavMeshQuery* query = slot.query_;
+
+    slot.localStart_ = queue.inverse_ * request->start_;
+    slot.localEnd_ = queue.inverse_ * request->end_;
+    slot.startRef_ = 0;
+    slot.endRef_ = 0;
+    query->findNearestPoly(&slot.localStart_.x_, &request->extents_.x_, queue.filter_, &slot.startRef_, nullptr);
+    query->findNearestPoly(&slot.localEnd_.x_, &request->extents_.x_, queue.filter_, &slot.endRef_, nullptr);
+
+    if (!slot.startRef_ || !slot.endRef_)
+    {
+        FinishNavigationPathQuery(queue, slot, 0);
+        return;
+    }
+
+    // The cache is only modified by the main thread while no queries are running. A corridor through rebuilt tiles is stale
+    HashMap<Pair<dtPolyRef, dtPolyRef>, PODVector<dtPolyRef> >::ConstIterator i =
+        queue.corridors_.Find(MakePair(slot.startRef_, slot.endRef_));
+    if (i != queue.corridors_.End())
+    {
+        const PODVector<dtPolyRef>& corridor = i->second_;
+        const dtNavMesh* navMesh = query->getAttachedNavMesh();
+        bool valid = true;
+        for (unsigned j = 0; j < corridor.Size() && valid; ++j)
+            valid = navMesh->isValidPolyRef(corridor[j]);
+
+        if (valid)
+        {
+            for (unsigned j = 0; j < corridor.Size(); ++j)
+                slot.pathData_.polys_[j] = corridor[j];
+            FinishNavigationPathQuery(queue, slot, corridor.Size());
+            return;
+        }
+    }
+
+    query->initSlicedFindPath(slot.startRef_, slot.endRef_, &slot.localStart_.x_, &slot.localEnd_.x_, queue.filter_);
+}
+
+static void ProcessNavigationPathQueries(const WorkItem* item, unsigned threadIndex)
+{
+    static const int SLICE_ITERATIONS = 32;
+
+    auto* queue = reinterpret_cast<NavigationPathQueue*>(item->aux_);
+    auto* slot = reinterpret_cast<NavigationPathSlot*>(item->start_);
+
+    while (queue->timer_.GetUSec(false) < queue->timeBudget_)
+    {
+        if (slot->current_ && slot->current_->state_ == PATH_REQUEST_CANCELLED)
+            slot->current_.Reset();
+
+        if (!slot->current_)
+        {
+            {
+                MutexLock lock(queue->mutex_);
+                while (queue->nextPending_ < queue->pending_.Size() && queue->pending_[queue->nextPending_]->IsFinished())
+                    ++queue->nextPending_;
+                if (queue->nextPending_ >= queue->pending_.Size())
+                    break;
+                slot->current_ = queue->pending_[queue->nextPending_++];
+            }
+
+            StartNavigationPathQuery(*queue, *slot);
+            continue;
+        }
+
+        int iterations = 0;
+        dtStatus status = slot->query_->updateSlicedFindPath(SLICE_ITERATIONS, &iterations);
+        if (dtStatusInProgress(status))
+            continue;
+
+        int numPolys = 0;
+        if (dtStatusSucceed(status))
+            slot->query_->finalizeSlicedFindPath(slot->pathData_.polys_, &numPolys, MAX_POLYS);
+
+        // Cache only complete corridors
+        if (numPolys && slot->pathData_.polys_[numPolys - 1] == slot->endRef_ && !dtStatusDetail(status, DT_PARTIAL_RESULT))
+        {
+            slot->corridors_.Push(MakePair(MakePair(slot->startRef_, slot->endRef_),
+                PODVector<dtPolyRef>(slot->pathData_.polys_, (unsigned)numPolys)));
+        }
+
+        FinishNavigationPathQuery(*queue, *slot, numPolys);
+    }
+}
+
+/// Spatially coherent part of the cached triangles of a geometry component.
+struct NavigationGeometryChunk
+{
+    /// Bounding box relative to the navigation mesh root node.
+    BoundingBox boundingBox_;
+    /// Vertices relative to the navigation mesh root node.
+    PODVector<Vector3> vertices_;
+    /// Triangle indices.
+    PODVector<int> indices_;
+};
+
+/// Cached triangles of a collision shape or drawable.
+struct NavigationGeometryCache : public RefCounted
+{
+    /// Component the triangles were extracted from.
+    WeakPtr<Component> component_;
+    /// Transform relative to the navigation mesh root node at extraction.
+    Matrix3x4 transform_;
+    /// Collision shape type, or -1 for a drawable.
+    int shapeType_{};
+    /// Source geometry data at extraction.
+    PODVector<const void*> sources_;
+    /// Triangle chunks.
+    Vector<NavigationGeometryChunk> chunks_;
+};
+
+/// Return the source data of a collision shape or drawable, used to detect changes of the cached triangles. Return false for other components.
+static bool GetGeometrySources(const NavigationGeometryInfo& info, PODVector<const void*>& sources, int& shapeType)
+{
+    sources.Clear();
+
+#ifdef URHO3D_PHYSICS
+    auto* shape = dynamic_cast<CollisionShape*>(info.component_);
+    if (shape)
+    {
+        // The shape's size is included in the transform
+        shapeType = shape->GetShapeType();
+        if (shapeType == SHAPE_TRIANGLEMESH && shape->GetModel())
+        {
+            Model* model = shape->GetModel();
+            for (unsigned i = 0; i < model->GetNumGeometries(); ++i)
+                sources.Push(model->GetGeometry(i, shape->GetLodLevel()));
+        }
+        else if (shapeType == SHAPE_CONVEXHULL)
+            sources.Push(shape->GetGeometryData());
+        return true;
+    }
+#endif
+    auto* drawable = dynamic_cast<Drawable*>(info.component_);
+    if (drawable)
+    {
+        shapeType = -1;
+        const Vector<SourceBatch>& batches = drawable->GetBatches();
+        for (unsigned i = 0; i < batches.Size(); ++i)
+            sources.Push(drawable->GetLodGeometry(i, info.lodLevel_));
+        return true;
+    }
+
+    return false;
+}
+
+/// Split triangles into chunks on a grid in the XZ plane.
+static void BuildGeometryChunks(Vector<NavigationGeometryChunk>& chunks, const PODVector<Vector3>& vertices, const PODVector<int>& indices,
+    float chunkSize)
+{
+    static const int MAX_CHUNKS_PER_AXIS = 32;
+
+    unsigned numTriangles = indices.Size() / 3;
+    if (!numTriangles)
+        return;
+
+    BoundingBox bounds;
+    for (unsigned i = 0; i < vertices.Size(); ++i)
+        bounds.Merge(vertices[i]);
+    Vector3 size = bounds.Size();
+    int numX = Clamp(CeilToInt(size.x_ / chunkSize), 1, MAX_CHUNKS_PER_AXIS);
+    int numZ = Clamp(CeilToInt(size.z_ / chunkSize), 1, MAX_CHUNKS_PER_AXIS);
+
+    // Sort the triangles by the chunk containing their centroid
+    PODVector<unsigned> triangleChunks(numTriangles);
+    PODVector<unsigned> chunkStarts((unsigned)(numX * numZ + 1), 0);
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        Vector3 centroid = (vertices[indices[i * 3]] + vertices[indices[i * 3 + 1]] + vertices[indices[i * 3 + 2]]) / 3.0f;
+        int x = size.x_ > 0.0f ? Clamp((int)((centroid.x_ - bounds.min_.x_) / size.x_ * numX), 0, numX - 1) : 0;
+        int z = size.z_ > 0.0f ? Clamp((int)((centroid.z_ - bounds.min_.z_) / size.z_ * numZ), 0, numZ - 1) : 0;
+        triangleChunks[i] = (unsigned)(z * numX + x);
+        ++chunkStarts[triangleChunks[i] + 1];
+    }
+    for (unsigned i = 1; i < chunkStarts.Size(); ++i)
+        chunkStarts[i] += chunkStarts[i - 1];
+    PODVector<unsigned> sortedTriangles(numTriangles);
+    PODVector<unsigned> chunkEnds(chunkStarts);
+    for (unsigned i = 0; i < numTriangles; ++i)
+        sortedTriangles[chunkEnds[triangleChunks[i]]++] = i;
+
+    // Copy the vertices used by each chunk, remapping the indices
+    PODVector<int> remap(vertices.Size(), -1);
+    for (unsigned i = 0; i + 1 < chunkStarts.Size(); ++i)
+    {
+        if (chunkStarts[i] == chunkStarts[i + 1])
+            continue;
+
+        chunks.Resize(chunks.Size() + 1);
+        NavigationGeometryChunk& chunk = chunks.Back();
+        for (unsigned j = chunkStarts[i]; j < chunkStarts[i + 1]; ++j)
+        {
+            for (unsigned k = 0; k < 3; ++k)
+            {
+                int index = indices[sortedTriangles[j] * 3 + k];
+                if (remap[index] < 0)
+                {
+                    remap[index] = chunk.vertices_.Size();
+                    chunk.vertices_.Push(vertices[index]);
+                    chunk.boundingBox_.Merge(vertices[index]);
+                }
+                chunk.indices_.Push(remap[index]);
+            }
+        }
+
+        for (unsigned j = chunkStarts[i]; j < chunkStarts[i + 1]; ++j)
+        {
+            for (unsigned k = 0; k < 3; ++k)
+                remap[indices[sortedTriangles[j] * 3 + k]] = -1;
+        }
+    }
+}
+
+/// Navigation mesh tile built in a worker thread.
+struct NavigationTileBuildJob
+{
+    /// Navigation mesh.
+    NavigationMesh* navMesh_;
+    /// Geometry to build from.
+    Vector<NavigationGeometryInfo>* geometryList_;
+    /// Tile X coordinate.
+    int x_;
+    /// Tile Z coordinate.
+    int z_;
+    /// Built Detour data, null if the tile is empty.
+    unsigned char* navData_;
+    /// Built Detour data size.
+    int navDataSize_;
+    /// Success flag.
+    bool success_;
+    /// Phase timing.
+    NavigationBuildStats stats_;
+};
+
+void BuildNavigationTileWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* job = reinterpret_cast<NavigationTileBuildJob*>(item->start_);
+    job->success_ = job->navMesh_->BuildTileData(*job->geometryList_, job->x_, job->z_, job->navData_, job->navDataSize_,
+        job->stats_);
+}
+
+/// Navigation mesh tile built in the background.
+struct NavigationAsyncTile : public RefCounted
+{
+    /// Destruct. Free the Detour data if it was not swapped in.
+    ~NavigationAsyncTile() override
+    {
+        dtFree(navData_);
+    }
+
+    /// Snapshot of the tile's input geometry.
+    SimpleNavBuildData build_;
+    /// Tile X coordinate.
+    int x_{};
+    /// Tile Z coordinate.
+    int z_{};
+    /// Built Detour data, null if the tile is empty.
+    unsigned char* navData_{};
+    /// Built Detour data size.
+    int navDataSize_{};
+    /// Success flag.
+    bool success_{};
+    /// Phase timing.
+    NavigationBuildStats stats_;
+    /// Work item.
+    SharedPtr<WorkItem> item_;
+};
+
+/// Background navigation mesh build, swapped in as a whole.
+struct NavigationAsyncBuild : public RefCounted
+{
+    /// First tile.
+    IntVector2 from_;
+    /// Last tile.
+    IntVector2 to_;
+    /// Tiles.
+    Vector<SharedPtr<NavigationAsyncTile> > tiles_;
+    /// Time since the build was started.
+    HiresTimer timer_;
+};
+
+void BuildNavigationTileAsyncWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* navMesh = reinterpret_cast<NavigationMesh*>(item->aux_);
+    auto* tile = reinterpret_cast<NavigationAsyncTile*>(item->start_);
+    tile->success_ = navMesh->BuildTileData(tile->build_, tile->x_, tile->z_, tile->navData_, tile->navDataSize_, tile->stats_);
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(nullptr),
     navMeshQuery_(nullptr),
     queryFilter_(new dtQueryFilter()),
     pathData_(new FindPathData()),
+    pathQueries_(new NavigationPathQueue()),
+    portalGraph_(new NavigationPortalGraph()),
     tileSize_(DEFAULT_TILE_SIZE),
     cellSize_(DEFAULT_CELL_SIZE),
     cellHeight_(DEFAULT_CELL_HEIGHT),
@@ -119,6 +506,7 @@ NavigationMesh::NavigationMesh(Context* context) :
     padding_(Vector3::ONE),
     numTilesX_(0),
     numTilesZ_(0),
+    prebuiltTile_(nullptr),
     partitionType_(NAVMESH_PARTITION_WATERSHED),
     keepInterResults_(false),
     drawOffMeshConnections_(false),
@@ -521,6 +909,113 @@ bool NavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     return true;
 }
 
+bool NavigationMesh::BuildAsync(const BoundingBox& boundingBox)
+{
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
+
+    float tileEdgeLength = (float)tileSize_ * cellSize_;
+
+    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+
+    return BuildAsync(IntVector2(sx, sz), IntVector2(ex, ez));
+}
+
+bool NavigationMesh::BuildAsync(const IntVector2& from, const IntVector2& to)
+{
+    URHO3D_PROFILE(BuildNavigationMeshAsync);
+
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    if (!node_->GetWorldScale().Equals(Vector3::ONE))
+        URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
+    {
+        URHO3D_LOGERROR("Work queue is required for background navigation mesh build");
+        return false;
+    }
+
+    IntVector2 start(Clamp(from.x_, 0, numTilesX_ - 1), Clamp(from.y_, 0, numTilesZ_ - 1));
+    IntVector2 end(Clamp(to.x_, 0, numTilesX_ - 1), Clamp(to.y_, 0, numTilesZ_ - 1));
+
+    Vector<NavigationGeometryInfo> geometryList;
+    CollectGeometries(geometryList);
+
+    SharedPtr<NavigationAsyncBuild> build(new NavigationAsyncBuild());
+    build->from_ = start;
+    build->to_ = end;
+
+    for (int z = start.y_; z <= end.y_; ++z)
+    {
+        for (int x = start.x_; x <= end.x_; ++x)
+        {
+            SharedPtr<NavigationAsyncTile> tile(new NavigationAsyncTile());
+            tile->x_ = x;
+            tile->z_ = z;
+            // Snapshot the geometry now, as the scene may change while the tile is being built
+            GetTileGeometry(&tile->build_, geometryList, x, z);
+
+            tile->item_ = new WorkItem();
+            tile->item_->priority_ = 0;
+            tile->item_->workFunction_ = BuildNavigationTileAsyncWork;
+            tile->item_->start_ = tile.Get();
+            tile->item_->aux_ = this;
+            queue->AddWorkItem(tile->item_);
+            build->tiles_.Push(tile);
+        }
+    }
+
+    if (asyncBuilds_.Empty())
+        SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(NavigationMesh, HandleUpdateAsyncBuilds));
+    asyncBuilds_.Push(build);
+    return true;
+}
+
+void NavigationMesh::CancelAsyncBuilds()
+{
+    if (asyncBuilds_.Empty())
+        return;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i < asyncBuilds_.Size(); ++i)
+    {
+        const Vector<SharedPtr<NavigationAsyncTile> >& tiles = asyncBuilds_[i]->tiles_;
+        for (unsigned j = 0; j < tiles.Size(); ++j)
+        {
+            WorkItem* item = tiles[j]->item_;
+            // A tile already taken by a worker thread refers to this object, so wait for it to finish
+            if (queue && !queue->RemoveWorkItem(tiles[j]->item_))
+            {
+                while (!item->completed_)
+                    Time::Sleep(0);
+            }
+        }
+    }
+
+    asyncBuilds_.Clear();
+    UnsubscribeFromEvent(E_UPDATE);
+}
+
 PODVector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -575,6 +1070,7 @@ void NavigationMesh::RemoveTile(const IntVector2& tile)
         return;
 
     navMesh_->removeTile(tileRef, nullptr, nullptr);
+    ClearPathCache();
 
     // Send event
     using namespace NavigationTileRemoved;
@@ -595,6 +1091,7 @@ void NavigationMesh::RemoveAllTiles()
         if (tile->header)
             navMesh_->removeTile(navMesh_->getTileRef(tile), nullptr, nullptr);
     }
+    ClearPathCache();
 
     // Send event
     using namespace NavigationAllTilesRemoved;
@@ -709,32 +1206,350 @@ void NavigationMesh::FindPath(PODVector<NavigationPathPoint>& dest, const Vector
         NavigationPathPoint pt;
         pt.position_ = transform * pathData_->pathPoints_[i];
         pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
+        pt.areaID_ = GetPathPointAreaID(pt.position_);
+
+        dest.Push(pt);
+    }
+}
+
+void NavigationMesh::FindPathHierarchical(PODVector<Vector3>& dest, const Vector3& start, const Vector3& end, const Vector3& extents,
+    unsigned maxRefinedPortals)
+{
+    PODVector<NavigationPathPoint> navPathPoints;
+    FindPathHierarchical(navPathPoints, start, end, extents, maxRefinedPortals);
+
+    dest.Clear();
+    for (unsigned i = 0; i < navPathPoints.Size(); ++i)
+        dest.Push(navPathPoints[i].position_);
+}
+
+void NavigationMesh::FindPathHierarchical(PODVector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end,
+    const Vector3& extents, unsigned maxRefinedPortals)
+{
+    URHO3D_PROFILE(FindPathHierarchical);
+    dest.Clear();
+
+    if (!InitializeQuery())
+        return;
+
+    // Paths to the same or a neighbouring tile do not benefit from the graph
+    IntVector2 startTile = GetTileIndex(start);
+    IntVector2 endTile = GetTileIndex(end);
+    if (Abs(startTile.x_ - endTile.x_) <= 1 && Abs(startTile.y_ - endTile.y_) <= 1)
+    {
+        FindPath(dest, start, end, extents);
+        return;
+    }
+
+    UpdatePortalGraph();
+
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+    Vector3 localStart = inverse * start;
+    Vector3 localEnd = inverse * end;
+
+    dtPolyRef startRef;
+    dtPolyRef endRef;
+    navMeshQuery_->findNearestPoly(&localStart.x_, &extents.x_, queryFilter_.Get(), &startRef, &localStart.x_);
+    navMeshQuery_->findNearestPoly(&localEnd.x_, &extents.x_, queryFilter_.Get(), &endRef, &localEnd.x_);
+    if (!startRef || !endRef)
+        return;
+
+    PODVector<Vector3> route;
+    if (!portalGraph_->FindRoute(route, navMeshQuery_, queryFilter_.Get(), startRef, localStart, startTile.x_, startTile.y_, endRef,
+        localEnd, endTile.x_, endTile.y_))
+    {
+        // Not connected through the portals, fall back to a single search which finds the closest reachable point
+        FindPath(dest, start, end, extents);
+        return;
+    }
+
+    // Refine the segments between consecutive portals
+    const Matrix3x4& transform = node_->GetWorldTransform();
+    PODVector<NavigationPathPoint> segment;
+    Vector3 segmentStart = start;
+    for (unsigned i = 0; i <= route.Size(); ++i)
+    {
+        Vector3 segmentEnd = i < route.Size() ? transform * route[i] : end;
+
+        if (i <= maxRefinedPortals)
+        {
+            FindPath(segment, segmentStart, segmentEnd, extents);
+            if (segment.Empty())
+            {
+                dest.Clear();
+                return;
+            }
+
+            // Join with the previous segment, whose last point is this segment's start
+            unsigned first = 0;
+            if (!dest.Empty())
+            {
+                dest.Back().flag_ = (NavigationPathPointFlag)(dest.Back().flag_ & ~NAVPATHFLAG_END);
+                first = 1;
+            }
+            for (unsigned j = first; j < segment.Size(); ++j)
+                dest.Push(segment[j]);
+            segmentStart = segment.Back().position_;
+        }
+        else
+        {
+            NavigationPathPoint pt;
+            pt.position_ = segmentEnd;
+            pt.flag_ = i < route.Size() ? NAVPATHFLAG_COARSE : (NavigationPathPointFlag)(NAVPATHFLAG_COARSE | NAVPATHFLAG_END);
+            pt.areaID_ = GetPathPointAreaID(pt.position_);
+            dest.Back().flag_ = (NavigationPathPointFlag)(dest.Back().flag_ & ~NAVPATHFLAG_END);
+            dest.Push(pt);
+        }
+    }
+}
+
+void NavigationMesh::UpdatePortalGraph()
+{
+    if (!navMesh_ || !InitializeQuery())
+        return;
+
+    URHO3D_PROFILE(UpdatePortalGraph);
+
+    IntVector2 numTiles = GetNumTiles();
+    if (numTiles != IntVector2(portalGraph_->GetNumTilesX(), portalGraph_->GetNumTilesZ()))
+        portalGraph_->Reset(numTiles.x_, numTiles.y_);
+
+    unsigned numChanged = portalGraph_->Update(navMesh_, navMeshQuery_, queryFilter_.Get(), cellSize_ * 2.0f, agentMaxClimb_);
+    if (numChanged)
+    {
+        URHO3D_LOGDEBUG("Updated " + String(numChanged) + " tiles of the navigation mesh portal graph, " +
+            String(portalGraph_->GetNumNodes()) + " portals");
+    }
+}
+
+unsigned NavigationMesh::GetNumPortals() const
+{
+    return portalGraph_->GetNumNodes();
+}
+
+SharedPtr<NavigationPathRequest> NavigationMesh::FindPathAsync(const Vector3& start, const Vector3& end, const Vector3& extents,
+    bool sendEvent)
+{
+    SharedPtr<NavigationPathRequest> request(new NavigationPathRequest());
+    request->start_ = start;
+    request->end_ = end;
+    request->extents_ = extents;
+    request->sendEvent_ = sendEvent;
+
+    if (!navMesh_)
+    {
+        request->state_ = PATH_REQUEST_FAILED;
+        return request;
+    }
+
+    if (!pathQueries_->subscribed_)
+    {
+        SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(NavigationMesh, HandlePostUpdatePathQueries));
+        pathQueries_->subscribed_ = true;
+    }
+    pathQueries_->pending_.Push(request);
+    return request;
+}
+
+void NavigationMesh::CancelPathQueries()
+{
+    NavigationPathQueue& queue = *pathQueries_;
+
+    for (unsigned i = 0; i < queue.pending_.Size(); ++i)
+        queue.pending_[i]->Cancel();
+    queue.pending_.Clear();
+
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        NavigationPathSlot& slot = queue.slots_[i];
+        if (slot.current_)
+        {
+            slot.current_->Cancel();
+            slot.current_.Reset();
+        }
+        dtFreeNavMeshQuery(slot.query_);
+    }
+    queue.slots_.Clear();
+    queue.corridors_.Clear();
+
+    if (queue.subscribed_)
+    {
+        UnsubscribeFromEvent(E_POSTUPDATE);
+        queue.subscribed_ = false;
+    }
+}
+
+void NavigationMesh::SetPathQueryTimeBudget(float milliseconds)
+{
+    pathQueries_->timeBudget_ = (long long)(Max(milliseconds, 0.0f) * 1000.0f);
+}
+
+void NavigationMesh::SetPathCacheSize(unsigned size)
+{
+    NavigationPathQueue& queue = *pathQueries_;
+    queue.cacheSize_ = size;
+    while (queue.corridors_.Size() > size)
+        queue.corridors_.Erase(queue.corridors_.Begin());
+}
+
+float NavigationMesh::GetPathQueryTimeBudget() const
+{
+    return (float)pathQueries_->timeBudget_ / 1000.0f;
+}
+
+unsigned NavigationMesh::GetPathCacheSize() const
+{
+    return pathQueries_->cacheSize_;
+}
+
+unsigned NavigationMesh::GetNumPendingPathQueries() const
+{
+    unsigned num = pathQueries_->pending_.Size();
+    for (unsigned i = 0; i < pathQueries_->slots_.Size(); ++i)
+    {
+        if (pathQueries_->slots_[i].current_)
+            ++num;
+    }
+    return num;
+}
+
+void NavigationMesh::HandlePostUpdatePathQueries(StringHash eventType, VariantMap& eventData)
+{
+    NavigationPathQueue& queue = *pathQueries_;
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    if (!navMesh_ || !workQueue)
+    {
+        CancelPathQueries();
+        return;
+    }
+
+    URHO3D_PROFILE(ProcessPathQueries);
 
-        // Walk through all NavAreas and find nearest
-        unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
-        float nearestDistance = M_LARGE_VALUE;
-        for (unsigned j = 0; j < areas_.Size(); j++)
+    // One query per thread, including the main thread
+    if (queue.slots_.Empty())
+    {
+        queue.slots_.Resize(workQueue->GetNumThreads() + 1);
+        for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+        {
+            NavigationPathSlot& slot = queue.slots_[i];
+            slot.query_ = dtAllocNavMeshQuery();
+            if (!slot.query_ || dtStatusFailed(slot.query_->init(navMesh_, MAX_POLYS)))
+            {
+                URHO3D_LOGERROR("Could not init navigation mesh query for path queries");
+                CancelPathQueries();
+                return;
+            }
+        }
+    }
+
+    queue.transform_ = node_->GetWorldTransform();
+    queue.inverse_ = queue.transform_.Inverse();
+    queue.filter_ = queryFilter_.Get();
+    queue.nextPending_ = 0;
+    queue.timer_.Reset();
+
+    // Search until the time budget is used up. Queries that do not finish continue on the next frame
+    unsigned numItems = 0;
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        if (i >= queue.pending_.Size() && !queue.slots_[i].current_)
+            continue;
+
+        SharedPtr<WorkItem> item = workQueue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = ProcessNavigationPathQueries;
+        item->start_ = &queue.slots_[i];
+        item->aux_ = &queue;
+        workQueue->AddWorkItem(item);
+        ++numItems;
+    }
+    if (numItems)
+        workQueue->Complete(M_MAX_UNSIGNED);
+
+    queue.pending_.Erase(0, queue.nextPending_);
+
+    Vector<SharedPtr<NavigationPathRequest> > finishedRefs;
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        NavigationPathSlot& slot = queue.slots_[i];
+        finishedRefs.Push(slot.finished_);
+        slot.finished_.Clear();
+
+        if (queue.cacheSize_)
+        {
+            for (unsigned j = 0; j < slot.corridors_.Size(); ++j)
+            {
+                if (queue.corridors_.Size() >= queue.cacheSize_)
+                    queue.corridors_.Erase(queue.corridors_.Begin());
+                queue.corridors_[slot.corridors_[j].first_] = slot.corridors_[j].second_;
+            }
+        }
+        slot.corridors_.Clear();
+    }
+
+    if (queue.pending_.Empty() && !GetNumPendingPathQueries())
+    {
+        UnsubscribeFromEvent(E_POSTUPDATE);
+        queue.subscribed_ = false;
+    }
+
+    // Transform the paths to world space, then notify
+    for (unsigned i = 0; i < finishedRefs.Size(); ++i)
+    {
+        NavigationPathRequest* request = finishedRefs[i];
+        for (unsigned j = 0; j < request->path_.Size(); ++j)
+        {
+            NavigationPathPoint& pt = request->path_[j];
+            pt.position_ = queue.transform_ * pt.position_;
+            pt.areaID_ = GetPathPointAreaID(pt.position_);
+        }
+    }
+
+    for (unsigned i = 0; i < finishedRefs.Size(); ++i)
+    {
+        NavigationPathRequest* request = finishedRefs[i];
+        if (request->sendEvent_)
         {
-            NavArea* area = areas_[j].Get();
-            if (area && area->IsEnabledEffective())
+            using namespace NavigationPathQueryFinished;
+            VariantMap& finishedData = GetContext()->GetEventDataMap();
+            finishedData[P_NODE] = GetNode();
+            finishedData[P_MESH] = this;
+            finishedData[P_REQUEST] = request;
+            finishedData[P_SUCCESS] = request->state_ == PATH_REQUEST_SUCCEEDED;
+            SendEvent(E_NAVIGATION_PATH_QUERY_FINISHED, finishedData);
+        }
+    }
+}
+
+unsigned char NavigationMesh::GetPathPointAreaID(const Vector3& position) const
+{
+    // Walk through all NavAreas and find nearest
+    unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
+    float nearestDistance = M_LARGE_VALUE;
+    for (unsigned j = 0; j < areas_.Size(); j++)
+    {
+        NavArea* area = areas_[j].Get();
+        if (area && area->IsEnabledEffective())
+        {
+            BoundingBox bb = area->GetWorldBoundingBox();
+            if (bb.IsInside(position) == INSIDE)
             {
-                BoundingBox bb = area->GetWorldBoundingBox();
-                if (bb.IsInside(pt.position_) == INSIDE)
+                Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
+                float distance = (areaWorldCenter - position).LengthSquared();
+                if (distance < nearestDistance)
                 {
-                    Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
-                    float distance = (areaWorldCenter - pt.position_).LengthSquared();
-                    if (distance < nearestDistance)
-                    {
-                        nearestDistance = distance;
-                        nearestNavAreaID = area->GetAreaID();
-                    }
+                    nearestDistance = distance;
+                    nearestNavAreaID = area->GetAreaID();
                 }
             }
         }
-        pt.areaID_ = (unsigned char)nearestNavAreaID;
-
-        dest.Push(pt);
     }
+    return (unsigned char)nearestNavAreaID;
+}
+
+void NavigationMesh::ClearPathCache()
+{
+    pathQueries_->corridors_.Clear();
 }
 
 Vector3 NavigationMesh::GetRandomPoint(const dtQueryFilter* filter, dtPolyRef* randomRef)
@@ -862,6 +1677,7 @@ void NavigationMesh::SetAreaCost(unsigned areaID, float cost)
 {
     if (queryFilter_)
         queryFilter_->setAreaCost((int)areaID, cost);
+    ClearPathCache();
 }
 
 BoundingBox NavigationMesh::GetWorldBoundingBox() const
@@ -1002,6 +1818,8 @@ void NavigationMesh::CollectGeometries(Vector<NavigationGeometryInfo>& geometryL
             areas_.Push(WeakPtr<NavArea>(area));
         }
     }
+
+    UpdateGeometryCache(geometryList);
 }
 
 void NavigationMesh::CollectGeometries(Vector<NavigationGeometryInfo>& geometryList, Node* node, HashSet<Node*>& processedNodes,
@@ -1082,6 +1900,59 @@ void NavigationMesh::CollectGeometries(Vector<NavigationGeometryInfo>& geometryL
     }
 }
 
+void NavigationMesh::UpdateGeometryCache(Vector<NavigationGeometryInfo>& geometryList)
+{
+    URHO3D_PROFILE(UpdateNavigationGeometryCache);
+
+    HashMap<Component*, SharedPtr<NavigationGeometryCache> > geometryCache;
+    SimpleNavBuildData build;
+    PODVector<const void*> sources;
+    int shapeType;
+    unsigned numExtracted = 0;
+
+    for (unsigned i = 0; i < geometryList.Size(); ++i)
+    {
+        NavigationGeometryInfo& info = geometryList[i];
+        if (!GetGeometrySources(info, sources, shapeType))
+            continue;
+
+        // Reuse the cached triangles if the geometry has not been moved or changed since they were extracted
+        SharedPtr<NavigationGeometryCache> entry;
+        HashMap<Component*, SharedPtr<NavigationGeometryCache> >::Iterator j = geometryCache_.Find(info.component_);
+        if (j != geometryCache_.End() && j->second_->component_.Get() == info.component_ && j->second_->shapeType_ == shapeType &&
+            j->second_->sources_ == sources && j->second_->transform_.Equals(info.transform_))
+            entry = j->second_;
+        else
+        {
+            entry = new NavigationGeometryCache();
+            entry->component_ = info.component_;
+            entry->transform_ = info.transform_;
+            entry->shapeType_ = shapeType;
+            entry->sources_ = sources;
+
+            build.vertices_.Clear();
+            build.indices_.Clear();
+            AddGeometry(&build, info);
+            BuildGeometryChunks(entry->chunks_, build.vertices_, build.indices_, (float)tileSize_ * cellSize_);
+            ++numExtracted;
+        }
+
+        info.cache_ = entry;
+        geometryCache[info.component_] = entry;
+    }
+
+    // Entries of geometry that was not collected are dropped
+    geometryCache_.Swap(geometryCache);
+
+    if (numExtracted)
+        URHO3D_LOGDEBUG("Extracted navigation geometry from " + String(numExtracted) + " components");
+}
+
+void NavigationMesh::ClearGeometryCache()
+{
+    geometryCache_.Clear();
+}
+
 void NavigationMesh::GetTileGeometry(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, BoundingBox& box)
 {
     Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
@@ -1090,8 +1961,6 @@ void NavigationMesh::GetTileGeometry(NavBuildData* build, Vector<NavigationGeome
     {
         if (box.IsInsideFast(geometryList[i].boundingBox_) != OUTSIDE)
         {
-            const Matrix3x4& transform = geometryList[i].transform_;
-
             if (geometryList[i].component_->GetType() == OffMeshConnection::GetTypeStatic())
             {
                 auto* connection = static_cast<OffMeshConnection*>(geometryList[i].component_);
@@ -1116,81 +1985,106 @@ void NavigationMesh::GetTileGeometry(NavBuildData* build, Vector<NavigationGeome
                 continue;
             }
 
-#ifdef URHO3D_PHYSICS
-            auto* shape = dynamic_cast<CollisionShape*>(geometryList[i].component_);
-            if (shape)
+            // Use the cached triangles when available, limited to the chunks overlapping the box
+            if (geometryList[i].cache_)
             {
-                switch (shape->GetShapeType())
+                const Vector<NavigationGeometryChunk>& chunks = geometryList[i].cache_->chunks_;
+                for (unsigned j = 0; j < chunks.Size(); ++j)
                 {
-                case SHAPE_TRIANGLEMESH:
-                    {
-                        Model* model = shape->GetModel();
-                        if (!model)
-                            continue;
-
-                        unsigned lodLevel = shape->GetLodLevel();
-                        for (unsigned j = 0; j < model->GetNumGeometries(); ++j)
-                            AddTriMeshGeometry(build, model->GetGeometry(j, lodLevel), transform);
-                    }
-                    break;
+                    const NavigationGeometryChunk& chunk = chunks[j];
+                    if (box.IsInsideFast(chunk.boundingBox_) == OUTSIDE)
+                        continue;
+
+                    unsigned destVertexStart = build->vertices_.Size();
+                    build->vertices_.Push(chunk.vertices_);
+                    for (unsigned k = 0; k < chunk.indices_.Size(); ++k)
+                        build->indices_.Push(chunk.indices_[k] + destVertexStart);
+                }
+                continue;
+            }
 
-                case SHAPE_CONVEXHULL:
-                    {
-                        auto* data = static_cast<ConvexData*>(shape->GetGeometryData());
-                        if (!data)
-                            continue;
+            AddGeometry(build, geometryList[i]);
+        }
+    }
+}
 
-                        unsigned numVertices = data->vertexCount_;
-                        unsigned numIndices = data->indexCount_;
-                        unsigned destVertexStart = build->vertices_.Size();
+void NavigationMesh::AddGeometry(NavBuildData* build, const NavigationGeometryInfo& info)
+{
+    const Matrix3x4& transform = info.transform_;
 
-                        for (unsigned j = 0; j < numVertices; ++j)
-                            build->vertices_.Push(transform * data->vertexData_[j]);
+#ifdef URHO3D_PHYSICS
+    auto* shape = dynamic_cast<CollisionShape*>(info.component_);
+    if (shape)
+    {
+        switch (shape->GetShapeType())
+        {
+        case SHAPE_TRIANGLEMESH:
+            {
+                Model* model = shape->GetModel();
+                if (!model)
+                    return;
 
-                        for (unsigned j = 0; j < numIndices; ++j)
-                            build->indices_.Push(data->indexData_[j] + destVertexStart);
-                    }
-                    break;
+                unsigned lodLevel = shape->GetLodLevel();
+                for (unsigned j = 0; j < model->GetNumGeometries(); ++j)
+                    AddTriMeshGeometry(build, model->GetGeometry(j, lodLevel), transform);
+            }
+            break;
 
-                case SHAPE_BOX:
-                    {
-                        unsigned destVertexStart = build->vertices_.Size();
-
-                        build->vertices_.Push(transform * Vector3(-0.5f, 0.5f, -0.5f));
-                        build->vertices_.Push(transform * Vector3(0.5f, 0.5f, -0.5f));
-                        build->vertices_.Push(transform * Vector3(0.5f, -0.5f, -0.5f));
-                        build->vertices_.Push(transform * Vector3(-0.5f, -0.5f, -0.5f));
-                        build->vertices_.Push(transform * Vector3(-0.5f, 0.5f, 0.5f));
-                        build->vertices_.Push(transform * Vector3(0.5f, 0.5f, 0.5f));
-                        build->vertices_.Push(transform * Vector3(0.5f, -0.5f, 0.5f));
-                        build->vertices_.Push(transform * Vector3(-0.5f, -0.5f, 0.5f));
-
-                        const unsigned indices[] = {
-                            0, 1, 2, 0, 2, 3, 1, 5, 6, 1, 6, 2, 4, 5, 1, 4, 1, 0, 5, 4, 7, 5, 7, 6,
-                            4, 0, 3, 4, 3, 7, 1, 0, 4, 1, 4, 5
-                        };
-
-                        for (unsigned index : indices)
-                            build->indices_.Push(index + destVertexStart);
-                    }
-                    break;
+        case SHAPE_CONVEXHULL:
+            {
+                auto* data = static_cast<ConvexData*>(shape->GetGeometryData());
+                if (!data)
+                    return;
 
-                default:
-                    break;
-                }
+                unsigned numVertices = data->vertexCount_;
+                unsigned numIndices = data->indexCount_;
+                unsigned destVertexStart = build->vertices_.Size();
 
-                continue;
+                for (unsigned j = 0; j < numVertices; ++j)
+                    build->vertices_.Push(transform * data->vertexData_[j]);
+
+                for (unsigned j = 0; j < numIndices; ++j)
+                    build->indices_.Push(data->indexData_[j] + destVertexStart);
             }
-#endif
-            auto* drawable = dynamic_cast<Drawable*>(geometryList[i].component_);
-            if (drawable)
-            {
-                const Vector<SourceBatch>& batches = drawable->GetBatches();
+            break;
 
-                for (unsigned j = 0; j < batches.Size(); ++j)
-                    AddTriMeshGeometry(build, drawable->GetLodGeometry(j, geometryList[i].lodLevel_), transform);
+        case SHAPE_BOX:
+            {
+                unsigned destVertexStart = build->vertices_.Size();
+
+                build->vertices_.Push(transform * Vector3(-0.5f, 0.5f, -0.5f));
+                build->vertices_.Push(transform * Vector3(0.5f, 0.5f, -0.5f));
+                build->vertices_.Push(transform * Vector3(0.5f, -0.5f, -0.5f));
+                build->vertices_.Push(transform * Vector3(-0.5f, -0.5f, -0.5f));
+                build->vertices_.Push(transform * Vector3(-0.5f, 0.5f, 0.5f));
+                build->vertices_.Push(transform * Vector3(0.5f, 0.5f, 0.5f));
+                build->vertices_.Push(transform * Vector3(0.5f, -0.5f, 0.5f));
+                build->vertices_.Push(transform * Vector3(-0.5f, -0.5f, 0.5f));
+
+                const unsigned indices[] = {
+                    0, 1, 2, 0, 2, 3, 1, 5, 6, 1, 6, 2, 4, 5, 1, 4, 1, 0, 5, 4, 7, 5, 7, 6,
+                    4, 0, 3, 4, 3, 7, 1, 0, 4, 1, 4, 5
+                };
+
+                for (unsigned index : indices)
+                    build->indices_.Push(index + destVertexStart);
             }
+            break;
+
+        default:
+            break;
         }
+
+        return;
+    }
+#endif
+    auto* drawable = dynamic_cast<Drawable*>(info.component_);
+    if (drawable)
+    {
+        const Vector<SourceBatch>& batches = drawable->GetBatches();
+
+        for (unsigned j = 0; j < batches.Size(); ++j)
+            AddTriMeshGeometry(build, drawable->GetLodGeometry(j, info.lodLevel_), transform);
     }
 }
 
@@ -1285,6 +2179,7 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
         dtFree(navData);
         return false;
     }
+    ClearPathCache();
 
     // Send event
     if (!silent)
@@ -1299,16 +2194,94 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
     return true;
 }
 
-bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+void NavigationMesh::HandleUpdateAsyncBuilds(StringHash eventType, VariantMap& eventData)
 {
-    URHO3D_PROFILE(BuildNavigationMeshTile);
+    // Swap in the finished builds in the order they were started, each as a whole so that pathfinding never sees a
+    // partially rebuilt area
+    while (!asyncBuilds_.Empty())
+    {
+        SharedPtr<NavigationAsyncBuild> build = asyncBuilds_.Front();
+        for (unsigned i = 0; i < build->tiles_.Size(); ++i)
+        {
+            if (!build->tiles_[i]->item_->completed_)
+                return;
+        }
 
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+        URHO3D_PROFILE(SwapNavigationMeshTiles);
 
-    const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
+        asyncBuilds_.Erase(0);
+
+        buildStats_ = NavigationBuildStats();
+        HiresTimer addTimer;
+        bool success = true;
+        for (unsigned i = 0; i < build->tiles_.Size() && navMesh_; ++i)
+        {
+            NavigationAsyncTile* tile = build->tiles_[i];
+            buildStats_.geometryTime_ += tile->stats_.geometryTime_;
+            buildStats_.rasterizeTime_ += tile->stats_.rasterizeTime_;
+            buildStats_.regionsTime_ += tile->stats_.regionsTime_;
+            buildStats_.polyMeshTime_ += tile->stats_.polyMeshTime_;
+            buildStats_.detailMeshTime_ += tile->stats_.detailMeshTime_;
+            buildStats_.navDataTime_ += tile->stats_.navDataTime_;
+
+            // A failed tile is removed, like in a synchronous build
+            success = AddTileData(tile->x_, tile->z_, tile->navData_, tile->navDataSize_) && tile->success_ && success;
+            tile->navData_ = nullptr;
+            if (tile->success_)
+                ++buildStats_.numTiles_;
+        }
+        buildStats_.addTilesTime_ = addTimer.GetUSec(false);
+        buildStats_.totalTime_ = build->timer_.GetUSec(false);
+
+        URHO3D_LOGDEBUG("Rebuilt " + String(buildStats_.numTiles_) + " tiles of the navigation mesh in the background");
+
+        using namespace NavigationAsyncBuildFinished;
+        VariantMap& finishedData = GetContext()->GetEventDataMap();
+        finishedData[P_NODE] = GetNode();
+        finishedData[P_MESH] = this;
+        finishedData[P_BOUNDSMIN] = GetTileBoudningBox(build->from_).min_;
+        finishedData[P_BOUNDSMAX] = GetTileBoudningBox(build->to_).max_;
+        finishedData[P_SUCCESS] = success;
+        SendEvent(E_NAVIGATION_ASYNC_BUILD_FINISHED, finishedData);
+    }
+
+    UnsubscribeFromEvent(E_UPDATE);
+}
+
+void NavigationMesh::GetTileGeometry(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+{
+    // Include the geometry within the tile's border padding, see BuildTileData()
+    BoundingBox expandedBox = GetTileBoudningBox(IntVector2(x, z));
+    float border = (CeilToInt(agentRadius_ / cellSize_) + 3) * cellSize_;
+    expandedBox.min_.x_ -= border;
+    expandedBox.min_.z_ -= border;
+    expandedBox.max_.x_ += border;
+    expandedBox.max_.z_ += border;
+
+    GetTileGeometry(build, geometryList, expandedBox);
+}
 
+bool NavigationMesh::BuildTileData(Vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData,
+    int& navDataSize, NavigationBuildStats& stats)
+{
+    HiresTimer geometryTimer;
     SimpleNavBuildData build;
+    GetTileGeometry(&build, geometryList, x, z);
+    stats.geometryTime_ += geometryTimer.GetUSec(false);
+
+    return BuildTileData(build, x, z, navData, navDataSize, stats);
+}
+
+bool NavigationMesh::BuildTileData(SimpleNavBuildData& build, int x, int z, unsigned char*& navData, int& navDataSize,
+    NavigationBuildStats& stats)
+{
+    URHO3D_PROFILE(BuildNavigationMeshTile);
+
+    navData = nullptr;
+    navDataSize = 0;
+    HiresTimer phaseTimer;
+
+    const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
 
     rcConfig cfg;       // NOLINT(hicpp-member-init)
     memset(&cfg, 0, sizeof cfg);
@@ -1337,9 +2310,6 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     cfg.bmax[0] += cfg.borderSize * cfg.cs;
     cfg.bmax[2] += cfg.borderSize * cfg.cs;
 
-    BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
-
     if (build.vertices_.Empty() || build.indices_.Empty())
         return true; // Nothing to do
 
@@ -1369,6 +2339,7 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 
     rcFilterWalkableLowHeightSpans(build.ctx_, cfg.walkableHeight, *build.heightField_);
     rcFilterLedgeSpans(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_);
+    stats.rasterizeTime_ += phaseTimer.GetUSec(true);
 
     build.compactHeightField_ = rcAllocCompactHeightfield();
     if (!build.compactHeightField_)
@@ -1416,6 +2387,8 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         }
     }
 
+    stats.regionsTime_ += phaseTimer.GetUSec(true);
+
     build.contourSet_ = rcAllocContourSet();
     if (!build.contourSet_)
     {
@@ -1441,6 +2414,8 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         return false;
     }
 
+    stats.polyMeshTime_ += phaseTimer.GetUSec(true);
+
     build.polyMeshDetail_ = rcAllocPolyMeshDetail();
     if (!build.polyMeshDetail_)
     {
@@ -1454,6 +2429,8 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         return false;
     }
 
+    stats.detailMeshTime_ += phaseTimer.GetUSec(true);
+
     // Set polygon flags
     /// \todo Assignment of flags from navigation areas?
     for (int i = 0; i < build.polyMesh_->npolys; ++i)
@@ -1462,9 +2439,6 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;       // NOLINT(hicpp-member-init)
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1507,6 +2481,43 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         return false;
     }
 
+    stats.navDataTime_ += phaseTimer.GetUSec(true);
+    return true;
+}
+
+bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+{
+    unsigned char* navData = nullptr;
+    int navDataSize = 0;
+    bool success;
+
+    // Take the data already built by a worker thread, if any
+    if (prebuiltTile_ && prebuiltTile_->x_ == x && prebuiltTile_->z_ == z)
+    {
+        navData = prebuiltTile_->navData_;
+        navDataSize = prebuiltTile_->navDataSize_;
+        success = prebuiltTile_->success_;
+        prebuiltTile_->navData_ = nullptr;
+        prebuiltTile_ = nullptr;
+    }
+    else
+        success = BuildTileData(geometryList, x, z, navData, navDataSize, buildStats_);
+
+    HiresTimer addTimer;
+    success = AddTileData(x, z, navData, navDataSize) && success;
+    buildStats_.addTilesTime_ += addTimer.GetUSec(false);
+    return success;
+}
+
+bool NavigationMesh::AddTileData(int x, int z, unsigned char* navData, int navDataSize)
+{
+    // Remove previous tile (if any)
+    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    ClearPathCache();
+
+    if (!navData)
+        return true;
+
     if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
@@ -1516,6 +2527,8 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 
     // Send a notification of the rebuild of this tile to anyone interested
     {
+        const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -1529,16 +2542,98 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 
 unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
+    HiresTimer totalTimer;
+    buildStats_ = NavigationBuildStats();
     unsigned numTiles = 0;
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    auto* queue = GetSubsystem<WorkQueue>();
+    auto numJobs = (unsigned)((to.x_ - from.x_ + 1) * (to.y_ - from.y_ + 1));
+
+    if (!queue || !queue->GetNumThreads() || numJobs < 2)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        for (int z = from.y_; z <= to.y_; ++z)
+        {
+            for (int x = from.x_; x <= to.x_; ++x)
+            {
+                if (BuildTile(geometryList, x, z))
+                    ++numTiles;
+            }
+        }
+    }
+    else
+    {
+        URHO3D_PROFILE(BuildNavigationMeshTiles);
+
+        // Update the world transforms the tile geometry depends on now, so that the worker threads only read them
+        node_->GetWorldTransform();
+        for (unsigned i = 0; i < geometryList.Size(); ++i)
         {
-            if (BuildTile(geometryList, x, z))
+            Component* component = geometryList[i].component_;
+            if (component->GetType() == OffMeshConnection::GetTypeStatic())
+            {
+                auto* connection = static_cast<OffMeshConnection*>(component);
+                connection->GetNode()->GetWorldPosition();
+                connection->GetEndPoint()->GetWorldPosition();
+            }
+            else if (component->GetType() == NavArea::GetTypeStatic())
+                static_cast<NavArea*>(component)->GetWorldBoundingBox();
+        }
+
+        // Build the tile data in the worker threads, then add the tiles in order in the main thread. Adding goes through
+        // BuildTile(), which subclasses may override
+        PODVector<NavigationTileBuildJob> jobs(numJobs);
+        unsigned index = 0;
+        for (int z = from.y_; z <= to.y_; ++z)
+        {
+            for (int x = from.x_; x <= to.x_; ++x)
+            {
+                NavigationTileBuildJob& job = jobs[index++];
+                job.navMesh_ = this;
+                job.geometryList_ = &geometryList;
+                job.x_ = x;
+                job.z_ = z;
+                job.navData_ = nullptr;
+                job.navDataSize_ = 0;
+                job.success_ = false;
+                job.stats_ = NavigationBuildStats();
+
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = BuildNavigationTileWork;
+                item->start_ = &job;
+                queue->AddWorkItem(item);
+            }
+        }
+        queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < jobs.Size(); ++i)
+        {
+            NavigationTileBuildJob& job = jobs[i];
+            prebuiltTile_ = &job;
+            if (BuildTile(geometryList, job.x_, job.z_))
                 ++numTiles;
+            prebuiltTile_ = nullptr;
+            // Free the data if an overriding BuildTile() did not use it
+            dtFree(job.navData_);
+
+            buildStats_.geometryTime_ += job.stats_.geometryTime_;
+            buildStats_.rasterizeTime_ += job.stats_.rasterizeTime_;
+            buildStats_.regionsTime_ += job.stats_.regionsTime_;
+            buildStats_.polyMeshTime_ += job.stats_.polyMeshTime_;
+            buildStats_.detailMeshTime_ += job.stats_.detailMeshTime_;
+            buildStats_.navDataTime_ += job.stats_.navDataTime_;
         }
     }
+
+    buildStats_.numTiles_ = numTiles;
+    buildStats_.totalTime_ = totalTimer.GetUSec(false);
+
+    URHO3D_LOGDEBUGF("Built %u navigation mesh tiles in %f ms. Geometry %f ms, rasterize %f ms, regions %f ms, "
+        "polygon mesh %f ms, detail mesh %f ms, tile data %f ms (summed over threads), add tiles %f ms", numTiles,
+        buildStats_.totalTime_ / 1000.0f, buildStats_.geometryTime_ / 1000.0f, buildStats_.rasterizeTime_ / 1000.0f,
+        buildStats_.regionsTime_ / 1000.0f, buildStats_.polyMeshTime_ / 1000.0f, buildStats_.detailMeshTime_ / 1000.0f,
+        buildStats_.navDataTime_ / 1000.0f, buildStats_.addTilesTime_ / 1000.0f);
+
     return numTiles;
 }
 
@@ -1568,6 +2663,10 @@ bool NavigationMesh::InitializeQuery()
 
 void NavigationMesh::ReleaseNavigationMesh()
 {
+    CancelAsyncBuilds();
+    CancelPathQueries();
+    portalGraph_->Reset(0, 0);
+
     dtFreeNavMesh(navMesh_);
     navMesh_ = nullptr;
 
@@ -1592,6 +2691,7 @@ void RegisterNavigationLibrary(Context* context)
     OffMeshConnection::RegisterObject(context);
     CrowdAgent::RegisterObject(context);
     CrowdManager::RegisterObject(context);
+    CrowdFlowField::RegisterObject(context);
     DynamicNavigationMesh::RegisterObject(context);
     Obstacle::RegisterObject(context);
     NavArea::RegisterObject(context);
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/ArrayPtr.h"
+#include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Math/BoundingBox.h"
 #include "../Math/Matrix3x4.h"
@@ -52,6 +53,13 @@ class NavArea;
 
 struct FindPathData;
 struct NavBuildData;
+struct NavigationAsyncBuild;
+struct NavigationGeometryCache;
+struct NavigationPathQueue;
+class NavigationPortalGraph;
+struct NavigationTileBuildJob;
+struct SimpleNavBuildData;
+struct WorkItem;
 
 /// Description of a navigation mesh geometry component, with transform and bounds information.
 struct NavigationGeometryInfo
@@ -64,7 +72,31 @@ struct NavigationGeometryInfo
     Matrix3x4 transform_;
     /// Bounding box relative to the navigation mesh root node.
     BoundingBox boundingBox_;
+    /// Cached triangles relative to the navigation mesh root node, null if not cached.
+    NavigationGeometryCache* cache_{};
+};
 
+/// Navigation mesh build timing of the latest build. The tile phase times in microseconds are summed over all threads.
+struct NavigationBuildStats
+{
+    /// Number of built tiles.
+    unsigned numTiles_{};
+    /// Collecting the tile geometry.
+    long long geometryTime_{};
+    /// Rasterizing and filtering the heightfield.
+    long long rasterizeTime_{};
+    /// Building the compact heightfield and the regions.
+    long long regionsTime_{};
+    /// Building the contours and the polygon mesh.
+    long long polyMeshTime_{};
+    /// Building the detail mesh.
+    long long detailMeshTime_{};
+    /// Creating the Detour tile data.
+    long long navDataTime_{};
+    /// Adding the tiles to the navigation mesh on the main thread.
+    long long addTilesTime_{};
+    /// Total wall clock time.
+    long long totalTime_{};
 };
 
 /// A flag representing the type of path point- none, the start of a path segment, the end of one, or an off-mesh connection.
@@ -73,7 +105,8 @@ enum NavigationPathPointFlag
     NAVPATHFLAG_NONE = 0,
     NAVPATHFLAG_START = 0x01,
     NAVPATHFLAG_END = 0x02,
-    NAVPATHFLAG_OFF_MESH = 0x04
+    NAVPATHFLAG_OFF_MESH = 0x04,
+    NAVPATHFLAG_COARSE = 0x08
 };
 
 struct URHO3D_API NavigationPathPoint
@@ -86,6 +119,42 @@ struct URHO3D_API NavigationPathPoint
     unsigned char areaID_;
 };
 
+/// State of a background path query.
+enum NavigationPathRequestState
+{
+    PATH_REQUEST_PENDING = 0,
+    PATH_REQUEST_SUCCEEDED,
+    PATH_REQUEST_FAILED,
+    PATH_REQUEST_CANCELLED
+};
+
+/// Background path query. Access only from the main thread. The path is valid once the state is no longer pending.
+struct URHO3D_API NavigationPathRequest : public RefCounted
+{
+    /// Cancel if still pending.
+    void Cancel()
+    {
+        if (state_ == PATH_REQUEST_PENDING)
+            state_ = PATH_REQUEST_CANCELLED;
+    }
+
+    /// Return whether the query has finished, successfully or not.
+    bool IsFinished() const { return state_ != PATH_REQUEST_PENDING; }
+
+    /// World-space start point.
+    Vector3 start_;
+    /// World-space end point.
+    Vector3 end_;
+    /// How far off the navigation mesh the points can be.
+    Vector3 extents_;
+    /// Resulting path points. If the end point could not be reached, the path ends at the closest reachable point.
+    PODVector<NavigationPathPoint> path_;
+    /// State.
+    NavigationPathRequestState state_{PATH_REQUEST_PENDING};
+    /// Send E_NAVIGATION_PATH_QUERY_FINISHED when finished flag.
+    bool sendEvent_{};
+};
+
 /// Navigation mesh component. Collects the navigation geometry from child nodes with the Navigable component and responds to path queries.
 class URHO3D_API NavigationMesh : public Component
 {
@@ -142,6 +211,14 @@ public:
     virtual bool Build(const BoundingBox& boundingBox);
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     virtual bool Build(const IntVector2& from, const IntVector2& to);
+    /// Rebuild part of the navigation mesh contained by the world-space bounding box in the background. The input geometry is collected immediately and the rebuilt tiles replace the old ones together on a later frame, after which E_NAVIGATION_ASYNC_BUILD_FINISHED is sent. Return true if the build was started.
+    virtual bool BuildAsync(const BoundingBox& boundingBox);
+    /// Rebuild part of the navigation mesh in the rectangular area in the background. Return true if the build was started.
+    virtual bool BuildAsync(const IntVector2& from, const IntVector2& to);
+    /// Cancel the pending background builds. Waits for the tiles already being built.
+    void CancelAsyncBuilds();
+    /// Clear the cached input geometry. Needed only if vertex data has been modified in place, as changes of transform, model or collision shape are detected automatically.
+    void ClearGeometryCache();
     /// Return tile data.
     virtual PODVector<unsigned char> GetTileData(const IntVector2& tile) const;
     /// Add tile to navigation mesh.
@@ -169,6 +246,23 @@ public:
     void FindPath
         (PODVector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
             const dtQueryFilter* filter = nullptr);
+    /// Find a path between world space points, planning long distances over the graph of tile portals to avoid the node limit and cost of a single search. The path is refined through the given number of portals; the rest contains only the portal points, flagged NAVPATHFLAG_COARSE. Extents specifies how far off the navigation mesh the points can be.
+    void FindPathHierarchical(PODVector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end,
+        const Vector3& extents = Vector3::ONE, unsigned maxRefinedPortals = M_MAX_UNSIGNED);
+    /// Find a path between world space points, planning long distances over the graph of tile portals. Return non-empty list of points if successful.
+    void FindPathHierarchical(PODVector<Vector3>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
+        unsigned maxRefinedPortals = M_MAX_UNSIGNED);
+    /// Build the tile portal graph, or update it for the tiles changed since the previous update. Called automatically by FindPathHierarchical().
+    void UpdatePortalGraph();
+    /// Queue a path query to be processed in the background with the default query filter. The work is spread over the worker threads during post-update within the time budget, and may take several frames.
+    SharedPtr<NavigationPathRequest> FindPathAsync(const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
+        bool sendEvent = false);
+    /// Cancel all background path queries.
+    void CancelPathQueries();
+    /// Set time budget in milliseconds per frame for the background path queries. Default 2.
+    void SetPathQueryTimeBudget(float milliseconds);
+    /// Set maximum number of polygon corridors cached for reuse by background path queries between the same polygons. Zero disables. Default 256.
+    void SetPathCacheSize(unsigned size);
     /// Return a random point on the navigation mesh.
     Vector3 GetRandomPoint(const dtQueryFilter* filter = nullptr, dtPolyRef* randomRef = nullptr);
     /// Return a random point on the navigation mesh within a circle. The circle radius is only a guideline and in practice the returned point may be further away.
@@ -272,24 +366,66 @@ public:
     /// Return whether to draw NavArea components.
     bool GetDrawNavAreas() const { return drawNavAreas_; }
 
+    /// Return timing of the latest full or partial build.
+    const NavigationBuildStats& GetBuildStats() const { return buildStats_; }
+
+    /// Return number of pending background builds.
+    unsigned GetNumAsyncBuilds() const { return asyncBuilds_.Size(); }
+
+    /// Return time budget in milliseconds per frame for the background path queries.
+    float GetPathQueryTimeBudget() const;
+    /// Return maximum number of cached polygon corridors.
+    unsigned GetPathCacheSize() const;
+    /// Return number of background path queries not yet finished.
+    unsigned GetNumPendingPathQueries() const;
+    /// Return number of portals in the tile portal graph.
+    unsigned GetNumPortals() const;
+
+    /// Return number of geometry components with cached input geometry.
+    unsigned GetNumCachedGeometries() const { return geometryCache_.Size(); }
+
 private:
+    friend void BuildNavigationTileWork(const WorkItem* item, unsigned threadIndex);
+    friend void BuildNavigationTileAsyncWork(const WorkItem* item, unsigned threadIndex);
+
     /// Write tile data.
     void WriteTile(Serializer& dest, int x, int z) const;
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Handle update to swap in the finished background builds.
+    void HandleUpdateAsyncBuilds(StringHash eventType, VariantMap& eventData);
+    /// Handle post-update to process the background path queries.
+    void HandlePostUpdatePathQueries(StringHash eventType, VariantMap& eventData);
+    /// Return the ID of the nearest enabled NavArea containing a world-space path point, or 0 if none.
+    unsigned char GetPathPointAreaID(const Vector3& position) const;
+    /// Drop the cached polygon corridors after the navigation mesh has changed.
+    void ClearPathCache();
 
 protected:
     /// Collect geometry from under Navigable components.
     void CollectGeometries(Vector<NavigationGeometryInfo>& geometryList);
     /// Visit nodes and collect navigable geometry.
     void CollectGeometries(Vector<NavigationGeometryInfo>& geometryList, Node* node, HashSet<Node*>& processedNodes, bool recursive);
+    /// Update the cached triangles of the collected geometry and drop the entries of geometry no longer present.
+    void UpdateGeometryCache(Vector<NavigationGeometryInfo>& geometryList);
+    /// Add the triangles of a collision shape or drawable to the geometry data, bypassing the cache.
+    void AddGeometry(NavBuildData* build, const NavigationGeometryInfo& info);
     /// Get geometry data within a bounding box.
     void GetTileGeometry(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, BoundingBox& box);
+    /// Get geometry data of one tile, including the border.
+    void GetTileGeometry(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, int x, int z);
     /// Add a triangle mesh to the geometry data.
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
-    /// Build one tile of the navigation mesh. Return true if successful.
+    /// Build one tile of the navigation mesh. Return true if successful. When tiles are built in parallel, called in the main thread to add each tile, with the data already built by the worker threads.
     virtual bool BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Build the Detour data of one tile without adding it. The data is null if the tile is empty. Return true if successful. Thread-safe when the geometry's world transforms are up to date.
+    bool BuildTileData(Vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData, int& navDataSize,
+        NavigationBuildStats& stats);
+    /// Build the Detour data of one tile from already collected geometry without adding it. Return true if successful. Thread-safe.
+    bool BuildTileData(SimpleNavBuildData& build, int x, int z, unsigned char*& navData, int& navDataSize, NavigationBuildStats& stats);
+    /// Replace a tile with built Detour data, which may be null to just remove the tile. Takes ownership of the data. Return true if successful.
+    bool AddTileData(int x, int z, unsigned char* navData, int navDataSize);
+    /// Build tiles in the rectangular area, in parallel if worker threads are available. Return number of built tiles.
     unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
@@ -306,6 +442,10 @@ protected:
     UniquePtr<dtQueryFilter> queryFilter_;
     /// Temporary data for finding a path.
     UniquePtr<FindPathData> pathData_;
+    /// Background path queries.
+    UniquePtr<NavigationPathQueue> pathQueries_;
+    /// Tile portal graph for hierarchical pathfinding.
+    UniquePtr<NavigationPortalGraph> portalGraph_;
     /// Tile size.
     int tileSize_;
     /// Cell size.
@@ -340,6 +480,14 @@ protected:
     int numTilesZ_;
     /// Whole navigation mesh bounding box.
     BoundingBox boundingBox_;
+    /// Timing of the latest build.
+    NavigationBuildStats buildStats_;
+    /// Tile data built by a worker thread, which BuildTile() adds instead of building it again.
+    NavigationTileBuildJob* prebuiltTile_;
+    /// Pending background builds in the order they were started.
+    Vector<SharedPtr<NavigationAsyncBuild> > asyncBuilds_;
+    /// Cached input geometry by component.
+    HashMap<Component*, SharedPtr<NavigationGeometryCache> > geometryCache_;
     /// Type of the heightfield partitioning.
     NavmeshPartitionType partitionType_;
     /// Keep internal build resources for debug draw modes.
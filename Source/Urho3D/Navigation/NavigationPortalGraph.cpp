@@ -0,0 +1,486 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Navigation/NavigationPortalGraph.h"
+
+#include <Detour/DetourNavMesh.h>
+#include <Detour/DetourNavMeshQuery.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const int MAX_COLUMN_LAYERS = 32;
+static const int MAX_PORTAL_PATH_POLYS = 256;
+static const unsigned long long UNKNOWN_STAMP = 0xffffffffffffffffULL;
+
+/// Part of a tile border edge linked to the neighbouring tile.
+struct NavigationPortalSegment
+{
+    /// Minimum coordinate along the border.
+    float min_;
+    /// Maximum coordinate along the border.
+    float max_;
+    /// Start point.
+    Vector3 start_;
+    /// End point.
+    Vector3 end_;
+    /// Polygon owning the edge.
+    dtPolyRef ref_;
+};
+
+static bool CompareNavigationPortalSegments(const NavigationPortalSegment& lhs, const NavigationPortalSegment& rhs)
+{
+    return lhs.min_ < rhs.min_;
+}
+
+/// Return the length of the path between two points, or a negative value if the end can not be reached.
+static float GetPathLength(dtNavMeshQuery* query, const dtQueryFilter* filter, dtPolyRef startRef, const Vector3& start, dtPolyRef endRef,
+    const Vector3& end)
+{
+    if (startRef == endRef)
+        return (end - start).Length();
+
+    dtPolyRef polys[MAX_PORTAL_PATH_POLYS];
+    int numPolys = 0;
+    dtStatus status = query->findPath(startRef, endRef, &start.x_, &end.x_, filter, polys, &numPolys, MAX_PORTAL_PATH_POLYS);
+    if (dtStatusFailed(status) || !numPolys || polys[numPolys - 1] != endRef)
+        return -1.0f;
+
+    Vector3 points[MAX_PORTAL_PATH_POLYS];
+    int numPoints = 0;
+    query->findStraightPath(&start.x_, &end.x_, polys, numPolys, &points[0].x_, nullptr, nullptr, &numPoints, MAX_PORTAL_PATH_POLYS);
+
+    float length = 0.0f;
+    for (int i = 1; i < numPoints; ++i)
+        length += (points[i] - points[i - 1]).Length();
+    return length;
+}
+
+/// Return a value that changes whenever a tile of the column is added, removed or replaced.
+static unsigned long long GetColumnStamp(const dtNavMesh* navMesh, int x, int z)
+{
+    const dtMeshTile* tiles[MAX_COLUMN_LAYERS];
+    int numTiles = navMesh->getTilesAt(x, z, tiles, MAX_COLUMN_LAYERS);
+
+    unsigned long long stamp = (unsigned long long)numTiles;
+    for (int i = 0; i < numTiles; ++i)
+        stamp = stamp * 31 + navMesh->getTileRef(tiles[i]);
+    return stamp;
+}
+
+NavigationPortalGraph::NavigationPortalGraph() :
+    numTilesX_(0),
+    numTilesZ_(0)
+{
+}
+
+void NavigationPortalGraph::Reset(int numTilesX, int numTilesZ)
+{
+    numTilesX_ = Max(numTilesX, 0);
+    numTilesZ_ = Max(numTilesZ, 0);
+
+    unsigned numColumns = (unsigned)(numTilesX_ * numTilesZ_);
+    nodes_.Clear();
+    freeNodes_.Clear();
+    borderNodes_.Clear();
+    borderNodes_.Resize(numColumns * 2);
+    columnEdges_.Clear();
+    columnEdges_.Resize(numColumns);
+    columnStamps_.Clear();
+    columnStamps_.Resize(numColumns);
+    for (unsigned i = 0; i < numColumns; ++i)
+        columnStamps_[i] = UNKNOWN_STAMP;
+}
+
+unsigned NavigationPortalGraph::Update(const dtNavMesh* navMesh, dtNavMeshQuery* query, const dtQueryFilter* filter,
+    float mergeDistance, float maxHeightDifference)
+{
+    if (!navMesh)
+        return 0;
+
+    // Detect the changed columns. Detour gives a replaced tile a new reference
+    PODVector<int> changedColumns;
+    for (int z = 0; z < numTilesZ_; ++z)
+    {
+        for (int x = 0; x < numTilesX_; ++x)
+        {
+            unsigned index = (unsigned)(z * numTilesX_ + x);
+            unsigned long long stamp = GetColumnStamp(navMesh, x, z);
+            if (stamp != columnStamps_[index])
+            {
+                columnStamps_[index] = stamp;
+                changedColumns.Push(index);
+            }
+        }
+    }
+
+    if (changedColumns.Empty())
+        return 0;
+
+    // Rebuild the four borders of each changed column. The links from the neighbours have changed too
+    PODVector<bool> rebuiltBorders(borderNodes_.Size(), false);
+    PODVector<bool> affectedColumns(columnEdges_.Size(), false);
+    for (unsigned i = 0; i < changedColumns.Size(); ++i)
+    {
+        int x = changedColumns[i] % numTilesX_;
+        int z = changedColumns[i] / numTilesX_;
+        const int borders[4][3] = { { x, z, 0 }, { x, z, 1 }, { x - 1, z, 0 }, { x, z - 1, 1 } };
+
+        for (const auto& border : borders)
+        {
+            unsigned index = GetBorderIndex(border[0], border[1], border[2]);
+            if (index == M_MAX_UNSIGNED || rebuiltBorders[index])
+                continue;
+
+            RebuildBorder(navMesh, border[0], border[1], border[2], mergeDistance, maxHeightDifference);
+            rebuiltBorders[index] = true;
+            affectedColumns[border[1] * numTilesX_ + border[0]] = true;
+            if (border[2] == 0)
+                affectedColumns[border[1] * numTilesX_ + border[0] + 1] = true;
+            else
+                affectedColumns[(border[1] + 1) * numTilesX_ + border[0]] = true;
+        }
+    }
+
+    for (unsigned i = 0; i < affectedColumns.Size(); ++i)
+    {
+        if (affectedColumns[i])
+            RebuildEdges(query, filter, i % numTilesX_, i / numTilesX_);
+    }
+
+    return changedColumns.Size();
+}
+
+bool NavigationPortalGraph::FindRoute(PODVector<Vector3>& route, dtNavMeshQuery* query, const dtQueryFilter* filter, dtPolyRef startRef,
+    const Vector3& start, int startX, int startZ, dtPolyRef endRef, const Vector3& end, int endX, int endZ)
+{
+    route.Clear();
+
+    if (startX < 0 || startZ < 0 || startX >= numTilesX_ || startZ >= numTilesZ_ || endX < 0 || endZ < 0 || endX >= numTilesX_ ||
+        endZ >= numTilesZ_)
+        return false;
+
+    // The goal is a virtual node after the portals
+    const unsigned goal = nodes_.Size();
+    PODVector<float> costs(nodes_.Size() + 1, M_INFINITY);
+    PODVector<unsigned> parents(nodes_.Size() + 1, M_MAX_UNSIGNED);
+    PODVector<float> goalCosts(nodes_.Size(), -1.0f);
+    // Open list as a binary min-heap of estimated total cost and node
+    PODVector<Pair<float, unsigned> > open;
+
+    auto pushOpen = [&open](float estimate, unsigned node)
+    {
+        open.Push(MakePair(estimate, node));
+        unsigned i = open.Size() - 1;
+        while (i > 0 && open[(i - 1) / 2].first_ > open[i].first_)
+        {
+            Swap(open[(i - 1) / 2], open[i]);
+            i = (i - 1) / 2;
+        }
+    };
+
+    auto popOpen = [&open]()
+    {
+        Pair<float, unsigned> top = open.Front();
+        open.Front() = open.Back();
+        open.Pop();
+        unsigned i = 0;
+        for (;;)
+        {
+            unsigned smallest = i;
+            unsigned left = i * 2 + 1;
+            unsigned right = left + 1;
+            if (left < open.Size() && open[left].first_ < open[smallest].first_)
+                smallest = left;
+            if (right < open.Size() && open[right].first_ < open[smallest].first_)
+                smallest = right;
+            if (smallest == i)
+                break;
+            Swap(open[i], open[smallest]);
+            i = smallest;
+        }
+        return top;
+    };
+
+    // Connect the end point to the portals of its tile
+    PODVector<unsigned> columnNodes;
+    GetColumnNodes(columnNodes, endX, endZ);
+    for (unsigned i = 0; i < columnNodes.Size(); ++i)
+    {
+        const NavigationPortalNode& node = nodes_[columnNodes[i]];
+        goalCosts[columnNodes[i]] = GetPathLength(query, filter, node.ref_, node.position_, endRef, end);
+    }
+
+    // Connect the start point to the portals of its tile
+    GetColumnNodes(columnNodes, startX, startZ);
+    for (unsigned i = 0; i < columnNodes.Size(); ++i)
+    {
+        unsigned index = columnNodes[i];
+        const NavigationPortalNode& node = nodes_[index];
+        float cost = GetPathLength(query, filter, startRef, start, node.ref_, node.position_);
+        if (cost >= 0.0f && cost < costs[index])
+        {
+            costs[index] = cost;
+            pushOpen(cost + (end - node.position_).Length(), index);
+        }
+    }
+
+    while (!open.Empty())
+    {
+        Pair<float, unsigned> current = popOpen();
+        unsigned index = current.second_;
+        if (index == goal)
+            break;
+
+        const NavigationPortalNode& node = nodes_[index];
+        // Skip outdated heap entries
+        if (current.first_ > costs[index] + (end - node.position_).Length() + M_EPSILON)
+            continue;
+
+        if (goalCosts[index] >= 0.0f && costs[index] + goalCosts[index] < costs[goal])
+        {
+            costs[goal] = costs[index] + goalCosts[index];
+            parents[goal] = index;
+            pushOpen(costs[goal], goal);
+        }
+
+        // A portal belongs to the two columns on either side of its border
+        int x = (int)(node.border_ / 2) % numTilesX_;
+        int z = (int)(node.border_ / 2) / numTilesX_;
+        const int columns[2] = { z * numTilesX_ + x, (node.border_ & 1) ? (z + 1) * numTilesX_ + x : z * numTilesX_ + x + 1 };
+
+        for (int column : columns)
+        {
+            const PODVector<NavigationPortalEdge>& edges = columnEdges_[column];
+            for (unsigned i = 0; i < edges.Size(); ++i)
+            {
+                const NavigationPortalEdge& edge = edges[i];
+                if (edge.from_ != index)
+                    continue;
+
+                float cost = costs[index] + edge.cost_;
+                if (cost < costs[edge.to_])
+                {
+                    costs[edge.to_] = cost;
+                    parents[edge.to_] = index;
+                    pushOpen(cost + (end - nodes_[edge.to_].position_).Length(), edge.to_);
+                }
+            }
+        }
+    }
+
+    if (parents[goal] == M_MAX_UNSIGNED)
+        return false;
+
+    for (unsigned index = parents[goal]; index != M_MAX_UNSIGNED; index = parents[index])
+        route.Push(nodes_[index].position_);
+    for (unsigned i = 0; i < route.Size() / 2; ++i)
+        Swap(route[i], route[route.Size() - 1 - i]);
+
+    return true;
+}
+
+unsigned NavigationPortalGraph::GetNumEdges() const
+{
+    unsigned num = 0;
+    for (unsigned i = 0; i < columnEdges_.Size(); ++i)
+        num += columnEdges_[i].Size();
+    return num;
+}
+
+void NavigationPortalGraph::RebuildBorder(const dtNavMesh* navMesh, int x, int z, int axis, float mergeDistance,
+    float maxHeightDifference)
+{
+    unsigned borderIndex = GetBorderIndex(x, z, axis);
+    PODVector<unsigned>& borderNodes = borderNodes_[borderIndex];
+    for (unsigned i = 0; i < borderNodes.Size(); ++i)
+    {
+        nodes_[borderNodes[i]].valid_ = false;
+        freeNodes_.Push(borderNodes[i]);
+    }
+    borderNodes.Clear();
+
+    // Gather the polygon edges linked to the neighbour on the +X (Detour side 0) or +Z (side 2) border
+    const unsigned char side = (unsigned char)(axis == 0 ? 0 : 2);
+    PODVector<NavigationPortalSegment> segments;
+    const dtMeshTile* tiles[MAX_COLUMN_LAYERS];
+    int numTiles = navMesh->getTilesAt(x, z, tiles, MAX_COLUMN_LAYERS);
+
+    for (int i = 0; i < numTiles; ++i)
+    {
+        const dtMeshTile* tile = tiles[i];
+        dtPolyRef base = navMesh->getPolyRefBase(tile);
+
+        for (int j = 0; j < tile->header->polyCount; ++j)
+        {
+            const dtPoly& poly = tile->polys[j];
+            if (poly.getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+                continue;
+
+            for (unsigned k = poly.firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+            {
+                const dtLink& link = tile->links[k];
+                if (link.side != side || link.edge >= poly.vertCount)
+                    continue;
+
+                Vector3 va(&tile->verts[poly.verts[link.edge] * 3]);
+                Vector3 vb(&tile->verts[poly.verts[(link.edge + 1) % poly.vertCount] * 3]);
+
+                NavigationPortalSegment segment;
+                segment.start_ = va.Lerp(vb, link.bmin / 255.0f);
+                segment.end_ = va.Lerp(vb, link.bmax / 255.0f);
+                float a = axis == 0 ? segment.start_.z_ : segment.start_.x_;
+                float b = axis == 0 ? segment.end_.z_ : segment.end_.x_;
+                segment.min_ = Min(a, b);
+                segment.max_ = Max(a, b);
+                segment.ref_ = base | (dtPolyRef)j;
+                segments.Push(segment);
+            }
+        }
+    }
+
+    if (segments.Empty())
+        return;
+
+    Sort(segments.Begin(), segments.End(), CompareNavigationPortalSegments);
+
+    // Merge adjacent segments at a similar height into portals, with a node in the middle of each
+    unsigned runStart = 0;
+    float runMax = segments[0].max_;
+    for (unsigned i = 1; i <= segments.Size(); ++i)
+    {
+        if (i < segments.Size())
+        {
+            const NavigationPortalSegment& segment = segments[i];
+            float height = (segment.start_.y_ + segment.end_.y_) * 0.5f;
+            float lastHeight = (segments[i - 1].start_.y_ + segments[i - 1].end_.y_) * 0.5f;
+            if (segment.min_ <= runMax + mergeDistance && Abs(height - lastHeight) <= maxHeightDifference)
+            {
+                runMax = Max(runMax, segment.max_);
+                continue;
+            }
+        }
+
+        float middle = (segments[runStart].min_ + runMax) * 0.5f;
+        unsigned best = runStart;
+        float bestDistance = M_INFINITY;
+        for (unsigned j = runStart; j < i; ++j)
+        {
+            float distance = middle < segments[j].min_ ? segments[j].min_ - middle : (middle > segments[j].max_ ? middle - segments[j].max_ : 0.0f);
+            if (distance < bestDistance)
+            {
+                best = j;
+                bestDistance = distance;
+            }
+        }
+
+        const NavigationPortalSegment& segment = segments[best];
+        float a = axis == 0 ? segment.start_.z_ : segment.start_.x_;
+        float b = axis == 0 ? segment.end_.z_ : segment.end_.x_;
+        float t = b != a ? Clamp((middle - a) / (b - a), 0.0f, 1.0f) : 0.5f;
+
+        unsigned index;
+        if (freeNodes_.Size())
+        {
+            index = freeNodes_.Back();
+            freeNodes_.Pop();
+        }
+        else
+        {
+            index = nodes_.Size();
+            nodes_.Resize(index + 1);
+        }
+
+        NavigationPortalNode& node = nodes_[index];
+        node.position_ = segment.start_.Lerp(segment.end_, t);
+        node.ref_ = segment.ref_;
+        node.border_ = borderIndex;
+        node.valid_ = true;
+        borderNodes.Push(index);
+
+        if (i < segments.Size())
+        {
+            runStart = i;
+            runMax = segments[i].max_;
+        }
+    }
+}
+
+void NavigationPortalGraph::RebuildEdges(dtNavMeshQuery* query, const dtQueryFilter* filter, int x, int z)
+{
+    PODVector<NavigationPortalEdge>& edges = columnEdges_[z * numTilesX_ + x];
+    edges.Clear();
+
+    PODVector<unsigned> columnNodes;
+    GetColumnNodes(columnNodes, x, z);
+
+    for (unsigned i = 0; i < columnNodes.Size(); ++i)
+    {
+        for (unsigned j = i + 1; j < columnNodes.Size(); ++j)
+        {
+            const NavigationPortalNode& a = nodes_[columnNodes[i]];
+            const NavigationPortalNode& b = nodes_[columnNodes[j]];
+            float cost = GetPathLength(query, filter, a.ref_, a.position_, b.ref_, b.position_);
+            if (cost < 0.0f)
+                continue;
+
+            NavigationPortalEdge edge;
+            edge.from_ = columnNodes[i];
+            edge.to_ = columnNodes[j];
+            edge.cost_ = cost;
+            edges.Push(edge);
+            Swap(edge.from_, edge.to_);
+            edges.Push(edge);
+        }
+    }
+}
+
+void NavigationPortalGraph::GetColumnNodes(PODVector<unsigned>& dest, int x, int z) const
+{
+    dest.Clear();
+
+    const int borders[4][3] = { { x, z, 0 }, { x, z, 1 }, { x - 1, z, 0 }, { x, z - 1, 1 } };
+    for (const auto& border : borders)
+    {
+        unsigned index = GetBorderIndex(border[0], border[1], border[2]);
+        if (index != M_MAX_UNSIGNED)
+            dest.Push(borderNodes_[index]);
+    }
+}
+
+unsigned NavigationPortalGraph::GetBorderIndex(int x, int z, int axis) const
+{
+    // The +X border of the last column and the +Z border of the last row have no neighbour
+    if (x < 0 || z < 0 || x >= numTilesX_ || z >= numTilesZ_ || (axis == 0 && x == numTilesX_ - 1) ||
+        (axis == 1 && z == numTilesZ_ - 1))
+        return M_MAX_UNSIGNED;
+
+    return (unsigned)(z * numTilesX_ + x) * 2 + axis;
+}
+
+}
@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/Vector3.h"
+
+#ifdef DT_POLYREF64
+using dtPolyRef = uint64_t;
+#else
+using dtPolyRef = unsigned int;
+#endif
+
+class dtNavMesh;
+class dtNavMeshQuery;
+class dtQueryFilter;
+
+namespace Urho3D
+{
+
+/// Portal between two neighbouring navigation mesh tiles.
+struct NavigationPortalNode
+{
+    /// Position in the middle of the portal, in navigation mesh space.
+    Vector3 position_;
+    /// Polygon at the position.
+    dtPolyRef ref_;
+    /// Border the portal is on.
+    unsigned border_;
+    /// Valid flag. Nodes of rebuilt borders are reused.
+    bool valid_;
+};
+
+/// Connection between two portals through a tile.
+struct NavigationPortalEdge
+{
+    /// Source node.
+    unsigned from_;
+    /// Destination node.
+    unsigned to_;
+    /// Path length.
+    float cost_;
+};
+
+/// Abstract graph over the portals between navigation mesh tiles for hierarchical pathfinding. Each tile column connects the portals on its four borders, with the path lengths through the tile as costs.
+class URHO3D_API NavigationPortalGraph
+{
+public:
+    /// Construct.
+    NavigationPortalGraph();
+
+    /// Clear and set the tile grid size. All tiles are processed on the next update.
+    void Reset(int numTilesX, int numTilesZ);
+    /// Update the portals and connections of the tile columns whose tiles have been replaced since the previous update. Return number of changed columns.
+    unsigned Update(const dtNavMesh* navMesh, dtNavMeshQuery* query, const dtQueryFilter* filter, float mergeDistance,
+        float maxHeightDifference);
+    /// Find the portals to pass through from start to end. Return false if not connected.
+    bool FindRoute(PODVector<Vector3>& route, dtNavMeshQuery* query, const dtQueryFilter* filter, dtPolyRef startRef, const Vector3& start,
+        int startX, int startZ, dtPolyRef endRef, const Vector3& end, int endX, int endZ);
+
+    /// Return number of tiles in X direction.
+    int GetNumTilesX() const { return numTilesX_; }
+
+    /// Return number of tiles in Z direction.
+    int GetNumTilesZ() const { return numTilesZ_; }
+
+    /// Return number of portals.
+    unsigned GetNumNodes() const { return nodes_.Size() - freeNodes_.Size(); }
+
+    /// Return number of connections.
+    unsigned GetNumEdges() const;
+
+private:
+    /// Rebuild the portals on the +X (axis 0) or +Z (axis 1) border of a tile column.
+    void RebuildBorder(const dtNavMesh* navMesh, int x, int z, int axis, float mergeDistance, float maxHeightDifference);
+    /// Rebuild the connections between the portals of a tile column.
+    void RebuildEdges(dtNavMeshQuery* query, const dtQueryFilter* filter, int x, int z);
+    /// Return the portals on the borders of a tile column.
+    void GetColumnNodes(PODVector<unsigned>& dest, int x, int z) const;
+    /// Return border index, or M_MAX_UNSIGNED if outside the grid.
+    unsigned GetBorderIndex(int x, int z, int axis) const;
+
+    /// Portals.
+    Vector<NavigationPortalNode> nodes_;
+    /// Free portal indices.
+    PODVector<unsigned> freeNodes_;
+    /// Portals by border.
+    Vector<PODVector<unsigned> > borderNodes_;
+    /// Connections by tile column.
+    Vector<PODVector<NavigationPortalEdge> > columnEdges_;
+    /// Tile references of each column at the previous update, to detect replaced tiles.
+    PODVector<unsigned long long> columnStamps_;
+    /// Number of tiles in X direction.
+    int numTilesX_;
+    /// Number of tiles in Z direction.
+    int numTilesZ_;
+};
+
+}
@@ -0,0 +1,372 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Network/ClientPrediction.h"
+#include "../Network/Connection.h"
+#include "../Network/NetworkEvents.h"
+#ifdef URHO3D_PHYSICS
+#include "../Physics/PhysicsWorld.h"
+#include "../Physics/RigidBody.h"
+#endif
+#include "../Scene/Node.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* NETWORK_CATEGORY;
+
+static const float DEFAULT_PREDICTION_SMOOTHING_CONSTANT = 10.0f;
+static const float DEFAULT_PREDICTION_SNAP_THRESHOLD = 1.0f;
+
+static const char* NET_POSITION_ATTR = "Network Position";
+static const char* NET_ROTATION_ATTR = "Network Rotation";
+static const char* LINEAR_VELOCITY_ATTR = "Linear Velocity";
+static const char* NET_ANGULAR_VELOCITY_ATTR = "Network Angular Velocity";
+
+ClientPrediction::ClientPrediction(Context* context) :
+    Component(context),
+    serverPosition_(Vector3::ZERO),
+    serverRotation_(Quaternion::IDENTITY),
+    serverLinearVelocity_(Vector3::ZERO),
+    serverAngularVelocity_(Vector3::ZERO),
+    positionError_(Vector3::ZERO),
+    rotationError_(Quaternion::IDENTITY),
+    replayControls_(nullptr),
+    smoothingConstant_(DEFAULT_PREDICTION_SMOOTHING_CONSTANT),
+    snapThreshold_(DEFAULT_PREDICTION_SNAP_THRESHOLD),
+    hasServerState_(false),
+    subscribed_(false)
+{
+}
+
+ClientPrediction::~ClientPrediction() = default;
+
+void ClientPrediction::RegisterObject(Context* context)
+{
+    context->RegisterFactory<ClientPrediction>(NETWORK_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Smoothing Constant", GetSmoothingConstant, SetSmoothingConstant, float,
+        DEFAULT_PREDICTION_SMOOTHING_CONSTANT, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Snap Threshold", GetSnapThreshold, SetSnapThreshold, float, DEFAULT_PREDICTION_SNAP_THRESHOLD,
+        AM_DEFAULT);
+}
+
+void ClientPrediction::SetSmoothingConstant(float constant)
+{
+    smoothingConstant_ = Max(constant, 0.0f);
+}
+
+void ClientPrediction::SetSnapThreshold(float threshold)
+{
+    snapThreshold_ = Max(threshold, 0.0f);
+}
+
+void ClientPrediction::Reconcile(Connection* connection)
+{
+    if (!node_ || !connection || !hasServerState_ || !IsEnabledEffective())
+        return;
+
+    URHO3D_PROFILE(ReconcilePrediction);
+
+    Vector3 predictedPosition = node_->GetPosition();
+    Quaternion predictedRotation = node_->GetRotation();
+
+#ifdef URHO3D_PHYSICS
+    auto* body = node_->GetComponent<RigidBody>();
+    if (body != interceptedBody_)
+        InterceptBody(body);
+#endif
+
+    // Rewind to the authoritative server state
+    node_->SetPosition(serverPosition_);
+    node_->SetRotation(serverRotation_);
+#ifdef URHO3D_PHYSICS
+    if (body)
+    {
+        body->SetLinearVelocity(serverLinearVelocity_);
+        body->SetAngularVelocity(serverAngularVelocity_);
+    }
+#endif
+
+    {
+        using namespace PredictionRewind;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_NODE] = node_;
+        eventData[P_SEQUENCE] = connection->GetAckedControlsSequence();
+        node_->SendEvent(E_PREDICTIONREWIND, eventData);
+    }
+
+    // Replay the controls the server has not yet processed. Each controls update lasts until the next one was sent
+    const Vector<ControlsRecord>& history = connection->GetControlsHistory();
+    float elapsedTime = GetSubsystem<Time>()->GetElapsedTime();
+
+#ifdef URHO3D_PHYSICS
+    PhysicsWorld* physicsWorld = body && body->IsEnabledEffective() ? body->GetPhysicsWorld() : nullptr;
+    PODVector<RigidBody*> bodies;
+    if (physicsWorld)
+        bodies.Push(body);
+#endif
+
+    for (unsigned i = 0; i < history.Size() && node_; ++i)
+    {
+        const ControlsRecord& record = history[i];
+        float timeStep = (i + 1 < history.Size() ? history[i + 1].time_ : elapsedTime) - record.time_;
+        if (timeStep <= 0.0f)
+            continue;
+
+        replayControls_ = &record.controls_;
+
+#ifdef URHO3D_PHYSICS
+        // Step the body at the physics rate, as the server does, so that per-step logic gets applied equally
+        if (physicsWorld)
+        {
+            float internalTimeStep = 1.0f / (float)physicsWorld->GetFps();
+            while (timeStep > M_EPSILON)
+            {
+                float step = Min(timeStep, internalTimeStep);
+                SendReplayEvent(record.sequence_, step);
+                physicsWorld->StepBodies(bodies, step);
+                timeStep -= step;
+            }
+        }
+        else
+#endif
+            SendReplayEvent(record.sequence_, timeStep);
+    }
+
+    replayControls_ = nullptr;
+
+    // The node may have been removed by the event handlers
+    if (!node_)
+        return;
+
+    // Then smooth out the difference between the previous prediction and the corrected one, unless it is too large
+    Vector3 correctedPosition = node_->GetPosition();
+    Quaternion correctedRotation = node_->GetRotation();
+    Vector3 error = predictedPosition - correctedPosition;
+
+    if (smoothingConstant_ <= 0.0f || error.LengthSquared() > snapThreshold_ * snapThreshold_)
+    {
+        positionError_ = Vector3::ZERO;
+        rotationError_ = Quaternion::IDENTITY;
+    }
+    else
+    {
+        positionError_ = error;
+        rotationError_ = predictedRotation * correctedRotation.Inverse();
+        node_->SetPosition(predictedPosition);
+        node_->SetRotation(predictedRotation);
+    }
+
+    UpdateSmoothingSubscription();
+}
+
+const Controls& ClientPrediction::GetReplayControls() const
+{
+    static const Controls noControls;
+    return replayControls_ ? *replayControls_ : noControls;
+}
+
+void ClientPrediction::OnNodeSet(Node* node)
+{
+    if (node)
+        SubscribeToEvent(E_CONTROLSACKNOWLEDGED, URHO3D_HANDLER(ClientPrediction, HandleControlsAcknowledged));
+    else
+    {
+        UnsubscribeFromAllEvents();
+        subscribed_ = false;
+    }
+
+    UpdateInterception();
+}
+
+void ClientPrediction::OnSetEnabled()
+{
+    UpdateInterception();
+}
+
+void ClientPrediction::UpdateInterception()
+{
+    // While disabled, the network updates are applied directly as usual
+    Node* node = IsEnabledEffective() ? node_ : nullptr;
+    if (node == interceptedNode_)
+        return;
+
+    if (interceptedNode_)
+    {
+        interceptedNode_->SetInterceptNetworkUpdate(NET_POSITION_ATTR, false);
+        interceptedNode_->SetInterceptNetworkUpdate(NET_ROTATION_ATTR, false);
+        UnsubscribeFromEvent(interceptedNode_, E_INTERCEPTNETWORKUPDATE);
+        interceptedNode_.Reset();
+    }
+    InterceptBody(nullptr);
+
+    // Drop the remaining correction, and the server state which may be stale once interception starts again
+    positionError_ = Vector3::ZERO;
+    rotationError_ = Quaternion::IDENTITY;
+    hasServerState_ = false;
+    UpdateSmoothingSubscription();
+
+    if (node)
+    {
+        interceptedNode_ = node;
+        // Redirect the authoritative transform from the server to this component instead of applying it directly
+        node->SetInterceptNetworkUpdate(NET_POSITION_ATTR, true);
+        node->SetInterceptNetworkUpdate(NET_ROTATION_ATTR, true);
+        SubscribeToEvent(node, E_INTERCEPTNETWORKUPDATE, URHO3D_HANDLER(ClientPrediction, HandleInterceptNetworkUpdate));
+
+        serverPosition_ = node->GetPosition();
+        serverRotation_ = node->GetRotation();
+    }
+}
+
+void ClientPrediction::InterceptBody(RigidBody* body)
+{
+#ifdef URHO3D_PHYSICS
+    if (interceptedBody_)
+    {
+        interceptedBody_->SetInterceptNetworkUpdate(LINEAR_VELOCITY_ATTR, false);
+        interceptedBody_->SetInterceptNetworkUpdate(NET_ANGULAR_VELOCITY_ATTR, false);
+        UnsubscribeFromEvent(interceptedBody_, E_INTERCEPTNETWORKUPDATE);
+    }
+
+    interceptedBody_ = body;
+
+    if (body)
+    {
+        body->SetInterceptNetworkUpdate(LINEAR_VELOCITY_ATTR, true);
+        body->SetInterceptNetworkUpdate(NET_ANGULAR_VELOCITY_ATTR, true);
+        SubscribeToEvent(body, E_INTERCEPTNETWORKUPDATE, URHO3D_HANDLER(ClientPrediction, HandleInterceptNetworkUpdate));
+
+        serverLinearVelocity_ = body->GetLinearVelocity();
+        serverAngularVelocity_ = body->GetAngularVelocity();
+    }
+#endif
+}
+
+void ClientPrediction::SendReplayEvent(unsigned sequence, float timeStep)
+{
+    using namespace PredictionReplay;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_NODE] = node_;
+    eventData[P_SEQUENCE] = sequence;
+    eventData[P_TIMESTEP] = timeStep;
+    node_->SendEvent(E_PREDICTIONREPLAY, eventData);
+}
+
+void ClientPrediction::UpdateSmoothingSubscription()
+{
+    bool needSmoothing = positionError_ != Vector3::ZERO || rotationError_ != Quaternion::IDENTITY;
+    Scene* scene = GetScene();
+
+    if (needSmoothing && !subscribed_ && scene)
+    {
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ClientPrediction, HandleScenePostUpdate));
+        subscribed_ = true;
+    }
+    else if (!needSmoothing && subscribed_)
+    {
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        subscribed_ = false;
+    }
+}
+
+void ClientPrediction::HandleInterceptNetworkUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace InterceptNetworkUpdate;
+
+    const String& name = eventData[P_NAME].GetString();
+    const Variant& value = eventData[P_VALUE];
+
+    if (name == NET_POSITION_ATTR)
+        serverPosition_ = value.GetVector3();
+    else if (name == NET_ROTATION_ATTR)
+    {
+        MemoryBuffer buf(value.GetBuffer());
+        serverRotation_ = buf.ReadPackedQuaternion();
+    }
+#ifdef URHO3D_PHYSICS
+    else if (name == LINEAR_VELOCITY_ATTR)
+        serverLinearVelocity_ = value.GetVector3();
+    else if (name == NET_ANGULAR_VELOCITY_ATTR)
+    {
+        PhysicsWorld* physicsWorld = interceptedBody_ ? interceptedBody_->GetPhysicsWorld() : nullptr;
+        float maxVelocity = physicsWorld ? physicsWorld->GetMaxNetworkAngularVelocity() : DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY;
+        MemoryBuffer buf(value.GetBuffer());
+        serverAngularVelocity_ = buf.ReadPackedVector3(maxVelocity);
+    }
+#endif
+    else
+        return;
+
+    hasServerState_ = true;
+}
+
+void ClientPrediction::HandleControlsAcknowledged(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ControlsAcknowledged;
+
+    auto* connection = static_cast<Connection*>(eventData[P_CONNECTION].GetPtr());
+    if (connection && connection->GetScene() == GetScene())
+        Reconcile(connection);
+}
+
+void ClientPrediction::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (!node_)
+        return;
+
+    using namespace ScenePostUpdate;
+
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    float constant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
+
+    // Move the node towards the corrected state by the smoothed-out fraction of the remaining error
+    Vector3 newPositionError = positionError_ * (1.0f - constant);
+    Quaternion newRotationError = rotationError_.Slerp(Quaternion::IDENTITY, constant);
+    if (newPositionError.LengthSquared() < M_EPSILON)
+        newPositionError = Vector3::ZERO;
+    if (newRotationError.Equals(Quaternion::IDENTITY))
+        newRotationError = Quaternion::IDENTITY;
+
+    node_->SetPosition(node_->GetPosition() - positionError_ + newPositionError);
+    node_->SetRotation(newRotationError * rotationError_.Inverse() * node_->GetRotation());
+
+    positionError_ = newPositionError;
+    rotationError_ = newRotationError;
+    UpdateSmoothingSubscription();
+}
+
+}
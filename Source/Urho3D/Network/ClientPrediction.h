@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Input/Controls.h"
+#include "../Scene/Component.h"
+
+namespace Urho3D
+{
+
+class Connection;
+class RigidBody;
+
+/// Client-side prediction and server reconciliation component. Create as local into the node controlled by the client.
+class URHO3D_API ClientPrediction : public Component
+{
+    URHO3D_OBJECT(ClientPrediction, Component);
+
+public:
+    /// Construct.
+    explicit ClientPrediction(Context* context);
+    /// Destruct.
+    ~ClientPrediction() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Handle enabled/disabled state change.
+    void OnSetEnabled() override;
+    /// Set correction smoothing constant. Higher values correct faster. Zero snaps immediately. Default 10.
+    void SetSmoothingConstant(float constant);
+    /// Set correction snap threshold. Position errors larger than this are corrected immediately. Default 1.
+    void SetSnapThreshold(float threshold);
+    /// Rewind to the latest server state and replay the controls not yet acknowledged by the server. Called automatically when the server acknowledges controls.
+    void Reconcile(Connection* connection);
+
+    /// Return correction smoothing constant.
+    float GetSmoothingConstant() const { return smoothingConstant_; }
+
+    /// Return correction snap threshold.
+    float GetSnapThreshold() const { return snapThreshold_; }
+
+    /// Return whether is currently replaying controls.
+    bool IsReplaying() const { return replayControls_ != nullptr; }
+
+    /// Return the controls being replayed. Valid only while handling the E_PREDICTIONREPLAY event.
+    const Controls& GetReplayControls() const;
+
+    /// Return the latest position received from the server.
+    const Vector3& GetServerPosition() const { return serverPosition_; }
+
+    /// Return the latest rotation received from the server.
+    const Quaternion& GetServerRotation() const { return serverRotation_; }
+
+    /// Return the remaining position error being smoothed out.
+    const Vector3& GetPositionError() const { return positionError_; }
+
+protected:
+    /// Handle scene node being assigned at creation.
+    void OnNodeSet(Node* node) override;
+
+private:
+    /// Intercept the network updates of the node while enabled, or stop intercepting them while disabled.
+    void UpdateInterception();
+    /// Redirect the network updates of a rigid body's velocities.
+    void InterceptBody(RigidBody* body);
+    /// Send the replay event for one step.
+    void SendReplayEvent(unsigned sequence, float timeStep);
+    /// Subscribe or unsubscribe the correction smoothing update.
+    void UpdateSmoothingSubscription();
+    /// Handle an intercepted network update of the node or rigid body.
+    void HandleInterceptNetworkUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle controls acknowledged by the server.
+    void HandleControlsAcknowledged(StringHash eventType, VariantMap& eventData);
+    /// Handle scene post-update for correction smoothing.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Latest server position.
+    Vector3 serverPosition_;
+    /// Latest server rotation.
+    Quaternion serverRotation_;
+    /// Latest server linear velocity.
+    Vector3 serverLinearVelocity_;
+    /// Latest server angular velocity.
+    Vector3 serverAngularVelocity_;
+    /// Remaining position error.
+    Vector3 positionError_;
+    /// Remaining rotation error.
+    Quaternion rotationError_;
+    /// Node whose transform updates are intercepted.
+    WeakPtr<Node> interceptedNode_;
+    /// Rigid body whose velocity updates are intercepted.
+    WeakPtr<RigidBody> interceptedBody_;
+    /// Controls being replayed.
+    const Controls* replayControls_;
+    /// Correction smoothing constant.
+    float smoothingConstant_;
+    /// Correction snap threshold.
+    float snapThreshold_;
+    /// Server state received flag.
+    bool hasServerState_;
+    /// Subscribed to smoothing update flag.
+    bool subscribed_;
+};
+
+}
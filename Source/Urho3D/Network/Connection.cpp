@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/Profiler.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
@@ -46,6 +47,29 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+static const unsigned DEFAULT_MAX_CONTROLS_HISTORY = 64;
+
+/// Return whether controls sequence number a is newer than b, taking wraparound into account.
+static inline bool IsNewerSequence(unsigned a, unsigned b)
+{
+    return (int)(a - b) > 0;
+}
+
+/// Return whether a node or component has attributes sent as latest data.
+static bool HasLatestDataAttributes(Serializable* serializable)
+{
+    const Vector<AttributeInfo>* attributes = serializable->GetNetworkAttributes();
+    if (!attributes)
+        return false;
+
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        if (attributes->At(i).mode_ & AM_LATESTDATA)
+            return true;
+    }
+
+    return false;
+}
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
@@ -65,10 +89,19 @@ Connection::Connection(Context* context, bool isClient, const kNet::SharedPtr<kN
     timeStamp_(0),
     connection_(connection),
     sendMode_(OPSM_NONE),
+    controlsSequence_(0),
+    ackedControlsSequence_(0),
+    maxControlsHistory_(DEFAULT_MAX_CONTROLS_HISTORY),
+    createNodeBytes_(0),
+    numPendingNodes_(0),
+    controlsAckPending_(false),
+    controlsAckDue_(false),
+    sequencedControls_(false),
     isClient_(isClient),
     connectPending_(false),
     sceneLoaded_(false),
-    logStatistics_(false)
+    logStatistics_(false),
+    statisticsEnabled_(false)
 {
     sceneState_.connection_ = this;
 
@@ -122,6 +155,15 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         memcpy(msg->data, data, numBytes);
 
     connection_->EndAndQueueMessage(msg);
+
+    if (statisticsEnabled_)
+    {
+        NetworkTrafficStats& stats = messageStats_[msgID];
+        ++stats.messagesOut_;
+        stats.bytesOut_ += numBytes;
+        ++totalStats_.messagesOut_;
+        totalStats_.bytesOut_ += numBytes;
+    }
 }
 
 void Connection::SendRemoteEvent(StringHash eventType, bool inOrder, const VariantMap& eventData)
@@ -170,6 +212,10 @@ void Connection::SetScene(Scene* newScene)
 
     scene_ = newScene;
     sceneLoaded_ = false;
+    controlsHistory_.Clear();
+    pendingSceneUpdates_.Clear();
+    numPendingNodes_ = 0;
+    controlsAckPending_ = false;
     UnsubscribeFromEvent(E_ASYNCLOADFINISHED);
 
     if (!scene_)
@@ -192,6 +238,7 @@ void Connection::SetScene(Scene* newScene)
             msg_.WriteUInt(package->GetTotalSize());
             msg_.WriteUInt(package->GetChecksum());
         }
+        msg_.WriteVLE(PROTOCOL_REVISION);
         SendMessage(MSG_LOADSCENE, true, true, msg_);
     }
     else
@@ -231,11 +278,30 @@ void Connection::SetConnectPending(bool connectPending)
     connectPending_ = connectPending;
 }
 
+void Connection::SetMaxControlsHistory(unsigned num)
+{
+    maxControlsHistory_ = Max(num, 1U);
+    if (controlsHistory_.Size() > maxControlsHistory_)
+        controlsHistory_.Erase(0, controlsHistory_.Size() - maxControlsHistory_);
+}
+
 void Connection::SetLogStatistics(bool enable)
 {
     logStatistics_ = enable;
 }
 
+void Connection::SetStatisticsEnabled(bool enable)
+{
+    statisticsEnabled_ = enable;
+}
+
+void Connection::ResetStatistics()
+{
+    messageStats_.Clear();
+    replicationStats_.Clear();
+    totalStats_ = NetworkTrafficStats();
+}
+
 void Connection::Disconnect(int waitMSec)
 {
     connection_->Disconnect(waitMSec);
@@ -246,6 +312,11 @@ void Connection::SendServerUpdate()
     if (!scene_ || !sceneLoaded_)
         return;
 
+    // Acknowledge the latest controls received from the client if not yet acknowledged. The acknowledgement is written into
+    // the latest data of the nodes owned by the client, so that it always arrives together with the state simulated with the
+    // controls. Clients sending controls without sequence numbers are not sent acknowledgements
+    controlsAckDue_ = controlsSequence_ && (!ackedControlsSequence_ || IsNewerSequence(controlsSequence_, ackedControlsSequence_));
+
     // Always check the root node (scene) first so that the scene-wide components get sent first,
     // and all other replicated nodes get added to the dirty set for sending the initial state
     unsigned sceneID = scene_->GetID();
@@ -256,11 +327,32 @@ void Connection::SendServerUpdate()
     nodesToProcess_.Insert(sceneState_.dirtyNodes_);
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
-    while (nodesToProcess_.Size())
+    unsigned createNodeBudget = GetSubsystem<Network>()->GetCreateNodeBudget();
+    if (createNodeBudget)
+        ProcessNewNodesWithBudget(createNodeBudget);
+    else
+    {
+        numPendingNodes_ = 0;
+        while (nodesToProcess_.Size())
+        {
+            unsigned nodeID = nodesToProcess_.Front();
+            ProcessNode(nodeID);
+        }
+    }
+
+    // If none of the owned nodes changed, send the acknowledgement with their unchanged state
+    if (controlsAckDue_ && ackedControlsSequence_ != controlsSequence_)
     {
-        unsigned nodeID = nodesToProcess_.Front();
-        ProcessNode(nodeID);
+        for (HashMap<unsigned, NodeReplicationState>::Iterator i = sceneState_.nodeStates_.Begin();
+             i != sceneState_.nodeStates_.End(); ++i)
+        {
+            Node* node = i->second_.node_;
+            if (node && node->GetOwner() == this)
+                ProcessExistingNode(node, i->second_);
+        }
     }
+
+    controlsAckDue_ = false;
 }
 
 void Connection::SendClientUpdate()
@@ -268,17 +360,36 @@ void Connection::SendClientUpdate()
     if (!scene_ || !sceneLoaded_)
         return;
 
+    ++controlsSequence_;
+    if (!controlsSequence_)
+        ++controlsSequence_;
+
+    // Store the controls for client-side prediction replay until the server acknowledges them. The server applies them
+    // until the next controls update arrives. A server of an older protocol revision does not acknowledge controls
+    if (sequencedControls_)
+    {
+        ControlsRecord record;
+        record.sequence_ = controlsSequence_;
+        record.time_ = GetSubsystem<Time>()->GetElapsedTime();
+        record.controls_ = controls_;
+        if (controlsHistory_.Size() >= maxControlsHistory_)
+            controlsHistory_.Erase(0, controlsHistory_.Size() - maxControlsHistory_ + 1);
+        controlsHistory_.Push(record);
+    }
+
     msg_.Clear();
     msg_.WriteUInt(controls_.buttons_);
     msg_.WriteFloat(controls_.yaw_);
     msg_.WriteFloat(controls_.pitch_);
     msg_.WriteVariantMap(controls_.extraData_);
     msg_.WriteUByte(timeStamp_);
+    if (sequencedControls_)
+        msg_.WriteUInt(controlsSequence_);
     if (sendMode_ >= OPSM_POSITION)
         msg_.WriteVector3(position_);
     if (sendMode_ >= OPSM_POSITION_ROTATION)
         msg_.WritePackedQuaternion(rotation_);
-    SendMessage(MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
+    SendMessage(sequencedControls_ ? MSG_SEQUENCEDCONTROLS : MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
 
     ++timeStamp_;
 }
@@ -387,8 +498,58 @@ void Connection::ProcessPendingLatestData()
     }
 }
 
+void Connection::ProcessPendingSceneUpdates()
+{
+    if (pendingSceneUpdates_.Empty() || !scene_ || !sceneLoaded_)
+        return;
+
+    URHO3D_PROFILE(ProcessPendingSceneUpdates);
+
+    auto timeBudget = (long long)(GetSubsystem<Network>()->GetCreateNodeTimeBudget() * 1000.0f);
+    HiresTimer timer;
+    bool processed = false;
+
+    // Process at least one message per frame to guarantee progress
+    while (!pendingSceneUpdates_.Empty() && (!processed || !timeBudget || timer.GetUSec(false) < timeBudget))
+    {
+        PendingSceneUpdate& update = pendingSceneUpdates_.Front();
+        MemoryBuffer msg(update.data_);
+        if (update.msgID_ == MSG_REMOTENODEEVENT)
+            ProcessRemoteEvent(update.msgID_, msg);
+        else
+            ProcessSceneUpdate(update.msgID_, msg);
+
+        pendingSceneUpdates_.PopFront();
+        processed = true;
+    }
+}
+
+void Connection::ProcessPendingControlsAck()
+{
+    if (!controlsAckPending_)
+        return;
+
+    controlsAckPending_ = false;
+
+    using namespace ControlsAcknowledged;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_CONNECTION] = this;
+    eventData[P_SEQUENCE] = ackedControlsSequence_;
+    SendEvent(E_CONTROLSACKNOWLEDGED, eventData);
+}
+
 bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
 {
+    if (statisticsEnabled_)
+    {
+        NetworkTrafficStats& stats = messageStats_[msgID];
+        ++stats.messagesIn_;
+        stats.bytesIn_ += msg.GetSize();
+        ++totalStats_.messagesIn_;
+        totalStats_.bytesIn_ += msg.GetSize();
+    }
+
     bool processed = true;
 
     switch (msgID)
@@ -398,6 +559,7 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
         break;
 
     case MSG_CONTROLS:
+    case MSG_SEQUENCEDCONTROLS:
         ProcessControls(msgID, msg);
         break;
 
@@ -426,11 +588,25 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
     case MSG_COMPONENTDELTAUPDATE:
     case MSG_COMPONENTLATESTDATA:
     case MSG_REMOVECOMPONENT:
-        ProcessSceneUpdate(msgID, msg);
+    case MSG_REMOTENODEEVENT:
+        // When node creation is deferred to later frames, defer also everything received after it to preserve the order
+        if (!isClient_ && (!pendingSceneUpdates_.Empty() ||
+            (msgID == MSG_CREATENODE && GetSubsystem<Network>()->GetCreateNodeTimeBudget() > 0.0f)))
+        {
+            pendingSceneUpdates_.Push(PendingSceneUpdate());
+            PendingSceneUpdate& update = pendingSceneUpdates_.Back();
+            update.msgID_ = msgID;
+            update.data_.Resize(msg.GetSize());
+            if (msg.GetSize())
+                memcpy(&update.data_[0], msg.GetData(), msg.GetSize());
+        }
+        else if (msgID == MSG_REMOTENODEEVENT)
+            ProcessRemoteEvent(msgID, msg);
+        else
+            ProcessSceneUpdate(msgID, msg);
         break;
 
     case MSG_REMOTEEVENT:
-    case MSG_REMOTENODEEVENT:
         ProcessRemoteEvent(msgID, msg);
         break;
 
@@ -463,9 +639,10 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
     // Store the scene file name we need to eventually load
     sceneFileName_ = msg.ReadString();
 
-    // Clear previous pending latest data and package downloads if any
+    // Clear previous pending latest data, scene updates and package downloads if any
     nodeLatestData_.Clear();
     componentLatestData_.Clear();
+    pendingSceneUpdates_.Clear();
     downloads_.Clear();
 
     // In case we have joined other scenes in this session, remove first all downloaded package files from the resource system
@@ -489,6 +666,9 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
         return;
     }
 
+    // Send controls with sequence numbers only if the server's protocol revision supports them
+    sequencedControls_ = !msg.IsEof() && msg.ReadVLE() >= 1;
+
     // If no downloads were queued, can load the scene directly
     if (downloads_.Empty())
         OnPackagesReady();
@@ -612,6 +792,22 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 node->ReadLatestDataUpdate(msg);
                 // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
                 // Furthermore it would propagate to components and child nodes, which is not desired in this case
+
+                // The latest data of a node owned by this client may be followed by the acknowledgement of the controls
+                // the state was simulated with, and the latest data of the node's components
+                if (!msg.IsEof())
+                {
+                    unsigned sequence = msg.ReadUInt();
+                    unsigned numComponents = msg.ReadVLE();
+                    while (numComponents-- && !msg.IsEof())
+                    {
+                        unsigned size = msg.ReadVLE();
+                        MemoryBuffer componentMsg(msg.GetData() + msg.GetPosition(), size);
+                        msg.SeekRelative(size);
+                        ProcessComponentLatestData(componentMsg);
+                    }
+                    ProcessControlsAck(sequence);
+                }
             }
             else
             {
@@ -682,22 +878,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
         break;
 
     case MSG_COMPONENTLATESTDATA:
-        {
-            unsigned componentID = msg.ReadNetID();
-            Component* component = scene_->GetComponent(componentID);
-            if (component)
-            {
-                if (component->ReadLatestDataUpdate(msg))
-                    component->ApplyAttributes();
-            }
-            else
-            {
-                // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
-                PODVector<unsigned char>& data = componentLatestData_[componentID];
-                data.Resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
-            }
-        }
+        ProcessComponentLatestData(msg);
         break;
 
     case MSG_REMOVECOMPONENT:
@@ -893,6 +1074,8 @@ void Connection::ProcessControls(int msgID, MemoryBuffer& msg)
 
     SetControls(newControls);
     timeStamp_ = msg.ReadUByte();
+    if (msgID == MSG_SEQUENCEDCONTROLS)
+        controlsSequence_ = msg.ReadUInt();
 
     // Client may or may not send observer position & rotation for interest management
     if (!msg.IsEof())
@@ -901,6 +1084,40 @@ void Connection::ProcessControls(int msgID, MemoryBuffer& msg)
         rotation_ = msg.ReadPackedQuaternion();
 }
 
+void Connection::ProcessComponentLatestData(MemoryBuffer& msg)
+{
+    unsigned componentID = msg.ReadNetID();
+    Component* component = scene_->GetComponent(componentID);
+    if (component)
+    {
+        if (component->ReadLatestDataUpdate(msg))
+            component->ApplyAttributes();
+    }
+    else
+    {
+        // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
+        PODVector<unsigned char>& data = componentLatestData_[componentID];
+        data.Resize(msg.GetSize());
+        memcpy(&data[0], msg.GetData(), msg.GetSize());
+    }
+}
+
+void Connection::ProcessControlsAck(unsigned sequence)
+{
+    if (ackedControlsSequence_ && !IsNewerSequence(sequence, ackedControlsSequence_))
+        return;
+
+    ackedControlsSequence_ = sequence;
+    controlsAckPending_ = true;
+
+    // Discard the controls which the server has already processed
+    unsigned numAcked = 0;
+    while (numAcked < controlsHistory_.Size() && !IsNewerSequence(controlsHistory_[numAcked].sequence_, sequence))
+        ++numAcked;
+    if (numAcked)
+        controlsHistory_.Erase(0, numAcked);
+}
+
 void Connection::ProcessSceneLoaded(int msgID, MemoryBuffer& msg)
 {
     if (!IsClient())
@@ -1162,6 +1379,7 @@ void Connection::ProcessNewNode(Node* node)
     node->AddReplicationState(&nodeState);
 
     // Write node's attributes
+    HiresTimer serializeTimer;
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
 
     // Write node's user variables
@@ -1175,6 +1393,9 @@ void Connection::ProcessNewNode(Node* node)
 
     // Write node's components
     msg_.WriteVLE(node->GetNumNetworkComponents());
+    if (statisticsEnabled_)
+        AddReplicationStats(Node::GetTypeStatic(), msg_.GetPosition(), serializeTimer.GetUSec(true));
+
     const Vector<SharedPtr<Component> >& components = node->GetComponents();
     for (unsigned i = 0; i < components.Size(); ++i)
     {
@@ -1189,17 +1410,51 @@ void Connection::ProcessNewNode(Node* node)
         componentState.component_ = component;
         component->AddReplicationState(&componentState);
 
+        unsigned startPosition = msg_.GetPosition();
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
         component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+        if (statisticsEnabled_)
+            AddReplicationStats(component->GetType(), msg_.GetPosition() - startPosition, serializeTimer.GetUSec(true));
     }
 
+    createNodeBytes_ += msg_.GetSize();
     SendMessage(MSG_CREATENODE, true, true, msg_);
 
     nodeState.markedDirty_ = false;
     sceneState_.dirtyNodes_.Erase(node->GetID());
 }
 
+void Connection::ProcessNewNodesWithBudget(unsigned budget)
+{
+    createNodeBytes_ = 0;
+
+    // Sort the new nodes by distance to the observer. Process the nodes the client already has first; they pull in any
+    // new nodes they depend on regardless of the budget
+    PODVector<unsigned> existingNodes;
+    newNodes_.Clear();
+    for (HashSet<unsigned>::ConstIterator i = nodesToProcess_.Begin(); i != nodesToProcess_.End(); ++i)
+    {
+        Node* node = sceneState_.nodeStates_.Contains(*i) ? nullptr : scene_->GetNode(*i);
+        if (node)
+            newNodes_.Push(MakePair((node->GetWorldPosition() - position_).LengthSquared(), *i));
+        else
+            existingNodes.Push(*i);
+    }
+
+    for (PODVector<unsigned>::ConstIterator i = existingNodes.Begin(); i != existingNodes.End(); ++i)
+        ProcessNode(*i);
+
+    Sort(newNodes_.Begin(), newNodes_.End());
+    for (PODVector<Pair<float, unsigned> >::ConstIterator i = newNodes_.Begin(); i != newNodes_.End() &&
+        createNodeBytes_ < budget; ++i)
+        ProcessNode(i->second_);
+
+    // The nodes left over remain dirty and will be sent on the following updates
+    numPendingNodes_ = nodesToProcess_.Size();
+    nodesToProcess_.Clear();
+}
+
 void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState)
 {
     // Process depended upon nodes first, if they are dirty
@@ -1221,8 +1476,11 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             return;
     }
 
+    // Acknowledge the client's controls with the state of its own node, even if unchanged
+    bool sendControlsAck = controlsAckDue_ && node->GetOwner() == this;
+
     // Check if attributes have changed
-    if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size())
+    if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size() || sendControlsAck)
     {
         const Vector<AttributeInfo>* attributes = node->GetNetworkAttributes();
         unsigned numAttributes = attributes->Size();
@@ -1238,11 +1496,16 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         }
 
         // Send latestdata message if necessary
-        if (hasLatestData)
+        if (hasLatestData || sendControlsAck)
         {
+            HiresTimer serializeTimer;
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
             node->WriteLatestDataUpdate(msg_, timeStamp_);
+            if (sendControlsAck)
+                WriteControlsAck(nodeState);
+            if (statisticsEnabled_)
+                AddReplicationStats(Node::GetTypeStatic(), msg_.GetSize(), serializeTimer.GetUSec(false));
 
             SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
         }
@@ -1250,6 +1513,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         // Send deltaupdate if remaining dirty bits, or vars have changed
         if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size())
         {
+            HiresTimer serializeTimer;
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
             node->WriteDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_);
@@ -1273,6 +1537,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     msg_.WriteVariant(Variant::EMPTY);
                 }
             }
+            if (statisticsEnabled_)
+                AddReplicationStats(Node::GetTypeStatic(), msg_.GetSize(), serializeTimer.GetUSec(false));
 
             SendMessage(MSG_NODEDELTAUPDATE, true, true, msg_);
 
@@ -1318,9 +1584,12 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 // Send latestdata message if necessary
                 if (hasLatestData)
                 {
+                    HiresTimer serializeTimer;
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
                     component->WriteLatestDataUpdate(msg_, timeStamp_);
+                    if (statisticsEnabled_)
+                        AddReplicationStats(component->GetType(), msg_.GetSize(), serializeTimer.GetUSec(false));
 
                     SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
                 }
@@ -1328,9 +1597,12 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 // Send deltaupdate if remaining dirty bits
                 if (componentState.dirtyAttributes_.Count())
                 {
+                    HiresTimer serializeTimer;
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
                     component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_);
+                    if (statisticsEnabled_)
+                        AddReplicationStats(component->GetType(), msg_.GetSize(), serializeTimer.GetUSec(false));
 
                     SendMessage(MSG_COMPONENTDELTAUPDATE, true, true, msg_);
 
@@ -1361,11 +1633,14 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 componentState.component_ = component;
                 component->AddReplicationState(&componentState);
 
+                HiresTimer serializeTimer;
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
                 msg_.WriteStringHash(component->GetType());
                 msg_.WriteNetID(component->GetID());
                 component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+                if (statisticsEnabled_)
+                    AddReplicationStats(component->GetType(), msg_.GetSize(), serializeTimer.GetUSec(false));
 
                 SendMessage(MSG_CREATECOMPONENT, true, true, msg_);
             }
@@ -1376,6 +1651,54 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     sceneState_.dirtyNodes_.Erase(node->GetID());
 }
 
+void Connection::WriteControlsAck(NodeReplicationState& nodeState)
+{
+    msg_.WriteUInt(controlsSequence_);
+
+    // Write also the latest data of the node's components, for example rigid body velocities, so that the whole state
+    // simulated with the acknowledged controls arrives at once. Their own latest data messages are then not sent
+    unsigned numComponents = 0;
+    for (HashMap<unsigned, ComponentReplicationState>::ConstIterator i = nodeState.componentStates_.Begin();
+         i != nodeState.componentStates_.End(); ++i)
+    {
+        if (i->second_.component_ && HasLatestDataAttributes(i->second_.component_))
+            ++numComponents;
+    }
+
+    msg_.WriteVLE(numComponents);
+    for (HashMap<unsigned, ComponentReplicationState>::Iterator i = nodeState.componentStates_.Begin();
+         i != nodeState.componentStates_.End(); ++i)
+    {
+        ComponentReplicationState& componentState = i->second_;
+        Component* component = componentState.component_;
+        if (!component || !HasLatestDataAttributes(component))
+            continue;
+
+        componentMsg_.Clear();
+        componentMsg_.WriteNetID(component->GetID());
+        component->WriteLatestDataUpdate(componentMsg_, timeStamp_);
+        msg_.WriteBuffer(componentMsg_.GetBuffer());
+
+        const Vector<AttributeInfo>* attributes = component->GetNetworkAttributes();
+        for (unsigned j = 0; j < attributes->Size(); ++j)
+        {
+            if (attributes->At(j).mode_ & AM_LATESTDATA)
+                componentState.dirtyAttributes_.Clear(j);
+        }
+    }
+
+    ackedControlsSequence_ = controlsSequence_;
+}
+
+void Connection::AddReplicationStats(StringHash type, unsigned bytes, long long serializeTime)
+{
+    NetworkTrafficStats& stats = replicationStats_[type];
+    ++stats.messagesOut_;
+    stats.bytesOut_ += bytes;
+    stats.serializeTime_ += serializeTime;
+    totalStats_.serializeTime_ += serializeTime;
+}
+
 bool Connection::RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg)
 {
     auto* cache = GetSubsystem<ResourceCache>();
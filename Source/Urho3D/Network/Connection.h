@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Container/List.h"
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
 #include "../Input/Controls.h"
@@ -93,6 +94,41 @@ struct PackageUpload
     unsigned totalFragments_;
 };
 
+/// Client controls update stored for client-side prediction replay.
+struct ControlsRecord
+{
+    /// Controls sequence number.
+    unsigned sequence_;
+    /// Elapsed time on the client when the controls were sent.
+    float time_;
+    /// Controls.
+    Controls controls_;
+};
+
+/// Scene update message deferred on the client to spread node creation over several frames.
+struct PendingSceneUpdate
+{
+    /// Message ID.
+    int msgID_;
+    /// Message data.
+    PODVector<unsigned char> data_;
+};
+
+/// %Network traffic and serialization cost counters for a message type or a replicated object type.
+struct NetworkTrafficStats
+{
+    /// Number of messages sent.
+    unsigned messagesOut_{};
+    /// Number of messages received.
+    unsigned messagesIn_{};
+    /// Bytes sent.
+    unsigned long long bytesOut_{};
+    /// Bytes received.
+    unsigned long long bytesIn_{};
+    /// Accumulated serialization time in microseconds.
+    long long serializeTime_{};
+};
+
 /// Send modes for observer position/rotation. Activated by the client setting either position or rotation.
 enum ObserverPositionSendMode
 {
@@ -134,6 +170,10 @@ public:
     void SetConnectPending(bool connectPending);
     /// Set whether to log data in/out statistics.
     void SetLogStatistics(bool enable);
+    /// Set whether to collect per message type and per replicated object type traffic statistics. Called by Network.
+    void SetStatisticsEnabled(bool enable);
+    /// Reset the collected traffic statistics.
+    void ResetStatistics();
     /// Disconnect. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
     /// Send scene update messages. Called by Network.
@@ -146,6 +186,12 @@ public:
     void SendPackages();
     /// Process pending latest data for nodes and components.
     void ProcessPendingLatestData();
+    /// Process scene update messages deferred by the node creation time budget. Called by Network.
+    void ProcessPendingSceneUpdates();
+    /// Send the controls acknowledged event if the server has acknowledged new controls since last call. Called by Network.
+    void ProcessPendingControlsAck();
+    /// Set maximum number of unacknowledged controls updates to keep for client-side prediction replay. Default 64.
+    void SetMaxControlsHistory(unsigned num);
     /// Process a message from the server or client. Called by Network.
     bool ProcessMessage(int msgID, MemoryBuffer& msg);
 
@@ -164,6 +210,18 @@ public:
     /// Return the controls timestamp, sent from client to server along each control update.
     unsigned char GetTimeStamp() const { return timeStamp_; }
 
+    /// Return the sequence number of the latest controls update sent (on the client) or received (on the server).
+    unsigned GetControlsSequence() const { return controlsSequence_; }
+
+    /// Return the sequence number of the latest controls update acknowledged by the server (on the client) or to the client (on the server).
+    unsigned GetAckedControlsSequence() const { return ackedControlsSequence_; }
+
+    /// Return sent controls updates not yet acknowledged by the server, oldest first. Client only.
+    const Vector<ControlsRecord>& GetControlsHistory() const { return controlsHistory_; }
+
+    /// Return maximum number of unacknowledged controls updates to keep for client-side prediction replay.
+    unsigned GetMaxControlsHistory() const { return maxControlsHistory_; }
+
     /// Return the observer position sent by the client for interest management.
     const Vector3& GetPosition() const { return position_; }
 
@@ -182,9 +240,27 @@ public:
     /// Return whether the scene is loaded and ready to receive server updates.
     bool IsSceneLoaded() const { return sceneLoaded_; }
 
+    /// Return number of new nodes not yet sent to the client due to the node creation budget. Server only.
+    unsigned GetNumPendingNodes() const { return numPendingNodes_; }
+
+    /// Return number of received scene update messages not yet processed due to the node creation time budget. Client only.
+    unsigned GetNumPendingSceneUpdates() const { return pendingSceneUpdates_.Size(); }
+
     /// Return whether to log data in/out statistics.
     bool GetLogStatistics() const { return logStatistics_; }
 
+    /// Return whether collects traffic statistics.
+    bool GetStatisticsEnabled() const { return statisticsEnabled_; }
+
+    /// Return total traffic statistics.
+    const NetworkTrafficStats& GetTotalStats() const { return totalStats_; }
+
+    /// Return traffic statistics by message ID.
+    const HashMap<int, NetworkTrafficStats>& GetMessageStats() const { return messageStats_; }
+
+    /// Return sent replication traffic statistics by node or component type. Server only.
+    const HashMap<StringHash, NetworkTrafficStats>& GetReplicationStats() const { return replicationStats_; }
+
     /// Return remote address.
     String GetAddress() const { return address_; }
 
@@ -245,6 +321,10 @@ private:
     void ProcessIdentity(int msgID, MemoryBuffer& msg);
     /// Process a Controls message from the client. Called by Network.
     void ProcessControls(int msgID, MemoryBuffer& msg);
+    /// Process a controls acknowledgement received from the server with the latest data of an owned node.
+    void ProcessControlsAck(unsigned sequence);
+    /// Process the latest data of a component received from the server, or store it until the component has been created.
+    void ProcessComponentLatestData(MemoryBuffer& msg);
     /// Process a SceneLoaded message from the client. Called by Network.
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
@@ -255,6 +335,12 @@ private:
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Write the controls acknowledgement and the latest data of the components after an owned node's latest data.
+    void WriteControlsAck(NodeReplicationState& nodeState);
+    /// Send new nodes nearest-first until the node creation budget is used up.
+    void ProcessNewNodesWithBudget(unsigned budget);
+    /// Add sent replication statistics for a node or component type.
+    void AddReplicationStats(StringHash type, unsigned bytes, long long serializeTime);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set)
@@ -286,10 +372,24 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     HashSet<unsigned> nodesToProcess_;
+    /// New nodes sorted by distance to the observer during a budgeted replication update.
+    PODVector<Pair<float, unsigned> > newNodes_;
+    /// Scene update messages deferred by the node creation time budget.
+    List<PendingSceneUpdate> pendingSceneUpdates_;
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Reusable buffer for the latest data of a component sent with a controls acknowledgement.
+    VectorBuffer componentMsg_;
     /// Queued remote events.
     Vector<RemoteEvent> remoteEvents_;
+    /// Sent controls updates not yet acknowledged by the server.
+    Vector<ControlsRecord> controlsHistory_;
+    /// Traffic statistics by message ID.
+    HashMap<int, NetworkTrafficStats> messageStats_;
+    /// Sent replication traffic statistics by node or component type.
+    HashMap<StringHash, NetworkTrafficStats> replicationStats_;
+    /// Total traffic statistics.
+    NetworkTrafficStats totalStats_;
     /// Scene file to load once all packages (if any) have been downloaded.
     String sceneFileName_;
     /// Statistics timer.
@@ -304,6 +404,22 @@ private:
     Quaternion rotation_;
     /// Send mode for the observer position & rotation.
     ObserverPositionSendMode sendMode_;
+    /// Latest sent or received controls sequence number.
+    unsigned controlsSequence_;
+    /// Latest controls sequence number acknowledged by the server, or to the client on the server.
+    unsigned ackedControlsSequence_;
+    /// Maximum number of unacknowledged controls updates to keep.
+    unsigned maxControlsHistory_;
+    /// Bytes of node creation messages sent during the current replication update.
+    unsigned createNodeBytes_;
+    /// Number of new nodes not yet sent to the client.
+    unsigned numPendingNodes_;
+    /// Controls acknowledgement received and not yet processed flag.
+    bool controlsAckPending_;
+    /// Controls acknowledgement to be sent with the owned nodes during the current replication update flag. Server only.
+    bool controlsAckDue_;
+    /// Send controls with sequence numbers flag. Client only.
+    bool sequencedControls_;
     /// Client connection flag.
     bool isClient_;
     /// Connection pending flag.
@@ -312,6 +428,8 @@ private:
     bool sceneLoaded_;
     /// Show statistics flag.
     bool logStatistics_;
+    /// Collect traffic statistics flag.
+    bool statisticsEnabled_;
 };
 
 }
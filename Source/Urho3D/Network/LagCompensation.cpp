@@ -0,0 +1,477 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Container/Sort.h"
+#include "../Network/Connection.h"
+#include "../Network/LagCompensation.h"
+#ifdef URHO3D_PHYSICS
+#include "../Physics/CollisionShape.h"
+#include "../Physics/PhysicsUtils.h"
+#include "../Physics/PhysicsWorld.h"
+#include "../Physics/RigidBody.h"
+#endif
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#ifdef URHO3D_PHYSICS
+#include <Bullet/BulletCollision/CollisionShapes/btCollisionShape.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* NETWORK_CATEGORY;
+
+static const unsigned DEFAULT_HISTORY_SIZE = 64;
+
+static bool CompareRaycastResults(const LagCompensationRaycastResult& lhs, const LagCompensationRaycastResult& rhs)
+{
+    return lhs.distance_ < rhs.distance_;
+}
+
+static float HitDistance(const Ray& ray, const LagCompensationHitbox& hitbox, Vector3& normal)
+{
+    if (hitbox.sphere_)
+    {
+        float distance = ray.HitDistance(Sphere(hitbox.position_, hitbox.halfSize_.x_));
+        if (distance < M_INFINITY)
+        {
+            normal = ray.origin_ + distance * ray.direction_ - hitbox.position_;
+            normal = normal == Vector3::ZERO ? -ray.direction_ : normal.Normalized();
+        }
+        return distance;
+    }
+
+    // Test the box in its local space
+    Quaternion inverse = hitbox.rotation_.Inverse();
+    Ray localRay(inverse * (ray.origin_ - hitbox.position_), inverse * ray.direction_);
+    float distance = localRay.HitDistance(BoundingBox(-hitbox.halfSize_, hitbox.halfSize_));
+    if (distance < M_INFINITY)
+    {
+        if (distance == 0.0f)
+            normal = -ray.direction_;
+        else
+        {
+            // The hit face is the one along the axis where the hit point is relatively furthest from the center
+            Vector3 localHit = localRay.origin_ + distance * localRay.direction_;
+            Vector3 relative = localHit / hitbox.halfSize_;
+            Vector3 absRelative = relative.Abs();
+            Vector3 localNormal;
+            if (absRelative.x_ >= absRelative.y_ && absRelative.x_ >= absRelative.z_)
+                localNormal = relative.x_ >= 0.0f ? Vector3::RIGHT : Vector3::LEFT;
+            else if (absRelative.y_ >= absRelative.z_)
+                localNormal = relative.y_ >= 0.0f ? Vector3::UP : Vector3::DOWN;
+            else
+                localNormal = relative.z_ >= 0.0f ? Vector3::FORWARD : Vector3::BACK;
+            normal = hitbox.rotation_ * localNormal;
+        }
+    }
+    return distance;
+}
+
+static bool IsInside(const Sphere& sphere, const LagCompensationHitbox& hitbox)
+{
+    if (hitbox.sphere_)
+        return (sphere.center_ - hitbox.position_).LengthSquared() <= (sphere.radius_ + hitbox.radius_) * (sphere.radius_ + hitbox.radius_);
+
+    // Find the closest point of the box to the sphere center in the box's local space
+    Vector3 localCenter = hitbox.rotation_.Inverse() * (sphere.center_ - hitbox.position_);
+    Vector3 closest(Clamp(localCenter.x_, -hitbox.halfSize_.x_, hitbox.halfSize_.x_),
+        Clamp(localCenter.y_, -hitbox.halfSize_.y_, hitbox.halfSize_.y_),
+        Clamp(localCenter.z_, -hitbox.halfSize_.z_, hitbox.halfSize_.z_));
+    return (localCenter - closest).LengthSquared() <= sphere.radius_ * sphere.radius_;
+}
+
+LagCompensation::LagCompensation(Context* context) :
+    Component(context),
+    head_(0),
+    numSnapshots_(0),
+    interpolationDelay_(0.0f),
+    rewoundTime_(0.0f),
+    rewoundDirty_(true)
+{
+    snapshots_.Resize(DEFAULT_HISTORY_SIZE);
+}
+
+LagCompensation::~LagCompensation() = default;
+
+void LagCompensation::RegisterObject(Context* context)
+{
+    context->RegisterFactory<LagCompensation>(NETWORK_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("History Size", GetHistorySize, SetHistorySize, unsigned, DEFAULT_HISTORY_SIZE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Interpolation Delay", GetInterpolationDelay, SetInterpolationDelay, float, 0.0f, AM_DEFAULT);
+}
+
+void LagCompensation::SetHistorySize(unsigned size)
+{
+    size = Max(size, 2U);
+    if (size == snapshots_.Size())
+        return;
+
+    snapshots_.Clear();
+    snapshots_.Resize(size);
+    head_ = 0;
+    numSnapshots_ = 0;
+    rewoundDirty_ = true;
+}
+
+void LagCompensation::SetInterpolationDelay(float delay)
+{
+    interpolationDelay_ = Max(delay, 0.0f);
+}
+
+void LagCompensation::AddNode(Node* node, const BoundingBox& hitbox)
+{
+    if (!node)
+        return;
+
+    for (Vector<TrackedNode>::Iterator i = trackedNodes_.Begin(); i != trackedNodes_.End(); ++i)
+    {
+        if (i->node_ == node)
+        {
+            i->hitbox_ = hitbox;
+            return;
+        }
+    }
+
+    TrackedNode tracked;
+    tracked.node_ = node;
+    tracked.hitbox_ = hitbox;
+    trackedNodes_.Push(tracked);
+}
+
+void LagCompensation::RemoveNode(Node* node)
+{
+    for (Vector<TrackedNode>::Iterator i = trackedNodes_.Begin(); i != trackedNodes_.End(); ++i)
+    {
+        if (i->node_ == node)
+        {
+            trackedNodes_.Erase(i);
+            return;
+        }
+    }
+}
+
+void LagCompensation::Clear()
+{
+    trackedNodes_.Clear();
+    for (unsigned i = 0; i < snapshots_.Size(); ++i)
+        snapshots_[i].hitboxes_.Clear();
+    head_ = 0;
+    numSnapshots_ = 0;
+    rewoundDirty_ = true;
+}
+
+void LagCompensation::Record()
+{
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    URHO3D_PROFILE(RecordLagCompensation);
+
+    // Overwrite the oldest snapshot, reusing its hitbox storage
+    head_ = (head_ + 1) % snapshots_.Size();
+    numSnapshots_ = Min(numSnapshots_ + 1, snapshots_.Size());
+    LagCompensationSnapshot& snapshot = snapshots_[head_];
+    snapshot.time_ = scene->GetElapsedTime();
+    snapshot.hitboxes_.Clear();
+    rewoundDirty_ = true;
+
+#ifdef URHO3D_PHYSICS
+    PODVector<CollisionShape*> shapes;
+#endif
+
+    for (unsigned i = 0; i < trackedNodes_.Size();)
+    {
+        Node* node = trackedNodes_[i].node_;
+        if (!node)
+        {
+            trackedNodes_.Erase(i);
+            continue;
+        }
+
+        const BoundingBox& box = trackedNodes_[i].hitbox_;
+        ++i;
+        if (!node->IsEnabled())
+            continue;
+
+        LagCompensationHitbox hitbox;
+        hitbox.nodeID_ = node->GetID();
+        hitbox.sphere_ = false;
+
+        if (box.Defined())
+        {
+            hitbox.index_ = 0;
+            hitbox.position_ = node->GetWorldTransform() * box.Center();
+            hitbox.rotation_ = node->GetWorldRotation();
+            hitbox.halfSize_ = box.HalfSize() * node->GetWorldScale();
+            hitbox.radius_ = hitbox.halfSize_.Length();
+            snapshot.hitboxes_.Push(hitbox);
+        }
+#ifdef URHO3D_PHYSICS
+        else
+        {
+            node->GetComponents<CollisionShape>(shapes);
+            if (shapes.Empty())
+                continue;
+
+            // Use the rigid body's world transform if possible, as it may be different from the rendering transform
+            auto* body = node->GetComponent<RigidBody>();
+            Matrix3x4 worldTransform = body ? Matrix3x4(body->GetPosition(), body->GetRotation(), node->GetWorldScale()) :
+                node->GetWorldTransform();
+            Quaternion worldRotation = worldTransform.Rotation();
+
+            for (unsigned j = 0; j < shapes.Size(); ++j)
+            {
+                CollisionShape* shape = shapes[j];
+                btCollisionShape* btShape = shape->GetCollisionShape();
+                ShapeType type = shape->GetShapeType();
+                // Infinite or terrain shapes are not meaningful as hitboxes
+                if (!btShape || !shape->IsEnabledEffective() || type == SHAPE_STATICPLANE || type == SHAPE_TERRAIN)
+                    continue;
+
+                // The shape's local bounds include its size and the node scale
+                btVector3 aabbMin, aabbMax;
+                btShape->getAabb(btTransform::getIdentity(), aabbMin, aabbMax);
+                Vector3 center = ToVector3((aabbMin + aabbMax) * 0.5f);
+
+                hitbox.index_ = j;
+                hitbox.rotation_ = worldRotation * shape->GetRotation();
+                hitbox.position_ = worldTransform * shape->GetPosition() + hitbox.rotation_ * center;
+                hitbox.halfSize_ = ToVector3((aabbMax - aabbMin) * 0.5f);
+                hitbox.sphere_ = type == SHAPE_SPHERE;
+                if (hitbox.sphere_)
+                    hitbox.halfSize_.x_ = Max(Max(hitbox.halfSize_.x_, hitbox.halfSize_.y_), hitbox.halfSize_.z_);
+                hitbox.radius_ = hitbox.sphere_ ? hitbox.halfSize_.x_ : hitbox.halfSize_.Length();
+                snapshot.hitboxes_.Push(hitbox);
+            }
+        }
+#endif
+    }
+}
+
+void LagCompensation::Raycast(PODVector<LagCompensationRaycastResult>& result, const Ray& ray, float maxDistance, float time,
+    unsigned occluderMask)
+{
+    URHO3D_PROFILE(LagCompensationRaycast);
+
+    result.Clear();
+
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+#ifdef URHO3D_PHYSICS
+    auto* physicsWorld = occluderMask ? scene->GetComponent<PhysicsWorld>() : nullptr;
+    if (physicsWorld)
+    {
+        PhysicsRaycastResult occluderResult;
+        physicsWorld->RaycastSingle(occluderResult, ray, maxDistance, occluderMask);
+        if (occluderResult.body_)
+            maxDistance = occluderResult.distance_;
+    }
+#endif
+
+    const PODVector<LagCompensationHitbox>& hitboxes = GetHitboxes(time);
+    for (PODVector<LagCompensationHitbox>::ConstIterator i = hitboxes.Begin(); i != hitboxes.End(); ++i)
+    {
+        if (ray.HitDistance(Sphere(i->position_, i->radius_)) >= maxDistance)
+            continue;
+
+        Vector3 normal;
+        float distance = HitDistance(ray, *i, normal);
+        if (distance < maxDistance)
+        {
+            LagCompensationRaycastResult newResult;
+            newResult.position_ = ray.origin_ + distance * ray.direction_;
+            newResult.normal_ = normal;
+            newResult.distance_ = distance;
+            newResult.node_ = scene->GetNode(i->nodeID_);
+            newResult.hitbox_ = i->index_;
+            result.Push(newResult);
+        }
+    }
+
+    Sort(result.Begin(), result.End(), CompareRaycastResults);
+}
+
+void LagCompensation::RaycastSingle(LagCompensationRaycastResult& result, const Ray& ray, float maxDistance, float time,
+    unsigned occluderMask)
+{
+    URHO3D_PROFILE(LagCompensationRaycastSingle);
+
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.node_ = nullptr;
+    result.hitbox_ = 0;
+
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+#ifdef URHO3D_PHYSICS
+    auto* physicsWorld = occluderMask ? scene->GetComponent<PhysicsWorld>() : nullptr;
+    if (physicsWorld)
+    {
+        PhysicsRaycastResult occluderResult;
+        physicsWorld->RaycastSingle(occluderResult, ray, maxDistance, occluderMask);
+        if (occluderResult.body_)
+            maxDistance = occluderResult.distance_;
+    }
+#endif
+
+    const PODVector<LagCompensationHitbox>& hitboxes = GetHitboxes(time);
+    const LagCompensationHitbox* closest = nullptr;
+    for (PODVector<LagCompensationHitbox>::ConstIterator i = hitboxes.Begin(); i != hitboxes.End(); ++i)
+    {
+        // Shrinking the max distance allows rejecting the further hitboxes by their bounding sphere only
+        if (ray.HitDistance(Sphere(i->position_, i->radius_)) >= maxDistance)
+            continue;
+
+        Vector3 normal;
+        float distance = HitDistance(ray, *i, normal);
+        if (distance < maxDistance)
+        {
+            maxDistance = distance;
+            closest = &(*i);
+            result.normal_ = normal;
+        }
+    }
+
+    if (closest)
+    {
+        result.position_ = ray.origin_ + maxDistance * ray.direction_;
+        result.distance_ = maxDistance;
+        result.node_ = scene->GetNode(closest->nodeID_);
+        result.hitbox_ = closest->index_;
+    }
+}
+
+void LagCompensation::GetNodes(PODVector<Node*>& result, const Sphere& sphere, float time)
+{
+    URHO3D_PROFILE(LagCompensationSphereQuery);
+
+    result.Clear();
+
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    const PODVector<LagCompensationHitbox>& hitboxes = GetHitboxes(time);
+    unsigned lastNodeID = 0;
+    for (PODVector<LagCompensationHitbox>::ConstIterator i = hitboxes.Begin(); i != hitboxes.End(); ++i)
+    {
+        // The hitboxes of a node are consecutive, so it is enough to check the previous found node for duplicates
+        if (i->nodeID_ == lastNodeID || !IsInside(sphere, *i))
+            continue;
+
+        lastNodeID = i->nodeID_;
+        Node* node = scene->GetNode(i->nodeID_);
+        if (node)
+            result.Push(node);
+    }
+}
+
+const PODVector<LagCompensationHitbox>& LagCompensation::GetHitboxes(float time)
+{
+    if (!rewoundDirty_ && time == rewoundTime_)
+        return rewoundHitboxes_;
+
+    rewoundTime_ = time;
+    rewoundDirty_ = false;
+    rewoundHitboxes_.Clear();
+    if (!numSnapshots_)
+        return rewoundHitboxes_;
+
+    // Find the newest snapshot that is not newer than the time, clamping to the oldest
+    unsigned age = 0;
+    while (age + 1 < numSnapshots_ && GetSnapshot(age).time_ > time)
+        ++age;
+
+    const LagCompensationSnapshot& older = GetSnapshot(age);
+    rewoundHitboxes_ = older.hitboxes_;
+    if (!age || older.time_ >= time)
+        return rewoundHitboxes_;
+
+    const LagCompensationSnapshot& newer = GetSnapshot(age - 1);
+    float t = (time - older.time_) / (newer.time_ - older.time_);
+
+    // Interpolate the hitboxes that exist in both snapshots. Unless nodes have been added or removed, they are in the same order
+    for (unsigned i = 0; i < rewoundHitboxes_.Size() && i < newer.hitboxes_.Size(); ++i)
+    {
+        LagCompensationHitbox& hitbox = rewoundHitboxes_[i];
+        const LagCompensationHitbox& next = newer.hitboxes_[i];
+        if (hitbox.nodeID_ != next.nodeID_ || hitbox.index_ != next.index_)
+            break;
+
+        hitbox.position_ = hitbox.position_.Lerp(next.position_, t);
+        hitbox.rotation_ = hitbox.rotation_.Slerp(next.rotation_, t);
+    }
+
+    return rewoundHitboxes_;
+}
+
+float LagCompensation::GetOldestTime() const
+{
+    return numSnapshots_ ? GetSnapshot(numSnapshots_ - 1).time_ : 0.0f;
+}
+
+float LagCompensation::GetNewestTime() const
+{
+    return numSnapshots_ ? GetSnapshot(0).time_ : 0.0f;
+}
+
+float LagCompensation::GetRewindTime(Connection* connection) const
+{
+    if (!connection)
+        return GetNewestTime();
+
+    // The client saw the world delayed by the one-way latency and its own interpolation, and its action took another one-way
+    // latency to arrive. The round trip time is in milliseconds
+    return GetNewestTime() - connection->GetRoundTripTime() * 0.001f - interpolationDelay_;
+}
+
+void LagCompensation::OnSceneSet(Scene* scene)
+{
+    if (scene)
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LagCompensation, HandleScenePostUpdate));
+    else
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+}
+
+void LagCompensation::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (IsEnabledEffective())
+        Record();
+}
+
+}
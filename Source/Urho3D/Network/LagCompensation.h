@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Math/BoundingBox.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Ray.h"
+#include "../Math/Sphere.h"
+#include "../Scene/Component.h"
+
+namespace Urho3D
+{
+
+class Connection;
+
+/// Recorded hitbox pose.
+struct LagCompensationHitbox
+{
+    /// Node ID.
+    unsigned nodeID_;
+    /// Index of the hitbox within the node.
+    unsigned index_;
+    /// World position of the hitbox center.
+    Vector3 position_;
+    /// World rotation.
+    Quaternion rotation_;
+    /// World half size. For a sphere, the radius is stored in the x component.
+    Vector3 halfSize_;
+    /// Bounding sphere radius for early rejection.
+    float radius_;
+    /// Sphere flag.
+    bool sphere_;
+};
+
+/// Recorded hitbox poses at one point in time.
+struct LagCompensationSnapshot
+{
+    /// Scene elapsed time.
+    float time_;
+    /// Hitboxes.
+    PODVector<LagCompensationHitbox> hitboxes_;
+};
+
+/// Lag compensation raycast hit.
+struct URHO3D_API LagCompensationRaycastResult
+{
+    /// Hit worldspace position.
+    Vector3 position_;
+    /// Hit worldspace normal.
+    Vector3 normal_;
+    /// Hit distance from ray origin.
+    float distance_{};
+    /// Scene node that was hit. Null if the node has since been removed.
+    Node* node_{};
+    /// Index of the hitbox within the node.
+    unsigned hitbox_{};
+};
+
+/// %Scene component that records the hitboxes of tracked nodes and answers queries against the world as it was at an earlier time. Create into the scene on the server.
+class URHO3D_API LagCompensation : public Component
+{
+    URHO3D_OBJECT(LagCompensation, Component);
+
+public:
+    /// Construct.
+    explicit LagCompensation(Context* context);
+    /// Destruct.
+    ~LagCompensation() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set number of recorded snapshots. One snapshot is recorded per scene update. Default 64.
+    void SetHistorySize(unsigned size);
+    /// Set client view interpolation delay in seconds, added to the round trip time when calculating the rewind time. Default 0.
+    void SetInterpolationDelay(float delay);
+    /// Start tracking a node. The hitbox is in the node's local space. If it is undefined, the node's collision shapes are used as hitboxes.
+    void AddNode(Node* node, const BoundingBox& hitbox = BoundingBox());
+    /// Stop tracking a node. Its already recorded hitboxes remain in the history.
+    void RemoveNode(Node* node);
+    /// Stop tracking all nodes and clear the history.
+    void Clear();
+    /// Record the current hitboxes of the tracked nodes. Called automatically on scene post-update.
+    void Record();
+
+    /// Perform a raycast against the hitboxes at the given time and return all hits sorted by distance. If the occluder collision mask is nonzero, the ray is first clipped against the live physics world.
+    void Raycast(PODVector<LagCompensationRaycastResult>& result, const Ray& ray, float maxDistance, float time, unsigned occluderMask = 0);
+    /// Perform a raycast against the hitboxes at the given time and return the closest hit. If the occluder collision mask is nonzero, the ray is first clipped against the live physics world.
+    void RaycastSingle(LagCompensationRaycastResult& result, const Ray& ray, float maxDistance, float time, unsigned occluderMask = 0);
+    /// Return the nodes whose hitboxes intersect a sphere at the given time.
+    void GetNodes(PODVector<Node*>& result, const Sphere& sphere, float time);
+    /// Return the hitboxes interpolated to the given time.
+    const PODVector<LagCompensationHitbox>& GetHitboxes(float time);
+
+    /// Return number of recorded snapshots.
+    unsigned GetHistorySize() const { return snapshots_.Size(); }
+
+    /// Return client view interpolation delay.
+    float GetInterpolationDelay() const { return interpolationDelay_; }
+
+    /// Return number of tracked nodes.
+    unsigned GetNumNodes() const { return trackedNodes_.Size(); }
+
+    /// Return time of the oldest recorded snapshot.
+    float GetOldestTime() const;
+    /// Return time of the newest recorded snapshot.
+    float GetNewestTime() const;
+    /// Return the time the world should be rewound to for queries on behalf of a client connection.
+    float GetRewindTime(Connection* connection) const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Tracked node.
+    struct TrackedNode
+    {
+        /// Node.
+        WeakPtr<Node> node_;
+        /// Local space hitbox. Undefined to use collision shapes.
+        BoundingBox hitbox_;
+    };
+
+    /// Return snapshot by age, 0 being the newest.
+    const LagCompensationSnapshot& GetSnapshot(unsigned age) const { return snapshots_[(head_ + snapshots_.Size() - age) % snapshots_.Size()]; }
+    /// Handle scene post-update.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Tracked nodes.
+    Vector<TrackedNode> trackedNodes_;
+    /// Snapshot ring buffer.
+    Vector<LagCompensationSnapshot> snapshots_;
+    /// Hitboxes interpolated for the latest query time.
+    PODVector<LagCompensationHitbox> rewoundHitboxes_;
+    /// Index of the newest snapshot.
+    unsigned head_;
+    /// Number of recorded snapshots.
+    unsigned numSnapshots_;
+    /// Client view interpolation delay.
+    float interpolationDelay_;
+    /// Time of the interpolated hitboxes.
+    float rewoundTime_;
+    /// Interpolated hitboxes valid flag.
+    bool rewoundDirty_;
+};
+
+}
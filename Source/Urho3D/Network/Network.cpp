@@ -26,12 +26,16 @@
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Engine/EngineEvents.h"
+#include "../Container/Sort.h"
+#include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
+#include "../Network/ClientPrediction.h"
 #include "../Network/HttpRequest.h"
+#include "../Network/LagCompensation.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
 #include "../Network/NetworkPriority.h"
@@ -40,6 +44,8 @@
 
 #include <kNet/kNet.h>
 
+#include <cstdio>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -47,13 +53,72 @@ namespace Urho3D
 
 static const int DEFAULT_UPDATE_FPS = 30;
 
+static const char* messageNames[] =
+{
+    "Identity",
+    "Controls",
+    "SceneLoaded",
+    "RequestPackage",
+    "PackageData",
+    "LoadScene",
+    "SceneChecksumError",
+    "CreateNode",
+    "NodeDeltaUpdate",
+    "NodeLatestData",
+    "RemoveNode",
+    "CreateComponent",
+    "ComponentDeltaUpdate",
+    "ComponentLatestData",
+    "RemoveComponent",
+    "RemoteEvent",
+    "RemoteNodeEvent",
+    "PackageInfo",
+    "SequencedControls"
+};
+
+static String GetMessageName(int msgID)
+{
+    if (msgID >= MSG_IDENTITY && msgID <= MSG_SEQUENCEDCONTROLS)
+        return messageNames[msgID - MSG_IDENTITY];
+    else
+        return "Custom " + String(msgID);
+}
+
+template <class T> static bool CompareTrafficStats(const Pair<T, NetworkTrafficStats>& lhs, const Pair<T, NetworkTrafficStats>& rhs)
+{
+    return lhs.second_.bytesOut_ + lhs.second_.bytesIn_ > rhs.second_.bytesOut_ + rhs.second_.bytesIn_;
+}
+
+static void AddTrafficStats(NetworkTrafficStats& dest, const NetworkTrafficStats& src)
+{
+    dest.messagesOut_ += src.messagesOut_;
+    dest.messagesIn_ += src.messagesIn_;
+    dest.bytesOut_ += src.bytesOut_;
+    dest.bytesIn_ += src.bytesIn_;
+    dest.serializeTime_ += src.serializeTime_;
+}
+
+static String FormatTrafficStats(const String& name, const NetworkTrafficStats& stats, float elapsed)
+{
+    char line[256];
+    sprintf(line, "%-24s %10u %12.1f %9.2f %10u %12.1f %9.2f %10.2f\n", name.Substring(0, 24).CString(), stats.messagesOut_,
+        stats.bytesOut_ / 1024.0, stats.bytesOut_ / 1024.0 / elapsed, stats.messagesIn_, stats.bytesIn_ / 1024.0,
+        stats.bytesIn_ / 1024.0 / elapsed, stats.serializeTime_ / 1000.0);
+    return String(line);
+}
+
 Network::Network(Context* context) :
     Object(context),
     updateFps_(DEFAULT_UPDATE_FPS),
     simulatedLatency_(0),
     simulatedPacketLoss_(0.0f),
+    createNodeBudget_(0),
+    createNodeTimeBudget_(0.0f),
     updateInterval_(1.0f / (float)DEFAULT_UPDATE_FPS),
-    updateAcc_(0.0f)
+    updateAcc_(0.0f),
+    messagesIn_(0),
+    bytesIn_(0),
+    statisticsEnabled_(false)
 {
     network_ = new kNet::Network();
 
@@ -105,6 +170,9 @@ Network::Network(Context* context) :
     blacklistedRemoteEvents_.Insert(E_NETWORKUPDATE);
     blacklistedRemoteEvents_.Insert(E_NETWORKUPDATESENT);
     blacklistedRemoteEvents_.Insert(E_NETWORKSCENELOADFAILED);
+    blacklistedRemoteEvents_.Insert(E_CONTROLSACKNOWLEDGED);
+    blacklistedRemoteEvents_.Insert(E_PREDICTIONREWIND);
+    blacklistedRemoteEvents_.Insert(E_PREDICTIONREPLAY);
 }
 
 Network::~Network()
@@ -123,6 +191,12 @@ void Network::HandleMessage(kNet::MessageConnection* source, kNet::packet_id_t p
     Connection* connection = GetConnection(source);
     if (connection)
     {
+        if (statisticsEnabled_)
+        {
+            ++messagesIn_;
+            bytesIn_ += numBytes;
+        }
+
         MemoryBuffer msg(data, (unsigned)numBytes);
         if (connection->ProcessMessage((int)msgId, msg))
             return;
@@ -145,6 +219,7 @@ u32 Network::ComputeContentID(kNet::message_id_t msgId, const char* data, size_t
     switch (msgId)
     {
     case MSG_CONTROLS:
+    case MSG_SEQUENCEDCONTROLS:
         // Return fixed content ID for controls
         return CONTROLS_CONTENT_ID;
 
@@ -169,6 +244,7 @@ void Network::NewConnectionEstablished(kNet::MessageConnection* connection)
     // Create a new client connection corresponding to this MessageConnection
     SharedPtr<Connection> newConnection(new Connection(context_, true, kNet::SharedPtr<kNet::MessageConnection>(connection)));
     newConnection->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+    newConnection->SetStatisticsEnabled(statisticsEnabled_);
     clientConnections_[connection] = newConnection;
     URHO3D_LOGINFO("Client " + newConnection->ToString() + " connected");
 
@@ -219,6 +295,7 @@ bool Network::Connect(const String& address, unsigned short port, Scene* scene,
         serverConnection_->SetIdentity(identity);
         serverConnection_->SetConnectPending(true);
         serverConnection_->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+        serverConnection_->SetStatisticsEnabled(statisticsEnabled_);
 
         URHO3D_LOGINFO("Connecting to server " + serverConnection_->ToString());
         return true;
@@ -351,6 +428,16 @@ void Network::SetSimulatedPacketLoss(float probability)
     ConfigureNetworkSimulator();
 }
 
+void Network::SetCreateNodeBudget(unsigned bytes)
+{
+    createNodeBudget_ = bytes;
+}
+
+void Network::SetCreateNodeTimeBudget(float ms)
+{
+    createNodeTimeBudget_ = Max(ms, 0.0f);
+}
+
 void Network::RegisterRemoteEvent(StringHash eventType)
 {
     if (blacklistedRemoteEvents_.Find(eventType) != blacklistedRemoteEvents_.End())
@@ -377,6 +464,35 @@ void Network::SetPackageCacheDir(const String& path)
     packageCacheDir_ = AddTrailingSlash(path);
 }
 
+void Network::SetStatisticsEnabled(bool enable)
+{
+    if (enable != statisticsEnabled_)
+    {
+        statisticsEnabled_ = enable;
+        if (serverConnection_)
+            serverConnection_->SetStatisticsEnabled(enable);
+        for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+             i != clientConnections_.End(); ++i)
+            i->second_->SetStatisticsEnabled(enable);
+
+        ResetStatistics();
+    }
+}
+
+void Network::ResetStatistics()
+{
+    if (serverConnection_)
+        serverConnection_->ResetStatistics();
+    for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+         i != clientConnections_.End(); ++i)
+        i->second_->ResetStatistics();
+
+    updateStats_ = NetworkUpdateStats();
+    messagesIn_ = 0;
+    bytesIn_ = 0;
+    statisticsTimer_.Reset();
+}
+
 void Network::SendPackageToClients(Scene* scene, PackageFile* package)
 {
     if (!scene)
@@ -447,6 +563,81 @@ bool Network::CheckRemoteEvent(StringHash eventType) const
     return allowedRemoteEvents_.Contains(eventType);
 }
 
+String Network::PrintStatistics() const
+{
+    Vector<SharedPtr<Connection> > connections = GetClientConnections();
+    if (serverConnection_)
+        connections.Push(serverConnection_);
+
+    // Combine the statistics from all connections
+    HashMap<int, NetworkTrafficStats> messageStats;
+    HashMap<StringHash, NetworkTrafficStats> replicationStats;
+    NetworkTrafficStats totalStats;
+    for (Vector<SharedPtr<Connection> >::ConstIterator i = connections.Begin(); i != connections.End(); ++i)
+    {
+        const HashMap<int, NetworkTrafficStats>& connMessageStats = (*i)->GetMessageStats();
+        for (HashMap<int, NetworkTrafficStats>::ConstIterator j = connMessageStats.Begin(); j != connMessageStats.End(); ++j)
+            AddTrafficStats(messageStats[j->first_], j->second_);
+        const HashMap<StringHash, NetworkTrafficStats>& connReplicationStats = (*i)->GetReplicationStats();
+        for (HashMap<StringHash, NetworkTrafficStats>::ConstIterator j = connReplicationStats.Begin(); j != connReplicationStats.End(); ++j)
+            AddTrafficStats(replicationStats[j->first_], j->second_);
+        AddTrafficStats(totalStats, (*i)->GetTotalStats());
+    }
+
+    // Sort the message and object types by total traffic
+    Vector<Pair<int, NetworkTrafficStats> > sortedMessageStats;
+    for (HashMap<int, NetworkTrafficStats>::ConstIterator i = messageStats.Begin(); i != messageStats.End(); ++i)
+        sortedMessageStats.Push(MakePair(i->first_, i->second_));
+    Sort(sortedMessageStats.Begin(), sortedMessageStats.End(), CompareTrafficStats<int>);
+    Vector<Pair<StringHash, NetworkTrafficStats> > sortedReplicationStats;
+    for (HashMap<StringHash, NetworkTrafficStats>::ConstIterator i = replicationStats.Begin(); i != replicationStats.End(); ++i)
+        sortedReplicationStats.Push(MakePair(i->first_, i->second_));
+    Sort(sortedReplicationStats.Begin(), sortedReplicationStats.End(), CompareTrafficStats<StringHash>);
+
+    float elapsed = Max(statisticsTimer_.GetMSec(false) / 1000.0f, M_EPSILON);
+    const char* header = "                           Msg out       KB out    KB/s out     Msg in        KB in     KB/s in  Serialize ms\n";
+    char line[256];
+    String output;
+
+    sprintf(line, "Network statistics over %.1f s%s\n", elapsed, statisticsEnabled_ ? "" : " (disabled)");
+    output += (const char*)line;
+    sprintf(line, "Last update: %u msg out, %.2f KB out, %u msg in, %.2f KB in, %.2f ms\n\n", updateStats_.messagesOut_,
+        updateStats_.bytesOut_ / 1024.0, updateStats_.messagesIn_, updateStats_.bytesIn_ / 1024.0, updateStats_.updateTime_ / 1000.0);
+    output += (const char*)line;
+
+    output += "Connection" + String(header).Substring(10);
+    for (Vector<SharedPtr<Connection> >::ConstIterator i = connections.Begin(); i != connections.End(); ++i)
+        output += FormatTrafficStats((*i)->ToString(), (*i)->GetTotalStats(), elapsed);
+    output += FormatTrafficStats("Total", totalStats, elapsed);
+
+    output += "\nMessage" + String(header).Substring(7);
+    for (Vector<Pair<int, NetworkTrafficStats> >::ConstIterator i = sortedMessageStats.Begin(); i != sortedMessageStats.End(); ++i)
+        output += FormatTrafficStats(GetMessageName(i->first_), i->second_, elapsed);
+
+    if (!sortedReplicationStats.Empty())
+    {
+        output += "\nReplication" + String(header).Substring(11);
+        for (Vector<Pair<StringHash, NetworkTrafficStats> >::ConstIterator i = sortedReplicationStats.Begin();
+             i != sortedReplicationStats.End(); ++i)
+        {
+            const String& typeName = context_->GetTypeName(i->first_);
+            output += FormatTrafficStats(typeName.Empty() ? i->first_.ToString() : typeName, i->second_, elapsed);
+        }
+    }
+
+    return output;
+}
+
+bool Network::SaveStatistics(const String& fileName) const
+{
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+        return false;
+
+    String output = PrintStatistics();
+    return file.Write(output.CString(), output.Length()) == output.Length();
+}
+
 void Network::Update(float timeStep)
 {
     URHO3D_PROFILE(UpdateNetwork);
@@ -459,9 +650,15 @@ void Network::Update(float timeStep)
         // Receive new messages
         connection->Process();
 
+        // Process scene updates deferred by the node creation time budget
+        serverConnection_->ProcessPendingSceneUpdates();
+
         // Process latest data messages waiting for the correct nodes or components to be created
         serverConnection_->ProcessPendingLatestData();
 
+        // Notify client-side prediction after all the server state for this frame has been applied
+        serverConnection_->ProcessPendingControlsAck();
+
         // Check for state transitions
         kNet::ConnectionState state = connection->GetConnectionState();
         if (serverConnection_->IsConnectPending() && state == kNet::ConnectionOK)
@@ -488,6 +685,17 @@ void Network::PostUpdate(float timeStep)
 
     if (updateNow)
     {
+        HiresTimer updateTimer;
+        NetworkTrafficStats statsBefore;
+        if (statisticsEnabled_)
+        {
+            for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                 i != clientConnections_.End(); ++i)
+                AddTrafficStats(statsBefore, i->second_->GetTotalStats());
+            if (serverConnection_)
+                AddTrafficStats(statsBefore, serverConnection_->GetTotalStats());
+        }
+
         // Notify of the impending update to allow for example updated client controls to be set
         SendEvent(E_NETWORKUPDATE);
         updateAcc_ = fmodf(updateAcc_, updateInterval_);
@@ -532,6 +740,24 @@ void Network::PostUpdate(float timeStep)
             serverConnection_->SendRemoteEvents();
         }
 
+        if (statisticsEnabled_)
+        {
+            NetworkTrafficStats statsAfter;
+            for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                 i != clientConnections_.End(); ++i)
+                AddTrafficStats(statsAfter, i->second_->GetTotalStats());
+            if (serverConnection_)
+                AddTrafficStats(statsAfter, serverConnection_->GetTotalStats());
+
+            updateStats_.messagesOut_ = statsAfter.messagesOut_ - statsBefore.messagesOut_;
+            updateStats_.bytesOut_ = statsAfter.bytesOut_ - statsBefore.bytesOut_;
+            updateStats_.messagesIn_ = messagesIn_;
+            updateStats_.bytesIn_ = bytesIn_;
+            updateStats_.updateTime_ = updateTimer.GetUSec(false);
+            messagesIn_ = 0;
+            bytesIn_ = 0;
+        }
+
         // Notify that the update was sent
         SendEvent(E_NETWORKUPDATESENT);
     }
@@ -596,6 +822,8 @@ void Network::ConfigureNetworkSimulator()
 void RegisterNetworkLibrary(Context* context)
 {
     NetworkPriority::RegisterObject(context);
+    ClientPrediction::RegisterObject(context);
+    LagCompensation::RegisterObject(context);
 }
 
 }
@@ -37,6 +37,21 @@ class HttpRequest;
 class MemoryBuffer;
 class Scene;
 
+/// Traffic summary of one network update.
+struct NetworkUpdateStats
+{
+    /// Messages sent during the update.
+    unsigned messagesOut_{};
+    /// Messages received since the previous update.
+    unsigned messagesIn_{};
+    /// Bytes sent during the update.
+    unsigned long long bytesOut_{};
+    /// Bytes received since the previous update.
+    unsigned long long bytesIn_{};
+    /// Time spent in sending the update in microseconds.
+    long long updateTime_{};
+};
+
 /// MessageConnection hash function.
 template <class T> unsigned MakeHash(kNet::MessageConnection* value) { return (unsigned)((size_t)value >> 9u); }
 
@@ -88,6 +103,10 @@ public:
     void SetSimulatedLatency(int ms);
     /// Set simulated packet loss probability between 0.0 - 1.0.
     void SetSimulatedPacketLoss(float probability);
+    /// Set maximum bytes of node creation messages sent to each client per network update. Nodes are sent nearest-first to the client's observer position. 0 (default) sends all new nodes at once.
+    void SetCreateNodeBudget(unsigned bytes);
+    /// Set maximum time in milliseconds the client spends per frame creating replicated nodes. Scene updates received after the first pending node creation are deferred to later frames. 0 (default) creates all nodes on reception.
+    void SetCreateNodeTimeBudget(float ms);
     /// Register a remote event as allowed to be received. There is also a fixed blacklist of events that can not be allowed in any case, such as ConsoleCommand.
     void RegisterRemoteEvent(StringHash eventType);
     /// Unregister a remote event as allowed to received.
@@ -96,6 +115,10 @@ public:
     void UnregisterAllRemoteEvents();
     /// Set the package download cache directory.
     void SetPackageCacheDir(const String& path);
+    /// Set whether to collect traffic statistics per connection, message type and replicated object type. Default false.
+    void SetStatisticsEnabled(bool enable);
+    /// Reset the collected traffic statistics on all connections.
+    void ResetStatistics();
     /// Trigger all client connections in the specified scene to download a package file from the server. Can be used to download additional resource packages when clients are already joined in the scene. The package must have been added as a requirement to the scene, or else the eventual download will fail.
     void SendPackageToClients(Scene* scene, PackageFile* package);
     /// Perform an HTTP request to the specified URL. Empty verb defaults to a GET request. Return a request object which can be used to read the response data.
@@ -112,6 +135,12 @@ public:
     /// Return simulated packet loss probability.
     float GetSimulatedPacketLoss() const { return simulatedPacketLoss_; }
 
+    /// Return maximum bytes of node creation messages sent to each client per network update.
+    unsigned GetCreateNodeBudget() const { return createNodeBudget_; }
+
+    /// Return maximum time in milliseconds the client spends per frame creating replicated nodes.
+    float GetCreateNodeTimeBudget() const { return createNodeTimeBudget_; }
+
     /// Return a client or server connection by kNet MessageConnection, or null if none exist.
     Connection* GetConnection(kNet::MessageConnection* connection) const;
     /// Return the connection to the server. Null if not connected.
@@ -126,6 +155,17 @@ public:
     /// Return the package download cache directory.
     const String& GetPackageCacheDir() const { return packageCacheDir_; }
 
+    /// Return whether collects traffic statistics.
+    bool GetStatisticsEnabled() const { return statisticsEnabled_; }
+
+    /// Return traffic summary of the latest network update.
+    const NetworkUpdateStats& GetUpdateStats() const { return updateStats_; }
+
+    /// Return traffic statistics as text, combined from all connections.
+    String PrintStatistics() const;
+    /// Save traffic statistics as text to a file. Return true if successful.
+    bool SaveStatistics(const String& fileName) const;
+
     /// Process incoming messages from connections. Called by HandleBeginFrame.
     void Update(float timeStep);
     /// Send outgoing messages after frame logic. Called by HandleRenderUpdate.
@@ -161,12 +201,26 @@ private:
     int simulatedLatency_;
     /// Simulated packet loss probability between 0.0 - 1.0.
     float simulatedPacketLoss_;
+    /// Node creation bytes budget per client and network update.
+    unsigned createNodeBudget_;
+    /// Client node creation time budget per frame in milliseconds.
+    float createNodeTimeBudget_;
     /// Update time interval.
     float updateInterval_;
     /// Update time accumulator.
     float updateAcc_;
     /// Package cache directory.
     String packageCacheDir_;
+    /// Traffic summary of the latest network update.
+    NetworkUpdateStats updateStats_;
+    /// Messages received since the latest network update.
+    unsigned messagesIn_;
+    /// Bytes received since the latest network update.
+    unsigned long long bytesIn_;
+    /// Time since statistics were enabled or reset.
+    mutable Timer statisticsTimer_;
+    /// Collect traffic statistics flag.
+    bool statisticsEnabled_;
 };
 
 /// Register Network library objects.
@@ -91,6 +91,28 @@ URHO3D_EVENT(E_NETWORKSCENELOADFAILED, NetworkSceneLoadFailed)
     URHO3D_PARAM(P_CONNECTION, Connection);      // Connection pointer
 }
 
+/// Server has acknowledged client controls updates. Sent on the client after receiving the server's update messages for the frame.
+URHO3D_EVENT(E_CONTROLSACKNOWLEDGED, ControlsAcknowledged)
+{
+    URHO3D_PARAM(P_CONNECTION, Connection);      // Connection pointer
+    URHO3D_PARAM(P_SEQUENCE, Sequence);          // unsigned
+}
+
+/// Client-side prediction has reset a node to the authoritative server state, before replaying unacknowledged controls. Sent by the predicted node.
+URHO3D_EVENT(E_PREDICTIONREWIND, PredictionRewind)
+{
+    URHO3D_PARAM(P_NODE, Node);                  // Node pointer
+    URHO3D_PARAM(P_SEQUENCE, Sequence);          // unsigned
+}
+
+/// Client-side prediction is replaying an unacknowledged controls update. Apply the controls to the node, see ClientPrediction::GetReplayControls(). Sent by the predicted node.
+URHO3D_EVENT(E_PREDICTIONREPLAY, PredictionReplay)
+{
+    URHO3D_PARAM(P_NODE, Node);                  // Node pointer
+    URHO3D_PARAM(P_SEQUENCE, Sequence);          // unsigned
+    URHO3D_PARAM(P_TIMESTEP, TimeStep);          // float
+}
+
 /// Remote event: adds Connection parameter to the event data
 URHO3D_EVENT(E_REMOTEEVENTDATA, RemoteEventData)
 {
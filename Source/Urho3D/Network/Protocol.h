@@ -63,7 +63,11 @@ static const int MSG_REMOTEEVENT = 0x14;
 static const int MSG_REMOTENODEEVENT = 0x15;
 /// Server->client: info about package.
 static const int MSG_PACKAGEINFO = 0x16;
+/// Client->server: send controls with a sequence number to be acknowledged. Sent instead of MSG_CONTROLS when the server's protocol revision supports it.
+static const int MSG_SEQUENCEDCONTROLS = 0x17;
 
+/// Protocol revision sent by the server at the end of the LoadScene message, which older clients ignore. Revision 1 adds sequenced controls, which are acknowledged at the end of the latest data of the client's owned nodes.
+static const unsigned PROTOCOL_REVISION = 1;
 /// Fixed content ID for client controls update.
 static const unsigned CONTROLS_CONTENT_ID = 1;
 /// Package file fragment size.
@@ -32,6 +32,8 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/PhysicsUtils.h"
@@ -49,6 +51,7 @@
 #include <Bullet/BulletCollision/CollisionShapes/btConvexHullShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btCylinderShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btOptimizedBvh.h>
 #include <Bullet/BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
@@ -62,6 +65,7 @@ namespace Urho3D
 
 static const float DEFAULT_COLLISION_MARGIN = 0.04f;
 static const unsigned QUANTIZE_MAX_TRIANGLES = 1000000;
+static const unsigned COOKED_GEOMETRY_VERSION = 1;
 
 static const btVector3 WHITE(1.0f, 1.0f, 1.0f);
 static const btVector3 GREEN(0.0f, 1.0f, 0.0f);
@@ -196,24 +200,104 @@ private:
     Vector<SharedArrayPtr<unsigned char> > dataArrays_;
 };
 
-TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel)
+TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel, Deserializer* cooked)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
-    shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, true);
 
-    infoMap_ = new btTriangleInfoMap();
-    btGenerateInternalEdgeInfo(shape_.Get(), infoMap_.Get());
+    if (!cooked || !LoadCooked(*cooked))
+    {
+        if (cooked)
+            URHO3D_LOGWARNING("Failed to read cooked triangle mesh collision data for " + model->GetName() + ", rebuilding");
+        Build();
+    }
 }
 
 TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
 {
     meshInterface_ = new TriangleMeshInterface(custom);
+    Build();
+}
+
+TriangleMeshData::~TriangleMeshData()
+{
+    // A BVH read from cooked data lives in its own buffer and is not owned by the shape, so destroy it after the shape
+    shape_.Reset();
+    if (bvhBuffer_)
+    {
+        static_cast<btQuantizedBvh*>(bvhBuffer_)->~btQuantizedBvh();
+        btAlignedFree(bvhBuffer_);
+    }
+}
+
+void TriangleMeshData::Build()
+{
     shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, true);
 
     infoMap_ = new btTriangleInfoMap();
     btGenerateInternalEdgeInfo(shape_.Get(), infoMap_.Get());
 }
 
+bool TriangleMeshData::LoadCooked(Deserializer& source)
+{
+    // The BVH is stored in Bullet's in-place format, which is used directly from an aligned buffer
+    unsigned bvhSize = source.ReadUInt();
+    if (!bvhSize || bvhSize > source.GetSize() - source.GetPosition())
+        return false;
+    void* buffer = btAlignedAlloc(bvhSize, 16);
+    btOptimizedBvh* bvh = source.Read(buffer, bvhSize) == bvhSize ? btOptimizedBvh::deSerializeInPlace(buffer, bvhSize, false) : nullptr;
+    if (!bvh)
+    {
+        btAlignedFree(buffer);
+        return false;
+    }
+    bvhBuffer_ = buffer;
+
+    unsigned numInfos = source.ReadUInt();
+    if ((unsigned long long)numInfos * (2 * sizeof(int) + 3 * sizeof(float)) != source.GetSize() - source.GetPosition())
+        return false;
+    infoMap_ = new btTriangleInfoMap();
+    for (unsigned i = 0; i < numInfos; ++i)
+    {
+        int key = source.ReadInt();
+        btTriangleInfo info;
+        info.m_flags = source.ReadInt();
+        info.m_edgeV0V1Angle = source.ReadFloat();
+        info.m_edgeV1V2Angle = source.ReadFloat();
+        info.m_edgeV2V0Angle = source.ReadFloat();
+        infoMap_->insert(btHashInt(key), info);
+    }
+
+    shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, false);
+    shape_->setOptimizedBvh(bvh);
+    shape_->setTriangleInfoMap(infoMap_.Get());
+    cooked_ = true;
+    return true;
+}
+
+bool TriangleMeshData::SaveCooked(Serializer& dest) const
+{
+    const btOptimizedBvh* bvh = shape_->getOptimizedBvh();
+    unsigned bvhSize = bvh->calculateSerializeBufferSize();
+    void* buffer = btAlignedAlloc(bvhSize, 16);
+    bool success = bvh->serializeInPlace(buffer, bvhSize, false);
+    success &= dest.WriteUInt(bvhSize);
+    success &= dest.Write(buffer, bvhSize) == bvhSize;
+    btAlignedFree(buffer);
+
+    success &= dest.WriteUInt((unsigned)infoMap_->size());
+    for (int i = 0; i < infoMap_->size(); ++i)
+    {
+        const btTriangleInfo* info = infoMap_->getAtIndex(i);
+        success &= dest.WriteInt(infoMap_->getKeyAtIndex(i).getUid1());
+        success &= dest.WriteInt(info->m_flags);
+        success &= dest.WriteFloat(info->m_edgeV0V1Angle);
+        success &= dest.WriteFloat(info->m_edgeV1V2Angle);
+        success &= dest.WriteFloat(info->m_edgeV2V0Angle);
+    }
+
+    return success;
+}
+
 GImpactMeshData::GImpactMeshData(Model* model, unsigned lodLevel)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
@@ -224,8 +308,15 @@ GImpactMeshData::GImpactMeshData(CustomGeometry* custom)
     meshInterface_ = new TriangleMeshInterface(custom);
 }
 
-ConvexData::ConvexData(Model* model, unsigned lodLevel)
+ConvexData::ConvexData(Model* model, unsigned lodLevel, Deserializer* cooked)
 {
+    if (cooked)
+    {
+        if (LoadCooked(*cooked))
+            return;
+        URHO3D_LOGWARNING("Failed to read cooked convex hull collision data for " + model->GetName() + ", rebuilding");
+    }
+
     PODVector<Vector3> vertices;
     unsigned numGeometries = model->GetNumGeometries();
 
@@ -314,6 +405,35 @@ void ConvexData::BuildHull(const PODVector<Vector3>& vertices)
     }
 }
 
+bool ConvexData::LoadCooked(Deserializer& source)
+{
+    unsigned vertexCount = source.ReadUInt();
+    unsigned indexCount = source.ReadUInt();
+    unsigned remaining = source.GetSize() - source.GetPosition();
+    if (!vertexCount || (unsigned long long)vertexCount * sizeof(Vector3) + (unsigned long long)indexCount * sizeof(unsigned) != remaining)
+        return false;
+
+    vertexCount_ = vertexCount;
+    vertexData_ = new Vector3[vertexCount_];
+    source.Read(vertexData_.Get(), vertexCount_ * sizeof(Vector3));
+
+    indexCount_ = indexCount;
+    indexData_ = new unsigned[indexCount_];
+    source.Read(indexData_.Get(), indexCount_ * sizeof(unsigned));
+
+    cooked_ = true;
+    return true;
+}
+
+bool ConvexData::SaveCooked(Serializer& dest) const
+{
+    bool success = dest.WriteUInt(vertexCount_);
+    success &= dest.WriteUInt(indexCount_);
+    success &= dest.Write(vertexData_.Get(), vertexCount_ * sizeof(Vector3)) == vertexCount_ * sizeof(Vector3);
+    success &= dest.Write(indexData_.Get(), indexCount_ * sizeof(unsigned)) == indexCount_ * sizeof(unsigned);
+    return success;
+}
+
 HeightfieldData::HeightfieldData(Terrain* terrain, unsigned lodLevel) :
     heightData_(terrain->GetHeightData()),
     spacing_(terrain->GetSpacing()),
@@ -424,6 +544,128 @@ CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, CustomGe
     }
 }
 
+/// Return the identifier of the platform that cooked collision geometry is valid for, as the BVH is stored in Bullet's memory layout.
+static unsigned GetCookedGeometryPlatform()
+{
+    return (unsigned)(sizeof(void*) << 8u | sizeof(btScalar));
+}
+
+/// Return the resource name of the cooked collision geometry of a model.
+static String GetCookedGeometryName(ShapeType shapeType, Model* model, unsigned lodLevel)
+{
+    return ReplaceExtension(model->GetName(), ".lod" + String(lodLevel) + (shapeType == SHAPE_TRIANGLEMESH ? ".bvh" : ".hull"));
+}
+
+/// Return a checksum of the model geometry used for collision, to detect outdated cooked collision geometry.
+static unsigned GetCollisionGeometryChecksum(Model* model, unsigned lodLevel)
+{
+    unsigned checksum = 0;
+    unsigned numGeometries = model->GetNumGeometries();
+
+    for (unsigned i = 0; i < numGeometries; ++i)
+    {
+        Geometry* geometry = model->GetGeometry(i, lodLevel);
+        if (!geometry)
+            continue;
+
+        const unsigned char* vertexData;
+        const unsigned char* indexData;
+        unsigned vertexSize;
+        unsigned indexSize;
+        const PODVector<VertexElement>* elements;
+
+        geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+        if (!vertexData)
+            continue;
+
+        unsigned vertexEnd = geometry->GetVertexStart() + geometry->GetVertexCount();
+        for (unsigned j = geometry->GetVertexStart(); j < vertexEnd; ++j)
+        {
+            const unsigned char* position = &vertexData[j * vertexSize];
+            for (unsigned k = 0; k < sizeof(Vector3); ++k)
+                checksum = SDBMHash(checksum, position[k]);
+        }
+
+        if (indexData)
+        {
+            unsigned indexEnd = (geometry->GetIndexStart() + geometry->GetIndexCount()) * indexSize;
+            for (unsigned j = geometry->GetIndexStart() * indexSize; j < indexEnd; ++j)
+                checksum = SDBMHash(checksum, indexData[j]);
+        }
+    }
+
+    return checksum;
+}
+
+/// Create triangle mesh or convex hull geometry data from a model, reading it from cooked collision geometry if up to date, and saving the cooked collision geometry next to the model if enabled.
+static CollisionGeometryData* CreateCookedCollisionGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel, PhysicsWorld* physicsWorld)
+{
+    auto* cache = physicsWorld->GetSubsystem<ResourceCache>();
+    String cookedName = GetCookedGeometryName(shapeType, model, lodLevel);
+    unsigned checksum = GetCollisionGeometryChecksum(model, lodLevel);
+
+    SharedPtr<File> cookedFile;
+    if (cache->Exists(cookedName))
+    {
+        cookedFile = cache->GetFile(cookedName, false);
+        if (cookedFile && (cookedFile->ReadFileID() != "UCOL" || cookedFile->ReadUInt() != COOKED_GEOMETRY_VERSION ||
+            cookedFile->ReadUInt() != GetCookedGeometryPlatform() || cookedFile->ReadUInt() != (unsigned)shapeType ||
+            cookedFile->ReadUInt() != checksum))
+        {
+            URHO3D_LOGDEBUG("Cooked collision geometry " + cookedName + " is outdated");
+            cookedFile.Reset();
+        }
+    }
+
+    CollisionGeometryData* geometry;
+    bool cooked;
+    if (shapeType == SHAPE_TRIANGLEMESH)
+    {
+        auto* triMesh = new TriangleMeshData(model, lodLevel, cookedFile.Get());
+        cooked = triMesh->cooked_;
+        geometry = triMesh;
+    }
+    else
+    {
+        auto* convex = new ConvexData(model, lodLevel, cookedFile.Get());
+        cooked = convex->cooked_;
+        geometry = convex;
+    }
+    // Close the outdated cooked collision geometry so that it can be overwritten
+    cookedFile.Reset();
+
+    if (!cooked && physicsWorld->GetSaveCookedGeometry())
+    {
+        // The cooked collision geometry can only be saved next to a model loaded from a resource directory
+        String modelFileName = cache->GetResourceFileName(model->GetName());
+        if (modelFileName.Empty())
+        {
+            URHO3D_LOGWARNING("Could not save cooked collision geometry for " + model->GetName() + ", which is not in a resource directory");
+            return geometry;
+        }
+
+        String fileName = GetPath(modelFileName) + GetFileNameAndExtension(cookedName);
+        File dest(physicsWorld->GetContext(), fileName, FILE_WRITE);
+        bool success = dest.IsOpen();
+        success &= dest.WriteFileID("UCOL");
+        success &= dest.WriteUInt(COOKED_GEOMETRY_VERSION);
+        success &= dest.WriteUInt(GetCookedGeometryPlatform());
+        success &= dest.WriteUInt((unsigned)shapeType);
+        success &= dest.WriteUInt(checksum);
+        if (shapeType == SHAPE_TRIANGLEMESH)
+            success &= static_cast<TriangleMeshData*>(geometry)->SaveCooked(dest);
+        else
+            success &= static_cast<ConvexData*>(geometry)->SaveCooked(dest);
+
+        if (success)
+            URHO3D_LOGDEBUG("Saved cooked collision geometry " + fileName);
+        else
+            URHO3D_LOGERROR("Failed to save cooked collision geometry " + fileName);
+    }
+
+    return geometry;
+}
+
 btCollisionShape* CreateCollisionGeometryDataShape(ShapeType shapeType, CollisionGeometryData* geometry, const Vector3& scale)
 {
     switch (shapeType)
@@ -1122,10 +1364,14 @@ void CollisionShape::UpdateCachedGeometryShape(CollisionGeometryDataCache& cache
             geometry_ = cachedGeometry->second_;
         else
         {
-            geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
+            // Check if model has dynamic buffers, do not cache or cook in that case
+            bool dynamic = HasDynamicBuffers(model_, lodLevel_);
+            if (!dynamic && physicsWorld_->GetUseCookedGeometry() && (shapeType_ == SHAPE_TRIANGLEMESH || shapeType_ == SHAPE_CONVEXHULL))
+                geometry_ = CreateCookedCollisionGeometryData(shapeType_, model_, lodLevel_, physicsWorld_);
+            else
+                geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
             assert(geometry_);
-            // Check if model has dynamic buffers, do not cache in that case
-            if (!HasDynamicBuffers(model_, lodLevel_))
+            if (!dynamic)
                 cache[id] = geometry_;
         }
 
@@ -39,10 +39,12 @@ namespace Urho3D
 {
 
 class CustomGeometry;
+class Deserializer;
 class Geometry;
 class Model;
 class PhysicsWorld;
 class RigidBody;
+class Serializer;
 class Terrain;
 class TriangleMeshInterface;
 
@@ -73,10 +75,15 @@ using CollisionGeometryDataCache = HashMap<Pair<Model*, unsigned>, SharedPtr<Col
 /// Triangle mesh geometry data.
 struct TriangleMeshData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    TriangleMeshData(Model* model, unsigned lodLevel);
+    /// Construct from a model. Read the BVH and internal edge data from cooked data if given, otherwise or on failure build them.
+    TriangleMeshData(Model* model, unsigned lodLevel, Deserializer* cooked = nullptr);
     /// Construct from a custom geometry.
     explicit TriangleMeshData(CustomGeometry* custom);
+    /// Destruct.
+    ~TriangleMeshData() override;
+
+    /// Write the BVH and internal edge data as cooked data. Return true if successful.
+    bool SaveCooked(Serializer& dest) const;
 
     /// Bullet triangle mesh interface.
     UniquePtr<TriangleMeshInterface> meshInterface_;
@@ -84,6 +91,16 @@ struct TriangleMeshData : public CollisionGeometryData
     UniquePtr<btBvhTriangleMeshShape> shape_;
     /// Bullet triangle info map.
     UniquePtr<btTriangleInfoMap> infoMap_;
+    /// Aligned buffer holding the BVH when it was read from cooked data.
+    void* bvhBuffer_{};
+    /// Read from cooked data flag.
+    bool cooked_{};
+
+private:
+    /// Build the BVH and internal edge data.
+    void Build();
+    /// Read the BVH and internal edge data from cooked data. Return true if successful.
+    bool LoadCooked(Deserializer& source);
 };
 
 /// Triangle mesh geometry data.
@@ -101,13 +118,17 @@ struct GImpactMeshData : public CollisionGeometryData
 /// Convex hull geometry data.
 struct ConvexData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    ConvexData(Model* model, unsigned lodLevel);
+    /// Construct from a model. Read the hull from cooked data if given, otherwise or on failure build it.
+    ConvexData(Model* model, unsigned lodLevel, Deserializer* cooked = nullptr);
     /// Construct from a custom geometry.
     explicit ConvexData(CustomGeometry* custom);
 
     /// Build the convex hull from vertices.
     void BuildHull(const PODVector<Vector3>& vertices);
+    /// Read the convex hull from cooked data. Return true if successful.
+    bool LoadCooked(Deserializer& source);
+    /// Write the convex hull as cooked data. Return true if successful.
+    bool SaveCooked(Serializer& dest) const;
 
     /// Vertex data.
     SharedArrayPtr<Vector3> vertexData_;
@@ -117,6 +138,8 @@ struct ConvexData : public CollisionGeometryData
     SharedArrayPtr<unsigned> indexData_;
     /// Number of indices.
     unsigned indexCount_{};
+    /// Read from cooked data flag.
+    bool cooked_{};
 };
 
 /// Heightfield geometry data.
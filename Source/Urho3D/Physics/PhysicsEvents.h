@@ -27,6 +27,9 @@
 namespace Urho3D
 {
 
+class Node;
+class RigidBody;
+
 /// Physics world is about to be stepped.
 URHO3D_EVENT(E_PHYSICSPRESTEP, PhysicsPreStep)
 {
@@ -96,6 +99,28 @@ URHO3D_EVENT(E_NODECOLLISION, NodeCollision)
     URHO3D_PARAM(P_CONTACTS, Contacts);            // Buffer containing position (Vector3), normal (Vector3), distance (float), impulse (float) for each contact
 }
 
+/// Typed node's physics collision ongoing. Sent by scene nodes participating in a 3D physics collision.
+struct URHO3D_API NodeCollisionEventData
+{
+    URHO3D_TYPED_EVENT(E_NODECOLLISION);
+
+    /// Convert to event parameters.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Convert from event parameters.
+    void FromVariantMap(VariantMap& eventData);
+
+    /// Rigid body of the sending node.
+    RigidBody* body_;
+    /// Other node.
+    Node* otherNode_;
+    /// Other rigid body.
+    RigidBody* otherBody_;
+    /// Trigger flag.
+    bool trigger_;
+    /// Buffer containing position (Vector3), normal (Vector3), distance (float), impulse (float) for each contact.
+    const PODVector<unsigned char>* contacts_;
+};
+
 /// Node's physics collision ended. Sent by scene nodes participating in a collision.
 URHO3D_EVENT(E_NODECOLLISIONEND, NodeCollisionEnd)
 {
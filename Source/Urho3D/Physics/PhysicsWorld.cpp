@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -46,7 +47,9 @@
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
-#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <Bullet/BulletDynamics/Dynamics/btRigidBody.h>
+#include <Bullet/BulletDynamics/Dynamics/btSimulationIslandManagerMt.h>
 
 extern ContactAddedCallback gContactAddedCallback;
 
@@ -144,6 +147,292 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+static const unsigned MIN_QUERIES_PER_WORK_ITEM = 16;
+
+static void RaycastSingleImpl(btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float maxDistance,
+    unsigned collisionMask)
+{
+    btCollisionWorld::ClosestRayResultCallback
+        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+    }
+    else
+    {
+        result.position_ = Vector3::ZERO;
+        result.normal_ = Vector3::ZERO;
+        result.distance_ = M_INFINITY;
+        result.hitFraction_ = 0.0f;
+        result.body_ = nullptr;
+    }
+}
+
+static void SphereCastImpl(btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float radius, float maxDistance,
+    unsigned collisionMask)
+{
+    btSphereShape shape(radius);
+    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
+
+    btCollisionWorld::ClosestConvexResultCallback
+        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
+        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+    {
+        result.body_ = nullptr;
+        result.position_ = Vector3::ZERO;
+        result.normal_ = Vector3::ZERO;
+        result.distance_ = M_INFINITY;
+        result.hitFraction_ = 0.0f;
+    }
+}
+
+/// Range of batched raycast queries executed by one work item.
+struct PhysicsRaycastRange
+{
+    /// Collision world.
+    btCollisionWorld* world_;
+    /// Queries.
+    const PhysicsRaycastQuery* queries_;
+    /// Results.
+    PhysicsRaycastResult* results_;
+    /// Number of queries.
+    unsigned count_;
+};
+
+static void RaycastRange(const PhysicsRaycastRange& range)
+{
+    for (unsigned i = 0; i < range.count_; ++i)
+    {
+        const PhysicsRaycastQuery& query = range.queries_[i];
+        if (query.radius_ > 0.0f)
+            SphereCastImpl(range.world_, range.results_[i], query.ray_, query.radius_, query.maxDistance_, query.collisionMask_);
+        else
+            RaycastSingleImpl(range.world_, range.results_[i], query.ray_, query.maxDistance_, query.collisionMask_);
+    }
+}
+
+static void RaycastWork(const WorkItem* item, unsigned threadIndex)
+{
+    RaycastRange(*reinterpret_cast<PhysicsRaycastRange*>(item->start_));
+}
+
+/// Constraint solver holding one sequential impulse solver for each thread solving simulation islands.
+class PhysicsSolverPool : public btConstraintSolver
+{
+public:
+    /// Construct with one solver.
+    PhysicsSolverPool()
+    {
+        Reserve(1);
+    }
+
+    /// Destruct.
+    ~PhysicsSolverPool() override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            delete solvers_[i];
+    }
+
+    /// Ensure there are solvers for the specified number of threads. Must be called before solving islands in parallel.
+    void Reserve(unsigned num)
+    {
+        while (solvers_.Size() < num)
+            solvers_.Push(new btSequentialImpulseConstraintSolver());
+    }
+
+    /// Return solver by thread.
+    btSequentialImpulseConstraintSolver* GetSolver(unsigned index) const { return solvers_[index]; }
+
+    /// Solve a group of constraints on the main thread.
+    btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds,
+        btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer,
+        btDispatcher* dispatcher) override
+    {
+        return solvers_[0]->solveGroup(bodies, numBodies, manifolds, numManifolds, constraints, numConstraints, info, debugDrawer,
+            dispatcher);
+    }
+
+    /// Prepare all solvers for a simulation step.
+    void prepareSolve(int numBodies, int numManifolds) override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->prepareSolve(numBodies, numManifolds);
+    }
+
+    /// Finish a simulation step on all solvers.
+    void allSolved(const btContactSolverInfo& info, btIDebugDraw* debugDrawer) override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->allSolved(info, debugDrawer);
+    }
+
+    /// Reset all solvers.
+    void reset() override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->reset();
+    }
+
+    /// Return solver type.
+    btConstraintSolverType getSolverType() const override { return BT_SEQUENTIAL_IMPULSE_SOLVER; }
+
+private:
+    /// Solvers by thread.
+    PODVector<btSequentialImpulseConstraintSolver*> solvers_;
+};
+
+class PhysicsDynamicsWorld;
+
+/// Simulation islands solved by one thread.
+struct PhysicsIslandRange
+{
+    /// Dynamics world.
+    PhysicsDynamicsWorld* world_;
+    /// Solver thread index.
+    unsigned index_;
+    /// Number of solver threads. The thread solves every island at this stride.
+    unsigned stride_;
+};
+
+/// Bullet dynamics world that solves its simulation islands in parallel on the WorkQueue threads.
+class PhysicsDynamicsWorld : public btDiscreteDynamicsWorldMt
+{
+public:
+    /// Construct.
+    PhysicsDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* broadphase, PhysicsSolverPool* solvers,
+        btCollisionConfiguration* collisionConfiguration) :
+        btDiscreteDynamicsWorldMt(dispatcher, broadphase, solvers, collisionConfiguration),
+        solvers_(solvers)
+    {
+        static_cast<btSimulationIslandManagerMt*>(getSimulationIslandManager())->setIslandDispatchFunction(DispatchIslands);
+    }
+
+    /// Step the simulation once with a variable timestep, keeping the fixed timestep accumulator and interpolation state of the regular update.
+    void StepOnce(btScalar timeStep)
+    {
+        btScalar localTime = m_localTime;
+        btScalar fixedTimeStep = m_fixedTimeStep;
+        stepSimulation(timeStep, 0, timeStep);
+        m_localTime = localTime;
+        m_fixedTimeStep = fixedTimeStep;
+    }
+
+    /// Solve constraints for a simulation step.
+    void solveConstraints(btContactSolverInfo& solverInfo) override
+    {
+        // Islands are dispatched through a static function, so record the world being solved. Worlds are stepped from the main thread only
+        solverInfo_ = &solverInfo;
+        solvingWorld = this;
+        btDiscreteDynamicsWorldMt::solveConstraints(solverInfo);
+        solvingWorld = nullptr;
+    }
+
+    /// Solve every stride'th island starting from the index with the index'th solver.
+    void SolveIslands(unsigned index, unsigned stride)
+    {
+        btSequentialImpulseConstraintSolver* solver = solvers_->GetSolver(index);
+        auto* physicsWorld = static_cast<PhysicsWorld*>(getWorldUserInfo());
+
+        for (int i = index; i < islands_->size(); i += stride)
+        {
+            btSimulationIslandManagerMt::Island* island = (*islands_)[i];
+            // Restart the solver's random sequence for each island, so that a randomized solver order does not depend on which
+            // islands the thread solved before
+            if (physicsWorld->IsDeterministic())
+                solver->setRandSeed(0);
+
+            solver->solveGroup(&island->bodyArray[0], island->bodyArray.size(),
+                island->manifoldArray.size() ? &island->manifoldArray[0] : nullptr, island->manifoldArray.size(),
+                island->constraintArray.size() ? &island->constraintArray[0] : nullptr, island->constraintArray.size(),
+                *solverInfo_, m_debugDrawer, m_dispatcher1);
+        }
+    }
+
+private:
+    /// Dispatch the simulation islands of the world being solved.
+    static void DispatchIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* islands,
+        btSimulationIslandManagerMt::IslandCallback* callback)
+    {
+        PhysicsDynamicsWorld* world = solvingWorld;
+        world->islands_ = islands;
+
+        // Solve on one thread per WorkQueue thread, the main thread included, or fewer if there are not enough islands
+        auto* physicsWorld = static_cast<PhysicsWorld*>(world->getWorldUserInfo());
+        auto* queue = physicsWorld->GetSubsystem<WorkQueue>();
+        unsigned numThreads = queue ? queue->GetNumThreads() + 1 : 1;
+        if (physicsWorld->GetMaxThreads())
+            numThreads = Min(numThreads, physicsWorld->GetMaxThreads());
+        numThreads = Min(numThreads, (unsigned)islands->size());
+
+        if (numThreads <= 1)
+        {
+            world->SolveIslands(0, 1);
+            return;
+        }
+
+        world->solvers_->Reserve(numThreads);
+
+        // The islands are sorted from largest to smallest, so interleave them between the threads to balance the work
+        PODVector<PhysicsIslandRange> ranges(numThreads);
+        for (unsigned i = 0; i < numThreads; ++i)
+        {
+            PhysicsIslandRange& range = ranges[i];
+            range.world_ = world;
+            range.index_ = i;
+            range.stride_ = numThreads;
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = SolveIslandsWork;
+            item->start_ = &range;
+            queue->AddWorkItem(item);
+        }
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    /// Solve simulation islands in a work item.
+    static void SolveIslandsWork(const WorkItem* item, unsigned threadIndex)
+    {
+        auto* range = reinterpret_cast<PhysicsIslandRange*>(item->start_);
+        range->world_->SolveIslands(range->index_, range->stride_);
+    }
+
+    /// World being solved.
+    static PhysicsDynamicsWorld* solvingWorld;
+
+    /// Constraint solvers by thread.
+    PhysicsSolverPool* solvers_;
+    /// Solver info of the step being solved.
+    btContactSolverInfo* solverInfo_{};
+    /// Simulation islands of the step being solved.
+    btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* islands_{};
+};
+
+PhysicsDynamicsWorld* PhysicsDynamicsWorld::solvingWorld = nullptr;
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     fps_(DEFAULT_FPS),
@@ -160,8 +449,9 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.Get()));
 
     broadphase_ = new btDbvtBroadphase();
-    solver_ = new btSequentialImpulseConstraintSolver();
-    world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+    auto* solvers = new PhysicsSolverPool();
+    solver_ = solvers;
+    world_ = new PhysicsDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solvers, collisionConfiguration_);
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -210,6 +500,8 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Max Threads", GetMaxThreads, SetMaxThreads, unsigned, 0, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Deterministic", IsDeterministic, SetDeterministic, bool, true, AM_FILE);
 }
 
 bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
@@ -285,7 +577,78 @@ void PhysicsWorld::Update(float timeStep)
 
     simulating_ = false;
 
-    // Apply delayed (parented) world transforms now
+    ApplyDelayedWorldTransforms();
+}
+
+void PhysicsWorld::UpdateCollisions()
+{
+    world_->performDiscreteCollisionDetection();
+}
+
+void PhysicsWorld::StepBodies(const PODVector<RigidBody*>& bodies, float timeStep)
+{
+    if (timeStep <= 0.0f || bodies.Empty())
+        return;
+
+    URHO3D_PROFILE(StepPhysicsBodies);
+
+    // Frozen rigid body state to be restored after the step
+    struct FrozenBody
+    {
+        btRigidBody* body_;
+        int activationState_;
+        Vector3 linearVelocity_;
+        Vector3 angularVelocity_;
+    };
+
+    HashSet<RigidBody*> steppedBodies;
+    for (PODVector<RigidBody*>::ConstIterator i = bodies.Begin(); i != bodies.End(); ++i)
+        steppedBodies.Insert(*i);
+
+    // Disable simulation of all other dynamic bodies. Store their velocities, as the constraint solver may still modify them
+    // through contacts with the stepped bodies
+    PODVector<FrozenBody> frozenBodies;
+    for (PODVector<RigidBody*>::ConstIterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+    {
+        btRigidBody* body = (*i)->GetBody();
+        if (!body || body->isStaticOrKinematicObject() || steppedBodies.Contains(*i))
+            continue;
+
+        FrozenBody frozen;
+        frozen.body_ = body;
+        frozen.activationState_ = body->getActivationState();
+        frozen.linearVelocity_ = ToVector3(body->getLinearVelocity());
+        frozen.angularVelocity_ = ToVector3(body->getAngularVelocity());
+        frozenBodies.Push(frozen);
+        body->forceActivationState(DISABLE_SIMULATION);
+    }
+
+    for (PODVector<RigidBody*>::ConstIterator i = bodies.Begin(); i != bodies.End(); ++i)
+        (*i)->Activate();
+
+    delayedWorldTransforms_.Clear();
+    simulating_ = true;
+    steppingBodies_ = true;
+
+    // Use a variable timestep. Bullet resets its fixed timestep accumulator for that, so it is restored afterward to not
+    // affect the substeps and interpolation of the normal update
+    static_cast<PhysicsDynamicsWorld*>(world_.Get())->StepOnce(timeStep);
+
+    steppingBodies_ = false;
+    simulating_ = false;
+
+    for (PODVector<FrozenBody>::ConstIterator i = frozenBodies.Begin(); i != frozenBodies.End(); ++i)
+    {
+        i->body_->forceActivationState(i->activationState_);
+        i->body_->setLinearVelocity(ToBtVector3(i->linearVelocity_));
+        i->body_->setAngularVelocity(ToBtVector3(i->angularVelocity_));
+    }
+
+    ApplyDelayedWorldTransforms();
+}
+
+void PhysicsWorld::ApplyDelayedWorldTransforms()
+{
     while (!delayedWorldTransforms_.Empty())
     {
         for (HashMap<RigidBody*, DelayedWorldTransform>::Iterator i = delayedWorldTransforms_.Begin();
@@ -305,11 +668,6 @@ void PhysicsWorld::Update(float timeStep)
     }
 }
 
-void PhysicsWorld::UpdateCollisions()
-{
-    world_->performDiscreteCollisionDetection();
-}
-
 void PhysicsWorld::SetFps(int fps)
 {
     fps_ = (unsigned)Clamp(fps, 1, 1000);
@@ -362,6 +720,26 @@ void PhysicsWorld::SetSplitImpulse(bool enable)
     MarkNetworkUpdate();
 }
 
+void PhysicsWorld::SetMaxThreads(unsigned num)
+{
+    maxThreads_ = num;
+}
+
+void PhysicsWorld::SetDeterministic(bool enable)
+{
+    deterministic_ = enable;
+}
+
+void PhysicsWorld::SetUseCookedGeometry(bool enable)
+{
+    useCookedGeometry_ = enable;
+}
+
+void PhysicsWorld::SetSaveCookedGeometry(bool enable)
+{
+    saveCookedGeometry_ = enable;
+}
+
 void PhysicsWorld::SetMaxNetworkAngularVelocity(float velocity)
 {
     maxNetworkAngularVelocity_ = Clamp(velocity, 1.0f, 32767.0f);
@@ -404,29 +782,7 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
-
-    if (rayCallback.hasHit())
-    {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
-    {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+    RaycastSingleImpl(world_.Get(), result, ray, maxDistance, collisionMask);
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask, float overlapDistance)
@@ -488,33 +844,7 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
-    btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
-
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
-
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
-    {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+    SphereCastImpl(world_.Get(), result, ray, radius, maxDistance, collisionMask);
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
@@ -611,6 +941,44 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
     }
 }
 
+void PhysicsWorld::RaycastSingleBatch(PODVector<PhysicsRaycastResult>& result, const PODVector<PhysicsRaycastQuery>& queries)
+{
+    URHO3D_PROFILE(PhysicsRaycastSingleBatch);
+
+    result.Resize(queries.Size());
+    if (queries.Empty())
+        return;
+
+    // The collision world is only read during the queries, so split them between the WorkQueue threads and the main thread
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numItems = queue ? Min(queue->GetNumThreads() + 1, queries.Size() / MIN_QUERIES_PER_WORK_ITEM) : 1;
+    if (numItems <= 1)
+    {
+        PhysicsRaycastRange range{world_.Get(), &queries[0], &result[0], queries.Size()};
+        RaycastRange(range);
+        return;
+    }
+
+    PODVector<PhysicsRaycastRange> ranges(numItems);
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        unsigned first = queries.Size() * i / numItems;
+        unsigned last = queries.Size() * (i + 1) / numItems;
+        PhysicsRaycastRange& range = ranges[i];
+        range.world_ = world_.Get();
+        range.queries_ = &queries[first];
+        range.results_ = &result[first];
+        range.count_ = last - first;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = RaycastWork;
+        item->start_ = &range;
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
 {
     RemoveCachedGeometryImpl(triMeshCache_, model);
@@ -799,6 +1167,10 @@ void PhysicsWorld::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap&
 
 void PhysicsWorld::PreStep(float timeStep)
 {
+    // When stepping selected bodies only, the step is not part of the normal simulation
+    if (steppingBodies_)
+        return;
+
     // Send pre-step event
     using namespace PhysicsPreStep;
 
@@ -807,6 +1179,11 @@ void PhysicsWorld::PreStep(float timeStep)
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPRESTEP, eventData);
 
+    // Apply the batched transform changes so that the rigid bodies are in sync before stepping
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateTransforms();
+
     // Start profiling block for the actual simulation step
 #ifdef URHO3D_PROFILING
     auto* profiler = GetSubsystem<Profiler>();
@@ -817,6 +1194,9 @@ void PhysicsWorld::PreStep(float timeStep)
 
 void PhysicsWorld::PostStep(float timeStep)
 {
+    if (steppingBodies_)
+        return;
+
 #ifdef URHO3D_PROFILING
     auto* profiler = GetSubsystem<Profiler>();
     if (profiler)
@@ -958,20 +1338,21 @@ void PhysicsWorld::SendCollisionEvents()
             if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                 continue;
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
-
             if (newCollision)
             {
+                nodeCollisionData_[NodeCollisionStart::P_BODY] = bodyA;
+                nodeCollisionData_[NodeCollisionStart::P_OTHERNODE] = nodeB;
+                nodeCollisionData_[NodeCollisionStart::P_OTHERBODY] = bodyB;
+                nodeCollisionData_[NodeCollisionStart::P_TRIGGER] = trigger;
+                nodeCollisionData_[NodeCollisionStart::P_CONTACTS] = contacts_.GetBuffer();
+
                 nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                     continue;
             }
 
-            nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+            // The ongoing collision event is sent typed, so the contacts are converted only for the subscribers by name
+            nodeA->SendEvent(NodeCollisionEventData{bodyA, nodeB, bodyB, trigger, &contacts_.GetBuffer()});
             if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                 continue;
 
@@ -1002,19 +1383,20 @@ void PhysicsWorld::SendCollisionEvents()
                 }
             }
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
-
             if (newCollision)
             {
+                nodeCollisionData_[NodeCollisionStart::P_BODY] = bodyB;
+                nodeCollisionData_[NodeCollisionStart::P_OTHERNODE] = nodeA;
+                nodeCollisionData_[NodeCollisionStart::P_OTHERBODY] = bodyA;
+                nodeCollisionData_[NodeCollisionStart::P_TRIGGER] = trigger;
+                nodeCollisionData_[NodeCollisionStart::P_CONTACTS] = contacts_.GetBuffer();
+
                 nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first_.first_ || !i->first_.second_)
                     continue;
             }
 
-            nodeB->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+            nodeB->SendEvent(NodeCollisionEventData{bodyB, nodeA, bodyA, trigger, &contacts_.GetBuffer()});
         }
     }
 
@@ -1080,6 +1462,28 @@ void PhysicsWorld::SendCollisionEvents()
     previousCollisions_ = currentCollisions_;
 }
 
+void NodeCollisionEventData::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace NodeCollision;
+
+    eventData[P_BODY] = body_;
+    eventData[P_OTHERNODE] = otherNode_;
+    eventData[P_OTHERBODY] = otherBody_;
+    eventData[P_TRIGGER] = trigger_;
+    eventData[P_CONTACTS] = *contacts_;
+}
+
+void NodeCollisionEventData::FromVariantMap(VariantMap& eventData)
+{
+    using namespace NodeCollision;
+
+    body_ = static_cast<RigidBody*>(eventData[P_BODY].GetPtr());
+    otherNode_ = static_cast<Node*>(eventData[P_OTHERNODE].GetPtr());
+    otherBody_ = static_cast<RigidBody*>(eventData[P_OTHERBODY].GetPtr());
+    trigger_ = eventData[P_TRIGGER].GetBool();
+    contacts_ = &eventData[P_CONTACTS].GetBuffer();
+}
+
 void RegisterPhysicsLibrary(Context* context)
 {
     CollisionShape::RegisterObject(context);
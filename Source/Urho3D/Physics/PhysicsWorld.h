@@ -25,6 +25,7 @@
 #include "../Container/HashSet.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Scene/Component.h"
@@ -48,7 +49,6 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -77,6 +77,31 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
+/// Physics raycast or sphere cast query for batched execution.
+struct URHO3D_API PhysicsRaycastQuery
+{
+    /// Construct with defaults.
+    PhysicsRaycastQuery() = default;
+
+    /// Construct with ray, maximum distance, sphere radius and collision mask.
+    PhysicsRaycastQuery(const Ray& ray, float maxDistance, float radius = 0.0f, unsigned collisionMask = M_MAX_UNSIGNED) :
+        ray_(ray),
+        maxDistance_(maxDistance),
+        radius_(radius),
+        collisionMask_(collisionMask)
+    {
+    }
+
+    /// Ray in world space.
+    Ray ray_;
+    /// Maximum distance along the ray.
+    float maxDistance_{};
+    /// Radius of the swept sphere, or 0 for a raycast.
+    float radius_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -165,6 +190,8 @@ public:
     void Update(float timeStep);
     /// Refresh collisions only without updating dynamics.
     void UpdateCollisions();
+    /// Step the simulation forward for the specified rigid bodies only, while other dynamic bodies stay frozen. Physics step and collision events are not sent. Used e.g. by client-side prediction to replay controls.
+    void StepBodies(const PODVector<RigidBody*>& bodies, float timeStep);
     /// Set simulation substeps per second.
     void SetFps(int fps);
     /// Set gravity.
@@ -181,6 +208,14 @@ public:
     void SetInternalEdge(bool enable);
     /// Set split impulse collision mode. This is more accurate, but slower. Disabled by default.
     void SetSplitImpulse(bool enable);
+    /// Set maximum number of threads to solve the simulation islands on, the main thread included. 0 (default) uses all WorkQueue threads, 1 solves on the main thread only.
+    void SetMaxThreads(unsigned num);
+    /// Set whether the simulation results are kept independent of the number of solver threads. Matters only when the constraint solver randomizes its order. Default true.
+    void SetDeterministic(bool enable);
+    /// Set whether triangle mesh and convex hull shapes read their BVH or hull from cooked collision geometry next to the model when it is up to date, instead of building it. Default true.
+    void SetUseCookedGeometry(bool enable);
+    /// Set whether to save the cooked collision geometry next to the model whenever it has to be built. The model must be in a resource directory. Default false.
+    void SetSaveCookedGeometry(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
     /// Perform a physics world raycast and return all hits.
@@ -200,6 +235,8 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a batch of raycasts, or sphere casts for queries with a radius, in parallel on the WorkQueue threads and return the closest hit of each in the same order.
+    void RaycastSingleBatch(PODVector<PhysicsRaycastResult>& result, const PODVector<PhysicsRaycastQuery>& queries);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -235,6 +272,18 @@ public:
     /// Return simulation steps per second.
     int GetFps() const { return fps_; }
 
+    /// Return maximum number of threads to solve the simulation islands on.
+    unsigned GetMaxThreads() const { return maxThreads_; }
+
+    /// Return whether the simulation results are kept independent of the number of solver threads.
+    bool IsDeterministic() const { return deterministic_; }
+
+    /// Return whether triangle mesh and convex hull shapes read cooked collision geometry.
+    bool GetUseCookedGeometry() const { return useCookedGeometry_; }
+
+    /// Return whether cooked collision geometry is saved when built.
+    bool GetSaveCookedGeometry() const { return saveCookedGeometry_; }
+
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
@@ -283,6 +332,9 @@ public:
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
 
+    /// Return whether is currently stepping only selected rigid bodies.
+    bool IsSteppingBodies() const { return steppingBodies_; }
+
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
 
@@ -299,6 +351,8 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Apply delayed (parented) world transforms after simulation.
+    void ApplyDelayedWorldTransforms();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -344,6 +398,14 @@ private:
     float timeAcc_{};
     /// Maximum angular velocity for network replication.
     float maxNetworkAngularVelocity_{DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY};
+    /// Maximum number of simulation island solver threads. 0 (default) for all WorkQueue threads.
+    unsigned maxThreads_{};
+    /// Deterministic island solving flag.
+    bool deterministic_{true};
+    /// Read cooked collision geometry flag.
+    bool useCookedGeometry_{true};
+    /// Save cooked collision geometry flag.
+    bool saveCookedGeometry_{};
     /// Automatic simulation update enabled flag.
     bool updateEnabled_{true};
     /// Interpolation flag.
@@ -354,6 +416,8 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Stepping only selected rigid bodies flag.
+    bool steppingBodies_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
@@ -24,6 +24,7 @@
 
 #include "../IO/VectorBuffer.h"
 #include "../Scene/Component.h"
+#include "../Scene/ComponentPool.h"
 
 #include <Bullet/LinearMath/btMotionState.h>
 
@@ -50,6 +51,7 @@ enum CollisionEventMode
 class URHO3D_API RigidBody : public Component, public btMotionState
 {
     URHO3D_OBJECT(RigidBody, Component);
+    URHO3D_POOLED_COMPONENT(RigidBody)
 
 public:
     /// Construct.
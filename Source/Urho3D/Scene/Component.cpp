@@ -55,6 +55,7 @@ Component::Component(Context* context) :
     Animatable(context),
     node_(nullptr),
     id_(0),
+    typeListIndex_(M_MAX_UNSIGNED),
     networkUpdate_(false),
     enabled_(true)
 {
@@ -184,12 +185,8 @@ void Component::PrepareNetworkUpdate()
         if (animationEnabled_ && IsAnimatedNetworkAttribute(attr))
             continue;
 
-        OnGetAttribute(attr, networkState_->currentValues_[i]);
-
-        if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
+        if (UpdateNetworkAttribute(i))
         {
-            networkState_->previousValues_[i] = networkState_->currentValues_[i];
-
             // Mark the attribute dirty in all replication states that are tracking this component
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
                  j != networkState_->replicationStates_.End(); ++j)
@@ -136,6 +136,8 @@ protected:
     Node* node_;
     /// Unique ID within the scene.
     unsigned id_;
+    /// Index in the scene's list of components of the same type, if the type is tracked.
+    unsigned typeListIndex_;
     /// Network update queued flag.
     bool networkUpdate_;
     /// Enabled flag.
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Scene/ComponentPool.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+ComponentPool::ComponentPool(unsigned objectSize, unsigned initialCapacity) :
+    allocator_(nullptr),
+    // Keep the objects pointer-aligned
+    objectSize_((unsigned)((objectSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1))),
+    initialCapacity_(initialCapacity),
+    numObjects_(0)
+{
+}
+
+ComponentPool::~ComponentPool()
+{
+    // If objects outlive the pool, leave their memory allocated
+    if (!numObjects_)
+        AllocatorUninitialize(allocator_);
+}
+
+void* ComponentPool::Allocate()
+{
+    if (!allocator_)
+        allocator_ = AllocatorInitialize(objectSize_, initialCapacity_);
+
+    ++numObjects_;
+    return AllocatorReserve(allocator_);
+}
+
+void ComponentPool::Free(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    AllocatorFree(allocator_, ptr);
+    --numObjects_;
+}
+
+}
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Allocator.h"
+
+#include <cstddef>
+
+namespace Urho3D
+{
+
+/// Fixed-size allocator that keeps the instances of a pooled component class close together in memory. Objects are never moved, so pointers to them stay valid. Not thread-safe: pooled components should be created and destroyed in the main thread.
+class URHO3D_API ComponentPool
+{
+public:
+    /// Construct with object size and initial capacity.
+    explicit ComponentPool(unsigned objectSize, unsigned initialCapacity = 64);
+    /// Destruct. Frees all memory if no objects remain.
+    ~ComponentPool();
+
+    /// Prevent copy construction.
+    ComponentPool(const ComponentPool& rhs) = delete;
+    /// Prevent assignment.
+    ComponentPool& operator =(const ComponentPool& rhs) = delete;
+
+    /// Reserve memory for an object.
+    void* Allocate();
+    /// Free the memory of an object.
+    void Free(void* ptr);
+
+    /// Return object size.
+    unsigned GetObjectSize() const { return objectSize_; }
+
+    /// Return number of objects allocated.
+    unsigned GetNumObjects() const { return numObjects_; }
+
+    /// Return number of objects that fit in the memory reserved so far.
+    unsigned GetCapacity() const { return allocator_ ? allocator_->capacity_ : 0; }
+
+private:
+    /// Allocator block.
+    AllocatorBlock* allocator_;
+    /// Object size.
+    unsigned objectSize_;
+    /// Initial capacity.
+    unsigned initialCapacity_;
+    /// Number of objects allocated.
+    unsigned numObjects_;
+};
+
+}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#define URHO3D_POOLED_DEBUGNEW(typeName) \
+    static void* operator new(size_t size, int, const char*, int) { return operator new(size); } \
+    static void operator delete(void* ptr, int, const char*, int) { operator delete(ptr, sizeof(typeName)); }
+#else
+#define URHO3D_POOLED_DEBUGNEW(typeName)
+#endif
+
+/// Allocate the instances of a component class from a ComponentPool instead of the heap. Subclasses of a different size fall back to the heap.
+#define URHO3D_POOLED_COMPONENT(typeName) \
+    public: \
+        static void* operator new(size_t size) { return size == sizeof(typeName) ? GetComponentPool().Allocate() : ::operator new(size); } \
+        static void operator delete(void* ptr, size_t size) { if (size == sizeof(typeName)) GetComponentPool().Free(ptr); else ::operator delete(ptr); } \
+        URHO3D_POOLED_DEBUGNEW(typeName) \
+        static Urho3D::ComponentPool& GetComponentPool() { static Urho3D::ComponentPool pool(sizeof(typeName)); return pool; }
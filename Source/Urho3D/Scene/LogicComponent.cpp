@@ -37,7 +37,9 @@ LogicComponent::LogicComponent(Context* context) :
     Component(context),
     updateEventMask_(USE_UPDATE | USE_POSTUPDATE | USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE),
     currentEventMask_(0),
-    delayedStartCalled_(false)
+    parallelUpdateIndex_(M_MAX_UNSIGNED),
+    delayedStartCalled_(false),
+    parallelUpdate_(false)
 {
 }
 
@@ -73,6 +75,16 @@ void LogicComponent::SetUpdateEventMask(UpdateEventFlags mask)
     }
 }
 
+void LogicComponent::SetParallelUpdate(bool enable)
+{
+    if (enable != parallelUpdate_)
+    {
+        ClearEventSubscription();
+        parallelUpdate_ = enable;
+        UpdateEventSubscription();
+    }
+}
+
 void LogicComponent::OnNodeSet(Node* node)
 {
     if (node)
@@ -92,15 +104,7 @@ void LogicComponent::OnSceneSet(Scene* scene)
     if (scene)
         UpdateEventSubscription();
     else
-    {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        currentEventMask_ = USE_NO_EVENT;
-    }
+        ClearEventSubscription();
 }
 
 void LogicComponent::UpdateEventSubscription()
@@ -111,10 +115,16 @@ void LogicComponent::UpdateEventSubscription()
 
     bool enabled = IsEnabledEffective();
 
+    if (parallelUpdate_)
+    {
+        UpdateParallelSubscription(scene, enabled);
+        return;
+    }
+
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
     if (needUpdate && !(currentEventMask_ & USE_UPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
+        SubscribeToEvent(scene, &LogicComponent::HandleSceneUpdate);
         currentEventMask_ |= USE_UPDATE;
     }
     else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
@@ -166,10 +176,53 @@ void LogicComponent::UpdateEventSubscription()
 #endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::UpdateParallelSubscription(Scene* scene, bool enabled)
 {
-    using namespace SceneUpdate;
+    UpdateEventFlags mask;
+    if (enabled)
+    {
+        if ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_)
+            mask |= USE_UPDATE;
+        mask |= updateEventMask_ & USE_POSTUPDATE;
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+        if (GetFixedUpdateSource())
+            mask |= updateEventMask_ & (USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE);
+#endif
+    }
+
+    // The scene calls the update functions of the events in the current mask
+    currentEventMask_ = mask;
+    if (mask)
+    {
+        scene->AddParallelUpdate(this);
+        parallelUpdateScene_ = scene;
+    }
+    else if (parallelUpdateScene_)
+    {
+        parallelUpdateScene_->RemoveParallelUpdate(this);
+        parallelUpdateScene_.Reset();
+    }
+}
+
+void LogicComponent::ClearEventSubscription()
+{
+    if (parallelUpdateScene_)
+    {
+        parallelUpdateScene_->RemoveParallelUpdate(this);
+        parallelUpdateScene_.Reset();
+    }
+
+    UnsubscribeFromEvent(E_SCENEUPDATE);
+    UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    UnsubscribeFromEvent(E_PHYSICSPRESTEP);
+    UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
+#endif
+    currentEventMask_ = USE_NO_EVENT;
+}
 
+void LogicComponent::HandleSceneUpdate(const SceneUpdateEventData& event)
+{
     // Execute user-defined delayed start function before first update
     if (!delayedStartCalled_)
     {
@@ -186,7 +239,7 @@ void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventDa
     }
 
     // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(event.timeStep_);
 }
 
 void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
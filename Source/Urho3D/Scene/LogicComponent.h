@@ -28,6 +28,8 @@
 namespace Urho3D
 {
 
+struct SceneUpdateEventData;
+
 enum UpdateEvent : unsigned
 {
     /// Bitmask for not using any events.
@@ -48,6 +50,8 @@ class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
 
+    friend class Scene;
+
     /// Construct.
     explicit LogicComponent(Context* context);
     /// Destruct.
@@ -76,6 +80,8 @@ class URHO3D_API LogicComponent : public Component
 
     /// Set what update events should be subscribed to. Use this for optimization: by default all are in use. Note that this is not an attribute and is not saved or network-serialized, therefore it should always be called eg. in the subclass constructor.
     void SetUpdateEventMask(UpdateEventFlags mask);
+    /// Set whether the update functions are called in parallel with other logic components on the work queue threads instead of by events. Only enable if the update functions modify nothing but the own node, its children and their components, and send no events. Structural changes should be deferred with Scene::DelayedCall(). DelayedStart() is always called on the main thread.
+    void SetParallelUpdate(bool enable);
 
     /// Return what update events are subscribed to.
     UpdateEventFlags GetUpdateEventMask() const { return updateEventMask_; }
@@ -83,6 +89,9 @@ class URHO3D_API LogicComponent : public Component
     /// Return whether the DelayedStart() function has been called.
     bool IsDelayedStartCalled() const { return delayedStartCalled_; }
 
+    /// Return whether the update functions are called in parallel.
+    bool GetParallelUpdate() const { return parallelUpdate_; }
+
 protected:
     /// Handle scene node being assigned at creation.
     void OnNodeSet(Node* node) override;
@@ -92,8 +101,12 @@ protected:
 private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
+    /// Add to or remove from the scene's parallel update based on current enabled state and update event mask.
+    void UpdateParallelSubscription(Scene* scene, bool enabled);
+    /// Unsubscribe from all update events and remove from the scene's parallel update.
+    void ClearEventSubscription();
     /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneUpdate(const SceneUpdateEventData& event);
     /// Handle scene post-update event.
     void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
@@ -106,8 +119,14 @@ private:
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
     UpdateEventFlags currentEventMask_;
+    /// Scene whose parallel update the component is in.
+    WeakPtr<Scene> parallelUpdateScene_;
+    /// Index in the scene's parallel update.
+    unsigned parallelUpdateIndex_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
+    /// Parallel update flag.
+    bool parallelUpdate_;
 };
 
 }
@@ -51,6 +51,7 @@ Node::Node(Context* context) :
     dirty_(false),
     enabled_(true),
     enabledPrev_(true),
+    transformQueueIndex_(M_MAX_UNSIGNED),
     networkUpdate_(false),
     parent_(nullptr),
     scene_(nullptr),
@@ -123,20 +124,8 @@ bool Node::Save(Serializer& dest) const
         return false;
 
     // Write components
-    dest.WriteVLE(GetNumPersistentComponents());
-    for (unsigned i = 0; i < components_.Size(); ++i)
-    {
-        Component* component = components_[i];
-        if (component->IsTemporary())
-            continue;
-
-        // Create a separate buffer to be able to skip failing components during deserialization
-        VectorBuffer compBuffer;
-        if (!component->Save(compBuffer))
-            return false;
-        dest.WriteVLE(compBuffer.GetSize());
-        dest.Write(compBuffer.GetData(), compBuffer.GetSize());
-    }
+    if (!SaveComponents(dest))
+        return false;
 
     // Write child nodes
     dest.WriteVLE(GetNumPersistentChildren());
@@ -735,6 +724,9 @@ void Node::SetOwner(Connection* owner)
 
 void Node::MarkDirty()
 {
+    // When the scene batches transform changes, queue the nodes to have their listeners notified later
+    Scene* batchScene = scene_ && scene_->IsBatchingTransforms() ? scene_ : nullptr;
+
     Node *cur = this;
     for (;;)
     {
@@ -750,21 +742,10 @@ void Node::MarkDirty()
         cur->dirty_ = true;
 
         // Notify listener components first, then mark child nodes
-        for (Vector<WeakPtr<Component> >::Iterator i = cur->listeners_.Begin(); i != cur->listeners_.End();)
-        {
-            Component *c = *i;
-            if (c)
-            {
-                c->OnMarkedDirty(cur);
-                ++i;
-            }
-            // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
-            else
-            {
-                *i = cur->listeners_.Back();
-                cur->listeners_.Pop();
-            }
-        }
+        if (batchScene)
+            batchScene->QueueTransformUpdate(cur);
+        else
+            cur->NotifyListeners();
 
         // Tail call optimization: Don't recurse to mark the first child dirty, but
         // instead process it in the context of the current function. If there are more
@@ -1713,12 +1694,8 @@ void Node::PrepareNetworkUpdate()
         if (animationEnabled_ && IsAnimatedNetworkAttribute(attr))
             continue;
 
-        OnGetAttribute(attr, networkState_->currentValues_[i]);
-
-        if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
+        if (UpdateNetworkAttribute(i))
         {
-            networkState_->previousValues_[i] = networkState_->currentValues_[i];
-
             // Mark the attribute dirty in all replication states that are tracking this node
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
                  j != networkState_->replicationStates_.End(); ++j)
@@ -2077,6 +2054,28 @@ Component* Node::SafeCreateComponent(const String& typeName, StringHash type, Cr
     }
 }
 
+bool Node::SaveComponents(Serializer& dest) const
+{
+    // Save each component into a separate buffer to be able to skip failing components during deserialization. The buffer is
+    // shared by the components to reuse its storage
+    VectorBuffer compBuffer;
+    dest.WriteVLE(GetNumPersistentComponents());
+    for (unsigned i = 0; i < components_.Size(); ++i)
+    {
+        Component* component = components_[i];
+        if (component->IsTemporary())
+            continue;
+
+        compBuffer.Clear();
+        if (!component->Save(compBuffer))
+            return false;
+        dest.WriteVLE(compBuffer.GetSize());
+        dest.Write(compBuffer.GetData(), compBuffer.GetSize());
+    }
+
+    return true;
+}
+
 void Node::UpdateWorldTransform() const
 {
     Matrix3x4 transform = GetTransform();
@@ -2096,6 +2095,25 @@ void Node::UpdateWorldTransform() const
     dirty_ = false;
 }
 
+void Node::NotifyListeners()
+{
+    for (Vector<WeakPtr<Component> >::Iterator i = listeners_.Begin(); i != listeners_.End();)
+    {
+        Component *c = *i;
+        if (c)
+        {
+            c->OnMarkedDirty(this);
+            ++i;
+        }
+        // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
+        else
+        {
+            *i = listeners_.Back();
+            listeners_.Pop();
+        }
+    }
+}
+
 void Node::RemoveChild(Vector<SharedPtr<Node> >::Iterator i)
 {
     // Keep a shared pointer to the child about to be removed, to make sure the erase from container completes first. Otherwise
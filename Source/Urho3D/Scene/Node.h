@@ -75,6 +75,7 @@ class URHO3D_API Node : public Animatable
     URHO3D_OBJECT(Node, Animatable);
 
     friend class Connection;
+    friend class Scene;
 
 public:
     /// Construct.
@@ -642,8 +643,12 @@ private:
     void SetEnabled(bool enable, bool recursive, bool storeSelf);
     /// Create component, allowing UnknownComponent if actual type is not supported. Leave typeName empty if not known.
     Component* SafeCreateComponent(const String& typeName, StringHash type, CreateMode mode, unsigned id);
+    /// Save the persistent components as binary data. Return true if successful.
+    bool SaveComponents(Serializer& dest) const;
     /// Recalculate the world transform.
     void UpdateWorldTransform() const;
+    /// Notify listener components that the transform has changed.
+    void NotifyListeners();
     /// Remove child node by iterator.
     void RemoveChild(Vector<SharedPtr<Node> >::Iterator i);
     /// Return child nodes recursively.
@@ -669,6 +674,8 @@ private:
     bool enabled_;
     /// Last SetEnabled flag before any SetDeepEnabled.
     bool enabledPrev_;
+    /// Index in the scene's batched transform update queue, or M_MAX_UNSIGNED if not queued.
+    unsigned transformQueueIndex_;
 
 protected:
     /// Network update queued flag.
@@ -22,22 +22,28 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
 #include "../Scene/Component.h"
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
+#include "../Scene/SceneStreamer.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
 #include "../Scene/UnknownComponent.h"
@@ -54,6 +60,19 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
+/// Minimum number of nodes for each work item of the batched transform update.
+static const unsigned MIN_NODES_PER_WORK_ITEM = 256;
+/// Minimum number of logic components for each work item of the parallel update.
+static const unsigned MIN_COMPONENTS_PER_WORK_ITEM = 64;
+
+/// Update function and timestep of a parallel logic component update.
+struct ParallelUpdateParams
+{
+    /// Update event.
+    UpdateEvent event_;
+    /// Timestep.
+    float timeStep_;
+};
 
 Scene::Scene(Context* context) :
     Node(context),
@@ -69,7 +88,9 @@ Scene::Scene(Context* context) :
     snapThreshold_(DEFAULT_SNAP_THRESHOLD),
     updateEnabled_(true),
     asyncLoading_(false),
-    threadedUpdate_(false)
+    threadedUpdate_(false),
+    batchedTransformUpdate_(false),
+    batchingTransforms_(false)
 {
     // Assign an ID to self so that nodes can refer to this node as a parent
     SetID(GetFreeNodeID(REPLICATED));
@@ -102,6 +123,7 @@ void Scene::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Smoothing Constant", GetSmoothingConstant, SetSmoothingConstant, float, DEFAULT_SMOOTHING_CONSTANT,
         AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Snap Threshold", GetSnapThreshold, SetSnapThreshold, float, DEFAULT_SNAP_THRESHOLD, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Batched Transform Update", GetBatchedTransformUpdate, SetBatchedTransformUpdate, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Elapsed Time", GetElapsedTime, SetElapsedTime, float, 0.0f, AM_FILE);
     URHO3D_ATTRIBUTE("Next Replicated Node ID", unsigned, replicatedNodeID_, FIRST_REPLICATED_ID, AM_FILE | AM_NOEDIT);
     URHO3D_ATTRIBUTE("Next Replicated Component ID", unsigned, replicatedComponentID_, FIRST_REPLICATED_ID, AM_FILE | AM_NOEDIT);
@@ -162,6 +184,270 @@ bool Scene::Save(Serializer& dest) const
         return false;
 }
 
+static void CollectChunkResources(const Node* node, Vector<ResourceRef>& resources, HashSet<Pair<StringHash, StringHash> >& found)
+{
+    const Vector<SharedPtr<Component> >& components = node->GetComponents();
+    for (unsigned i = 0; i < components.Size(); ++i)
+    {
+        Component* component = components[i];
+        const Vector<AttributeInfo>* attributes = component->GetAttributes();
+        if (component->IsTemporary() || !attributes)
+            continue;
+
+        for (unsigned j = 0; j < attributes->Size(); ++j)
+        {
+            const AttributeInfo& attr = attributes->At(j);
+            if (!(attr.mode_ & AM_FILE) || (attr.type_ != VAR_RESOURCEREF && attr.type_ != VAR_RESOURCEREFLIST))
+                continue;
+
+            Variant value;
+            bool exists;
+            component->OnGetAttribute(attr, value);
+            if (attr.type_ == VAR_RESOURCEREF)
+            {
+                const ResourceRef& ref = value.GetResourceRef();
+                if (ref.name_.Empty())
+                    continue;
+                found.Insert(MakePair(ref.type_, StringHash(ref.name_)), exists);
+                if (!exists)
+                    resources.Push(ref);
+            }
+            else
+            {
+                const ResourceRefList& refList = value.GetResourceRefList();
+                for (unsigned k = 0; k < refList.names_.Size(); ++k)
+                {
+                    if (refList.names_[k].Empty())
+                        continue;
+                    found.Insert(MakePair(refList.type_, StringHash(refList.names_[k])), exists);
+                    if (!exists)
+                        resources.Push(ResourceRef(refList.type_, refList.names_[k]));
+                }
+            }
+        }
+    }
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        if (!children[i]->IsTemporary())
+            CollectChunkResources(children[i], resources, found);
+    }
+}
+
+static void DecodeSceneChunkWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* chunk = reinterpret_cast<SceneChunkData*>(item->start_);
+    auto* context = reinterpret_cast<Context*>(item->aux_);
+    DecodeSceneChunk(context, *chunk);
+}
+
+bool Scene::SaveChunked(Serializer& dest) const
+{
+    URHO3D_PROFILE(SaveSceneChunked);
+
+    // Serialize the header and the chunks first, as the chunk table needs their sizes
+    VectorBuffer header;
+    if (!header.WriteUInt(id_) || !Animatable::Save(header) || !SaveComponents(header))
+    {
+        URHO3D_LOGERROR("Could not save scene, serializing the scene attributes failed");
+        return false;
+    }
+
+    Vector<SceneChunkInfo> chunks;
+    VectorBuffer chunkData;
+    for (unsigned i = 0; i < children_.Size(); ++i)
+    {
+        Node* node = children_[i];
+        if (node->IsTemporary())
+            continue;
+
+        chunks.Resize(chunks.Size() + 1);
+        SceneChunkInfo& info = chunks.Back();
+        info.nodeID_ = node->GetID();
+        info.position_ = node->GetWorldPosition();
+        info.offset_ = chunkData.GetPosition();
+        if (!node->Save(chunkData))
+        {
+            URHO3D_LOGERROR("Could not save scene, serializing node " + String(node->GetID()) + " failed");
+            return false;
+        }
+        info.size_ = chunkData.GetPosition() - info.offset_;
+
+        HashSet<Pair<StringHash, StringHash> > found;
+        CollectChunkResources(node, info.resources_, found);
+    }
+
+    // The table size does not depend on the offsets, so write it once to measure, then again with offsets from the file start
+    VectorBuffer table;
+    table.WriteVLE(chunks.Size());
+    for (unsigned i = 0; i < chunks.Size(); ++i)
+        chunks[i].Write(table);
+    unsigned dataStart = 4 + header.GetSize() + table.GetSize();
+    table.Clear();
+    table.WriteVLE(chunks.Size());
+    for (unsigned i = 0; i < chunks.Size(); ++i)
+    {
+        chunks[i].offset_ += dataStart;
+        chunks[i].Write(table);
+    }
+
+    if (!dest.WriteFileID("UCSN") || dest.Write(header.GetData(), header.GetSize()) != header.GetSize() ||
+        dest.Write(table.GetData(), table.GetSize()) != table.GetSize() ||
+        dest.Write(chunkData.GetData(), chunkData.GetSize()) != chunkData.GetSize())
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+
+    auto* ptr = dynamic_cast<Deserializer*>(&dest);
+    if (ptr)
+        URHO3D_LOGINFO("Saving scene to " + ptr->GetName());
+
+    FinishSaving(&dest);
+    return true;
+}
+
+bool Scene::LoadChunked(Deserializer& source)
+{
+    URHO3D_PROFILE(LoadSceneChunked);
+
+    Vector<SceneChunkInfo> chunks;
+    if (!LoadChunkedHeader(source, chunks))
+        return false;
+
+    PODVector<unsigned> indices(chunks.Size());
+    for (unsigned i = 0; i < chunks.Size(); ++i)
+        indices[i] = i;
+
+    return LoadChunks(source, chunks, indices);
+}
+
+bool Scene::LoadChunkedHeader(Deserializer& source, Vector<SceneChunkInfo>& chunks)
+{
+    StopAsyncLoading();
+
+    // Chunk offsets are relative to the file ID
+    unsigned basePosition = source.GetPosition();
+    if (source.ReadFileID() != "UCSN")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid chunked scene file");
+        return false;
+    }
+
+    URHO3D_LOGINFO("Loading scene from " + source.GetName());
+
+    Clear();
+    chunks.Clear();
+
+    // Load the scene attributes and root-level components
+    SceneResolver resolver;
+    unsigned nodeID = source.ReadUInt();
+    resolver.AddNode(nodeID, this);
+    if (!Node::Load(source, resolver, false))
+        return false;
+
+    chunks.Resize(source.ReadVLE());
+    for (unsigned i = 0; i < chunks.Size(); ++i)
+    {
+        if (!chunks[i].Read(source, basePosition))
+        {
+            URHO3D_LOGERROR("Could not load scene, chunk table of " + source.GetName() + " is invalid");
+            chunks.Clear();
+            return false;
+        }
+    }
+
+    resolver.Resolve();
+    Serializable::ApplyAttributes();
+    for (unsigned i = 0; i < components_.Size(); ++i)
+        components_[i]->ApplyAttributes();
+
+    FinishLoading(&source);
+    return true;
+}
+
+bool Scene::LoadChunks(Deserializer& source, const Vector<SceneChunkInfo>& chunks, const PODVector<unsigned>& indices,
+    PODVector<Node*>* dest)
+{
+    URHO3D_PROFILE(LoadSceneChunks);
+
+    bool success = true;
+
+    // Read the chunk data sequentially
+    Vector<SceneChunkData> chunkData(indices.Size());
+    for (unsigned i = 0; i < indices.Size(); ++i)
+    {
+        if (indices[i] >= chunks.Size())
+        {
+            URHO3D_LOGERROR("Chunk index " + String(indices[i]) + " out of range");
+            success = false;
+            continue;
+        }
+
+        const SceneChunkInfo& info = chunks[indices[i]];
+        chunkData[i].buffer_.Resize(info.size_);
+        if (source.Seek(info.offset_) != info.offset_ || source.Read(chunkData[i].buffer_.Buffer(), info.size_) != info.size_)
+        {
+            URHO3D_LOGERROR("Could not read chunk " + String(indices[i]) + " from " + source.GetName());
+            chunkData[i].buffer_.Clear();
+            success = false;
+        }
+    }
+
+    // Decode the chunks on the work queue threads, then create the objects on the main thread
+    {
+        URHO3D_PROFILE(DecodeSceneChunks);
+
+        auto* queue = GetSubsystem<WorkQueue>();
+        for (unsigned i = 0; i < chunkData.Size(); ++i)
+        {
+            if (chunkData[i].buffer_.Empty())
+                continue;
+
+            // Without a work queue, decode in the main thread
+            if (!queue)
+            {
+                DecodeSceneChunk(context_, chunkData[i]);
+                continue;
+            }
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = DecodeSceneChunkWork;
+            item->start_ = &chunkData[i];
+            item->aux_ = context_;
+            queue->AddWorkItem(item);
+        }
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    SceneResolver resolver;
+    PODVector<Node*> chunkNodes(chunkData.Size());
+    for (unsigned i = 0; i < chunkData.Size(); ++i)
+    {
+        chunkNodes[i] = chunkData[i].decoded_ ? InstantiateChunk(chunkData[i], resolver) : nullptr;
+        if (!chunkNodes[i] && !chunkData[i].buffer_.Empty())
+        {
+            URHO3D_LOGERROR("Could not load chunk " + String(indices[i]) + " from " + source.GetName());
+            success = false;
+        }
+    }
+
+    resolver.Resolve();
+    for (unsigned i = 0; i < chunkNodes.Size(); ++i)
+    {
+        if (chunkNodes[i])
+            chunkNodes[i]->ApplyAttributes();
+    }
+
+    if (dest)
+        *dest = chunkNodes;
+
+    return success;
+}
+
 bool Scene::LoadXML(const XMLElement& source)
 {
     URHO3D_PROFILE(LoadSceneXML);
@@ -664,6 +950,19 @@ void Scene::SetSnapThreshold(float threshold)
     Node::MarkNetworkUpdate();
 }
 
+void Scene::SetBatchedTransformUpdate(bool enable)
+{
+    if (enable == batchedTransformUpdate_)
+        return;
+
+    batchedTransformUpdate_ = enable;
+    if (!enable)
+    {
+        UpdateTransforms();
+        batchingTransforms_ = false;
+    }
+}
+
 void Scene::SetAsyncLoadingMs(int ms)
 {
     asyncLoadingMs_ = Max(ms, 1);
@@ -744,6 +1043,39 @@ Component* Scene::GetComponent(unsigned id) const
     }
 }
 
+const PODVector<Component*>& Scene::GetComponentsOfType(StringHash type)
+{
+    HashMap<StringHash, ComponentTypeList>::Iterator i = componentTypeLists_.Find(type);
+    if (i == componentTypeLists_.End())
+    {
+        // Start tracking the type. From now on components are added and removed as they enter and leave the scene
+        i = componentTypeLists_.Insert(MakePair(type, ComponentTypeList()));
+        PODVector<Component*>& components = i->second_.components_;
+        for (HashMap<unsigned, Component*>::ConstIterator j = replicatedComponents_.Begin(); j != replicatedComponents_.End(); ++j)
+        {
+            if (j->second_->GetType() == type)
+                components.Push(j->second_);
+        }
+        for (HashMap<unsigned, Component*>::ConstIterator j = localComponents_.Begin(); j != localComponents_.End(); ++j)
+        {
+            if (j->second_->GetType() == type)
+                components.Push(j->second_);
+        }
+        i->second_.unsorted_ = true;
+    }
+
+    ComponentTypeList& list = i->second_;
+    if (list.unsorted_)
+    {
+        Sort(list.components_.Begin(), list.components_.End());
+        for (unsigned j = 0; j < list.components_.Size(); ++j)
+            list.components_[j]->typeListIndex_ = j;
+        list.unsorted_ = false;
+    }
+
+    return list.components_;
+}
+
 float Scene::GetAsyncProgress() const
 {
     return !asyncLoading_ || asyncProgress_.totalNodes_ + asyncProgress_.totalResources_ == 0 ? 1.0f :
@@ -771,18 +1103,25 @@ void Scene::Update(float timeStep)
 
     timeStep *= timeScale_;
 
+    // Batch the transform changes of the update if enabled
+    batchingTransforms_ = batchedTransformUpdate_;
+
+    // Update variable timestep logic. Sent typed before filling the event data, as it may use the same event data map
+    SendEvent(SceneUpdateEventData{this, timeStep});
+    ParallelUpdate(USE_UPDATE, timeStep);
+
     using namespace SceneUpdate;
 
     VariantMap& eventData = GetEventDataMap();
     eventData[P_SCENE] = this;
     eventData[P_TIMESTEP] = timeStep;
 
-    // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
-
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
 
+    // Apply the transform changes so far, so that the scene subsystems see them
+    UpdateTransforms();
+
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
     SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
 
@@ -802,6 +1141,11 @@ void Scene::Update(float timeStep)
 
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
+    ParallelUpdate(USE_POSTUPDATE, timeStep);
+
+    // Apply the remaining transform changes before rendering, and stop batching
+    UpdateTransforms();
+    batchingTransforms_ = false;
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -811,8 +1155,9 @@ void Scene::Update(float timeStep)
 
 void Scene::BeginThreadedUpdate()
 {
-    // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
-    if (GetSubsystem<WorkQueue>()->GetNumThreads())
+    // Check the work queue subsystem whether it exists and actually has created worker threads. If not, do not enter threaded mode.
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (queue && queue->GetNumThreads())
         threadedUpdate_ = true;
 }
 
@@ -831,6 +1176,320 @@ void Scene::EndThreadedUpdate()
             (*i)->OnMarkedDirty((*i)->GetNode());
         delayedDirtyComponents_.Clear();
     }
+
+    if (!delayedCalls_.Empty())
+    {
+        URHO3D_PROFILE(DelayedCalls);
+
+        // The calls may queue more calls, which are now executed immediately
+        Vector<std::function<void()> > calls;
+        calls.Swap(delayedCalls_);
+        for (unsigned i = 0; i < calls.Size(); ++i)
+            calls[i]();
+    }
+}
+
+static void UpdateTransformsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<Node**>(item->start_);
+    auto** end = reinterpret_cast<Node**>(item->end_);
+    for (Node** i = start; i != end; ++i)
+        (*i)->GetWorldTransform();
+}
+
+void Scene::UpdateTransforms()
+{
+    if (transformQueue_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateTransforms);
+
+    // Transform changes made by the listener components are applied right away
+    bool wasBatching = batchingTransforms_;
+    batchingTransforms_ = false;
+
+    // Find the hierarchy depth of each queued node. Nodes are queued parent first when marked dirty together, so reuse the
+    // parent's depth when possible instead of walking up the hierarchy
+    unsigned numNodes = transformQueue_.Size();
+    unsigned maxDepth = 0;
+    transformDepths_.Resize(numNodes);
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = transformQueue_[i];
+        if (!node)
+            continue;
+
+        Node* parent = node->parent_;
+        unsigned depth = 0;
+        if (parent && parent->transformQueueIndex_ < i)
+            depth = transformDepths_[parent->transformQueueIndex_] + 1;
+        else
+        {
+            for (; parent; parent = parent->parent_)
+            {
+                // A dirty ancestor that is not queued would be updated concurrently by its descendants, so update it now
+                if (parent->dirty_ && parent->transformQueueIndex_ == M_MAX_UNSIGNED)
+                    parent->UpdateWorldTransform();
+                ++depth;
+            }
+        }
+
+        transformDepths_[i] = depth;
+        maxDepth = Max(maxDepth, depth);
+    }
+
+    // Sort the nodes by depth, keeping their order within each depth
+    transformLevelStarts_.Resize(maxDepth + 2);
+    for (unsigned i = 0; i < transformLevelStarts_.Size(); ++i)
+        transformLevelStarts_[i] = 0;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        if (transformQueue_[i])
+            ++transformLevelStarts_[transformDepths_[i] + 1];
+    }
+    for (unsigned i = 1; i < transformLevelStarts_.Size(); ++i)
+        transformLevelStarts_[i] += transformLevelStarts_[i - 1];
+    transformLevelNodes_.Resize(transformLevelStarts_.Back());
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        if (transformQueue_[i])
+            transformLevelNodes_[transformLevelStarts_[transformDepths_[i]]++] = transformQueue_[i];
+    }
+    // The start indices were advanced to the level ends, shift them back
+    for (unsigned i = transformLevelStarts_.Size() - 1; i > 0; --i)
+        transformLevelStarts_[i] = transformLevelStarts_[i - 1];
+    transformLevelStarts_[0] = 0;
+
+    // Recompute the world transforms one depth level at a time. Within a level the nodes only read their parents' world
+    // transforms, which are up to date, so the level can be split between the WorkQueue threads and the main thread
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (unsigned level = 0; level <= maxDepth; ++level)
+    {
+        unsigned start = transformLevelStarts_[level];
+        unsigned count = transformLevelStarts_[level + 1] - start;
+        unsigned numItems = queue ? Min(queue->GetNumThreads() + 1, count / MIN_NODES_PER_WORK_ITEM) : 1;
+        if (numItems <= 1)
+        {
+            for (unsigned i = start; i < start + count; ++i)
+                transformLevelNodes_[i]->GetWorldTransform();
+            continue;
+        }
+
+        for (unsigned i = 0; i < numItems; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = UpdateTransformsWork;
+            item->start_ = &transformLevelNodes_[start + count * i / numItems];
+            item->end_ = &transformLevelNodes_[0] + start + count * (i + 1) / numItems;
+            queue->AddWorkItem(item);
+        }
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    // Notify the listener components in the order the nodes were marked dirty, parents first. Nodes removed meanwhile
+    // have been cleared from the queue
+    for (unsigned i = 0; i < transformQueue_.Size(); ++i)
+    {
+        Node* node = transformQueue_[i];
+        if (node)
+        {
+            node->transformQueueIndex_ = M_MAX_UNSIGNED;
+            node->NotifyListeners();
+        }
+    }
+
+    transformQueue_.Clear();
+    batchingTransforms_ = wasBatching;
+}
+
+void Scene::QueueTransformUpdate(Node* node)
+{
+    if (node->transformQueueIndex_ != M_MAX_UNSIGNED)
+        return;
+
+    if (!threadedUpdate_)
+    {
+        node->transformQueueIndex_ = transformQueue_.Size();
+        transformQueue_.Push(node);
+    }
+    else
+    {
+        MutexLock lock(sceneMutex_);
+        node->transformQueueIndex_ = transformQueue_.Size();
+        transformQueue_.Push(node);
+    }
+}
+
+void Scene::AddParallelUpdate(LogicComponent* component)
+{
+    if (component->parallelUpdateIndex_ == M_MAX_UNSIGNED)
+    {
+        component->parallelUpdateIndex_ = parallelUpdates_.Size();
+        parallelUpdates_.Push(component);
+    }
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    // Subscribe to the fixed update source once for all components
+    if (component->currentEventMask_ & (USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE))
+    {
+        Component* source = component->GetFixedUpdateSource();
+        if (source && source != parallelFixedUpdateSource_)
+        {
+            if (parallelFixedUpdateSource_)
+                UnsubscribeFromEvents(parallelFixedUpdateSource_);
+            SubscribeToEvent(source, E_PHYSICSPRESTEP, URHO3D_HANDLER(Scene, HandlePhysicsPreStep));
+            SubscribeToEvent(source, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(Scene, HandlePhysicsPostStep));
+            parallelFixedUpdateSource_ = source;
+        }
+    }
+#endif
+}
+
+void Scene::RemoveParallelUpdate(LogicComponent* component)
+{
+    unsigned index = component->parallelUpdateIndex_;
+    if (index == M_MAX_UNSIGNED)
+        return;
+
+    // Move the last component to the freed slot
+    LogicComponent* last = parallelUpdates_.Back();
+    parallelUpdates_[index] = last;
+    last->parallelUpdateIndex_ = index;
+    parallelUpdates_.Pop();
+    component->parallelUpdateIndex_ = M_MAX_UNSIGNED;
+}
+
+static void ParallelUpdateWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto** start = reinterpret_cast<LogicComponent**>(item->start_);
+    auto** end = reinterpret_cast<LogicComponent**>(item->end_);
+    const auto* params = reinterpret_cast<const ParallelUpdateParams*>(item->aux_);
+    float timeStep = params->timeStep_;
+
+    switch (params->event_)
+    {
+    case USE_UPDATE:
+        for (LogicComponent** i = start; i != end; ++i)
+            (*i)->Update(timeStep);
+        break;
+
+    case USE_POSTUPDATE:
+        for (LogicComponent** i = start; i != end; ++i)
+            (*i)->PostUpdate(timeStep);
+        break;
+
+    case USE_FIXEDUPDATE:
+        for (LogicComponent** i = start; i != end; ++i)
+            (*i)->FixedUpdate(timeStep);
+        break;
+
+    case USE_FIXEDPOSTUPDATE:
+        for (LogicComponent** i = start; i != end; ++i)
+            (*i)->FixedPostUpdate(timeStep);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void Scene::ParallelUpdate(UpdateEvent event, float timeStep)
+{
+    if (parallelUpdates_.Empty())
+        return;
+
+    URHO3D_PROFILE(ParallelLogicUpdate);
+
+    // Execute the delayed start functions on the main thread before the first update, as they may access the rest of the
+    // scene. They may also remove components, so keep weak pointers
+    if (event == USE_UPDATE || event == USE_FIXEDUPDATE)
+    {
+        Vector<WeakPtr<LogicComponent> > starting;
+        for (unsigned i = 0; i < parallelUpdates_.Size(); ++i)
+        {
+            LogicComponent* component = parallelUpdates_[i];
+            if (!component->delayedStartCalled_ && (component->currentEventMask_ & event))
+                starting.Push(WeakPtr<LogicComponent>(component));
+        }
+
+        for (unsigned i = 0; i < starting.Size(); ++i)
+        {
+            LogicComponent* component = starting[i];
+            if (component && !component->delayedStartCalled_)
+            {
+                component->DelayedStart();
+                component->delayedStartCalled_ = true;
+                // Drops the update if was only needed for the delayed start
+                component->UpdateEventSubscription();
+            }
+        }
+    }
+
+    // Bring the parents' world transforms up to date, so that the components can read them while modifying their own nodes
+    parallelUpdateNodes_.Clear();
+    parallelUpdateGroups_.Clear();
+    for (unsigned i = 0; i < parallelUpdates_.Size(); ++i)
+    {
+        LogicComponent* component = parallelUpdates_[i];
+        if (component->currentEventMask_ & event)
+        {
+            Node* parent = component->GetNode()->GetParent();
+            if (parent)
+                parent->GetWorldTransform();
+            parallelUpdateNodes_.Insert(component->GetNode());
+            parallelUpdateGroups_.Push(MakePair(component->GetNode(), component));
+        }
+    }
+
+    unsigned count = parallelUpdateGroups_.Size();
+    if (!count)
+        return;
+
+    // A component may modify its node and the children, so components in the same subtree must not run concurrently. Group
+    // the components by the topmost node of their subtree that has components in the update
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Node*& root = parallelUpdateGroups_[i].first_;
+        for (Node* ancestor = root->GetParent(); ancestor; ancestor = ancestor->GetParent())
+        {
+            if (parallelUpdateNodes_.Contains(ancestor))
+                root = ancestor;
+        }
+    }
+    Sort(parallelUpdateGroups_.Begin(), parallelUpdateGroups_.End());
+    parallelUpdateBatch_.Resize(count);
+    for (unsigned i = 0; i < count; ++i)
+        parallelUpdateBatch_[i] = parallelUpdateGroups_[i].second_;
+
+    // Split the components between the work queue threads and the main thread without splitting a group. Dirty notifications,
+    // transform and network updates and delayed calls are queued until the threaded update ends
+    ParallelUpdateParams params{event, timeStep};
+    auto* queue = GetSubsystem<WorkQueue>();
+    BeginThreadedUpdate();
+    unsigned numItems = queue ? Clamp(count / MIN_COMPONENTS_PER_WORK_ITEM, 1U, queue->GetNumThreads() + 1) : 1;
+    unsigned begin = 0;
+    for (unsigned i = 0; i < numItems && begin < count; ++i)
+    {
+        unsigned end = Max(count * (i + 1) / numItems, begin + 1);
+        while (end < count && parallelUpdateGroups_[end].first_ == parallelUpdateGroups_[end - 1].first_)
+            ++end;
+
+        SharedPtr<WorkItem> item = queue ? queue->GetFreeItem() : SharedPtr<WorkItem>(new WorkItem());
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = ParallelUpdateWork;
+        item->start_ = &parallelUpdateBatch_[begin];
+        item->end_ = &parallelUpdateBatch_[0] + end;
+        item->aux_ = &params;
+        if (queue)
+            queue->AddWorkItem(item);
+        else
+            ParallelUpdateWork(item, 0);
+        begin = end;
+    }
+    if (queue)
+        queue->Complete(M_MAX_UNSIGNED);
+    EndThreadedUpdate();
 }
 
 void Scene::DelayedMarkedDirty(Component* component)
@@ -839,6 +1498,17 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.Push(component);
 }
 
+void Scene::DelayedCall(const std::function<void()>& function)
+{
+    if (!threadedUpdate_)
+        function();
+    else
+    {
+        MutexLock lock(sceneMutex_);
+        delayedCalls_.Push(function);
+    }
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -981,6 +1651,15 @@ void Scene::NodeRemoved(Node* node)
     if (!node || node->GetScene() != this)
         return;
 
+    // A node leaving the scene has its batched transform change applied right away, unless it is being destroyed
+    if (node->transformQueueIndex_ != M_MAX_UNSIGNED)
+    {
+        transformQueue_[node->transformQueueIndex_] = nullptr;
+        node->transformQueueIndex_ = M_MAX_UNSIGNED;
+        if (node->Refs() > 0)
+            node->NotifyListeners();
+    }
+
     unsigned id = node->GetID();
     if (Scene::IsReplicatedID(id))
     {
@@ -1046,6 +1725,18 @@ void Scene::ComponentAdded(Component* component)
         localComponents_[id] = component;
     }
 
+    // Add to the component list of the type if tracked
+    if (!componentTypeLists_.Empty() && component->typeListIndex_ == M_MAX_UNSIGNED)
+    {
+        HashMap<StringHash, ComponentTypeList>::Iterator i = componentTypeLists_.Find(component->GetType());
+        if (i != componentTypeLists_.End())
+        {
+            component->typeListIndex_ = i->second_.components_.Size();
+            i->second_.components_.Push(component);
+            i->second_.unsorted_ = true;
+        }
+    }
+
     component->OnSceneSet(this);
 }
 
@@ -1060,6 +1751,18 @@ void Scene::ComponentRemoved(Component* component)
     else
         localComponents_.Erase(id);
 
+    // Remove from the component list of the type by moving the last component to its place
+    if (component->typeListIndex_ != M_MAX_UNSIGNED)
+    {
+        ComponentTypeList& list = componentTypeLists_[component->GetType()];
+        Component* last = list.components_.Back();
+        list.components_[component->typeListIndex_] = last;
+        last->typeListIndex_ = component->typeListIndex_;
+        list.components_.Pop();
+        list.unsorted_ = true;
+        component->typeListIndex_ = M_MAX_UNSIGNED;
+    }
+
     component->SetID(0);
     component->OnSceneSet(nullptr);
 }
@@ -1185,6 +1888,24 @@ void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eve
     }
 }
 
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+
+void Scene::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    ParallelUpdate(USE_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void Scene::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+
+    ParallelUpdate(USE_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#endif
+
 void Scene::UpdateAsyncLoading()
 {
     URHO3D_PROFILE(UpdateAsyncLoading);
@@ -1288,6 +2009,56 @@ void Scene::FinishSaving(Serializer* dest) const
     }
 }
 
+Node* Scene::InstantiateChunk(const SceneChunkData& chunk, SceneResolver& resolver, bool rewriteIDs)
+{
+    if (!chunk.decoded_)
+        return nullptr;
+
+    PODVector<Node*> nodes(chunk.nodes_.Size());
+    for (unsigned i = 0; i < chunk.nodes_.Size(); ++i)
+    {
+        const SceneChunkNode& nodeData = chunk.nodes_[i];
+        Node* parent = nodeData.parentIndex_ < i ? nodes[nodeData.parentIndex_] : this;
+        Node* node = parent->CreateChild(rewriteIDs ? 0 : nodeData.id_, IsReplicatedID(nodeData.id_) ? REPLICATED : LOCAL);
+        resolver.AddNode(nodeData.id_, node);
+        nodes[i] = node;
+
+        if (!node->LoadValues(nodeData.values_))
+        {
+            // Forget the objects created so far, so that the resolver can still be used for other chunks
+            for (unsigned j = 0; j <= i; ++j)
+            {
+                resolver.RemoveNode(chunk.nodes_[j].id_);
+                for (unsigned k = 0; j < i && k < chunk.nodes_[j].components_.Size(); ++k)
+                    resolver.RemoveComponent(chunk.nodes_[j].components_[k].id_);
+            }
+            nodes[0]->Remove();
+            return nullptr;
+        }
+
+        for (unsigned j = 0; j < nodeData.components_.Size(); ++j)
+        {
+            const SceneChunkComponent& compData = nodeData.components_[j];
+            Component* newComponent = node->SafeCreateComponent(String::EMPTY, compData.type_,
+                IsReplicatedID(compData.id_) ? REPLICATED : LOCAL, rewriteIDs ? 0 : compData.id_);
+            if (!newComponent)
+                continue;
+
+            resolver.AddComponent(compData.id_, newComponent);
+            // Components with instance-specific attributes, or which failed to decode, load from their data as usual
+            if (compData.decoded_ && newComponent->GetAttributes() == context_->GetAttributes(compData.type_))
+                newComponent->LoadValues(compData.values_);
+            else
+            {
+                MemoryBuffer compBuffer(chunk.buffer_.Buffer() + compData.offset_, compData.size_);
+                newComponent->Load(compBuffer);
+            }
+        }
+    }
+
+    return nodes.Empty() ? nullptr : nodes[0];
+}
+
 void Scene::PreloadResources(File* file, bool isSceneFile)
 {
     // If not threaded, can not background load resources, so rather load synchronously later when needed
@@ -1527,6 +2298,22 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
 #endif
 }
 
+void SceneUpdateEventData::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace SceneUpdate;
+
+    eventData[P_SCENE] = scene_;
+    eventData[P_TIMESTEP] = timeStep_;
+}
+
+void SceneUpdateEventData::FromVariantMap(VariantMap& eventData)
+{
+    using namespace SceneUpdate;
+
+    scene_ = static_cast<Scene*>(eventData[P_SCENE].GetPtr());
+    timeStep_ = eventData[P_TIMESTEP].GetFloat();
+}
+
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
@@ -1536,6 +2323,7 @@ void RegisterSceneLibrary(Context* context)
     SmoothedTransform::RegisterObject(context);
     UnknownComponent::RegisterObject(context);
     SplinePath::RegisterObject(context);
+    SceneStreamer::RegisterObject(context);
 }
 
 }
@@ -22,11 +22,14 @@
 
 #pragma once
 
+#include "../Container/FlatHashSet.h"
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/LogicComponent.h"
 #include "../Scene/Node.h"
+#include "../Scene/SceneChunk.h"
 #include "../Scene/SceneResolver.h"
 
 namespace Urho3D
@@ -81,6 +84,15 @@ struct AsyncProgress
     unsigned totalNodes_;
 };
 
+/// Components of one type in a scene.
+struct ComponentTypeList
+{
+    /// Components.
+    PODVector<Component*> components_;
+    /// Components not in memory order flag.
+    bool unsorted_;
+};
+
 /// Root scene node, represents the whole scene.
 class URHO3D_API Scene : public Node
 {
@@ -111,6 +123,17 @@ public:
     /// Add a replication state that is tracking this scene.
     void AddReplicationState(NodeReplicationState* state) override;
 
+    /// Save to chunked binary data. Each root-level child node forms a chunk with its sub-hierarchy, and a chunk table lists the offset, world position and referenced resources of each chunk, so that chunks can be decoded in parallel or loaded on their own. Return true if successful.
+    bool SaveChunked(Serializer& dest) const;
+    /// Load from chunked binary data. Removes all existing child nodes and components first. The chunks are decoded in parallel on the work queue threads. Return true if successful.
+    bool LoadChunked(Deserializer& source);
+    /// Load the scene attributes and root-level components from chunked binary data and read its chunk table, without loading any chunk. Removes all existing child nodes and components first. Return true if successful.
+    bool LoadChunkedHeader(Deserializer& source, Vector<SceneChunkInfo>& chunks);
+    /// Load chunks by index from chunked binary data whose header has been loaded, decoding them in parallel on the work queue threads. Node and component references are resolved between the chunks loaded together. Optionally return the chunk root nodes, or null for chunks that failed to load. Return true if all were loaded successfully.
+    bool LoadChunks(Deserializer& source, const Vector<SceneChunkInfo>& chunks, const PODVector<unsigned>& indices,
+        PODVector<Node*>* dest = nullptr);
+    /// Create the nodes and components of a scene chunk decoded with DecodeSceneChunk() as a root-level child, optionally assigning new IDs. Resolve the resolver and apply attributes afterward. Return the chunk root node, or null if failed, in which case the objects created are removed and unregistered from the resolver.
+    Node* InstantiateChunk(const SceneChunkData& chunk, SceneResolver& resolver, bool rewriteIDs = false);
     /// Load from an XML file. Return true if successful.
     bool LoadXML(Deserializer& source);
     /// Load from a JSON file. Return true if successful.
@@ -152,6 +175,8 @@ public:
     void SetSmoothingConstant(float constant);
     /// Set network client motion smoothing snap threshold.
     void SetSnapThreshold(float threshold);
+    /// Set whether transform changes during the scene update are batched. When enabled, the moved nodes are queued instead of notifying their listener components right away; their world transforms are then recomputed breadth-first on the WorkQueue threads and the listeners notified together before the scene subsystem update, before each physics step and after the scene post-update. Default false.
+    void SetBatchedTransformUpdate(bool enable);
     /// Set maximum milliseconds per frame to spend on async scene loading.
     void SetAsyncLoadingMs(int ms);
     /// Add a required package file for networking. To be called on the server.
@@ -171,6 +196,10 @@ public:
     Component* GetComponent(unsigned id) const;
     /// Get nodes with specific tag from the whole scene, return false if empty.
     bool GetNodesWithTag(PODVector<Node*>& dest, const String& tag)  const;
+    /// Return all components of a specific type in the whole scene, sorted by memory address so that pooled components are iterated linearly. Does not include subclasses. The type is tracked from the first call on, so that later calls are cheap. The list must not be held while components of the type are created or removed.
+    const PODVector<Component*>& GetComponentsOfType(StringHash type);
+    /// Template version of returning all components of a specific type in the whole scene.
+    template <class T> const PODVector<T*>& GetComponentsOfType();
 
     /// Return whether updates are enabled.
     bool IsUpdateEnabled() const { return updateEnabled_; }
@@ -202,6 +231,9 @@ public:
     /// Return motion smoothing snap threshold.
     float GetSnapThreshold() const { return snapThreshold_; }
 
+    /// Return whether transform changes during the scene update are batched.
+    bool GetBatchedTransformUpdate() const { return batchedTransformUpdate_; }
+
     /// Return maximum milliseconds per frame to spend on async loading.
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
@@ -219,10 +251,28 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Queue a function to be called on the main thread at the end of the threaded update, or call it immediately outside the threaded update. Use for structural changes and event sending from threaded code. Is thread-safe.
+    void DelayedCall(const std::function<void()>& function);
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
 
+    /// Apply the batched transform changes: recompute the world transforms of the queued nodes and notify their listener components.
+    void UpdateTransforms();
+    /// Queue a node whose transform changed while transform changes are batched. Called by Node.
+    void QueueTransformUpdate(Node* node);
+
+    /// Return whether transform changes are currently being batched.
+    bool IsBatchingTransforms() const { return batchingTransforms_; }
+
+    /// Add a logic component to the parallel update, if not added yet. Called by LogicComponent.
+    void AddParallelUpdate(LogicComponent* component);
+    /// Remove a logic component from the parallel update. Called by LogicComponent.
+    void RemoveParallelUpdate(LogicComponent* component);
+
+    /// Return number of logic components in the parallel update.
+    unsigned GetNumParallelUpdates() const { return parallelUpdates_.Size(); }
+
     /// Get free node ID, either non-local or local.
     unsigned GetFreeNodeID(CreateMode mode);
     /// Get free component ID, either non-local or local.
@@ -263,6 +313,14 @@ private:
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    /// Handle the physics pre-step event for the parallel fixed update.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle the physics post-step event for the parallel fixed post-update.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
+    /// Call one update function of the logic components in the parallel update, split between the work queue threads.
+    void ParallelUpdate(UpdateEvent event, float timeStep);
     /// Update asynchronous loading.
     void UpdateAsyncLoading();
     /// Finish asynchronous loading.
@@ -298,13 +356,35 @@ private:
     Vector<SharedPtr<PackageFile> > requiredPackageFiles_;
     /// Registered node user variable reverse mappings.
     HashMap<StringHash, String> varNames_;
+    /// Tracked component types.
+    HashMap<StringHash, ComponentTypeList> componentTypeLists_;
+    /// Nodes with batched transform changes, in the order they were marked dirty.
+    PODVector<Node*> transformQueue_;
+    /// Queued nodes sorted by hierarchy depth.
+    PODVector<Node*> transformLevelNodes_;
+    /// Hierarchy depths of the queued nodes.
+    PODVector<unsigned> transformDepths_;
+    /// Start indices of the hierarchy depth levels in the sorted queued nodes.
+    PODVector<unsigned> transformLevelStarts_;
+    /// Logic components in the parallel update.
+    PODVector<LogicComponent*> parallelUpdates_;
+    /// Logic components being updated in parallel.
+    PODVector<LogicComponent*> parallelUpdateBatch_;
+    /// Nodes of the logic components being updated in parallel.
+    FlatHashSet<Node*> parallelUpdateNodes_;
+    /// Logic components being updated in parallel with the topmost node of their subtree that has components in the update.
+    PODVector<Pair<Node*, LogicComponent*> > parallelUpdateGroups_;
+    /// Fixed update source subscribed to for the parallel fixed updates.
+    WeakPtr<Component> parallelFixedUpdateSource_;
     /// Nodes to check for attribute changes on the next network update.
     HashSet<unsigned> networkUpdateNodes_;
     /// Components to check for attribute changes on the next network update.
     HashSet<unsigned> networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     PODVector<Component*> delayedDirtyComponents_;
-    /// Mutex for the delayed dirty notification queue.
+    /// Functions to call at the end of the threaded update.
+    Vector<std::function<void()> > delayedCalls_;
+    /// Mutex for the delayed dirty notification and call queues.
     Mutex sceneMutex_;
     /// Preallocated event data map for smoothing update events.
     VariantMap smoothingData_;
@@ -334,8 +414,17 @@ private:
     bool asyncLoading_;
     /// Threaded update flag.
     bool threadedUpdate_;
+    /// Batched transform update enabled flag.
+    bool batchedTransformUpdate_;
+    /// Transform changes being batched flag.
+    bool batchingTransforms_;
 };
 
+template <class T> const PODVector<T*>& Scene::GetComponentsOfType()
+{
+    return reinterpret_cast<const PODVector<T*>&>(GetComponentsOfType(T::GetTypeStatic()));
+}
+
 /// Register Scene library objects.
 void URHO3D_API RegisterSceneLibrary(Context* context);
 
@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneChunk.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static bool DecodeSceneChunkNode(Context* context, const Vector<AttributeInfo>* nodeAttributes, SceneChunkData& chunk,
+    MemoryBuffer& source, unsigned parentIndex)
+{
+    // Refer to the node by index, as decoding the children reallocates the node vector
+    unsigned index = chunk.nodes_.Size();
+    chunk.nodes_.Resize(index + 1);
+    chunk.nodes_[index].id_ = source.ReadUInt();
+    chunk.nodes_[index].parentIndex_ = parentIndex;
+
+    if (!Serializable::DecodeAttributes(nodeAttributes, source, chunk.nodes_[index].values_))
+        return false;
+
+    unsigned numComponents = source.ReadVLE();
+    chunk.nodes_[index].components_.Resize(numComponents);
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        SceneChunkComponent& component = chunk.nodes_[index].components_[i];
+        unsigned dataSize = source.ReadVLE();
+        unsigned dataStart = source.GetPosition();
+        if (dataStart + dataSize > source.GetSize())
+            return false;
+
+        MemoryBuffer compBuffer(chunk.buffer_.Buffer() + dataStart, dataSize);
+        component.type_ = compBuffer.ReadStringHash();
+        component.id_ = compBuffer.ReadUInt();
+        component.offset_ = dataStart + compBuffer.GetPosition();
+        component.size_ = dataSize - compBuffer.GetPosition();
+        // Unknown component types are kept as raw data for UnknownComponent
+        if (!context->GetTypeName(component.type_).Empty())
+            component.decoded_ = Serializable::DecodeAttributes(context->GetAttributes(component.type_), compBuffer, component.values_);
+
+        source.Seek(dataStart + dataSize);
+    }
+
+    unsigned numChildren = source.ReadVLE();
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        if (!DecodeSceneChunkNode(context, nodeAttributes, chunk, source, index))
+            return false;
+    }
+
+    return true;
+}
+
+bool SceneChunkInfo::Write(Serializer& dest) const
+{
+    if (!dest.WriteUInt(nodeID_) || !dest.WriteVector3(position_) || !dest.WriteUInt(offset_) || !dest.WriteUInt(size_) ||
+        !dest.WriteVLE(resources_.Size()))
+        return false;
+
+    for (unsigned i = 0; i < resources_.Size(); ++i)
+    {
+        if (!dest.WriteResourceRef(resources_[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool SceneChunkInfo::Read(Deserializer& source, unsigned basePosition)
+{
+    if (source.IsEof())
+        return false;
+
+    nodeID_ = source.ReadUInt();
+    position_ = source.ReadVector3();
+    offset_ = basePosition + source.ReadUInt();
+    size_ = source.ReadUInt();
+    resources_.Resize(source.ReadVLE());
+    for (unsigned i = 0; i < resources_.Size(); ++i)
+        resources_[i] = source.ReadResourceRef();
+
+    // A chunk holds at least the root node ID
+    return size_ >= sizeof(unsigned);
+}
+
+bool ReadSceneChunkTable(Context* context, Deserializer& source, Vector<SceneChunkInfo>& chunks)
+{
+    chunks.Clear();
+
+    // Chunk offsets are relative to the file ID
+    unsigned basePosition = source.GetPosition();
+    if (source.ReadFileID() != "UCSN")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid chunked scene file");
+        return false;
+    }
+
+    // Skip the scene node ID, attributes and root-level components
+    source.ReadUInt();
+    Vector<Variant> values;
+    if (!Serializable::DecodeAttributes(context->GetAttributes(Scene::GetTypeStatic()), source, values))
+        return false;
+    unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        unsigned dataSize = source.ReadVLE();
+        source.Seek(source.GetPosition() + dataSize);
+    }
+
+    chunks.Resize(source.ReadVLE());
+    for (unsigned i = 0; i < chunks.Size(); ++i)
+    {
+        if (!chunks[i].Read(source, basePosition))
+        {
+            URHO3D_LOGERROR("Chunk table of " + source.GetName() + " is invalid");
+            chunks.Clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DecodeSceneChunk(Context* context, SceneChunkData& chunk)
+{
+    chunk.nodes_.Clear();
+    chunk.decoded_ = false;
+    if (chunk.buffer_.Empty())
+        return false;
+
+    MemoryBuffer source(chunk.buffer_);
+    if (!DecodeSceneChunkNode(context, context->GetAttributes(Node::GetTypeStatic()), chunk, source, M_MAX_UNSIGNED))
+        return false;
+
+    chunk.decoded_ = true;
+    return true;
+}
+
+}
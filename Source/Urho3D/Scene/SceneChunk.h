@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Core/Variant.h"
+#include "../Math/Vector3.h"
+
+namespace Urho3D
+{
+
+class Context;
+class Deserializer;
+class Serializer;
+
+/// Chunk table entry of a chunked binary scene file. Each root-level child node of the scene forms a chunk with its sub-hierarchy.
+struct URHO3D_API SceneChunkInfo
+{
+    /// Write to a stream. Return true if successful.
+    bool Write(Serializer& dest) const;
+    /// Read from a stream. The offset is made absolute by adding the start position of the file. Return true if successful.
+    bool Read(Deserializer& source, unsigned basePosition);
+
+    /// ID of the chunk root node.
+    unsigned nodeID_{};
+    /// World position of the chunk root node.
+    Vector3 position_;
+    /// Offset of the chunk data from the start of the file.
+    unsigned offset_{};
+    /// Size of the chunk data in bytes.
+    unsigned size_{};
+    /// Resources referenced by the chunk's components, for preloading.
+    Vector<ResourceRef> resources_;
+};
+
+/// Component decoded from a scene chunk.
+struct SceneChunkComponent
+{
+    /// Component type.
+    StringHash type_;
+    /// Component ID in the file.
+    unsigned id_{};
+    /// Offset of the attribute data in the chunk data.
+    unsigned offset_{};
+    /// Size of the attribute data.
+    unsigned size_{};
+    /// Decoded attribute values, valid if the decoded flag is set.
+    Vector<Variant> values_;
+    /// Decoded flag. If not set, the component is loaded from the attribute data instead.
+    bool decoded_{};
+};
+
+/// Node decoded from a scene chunk.
+struct SceneChunkNode
+{
+    /// Node ID in the file.
+    unsigned id_{};
+    /// Index of the parent node in the chunk, or M_MAX_UNSIGNED for the chunk root.
+    unsigned parentIndex_{};
+    /// Decoded attribute values.
+    Vector<Variant> values_;
+    /// Components.
+    Vector<SceneChunkComponent> components_;
+};
+
+/// Data of a scene chunk and the nodes decoded from it.
+struct SceneChunkData
+{
+    /// Chunk data as saved by Node::Save().
+    PODVector<unsigned char> buffer_;
+    /// Decoded nodes in depth-first order, parents before their children.
+    Vector<SceneChunkNode> nodes_;
+    /// Decoded successfully flag.
+    bool decoded_{};
+};
+
+/// Read the chunk table of chunked binary scene data, skipping the scene attributes and root-level components. Return true if successful.
+URHO3D_API bool ReadSceneChunkTable(Context* context, Deserializer& source, Vector<SceneChunkInfo>& chunks);
+/// Decode the nodes and components of a scene chunk into attribute values without creating any objects. Components whose type is not registered are left to be loaded from their data. Is thread-safe as long as no object types or attributes are being registered. Return true if successful.
+URHO3D_API bool DecodeSceneChunk(Context* context, SceneChunkData& chunk);
+
+}
@@ -27,6 +27,8 @@
 namespace Urho3D
 {
 
+class Scene;
+
 /// Variable timestep scene update.
 URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
@@ -34,6 +36,22 @@ URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed variable timestep scene update.
+struct URHO3D_API SceneUpdateEventData
+{
+    URHO3D_TYPED_EVENT(E_SCENEUPDATE);
+
+    /// Convert to event parameters.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Convert from event parameters.
+    void FromVariantMap(VariantMap& eventData);
+
+    /// Scene.
+    Scene* scene_;
+    /// Time step.
+    float timeStep_;
+};
+
 /// Scene subsystem update.
 URHO3D_EVENT(E_SCENESUBSYSTEMUPDATE, SceneSubsystemUpdate)
 {
@@ -212,4 +230,20 @@ URHO3D_EVENT(E_INTERCEPTNETWORKUPDATE, InterceptNetworkUpdate)
     URHO3D_PARAM(P_VALUE, Value);                  // Variant
 }
 
+/// A world streaming cell has been loaded and instantiated.
+URHO3D_EVENT(E_STREAMINGCELLLOADED, StreamingCellLoaded)
+{
+    URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
+    URHO3D_PARAM(P_INDEX, Index);                  // unsigned
+    URHO3D_PARAM(P_NODE, Node);                    // Node pointer
+}
+
+/// A world streaming cell is about to be unloaded.
+URHO3D_EVENT(E_STREAMINGCELLUNLOADED, StreamingCellUnloaded)
+{
+    URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
+    URHO3D_PARAM(P_INDEX, Index);                  // unsigned
+    URHO3D_PARAM(P_NODE, Node);                    // Node pointer
+}
+
 }
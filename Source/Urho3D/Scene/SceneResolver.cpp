@@ -54,6 +54,16 @@ void SceneResolver::AddComponent(unsigned oldID, Component* component)
         components_[oldID] = component;
 }
 
+void SceneResolver::RemoveNode(unsigned oldID)
+{
+    nodes_.Erase(oldID);
+}
+
+void SceneResolver::RemoveComponent(unsigned oldID)
+{
+    components_.Erase(oldID);
+}
+
 void SceneResolver::Resolve()
 {
     // Nodes do not have component or node ID attributes, so only have to go through components
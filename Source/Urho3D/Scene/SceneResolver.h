@@ -46,6 +46,10 @@ public:
     void AddNode(unsigned oldID, Node* node);
     /// Remember a created component.
     void AddComponent(unsigned oldID, Component* component);
+    /// Forget a node, for example when it has been removed after a failed load.
+    void RemoveNode(unsigned oldID);
+    /// Forget a component.
+    void RemoveComponent(unsigned oldID);
     /// Resolve component and node ID attributes and reset.
     void Resolve();
 
@@ -0,0 +1,588 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+#include "../Scene/SceneStreamer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* SUBSYSTEM_CATEGORY;
+
+static const float DEFAULT_LOAD_DISTANCE = 100.0f;
+static const float DEFAULT_UNLOAD_DISTANCE = 150.0f;
+static const unsigned DEFAULT_MAX_LOADS = 4;
+static const int DEFAULT_TIME_BUDGET = 5;
+
+static void LoadStreamingCellWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* load = reinterpret_cast<StreamingCellLoad*>(item->start_);
+    auto* cache = reinterpret_cast<ResourceCache*>(item->aux_);
+
+    SharedPtr<File> file = cache->GetFile(load->fileName_, false);
+    if (!file || file->Seek(load->offset_) != load->offset_)
+        return;
+
+    load->data_.buffer_.Resize(load->size_);
+    if (file->Read(load->data_.buffer_.Buffer(), load->size_) != load->size_)
+    {
+        load->data_.buffer_.Clear();
+        return;
+    }
+
+    DecodeSceneChunk(cache->GetContext(), load->data_);
+}
+
+SceneStreamer::SceneStreamer(Context* context) :
+    Component(context),
+    loadDistance_(DEFAULT_LOAD_DISTANCE),
+    unloadDistance_(DEFAULT_UNLOAD_DISTANCE),
+    maxLoads_(DEFAULT_MAX_LOADS),
+    timeBudget_(DEFAULT_TIME_BUDGET)
+{
+}
+
+SceneStreamer::~SceneStreamer()
+{
+    while (!loading_.Empty())
+        CancelLoad(loading_.Back());
+}
+
+void SceneStreamer::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SceneStreamer>(SUBSYSTEM_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("World File", GetWorldFile, SetWorldFile, String, String::EMPTY, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Load Distance", GetLoadDistance, SetLoadDistance, float, DEFAULT_LOAD_DISTANCE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Unload Distance", GetUnloadDistance, SetUnloadDistance, float, DEFAULT_UNLOAD_DISTANCE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Max Loads", GetMaxLoads, SetMaxLoads, unsigned, DEFAULT_MAX_LOADS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Time Budget", GetTimeBudget, SetTimeBudget, int, DEFAULT_TIME_BUDGET, AM_DEFAULT);
+}
+
+unsigned SceneStreamer::Partition(Scene* scene, float cellSize)
+{
+    if (!scene || cellSize <= 0.0f)
+    {
+        URHO3D_LOGERROR("Null scene or non-positive cell size for partitioning");
+        return 0;
+    }
+
+    // Take a copy of the children, as they are reparented during iteration
+    Vector<SharedPtr<Node> > children = scene->GetChildren();
+    HashMap<IntVector2, Node*> cells;
+
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        Node* child = children[i];
+        if (child->IsTemporary())
+            continue;
+
+        Vector3 position = child->GetWorldPosition();
+        IntVector2 coords(FloorToInt(position.x_ / cellSize), FloorToInt(position.z_ / cellSize));
+        HashMap<IntVector2, Node*>::Iterator j = cells.Find(coords);
+        Node* cell;
+        if (j != cells.End())
+            cell = j->second_;
+        else
+        {
+            cell = scene->CreateChild("Cell " + coords.ToString());
+            cell->SetPosition(Vector3((coords.x_ + 0.5f) * cellSize, 0.0f, (coords.y_ + 0.5f) * cellSize));
+            cells[coords] = cell;
+        }
+
+        child->SetParent(cell);
+    }
+
+    return cells.Size();
+}
+
+bool SceneStreamer::SetWorldFile(const String& fileName)
+{
+    if (fileName == fileName_ && !cells_.Empty())
+        return true;
+
+    UnloadAllCells();
+    cells_.Clear();
+    fileName_ = fileName;
+    MarkNetworkUpdate();
+
+    if (fileName_.Empty())
+        return true;
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    SharedPtr<File> file = cache->GetFile(fileName_);
+    if (!file)
+        return false;
+
+    Vector<SceneChunkInfo> chunks;
+    if (!ReadSceneChunkTable(context_, *file, chunks))
+    {
+        URHO3D_LOGERROR("Could not read the chunk table of " + fileName_);
+        return false;
+    }
+
+    cells_.Resize(chunks.Size());
+    for (unsigned i = 0; i < chunks.Size(); ++i)
+        cells_[i].info_ = chunks[i];
+
+    return true;
+}
+
+void SceneStreamer::AddFocus(Node* node)
+{
+    if (!node)
+        return;
+
+    for (unsigned i = 0; i < focusNodes_.Size(); ++i)
+    {
+        if (focusNodes_[i] == node)
+            return;
+    }
+
+    focusNodes_.Push(WeakPtr<Node>(node));
+}
+
+void SceneStreamer::RemoveFocus(Node* node)
+{
+    for (unsigned i = 0; i < focusNodes_.Size(); ++i)
+    {
+        if (focusNodes_[i] == node)
+        {
+            focusNodes_.Erase(i);
+            return;
+        }
+    }
+}
+
+void SceneStreamer::RemoveAllFocus()
+{
+    focusNodes_.Clear();
+}
+
+void SceneStreamer::SetLoadDistance(float distance)
+{
+    loadDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void SceneStreamer::SetUnloadDistance(float distance)
+{
+    unloadDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void SceneStreamer::SetMaxLoads(unsigned maxLoads)
+{
+    maxLoads_ = Max(maxLoads, 1U);
+    MarkNetworkUpdate();
+}
+
+void SceneStreamer::SetTimeBudget(int ms)
+{
+    timeBudget_ = Max(ms, 0);
+    MarkNetworkUpdate();
+}
+
+bool SceneStreamer::LoadCell(unsigned index)
+{
+    if (index >= cells_.Size())
+    {
+        URHO3D_LOGERROR("Cell index out of bounds");
+        return false;
+    }
+
+    if (cells_[index].state_ == CELL_LOADED)
+        return true;
+    if (cells_[index].state_ == CELL_UNLOADED && !StartLoad(index))
+        return false;
+
+    // Complete the load in the main thread unless already taken by a worker thread
+    StreamingCellLoad* load = cells_[index].load_;
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (queue && queue->RemoveWorkItem(load->item_))
+        LoadStreamingCellWork(load->item_, 0);
+    else
+    {
+        while (!load->item_->completed_)
+            Time::Sleep(0);
+    }
+
+    return FinishLoad(index);
+}
+
+void SceneStreamer::UnloadCell(unsigned index)
+{
+    if (index >= cells_.Size())
+        return;
+
+    StreamingCell& cell = cells_[index];
+    if (cell.state_ == CELL_UNLOADED)
+        return;
+
+    if (cell.state_ == CELL_LOADING)
+        CancelLoad(index);
+    else if (cell.node_)
+    {
+        using namespace StreamingCellUnloaded;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_SCENE] = GetScene();
+        eventData[P_INDEX] = index;
+        eventData[P_NODE] = cell.node_.Get();
+        SendEvent(E_STREAMINGCELLUNLOADED, eventData);
+
+        if (cell.node_)
+            cell.node_->Remove();
+    }
+
+    cell.node_.Reset();
+    cell.state_ = CELL_UNLOADED;
+    ReleaseCellResources(index);
+}
+
+void SceneStreamer::UnloadAllCells()
+{
+    for (unsigned i = 0; i < cells_.Size(); ++i)
+        UnloadCell(i);
+}
+
+unsigned SceneStreamer::GetNumLoadedCells() const
+{
+    unsigned num = 0;
+    for (unsigned i = 0; i < cells_.Size(); ++i)
+    {
+        if (cells_[i].state_ == CELL_LOADED)
+            ++num;
+    }
+    return num;
+}
+
+StreamingCellState SceneStreamer::GetCellState(unsigned index) const
+{
+    return index < cells_.Size() ? cells_[index].state_ : CELL_UNLOADED;
+}
+
+Vector3 SceneStreamer::GetCellPosition(unsigned index) const
+{
+    return index < cells_.Size() ? cells_[index].info_.position_ : Vector3::ZERO;
+}
+
+Node* SceneStreamer::GetCellNode(unsigned index) const
+{
+    return index < cells_.Size() ? cells_[index].node_.Get() : nullptr;
+}
+
+unsigned long long SceneStreamer::GetCellMemoryUse(unsigned index) const
+{
+    if (index >= cells_.Size())
+        return 0;
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    const SceneChunkInfo& info = cells_[index].info_;
+    unsigned long long total = info.size_;
+    for (unsigned i = 0; i < info.resources_.Size(); ++i)
+    {
+        Resource* resource = cache->GetExistingResource(info.resources_[i].type_, info.resources_[i].name_);
+        if (resource)
+            total += resource->GetMemoryUse();
+    }
+    return total;
+}
+
+unsigned long long SceneStreamer::GetMemoryUse() const
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    HashSet<Resource*> counted;
+    unsigned long long total = 0;
+
+    for (unsigned i = 0; i < cells_.Size(); ++i)
+    {
+        if (cells_[i].state_ != CELL_LOADED)
+            continue;
+
+        const SceneChunkInfo& info = cells_[i].info_;
+        total += info.size_;
+        for (unsigned j = 0; j < info.resources_.Size(); ++j)
+        {
+            Resource* resource = cache->GetExistingResource(info.resources_[j].type_, info.resources_[j].name_);
+            bool exists;
+            if (resource)
+            {
+                counted.Insert(resource, exists);
+                if (!exists)
+                    total += resource->GetMemoryUse();
+            }
+        }
+    }
+    return total;
+}
+
+void SceneStreamer::OnSceneSet(Scene* scene)
+{
+    if (scene)
+    {
+        if (scene != node_)
+        {
+            URHO3D_LOGERROR("SceneStreamer is a scene component and should only be attached to the scene node");
+            return;
+        }
+
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(SceneStreamer, HandleSceneUpdate));
+        SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(SceneStreamer, HandleResourceBackgroundLoaded));
+    }
+    else
+    {
+        // The loaded cells stay in the scene, but loads in progress are abandoned
+        while (!loading_.Empty())
+        {
+            unsigned index = loading_.Back();
+            CancelLoad(index);
+            cells_[index].state_ = CELL_UNLOADED;
+        }
+
+        UnsubscribeFromEvent(E_SCENEUPDATE);
+        UnsubscribeFromEvent(E_RESOURCEBACKGROUNDLOADED);
+    }
+}
+
+bool SceneStreamer::StartLoad(unsigned index)
+{
+    StreamingCell& cell = cells_[index];
+    if (!cell.info_.size_)
+    {
+        URHO3D_LOGERROR("Cell " + String(index) + " of " + fileName_ + " is empty");
+        return false;
+    }
+
+    SharedPtr<StreamingCellLoad> load(new StreamingCellLoad());
+    load->fileName_ = fileName_;
+    load->offset_ = cell.info_.offset_;
+    load->size_ = cell.info_.size_;
+
+    // If not threaded, can not background load resources, so rather load synchronously when instantiating
+#ifdef URHO3D_THREADING
+    auto* cache = GetSubsystem<ResourceCache>();
+    const Vector<ResourceRef>& resources = cell.info_.resources_;
+    for (unsigned i = 0; i < resources.Size(); ++i)
+    {
+        // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
+        String name = cache->SanitateResourceName(resources[i].name_);
+        if (cache->BackgroundLoadResource(resources[i].type_, name))
+            load->resources_.Insert(StringHash(name));
+    }
+#endif
+
+    // Read and decode the chunk in a low-priority work item, which is completed in the main thread at the beginning of the frame if there are no worker threads.
+    // Not taken from the pool, as the completed flag is polled after the work queue has purged the item
+    auto* queue = GetSubsystem<WorkQueue>();
+    load->item_ = new WorkItem();
+    load->item_->priority_ = 0;
+    load->item_->workFunction_ = LoadStreamingCellWork;
+    load->item_->start_ = load.Get();
+    load->item_->aux_ = GetSubsystem<ResourceCache>();
+    if (queue)
+        queue->AddWorkItem(load->item_);
+    else
+    {
+        // Without a work queue, decode immediately
+        LoadStreamingCellWork(load->item_, 0);
+        load->item_->completed_ = true;
+    }
+
+    cell.load_ = load;
+    cell.state_ = CELL_LOADING;
+    loading_.Push(index);
+    return true;
+}
+
+bool SceneStreamer::FinishLoad(unsigned index)
+{
+    StreamingCell& cell = cells_[index];
+    SharedPtr<StreamingCellLoad> load = cell.load_;
+    cell.load_.Reset();
+    loading_.Remove(index);
+
+    // A cell that fails to load is left in the loaded state without a node, so that it is not retried until unloaded
+    cell.state_ = CELL_LOADED;
+    Scene* scene = GetScene();
+    if (!scene || !load->data_.decoded_)
+    {
+        URHO3D_LOGERROR("Could not load cell " + String(index) + " from " + fileName_);
+        return false;
+    }
+
+    URHO3D_PROFILE(InstantiateStreamingCell);
+
+    // Assign new IDs, as cells loaded into the same scene over time may have conflicting IDs with nodes created meanwhile
+    SceneResolver resolver;
+    Node* node = scene->InstantiateChunk(load->data_, resolver, true);
+    if (!node)
+    {
+        URHO3D_LOGERROR("Could not instantiate cell " + String(index) + " from " + fileName_);
+        return false;
+    }
+
+    resolver.Resolve();
+    node->ApplyAttributes();
+    cell.node_ = node;
+
+    using namespace StreamingCellLoaded;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_SCENE] = scene;
+    eventData[P_INDEX] = index;
+    eventData[P_NODE] = node;
+    SendEvent(E_STREAMINGCELLLOADED, eventData);
+
+    return true;
+}
+
+void SceneStreamer::CancelLoad(unsigned index)
+{
+    SharedPtr<StreamingCellLoad> load = cells_[index].load_;
+    cells_[index].load_.Reset();
+    loading_.Remove(index);
+    if (!load)
+        return;
+
+    // A load already taken by a worker thread refers to the load data, so wait for it to finish
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (queue && !queue->RemoveWorkItem(load->item_))
+    {
+        while (!load->item_->completed_)
+            Time::Sleep(0);
+    }
+}
+
+void SceneStreamer::ReleaseCellResources(unsigned index)
+{
+    // Compare sanitated names, as the same resource may be referred to with different spellings
+    auto* cache = GetSubsystem<ResourceCache>();
+    HashSet<StringHash> used;
+    for (unsigned i = 0; i < cells_.Size(); ++i)
+    {
+        if (cells_[i].state_ == CELL_UNLOADED)
+            continue;
+
+        const Vector<ResourceRef>& resources = cells_[i].info_.resources_;
+        for (unsigned j = 0; j < resources.Size(); ++j)
+            used.Insert(StringHash(cache->SanitateResourceName(resources[j].name_)));
+    }
+
+    // Resources still referenced elsewhere, for example by nodes created outside the streamer, are kept by the cache
+    const Vector<ResourceRef>& resources = cells_[index].info_.resources_;
+    for (unsigned i = 0; i < resources.Size(); ++i)
+    {
+        String name = cache->SanitateResourceName(resources[i].name_);
+        if (!used.Contains(StringHash(name)))
+            cache->ReleaseResource(resources[i].type_, name);
+    }
+}
+
+void SceneStreamer::UpdateCells()
+{
+    URHO3D_PROFILE(UpdateSceneStreamer);
+
+    PODVector<Vector3> focusPositions;
+    for (unsigned i = 0; i < focusNodes_.Size();)
+    {
+        if (focusNodes_[i])
+        {
+            focusPositions.Push(focusNodes_[i]->GetWorldPosition());
+            ++i;
+        }
+        else
+            focusNodes_.Erase(i);
+    }
+
+    if (!focusPositions.Empty())
+    {
+        // Unload the cells beyond the unload distance of all focus nodes and collect the unloaded cells within the load distance
+        PODVector<Pair<float, unsigned> > candidates;
+        for (unsigned i = 0; i < cells_.Size(); ++i)
+        {
+            float distance = M_INFINITY;
+            for (unsigned j = 0; j < focusPositions.Size(); ++j)
+                distance = Min(distance, (cells_[i].info_.position_ - focusPositions[j]).Length());
+
+            if (cells_[i].state_ == CELL_UNLOADED)
+            {
+                if (distance <= loadDistance_)
+                    candidates.Push(MakePair(distance, i));
+            }
+            else if (distance > Max(unloadDistance_, loadDistance_))
+                UnloadCell(i);
+        }
+
+        // Start loading the nearest cells first
+        Sort(candidates.Begin(), candidates.End());
+        for (unsigned i = 0; i < candidates.Size() && loading_.Size() < maxLoads_; ++i)
+            StartLoad(candidates[i].second_);
+    }
+
+    // Instantiate the decoded cells whose resources have finished loading, in the order they were started
+    HiresTimer timer;
+    long long maxUSec = timeBudget_ * 1000LL;
+    for (unsigned i = 0; i < loading_.Size();)
+    {
+        StreamingCellLoad* load = cells_[loading_[i]].load_;
+        if (load->item_->completed_ && load->resources_.Empty())
+        {
+            FinishLoad(loading_[i]);
+            if (timer.GetUSec(false) >= maxUSec)
+                break;
+        }
+        else
+            ++i;
+    }
+}
+
+void SceneStreamer::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (IsEnabledEffective())
+        UpdateCells();
+}
+
+void SceneStreamer::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ResourceBackgroundLoaded;
+
+    StringHash nameHash(eventData[P_RESOURCENAME].GetString());
+    for (unsigned i = 0; i < loading_.Size(); ++i)
+        cells_[loading_[i]].load_->resources_.Erase(nameHash);
+}
+
+}
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2008-2018 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashSet.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/Component.h"
+#include "../Scene/SceneChunk.h"
+
+namespace Urho3D
+{
+
+/// Streaming state of a scene cell.
+enum StreamingCellState
+{
+    CELL_UNLOADED = 0,
+    CELL_LOADING,
+    CELL_LOADED
+};
+
+/// Asynchronous load of a streaming cell.
+struct StreamingCellLoad : public RefCounted
+{
+    /// Work item reading and decoding the chunk.
+    SharedPtr<WorkItem> item_;
+    /// Chunked scene file name.
+    String fileName_;
+    /// Offset of the chunk data in the file.
+    unsigned offset_{};
+    /// Size of the chunk data.
+    unsigned size_{};
+    /// Chunk data, decoded by the work item.
+    SceneChunkData data_;
+    /// Name hashes of the resources still being background loaded.
+    HashSet<StringHash> resources_;
+};
+
+/// Spatial cell of a streamed world.
+struct StreamingCell
+{
+    /// Chunk table entry of the cell.
+    SceneChunkInfo info_;
+    /// Cell root node when loaded.
+    WeakPtr<Node> node_;
+    /// Load in progress.
+    SharedPtr<StreamingCellLoad> load_;
+    /// Streaming state.
+    StreamingCellState state_{CELL_UNLOADED};
+};
+
+/// World streaming scene component. Loads the cells of a chunked binary scene file asynchronously around the focus nodes and unloads the far ones, releasing their resources. Each chunk of the file is a cell, positioned at its root node. Should be added only to the root scene node.
+class URHO3D_API SceneStreamer : public Component
+{
+    URHO3D_OBJECT(SceneStreamer, Component);
+
+public:
+    /// Construct.
+    explicit SceneStreamer(Context* context);
+    /// Destruct.
+    ~SceneStreamer() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Move the root-level child nodes of a scene under cell nodes at the centers of a grid on the XZ plane, so that saving the scene with Scene::SaveChunked() makes one chunk for each cell. Return the number of cells.
+    static unsigned Partition(Scene* scene, float cellSize);
+
+    /// Set the chunked binary scene file to stream the cells from. Unloads any cells of the previous file. Return true if successful.
+    bool SetWorldFile(const String& fileName);
+    /// Add a node around which the cells are loaded.
+    void AddFocus(Node* node);
+    /// Remove a focus node.
+    void RemoveFocus(Node* node);
+    /// Remove all focus nodes.
+    void RemoveAllFocus();
+    /// Set the distance from a focus node within which cells are loaded.
+    void SetLoadDistance(float distance);
+    /// Set the distance from all focus nodes beyond which cells are unloaded. Should be larger than the load distance to avoid cells being reloaded repeatedly.
+    void SetUnloadDistance(float distance);
+    /// Set the maximum number of cells loading at the same time.
+    void SetMaxLoads(unsigned maxLoads);
+    /// Set the time in milliseconds per frame to spend on instantiating loaded cells. At least one cell is instantiated each frame when ready.
+    void SetTimeBudget(int ms);
+    /// Load a cell immediately regardless of the focus nodes. Return true if successful.
+    bool LoadCell(unsigned index);
+    /// Unload a cell and release its resources that are not used by other cells.
+    void UnloadCell(unsigned index);
+    /// Unload all cells.
+    void UnloadAllCells();
+
+    /// Return the chunked binary scene file name.
+    const String& GetWorldFile() const { return fileName_; }
+
+    /// Return the number of focus nodes.
+    unsigned GetNumFocus() const { return focusNodes_.Size(); }
+
+    /// Return the load distance.
+    float GetLoadDistance() const { return loadDistance_; }
+
+    /// Return the unload distance.
+    float GetUnloadDistance() const { return unloadDistance_; }
+
+    /// Return the maximum number of cells loading at the same time.
+    unsigned GetMaxLoads() const { return maxLoads_; }
+
+    /// Return the time budget in milliseconds per frame.
+    int GetTimeBudget() const { return timeBudget_; }
+
+    /// Return the number of cells.
+    unsigned GetNumCells() const { return cells_.Size(); }
+
+    /// Return the number of loaded cells.
+    unsigned GetNumLoadedCells() const;
+    /// Return the streaming state of a cell.
+    StreamingCellState GetCellState(unsigned index) const;
+    /// Return the position of a cell.
+    Vector3 GetCellPosition(unsigned index) const;
+    /// Return the root node of a cell, or null if not loaded.
+    Node* GetCellNode(unsigned index) const;
+    /// Return the memory use in bytes of a cell: its chunk data and its resources currently in the resource cache.
+    unsigned long long GetCellMemoryUse(unsigned index) const;
+    /// Return the memory use in bytes of the loaded cells, counting resources shared by several cells once.
+    unsigned long long GetMemoryUse() const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Start loading a cell. Return true if successful.
+    bool StartLoad(unsigned index);
+    /// Instantiate a cell whose chunk has been decoded. Return true if successful.
+    bool FinishLoad(unsigned index);
+    /// Stop a load in progress, waiting for its work item if already taken by a worker thread.
+    void CancelLoad(unsigned index);
+    /// Release the resources of a cell that are not used by other loaded or loading cells.
+    void ReleaseCellResources(unsigned index);
+    /// Load and unload cells according to the focus nodes and instantiate loaded cells within the time budget.
+    void UpdateCells();
+    /// Handle the scene update event.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle a background loaded resource.
+    void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+
+    /// Chunked binary scene file name.
+    String fileName_;
+    /// Cells.
+    Vector<StreamingCell> cells_;
+    /// Focus nodes.
+    Vector<WeakPtr<Node> > focusNodes_;
+    /// Indices of the loading cells, in the order they were started.
+    PODVector<unsigned> loading_;
+    /// Load distance.
+    float loadDistance_;
+    /// Unload distance.
+    float unloadDistance_;
+    /// Maximum number of cells loading at the same time.
+    unsigned maxLoads_;
+    /// Time budget in milliseconds per frame.
+    int timeBudget_;
+};
+
+}
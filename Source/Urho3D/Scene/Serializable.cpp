@@ -308,8 +308,59 @@ bool Serializable::Load(Deserializer& source)
             return false;
         }
 
-        Variant varValue = source.ReadVariant(attr.type_);
-        OnSetAttribute(attr, varValue);
+        // Read attributes with accessors as their own type, unless the instance defaults are being recorded or the class
+        // intercepts attribute access
+        if (attr.typedAccess_ && attr.accessor_ && !setInstanceDefault_)
+            attr.accessor_->Read(this, source, attr.type_);
+        else
+            OnSetAttribute(attr, source.ReadVariant(attr.type_));
+    }
+
+    return true;
+}
+
+bool Serializable::LoadValues(const Vector<Variant>& values)
+{
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    unsigned valueIndex = 0;
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (valueIndex >= values.Size())
+        {
+            URHO3D_LOGERROR("Could not load " + GetTypeName() + ", not enough attribute values");
+            return false;
+        }
+
+        OnSetAttribute(attr, values[valueIndex++]);
+    }
+
+    return true;
+}
+
+bool Serializable::DecodeAttributes(const Vector<AttributeInfo>* attributes, Deserializer& source, Vector<Variant>& values)
+{
+    values.Clear();
+    if (!attributes)
+        return true;
+
+    values.Reserve(attributes->Size());
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if (!(attr.mode_ & AM_FILE))
+            continue;
+
+        if (source.IsEof())
+            return false;
+
+        values.Push(source.ReadVariant(attr.type_));
     }
 
     return true;
@@ -329,9 +380,17 @@ bool Serializable::Save(Serializer& dest) const
         if (!(attr.mode_ & AM_FILE) || (attr.mode_ & AM_FILEREADONLY) == AM_FILEREADONLY)
             continue;
 
-        OnGetAttribute(attr, value);
+        // Write attributes with accessors as their own type, unless the class intercepts attribute access
+        bool success;
+        if (attr.typedAccess_ && attr.accessor_)
+            success = attr.accessor_->Write(this, dest);
+        else
+        {
+            OnGetAttribute(attr, value);
+            success = dest.WriteVariantData(value);
+        }
 
-        if (!dest.WriteVariantData(value))
+        if (!success)
         {
             URHO3D_LOGERROR("Could not save " + GetTypeName() + ", writing to stream failed");
             return false;
@@ -647,6 +706,42 @@ bool Serializable::SetAttribute(const String& name, const Variant& value)
     return false;
 }
 
+bool Serializable::SetAttributeValues(const Vector<Variant>& values)
+{
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+    {
+        URHO3D_LOGERROR(GetTypeName() + " has no attributes");
+        return false;
+    }
+
+    bool success = true;
+    if (values.Size() != attributes->Size())
+    {
+        URHO3D_LOGERROR("Could not set all attributes of " + GetTypeName() + ": expected " + String(attributes->Size()) +
+                 " values but got " + String(values.Size()));
+        success = false;
+    }
+
+    unsigned numValues = Min(values.Size(), attributes->Size());
+    for (unsigned i = 0; i < numValues; ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+
+        // Check that the new value's type matches the attribute type
+        if (values[i].GetType() == attr.type_)
+            OnSetAttribute(attr, values[i]);
+        else
+        {
+            URHO3D_LOGERROR("Could not set attribute " + attr.name_ + ": expected type " + Variant::GetTypeName(attr.type_) +
+                     " but got " + values[i].GetTypeName());
+            success = false;
+        }
+    }
+
+    return success;
+}
+
 void Serializable::ResetToDefault()
 {
     const Vector<AttributeInfo>* attributes = GetAttributes();
@@ -728,9 +823,12 @@ void Serializable::AllocateNetworkState()
         networkState_->currentValues_.Resize(numAttributes);
         networkState_->previousValues_.Resize(numAttributes);
 
-        // Copy the default attribute values to the previous state as a starting point
+        // Copy the default attribute values to the current and previous state as a starting point
         for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            networkState_->currentValues_[i] = networkAttributes->At(i).defaultValue_;
             networkState_->previousValues_[i] = networkAttributes->At(i).defaultValue_;
+        }
     }
 }
 
@@ -943,6 +1041,21 @@ Variant Serializable::GetAttribute(const String& name) const
     return ret;
 }
 
+void Serializable::GetAttributeValues(Vector<Variant>& dest) const
+{
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+    {
+        dest.Clear();
+        return;
+    }
+
+    // Assigning to the existing values reuses their storage when the type does not change
+    dest.Resize(attributes->Size());
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+        OnGetAttribute(attributes->At(i), dest[i]);
+}
+
 Variant Serializable::GetAttributeDefault(unsigned index) const
 {
     const Vector<AttributeInfo>* attributes = GetAttributes();
@@ -998,6 +1111,31 @@ unsigned Serializable::GetNumNetworkAttributes() const
     return attributes ? attributes->Size() : 0;
 }
 
+bool Serializable::UpdateNetworkAttribute(unsigned index)
+{
+    const AttributeInfo& attr = networkState_->attributes_->At(index);
+    Variant& current = networkState_->currentValues_[index];
+    Variant& previous = networkState_->previousValues_[index];
+
+    // Compare attributes with accessors as their own type. The current value follows the previous value, which may have been
+    // reset to force resending the attribute
+    if (attr.typedAccess_ && attr.accessor_)
+    {
+        if (!attr.accessor_->Update(this, previous))
+            return false;
+
+        current = previous;
+        return true;
+    }
+
+    OnGetAttribute(attr, current);
+    if (current == previous)
+        return false;
+
+    previous = current;
+    return true;
+}
+
 bool Serializable::GetInterceptNetworkUpdate(const String& attributeName) const
 {
     const Vector<AttributeInfo>* attributes = GetNetworkAttributes();
@@ -24,6 +24,8 @@
 
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
 
 #include <cstddef>
 
@@ -31,8 +33,6 @@ namespace Urho3D
 {
 
 class Connection;
-class Deserializer;
-class Serializer;
 class XMLElement;
 class JSONValue;
 
@@ -51,9 +51,9 @@ public:
     /// Destruct.
     ~Serializable() override;
 
-    /// Handle attribute write access. Default implementation writes to the variable at offset, or invokes the set accessor.
+    /// Handle attribute write access. Default implementation writes to the variable at offset, or invokes the set accessor. Binary loading sets attributes with accessors directly through the accessor.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
-    /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor.
+    /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor. Binary saving and network change detection read attributes with accessors directly through the accessor.
     virtual void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const;
     /// Return attribute descriptions, or null if none defined.
     virtual const Vector<AttributeInfo>* GetAttributes() const;
@@ -63,6 +63,8 @@ public:
     virtual bool Load(Deserializer& source);
     /// Save as binary data. Return true if successful.
     virtual bool Save(Serializer& dest) const;
+    /// Load from attribute values decoded from binary data with DecodeAttributes(). Subclasses that override Load() to change how the attributes are applied should override this as well. Return true if successful.
+    virtual bool LoadValues(const Vector<Variant>& values);
     /// Load from XML data. Return true if successful.
     virtual bool LoadXML(const XMLElement& source);
     /// Save as XML data. Return true if successful.
@@ -85,6 +87,8 @@ public:
     bool SetAttribute(unsigned index, const Variant& value);
     /// Set attribute by name. Return true if successfully set.
     bool SetAttribute(const String& name, const Variant& value);
+    /// Set all attributes from values in attribute order. Values of the wrong type are skipped. Return true if all were set.
+    bool SetAttributeValues(const Vector<Variant>& values);
     /// Set instance-level default flag.
     void SetInstanceDefault(bool enable) { setInstanceDefault_ = enable; }
     /// Reset all editable attributes to their default values.
@@ -107,11 +111,15 @@ public:
     bool ReadDeltaUpdate(Deserializer& source);
     /// Read and apply a network latest data update. Return true if attributes were changed.
     bool ReadLatestDataUpdate(Deserializer& source);
+    /// Decode binary data saved with attribute descriptions into values without creating an object, as Load() would read them. Is thread-safe. Return true if successful.
+    static bool DecodeAttributes(const Vector<AttributeInfo>* attributes, Deserializer& source, Vector<Variant>& values);
 
     /// Return attribute value by index. Return empty if illegal index.
     Variant GetAttribute(unsigned index) const;
     /// Return attribute value by name. Return empty if not found.
     Variant GetAttribute(const String& name) const;
+    /// Return all attribute values in attribute order, reusing the storage of the destination values.
+    void GetAttributeValues(Vector<Variant>& dest) const;
     /// Return attribute default value by index. Return empty if illegal index.
     Variant GetAttributeDefault(unsigned index) const;
     /// Return attribute default value by name. Return empty if not found.
@@ -131,6 +139,9 @@ public:
     NetworkState* GetNetworkState() const { return networkState_.Get(); }
 
 protected:
+    /// Read a network attribute into the network state. Return true if it changed since the previous update.
+    bool UpdateNetworkAttribute(unsigned index);
+
     /// Network attribute state.
     UniquePtr<NetworkState> networkState_;
 
@@ -179,6 +190,124 @@ private:
     TSetFunction setFunction_;
 };
 
+/// Binary attribute data of a type, in the format of Serializer::WriteVariantData() and Deserializer::ReadVariant(). Types without a specialization are converted through a Variant.
+template <class T> struct AttributeData
+{
+    /// Write a value.
+    static bool Write(Serializer& dest, const T& value) { return dest.WriteVariantData(Variant(value)); }
+    /// Read a value.
+    static T Read(Deserializer& source) { return source.ReadVariant(GetVariantType<T>()).template Get<T>(); }
+};
+
+/// Specialize the binary attribute data of a type to use serializer functions directly.
+#define URHO3D_ATTRIBUTE_DATA(typeName, writeFunction, readFunction) template <> struct AttributeData<typeName > \
+{ \
+    static bool Write(Serializer& dest, const typeName& value) { return dest.writeFunction(value); } \
+    static typeName Read(Deserializer& source) { return source.readFunction(); } \
+}
+
+URHO3D_ATTRIBUTE_DATA(int, WriteInt, ReadInt);
+URHO3D_ATTRIBUTE_DATA(unsigned, WriteUInt, ReadUInt);
+URHO3D_ATTRIBUTE_DATA(long long, WriteInt64, ReadInt64);
+URHO3D_ATTRIBUTE_DATA(unsigned long long, WriteUInt64, ReadUInt64);
+URHO3D_ATTRIBUTE_DATA(bool, WriteBool, ReadBool);
+URHO3D_ATTRIBUTE_DATA(float, WriteFloat, ReadFloat);
+URHO3D_ATTRIBUTE_DATA(double, WriteDouble, ReadDouble);
+URHO3D_ATTRIBUTE_DATA(Vector2, WriteVector2, ReadVector2);
+URHO3D_ATTRIBUTE_DATA(Vector3, WriteVector3, ReadVector3);
+URHO3D_ATTRIBUTE_DATA(Vector4, WriteVector4, ReadVector4);
+URHO3D_ATTRIBUTE_DATA(Quaternion, WriteQuaternion, ReadQuaternion);
+URHO3D_ATTRIBUTE_DATA(Color, WriteColor, ReadColor);
+URHO3D_ATTRIBUTE_DATA(IntRect, WriteIntRect, ReadIntRect);
+URHO3D_ATTRIBUTE_DATA(IntVector2, WriteIntVector2, ReadIntVector2);
+URHO3D_ATTRIBUTE_DATA(IntVector3, WriteIntVector3, ReadIntVector3);
+URHO3D_ATTRIBUTE_DATA(Matrix3, WriteMatrix3, ReadMatrix3);
+URHO3D_ATTRIBUTE_DATA(Matrix3x4, WriteMatrix3x4, ReadMatrix3x4);
+URHO3D_ATTRIBUTE_DATA(Matrix4, WriteMatrix4, ReadMatrix4);
+URHO3D_ATTRIBUTE_DATA(String, WriteString, ReadString);
+URHO3D_ATTRIBUTE_DATA(PODVector<unsigned char>, WriteBuffer, ReadBuffer);
+URHO3D_ATTRIBUTE_DATA(ResourceRef, WriteResourceRef, ReadResourceRef);
+URHO3D_ATTRIBUTE_DATA(ResourceRefList, WriteResourceRefList, ReadResourceRefList);
+URHO3D_ATTRIBUTE_DATA(VariantVector, WriteVariantVector, ReadVariantVector);
+URHO3D_ATTRIBUTE_DATA(StringVector, WriteStringVector, ReadStringVector);
+URHO3D_ATTRIBUTE_DATA(VariantMap, WriteVariantMap, ReadVariantMap);
+
+#undef URHO3D_ATTRIBUTE_DATA
+
+/// Template implementation of the typed attribute accessor. Binary serialization and network change detection access the value as its own type instead of converting to a Variant.
+template <class TClassType, class T, class TGetFunction, class TSetFunction>
+class TypedAttributeAccessorImpl : public AttributeAccessor
+{
+public:
+    /// Construct.
+    TypedAttributeAccessorImpl(TGetFunction getFunction, TSetFunction setFunction) : getFunction_(getFunction), setFunction_(setFunction) { }
+
+    /// Invoke getter function.
+    void Get(const Serializable* ptr, Variant& value) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        value = getFunction_(*classPtr);
+    }
+
+    /// Invoke setter function.
+    void Set(Serializable* ptr, const Variant& value) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        setFunction_(*classPtr, value.Get<T>());
+    }
+
+    /// Write the value returned by the getter function.
+    bool Write(const Serializable* ptr, Serializer& dest) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        return AttributeData<T>::Write(dest, getFunction_(*classPtr));
+    }
+
+    /// Read a value and invoke the setter function.
+    void Read(Serializable* ptr, Deserializer& source, VariantType type) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        if (type == GetVariantType<T>())
+            setFunction_(*classPtr, AttributeData<T>::Read(source));
+        else
+            setFunction_(*classPtr, source.ReadVariant(type).Get<T>());
+    }
+
+    /// Compare the value returned by the getter function.
+    bool Update(const Serializable* ptr, Variant& value) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        const T& current = getFunction_(*classPtr);
+        if (value == current)
+            return false;
+
+        value = current;
+        return true;
+    }
+
+private:
+    /// Get functor.
+    TGetFunction getFunction_;
+    /// Set functor.
+    TSetFunction setFunction_;
+};
+
+/// Make typed attribute accessor implementation.
+/// \tparam TClassType Serializable class type.
+/// \tparam T Attribute value type.
+/// \tparam TGetFunction Functional object with call signature `T getFunction(const TClassType& self)`, which may also return a reference.
+/// \tparam TSetFunction Functional object with call signature `void setFunction(TClassType& self, const T& value)`
+template <class TClassType, class T, class TGetFunction, class TSetFunction>
+SharedPtr<AttributeAccessor> MakeTypedAttributeAccessor(TGetFunction getFunction, TSetFunction setFunction)
+{
+    return SharedPtr<AttributeAccessor>(new TypedAttributeAccessorImpl<TClassType, T, TGetFunction, TSetFunction>(getFunction, setFunction));
+}
+
 /// Make variant attribute accessor implementation.
 /// \tparam TClassType Serializable class type.
 /// \tparam TGetFunction Functional object with call signature `void getFunction(const TClassType& self, Variant& value)`
@@ -189,35 +318,35 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     return SharedPtr<AttributeAccessor>(new VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>(getFunction, setFunction));
 }
 
-/// Make member attribute accessor.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); })
+/// Make member attribute accessor. The member is read by reference.
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype((self.variable)) { return self.variable; }, \
+    [](ClassName& self, const typeName& value) { self.variable = value; })
 
 /// Make member attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); self.postSetCallback(); })
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype((self.variable)) { return self.variable; }, \
+    [](ClassName& self, const typeName& value) { self.variable = value; self.postSetCallback(); })
 
-/// Make get/set attribute accessor.
-#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.getFunction(); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(value.Get<typeName>()); })
+/// Make get/set attribute accessor. A getter returning a reference is not copied.
+#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(self.getFunction()) { return self.getFunction(); }, \
+    [](ClassName& self, const typeName& value) { self.setFunction(value); })
 
 /// Make member enum attribute accessor
-#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = static_cast<int>(self.variable); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = static_cast<decltype(self.variable)>(value.Get<int>()); })
+#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeTypedAttributeAccessor<ClassName, int>( \
+    [](const ClassName& self) { return static_cast<int>(self.variable); }, \
+    [](ClassName& self, const int& value) { self.variable = static_cast<decltype(self.variable)>(value); })
 
 /// Make member enum attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR_EX(variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = static_cast<int>(self.variable); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = static_cast<decltype(self.variable)>(value.Get<int>()); self.postSetCallback(); })
+#define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR_EX(variable, postSetCallback) Urho3D::MakeTypedAttributeAccessor<ClassName, int>( \
+    [](const ClassName& self) { return static_cast<int>(self.variable); }, \
+    [](ClassName& self, const int& value) { self.variable = static_cast<decltype(self.variable)>(value); self.postSetCallback(); })
 
 /// Make get/set enum attribute accessor.
-#define URHO3D_MAKE_GET_SET_ENUM_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = static_cast<int>(self.getFunction()); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(static_cast<typeName>(value.Get<int>())); })
+#define URHO3D_MAKE_GET_SET_ENUM_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeTypedAttributeAccessor<ClassName, int>( \
+    [](const ClassName& self) { return static_cast<int>(self.getFunction()); }, \
+    [](ClassName& self, const int& value) { self.setFunction(static_cast<typeName>(value)); })
 
 /// Attribute metadata.
 namespace AttributeMetadata
@@ -287,6 +287,11 @@ void PhysicsWorld2D::Update(float timeStep)
     eventData[P_TIMESTEP] = timeStep;
     SendEvent(E_PHYSICSPRESTEP, eventData);
 
+    // Apply the batched transform changes so that the rigid bodies are in sync before stepping
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateTransforms();
+
     physicsStepping_ = true;
     world_->Step(timeStep, velocityIterations_, positionIterations_);
     physicsStepping_ = false;